@@ -78,6 +78,9 @@
 /* mbedTLS transport interface header.*/
 #include "transport_mbedtls.h"
 
+/* TLS connection pool for the HTTP downloads. */
+#include "transport_mbedtls_pool.h"
+
 /* OTA Library include. */
 #include "ota.h"
 
@@ -539,9 +542,11 @@ static MQTTAgentMessageContext_t xCommandQueue;
 static NetworkContext_t xNetworkContextMqtt;
 
 /**
- * @brief Network connection context used for HTTP connection.
+ * @brief Network connection context used for HTTP connection, acquired from
+ * the TLS connection pool so that consecutive downloads from the same host
+ * reuse the connection.
  */
-static NetworkContext_t xNetworkContextHttp;
+static NetworkContext_t * pxNetworkContextHttp = NULL;
 
 /**
  * @brief The host address string extracted from the pre-signed URL.
@@ -571,11 +576,6 @@ static uint8_t aucHttpUserBuffer[ HTTP_USER_BUFFER_LENGTH ];
  */
 static TlsTransportParams_t xTlsTransportParams;
 
-/**
- * @brief The parameters for the network context using a TLS channel for https.
- */
-static TlsTransportParams_t xTlsTransportParamsHttps;
-
 /**
  * @brief The global array of subscription elements.
  *
@@ -1719,7 +1719,7 @@ static void prvDisconnectFromMQTTBroker( void )
     prvSocketDisconnect( &xNetworkContextMqtt );
 }
 
-static BaseType_t connectToS3Server( NetworkContext_t * pxNetworkContext,
+static BaseType_t connectToS3Server( NetworkContext_t ** ppxNetworkContext,
                                      const char * pcUrl )
 {
     TlsTransportStatus_t xNetworkStatus;
@@ -1730,7 +1730,7 @@ static BaseType_t connectToS3Server( NetworkContext_t * pxNetworkContext,
     /* The location of the host address within the pre-signed URL. */
     const char * pcAddress = NULL;
 
-    configASSERT( pxNetworkContext != NULL );
+    configASSERT( ppxNetworkContext != NULL );
 
     /* Retrieve the address location and length from S3_PRESIGNED_GET_URL. */
     if( pcUrl != NULL )
@@ -1769,13 +1769,14 @@ static BaseType_t connectToS3Server( NetworkContext_t * pxNetworkContext,
                    acServerHost,
                    democonfigHTTPS_PORT ) );
 
-        /* Attempt to create a server-authenticated TLS connection. */
-        xNetworkStatus = TLS_FreeRTOS_Connect( pxNetworkContext,
-                                               acServerHost,
-                                               democonfigHTTPS_PORT,
-                                               &xNetworkCredentials,
-                                               otaexampleTRANSPORT_SEND_RECV_TIMEOUT_MS,
-                                               otaexampleTRANSPORT_SEND_RECV_TIMEOUT_MS );
+        /* Attempt to create a server-authenticated TLS connection, or reuse
+         * an idle one to the same host. */
+        xNetworkStatus = TLS_FreeRTOS_PoolAcquire( ppxNetworkContext,
+                                                   acServerHost,
+                                                   democonfigHTTPS_PORT,
+                                                   &xNetworkCredentials,
+                                                   otaexampleTRANSPORT_SEND_RECV_TIMEOUT_MS,
+                                                   otaexampleTRANSPORT_SEND_RECV_TIMEOUT_MS );
 
         if( xNetworkStatus == TLS_TRANSPORT_SUCCESS )
         {
@@ -1866,21 +1867,27 @@ static OtaHttpStatus_t httpInit( char * pUrl )
     /* Establish HTTPs connection */
     LogInfo( ( "Performing TLS handshake on top of the TCP connection." ) );
 
-    xNetworkContextHttp.pParams = &xTlsTransportParamsHttps;
+    /* Give back the connection of a previous download that was not
+     * deinitialized. */
+    if( pxNetworkContextHttp != NULL )
+    {
+        TLS_FreeRTOS_PoolRelease( pxNetworkContextHttp, pdTRUE );
+        pxNetworkContextHttp = NULL;
+    }
 
     /* Attempt to connect to the HTTPs server. If connection fails, retry after
      * a timeout. Timeout value will be exponentially increased till the maximum
      * attempts are reached or maximum timeout value is reached. The function
      * returns EXIT_FAILURE if the TCP connection cannot be established to
      * broker after configured number of attempts. */
-    xReturnStatus = connectToS3Server( &xNetworkContextHttp, pUrl );
+    xReturnStatus = connectToS3Server( &pxNetworkContextHttp, pUrl );
 
     if( xReturnStatus == pdPASS )
     {
         /* Define the transport interface. */
         ( void ) memset( &xTransportInterfaceHttp, 0, sizeof( xTransportInterfaceHttp ) );
         /* Define the transport interface. */
-        xTransportInterfaceHttp.pNetworkContext = &xNetworkContextHttp;
+        xTransportInterfaceHttp.pNetworkContext = pxNetworkContextHttp;
         xTransportInterfaceHttp.send = TLS_FreeRTOS_send;
         xTransportInterfaceHttp.recv = TLS_FreeRTOS_recv;
 
@@ -1953,7 +1960,12 @@ static OtaHttpStatus_t httpRequest( uint32_t rangeStart,
 
     HTTPClient_AddRangeHeader( &requestHeaders, rangeStart, rangeEnd );
 
-    if( httpStatus == HTTPSuccess )
+    if( ( httpStatus == HTTPSuccess ) && ( xTransportInterfaceHttp.pNetworkContext == NULL ) )
+    {
+        /* An earlier reconnect failed, so connect again below instead. */
+        httpStatus = HTTPNetworkError;
+    }
+    else if( httpStatus == HTTPSuccess )
     {
         /* Initialize the response object. The same buffer used for storing
          * request headers is reused here. */
@@ -2003,11 +2015,20 @@ static OtaHttpStatus_t httpRequest( uint32_t rangeStart,
     if( reconnectRequired == true )
     {
         /* End TLS session, then close TCP connection. */
-        TLS_FreeRTOS_Disconnect( &xNetworkContextHttp );
+        if( pxNetworkContextHttp != NULL )
+        {
+            TLS_FreeRTOS_PoolRelease( pxNetworkContextHttp, pdFALSE );
+            pxNetworkContextHttp = NULL;
+        }
+
+        /* The released context must not be used again, and the pool may hand
+         * out a different one for the new connection. */
+        xTransportInterfaceHttp.pNetworkContext = NULL;
 
         /* Try establishing connection to S3 server again. */
-        if( connectToS3Server( &xNetworkContextHttp, NULL ) == EXIT_SUCCESS )
+        if( connectToS3Server( &pxNetworkContextHttp, NULL ) == EXIT_SUCCESS )
         {
+            xTransportInterfaceHttp.pNetworkContext = pxNetworkContextHttp;
             ret = HTTPSuccess;
         }
         else
@@ -2030,7 +2051,14 @@ static OtaHttpStatus_t httpDeinit( void )
 {
     OtaHttpStatus_t ret = OtaHttpSuccess;
 
-    /* Nothing special to do here .*/
+    /* Keep the connection open in the pool for the next download. */
+    if( pxNetworkContextHttp != NULL )
+    {
+        TLS_FreeRTOS_PoolRelease( pxNetworkContextHttp, pdTRUE );
+        pxNetworkContextHttp = NULL;
+    }
+
+    xTransportInterfaceHttp.pNetworkContext = NULL;
 
     return ret;
 }
@@ -2546,6 +2574,13 @@ void vOtaDemoTask( void * pParam )
         xReturnStatus = pdFAIL;
     }
 
+    /* Create the pool of HTTPS connections. */
+    if( TLS_FreeRTOS_PoolInit() != TLS_TRANSPORT_SUCCESS )
+    {
+        LogError( ( "Failed to initialize the TLS connection pool." ) );
+        xReturnStatus = pdFAIL;
+    }
+
     /* Wait for Networking */
     if( xPlatformIsNetworkUp() == pdFALSE )
     {
@@ -1437,7 +1437,7 @@ static MQTTStatus_t prvMQTTInit( void )
     xTransport.pNetworkContext = &xNetworkContextMqtt;
     xTransport.send = TLS_FreeRTOS_send;
     xTransport.recv = TLS_FreeRTOS_recv;
-    xTransport.writev = NULL;
+    xTransport.writev = TLS_FreeRTOS_writev;
 
     /* Initialize MQTT library. */
     xReturn = MQTTAgent_Init( &xGlobalMqttAgentContext,
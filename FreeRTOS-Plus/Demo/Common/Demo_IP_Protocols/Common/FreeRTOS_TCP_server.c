@@ -33,6 +33,7 @@
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "task.h"
+#include "queue.h"
 
 /* FreeRTOS+TCP includes. */
 #include "FreeRTOS_IP.h"
@@ -53,6 +54,28 @@ static char *strnew( const char *pcString );
 /* Remove slashes at the end of a path. */
 static void prvRemoveSlash( char *pcDir );
 
+#if( ipconfigTCP_SERVER_WORKERS > 0 ) && ( ipconfigSUPPORT_SIGNALS == 0 )
+	#error ipconfigTCP_SERVER_WORKERS needs ipconfigSUPPORT_SIGNALS, to wake up a worker when it is given a client
+#endif
+
+#if( ipconfigTCP_SERVER_WORKERS > 0 )
+	/* A connection accepted by the parent, on its way to a worker. */
+	typedef struct xNEW_CLIENT
+	{
+		BaseType_t xIndex;		/* The index in xServers[]. */
+		Socket_t xSocket;
+	} NewClient_t;
+
+	/* Create the worker tasks, each with its own copy of the server. */
+	static void prvCreateWorkers( TCPServer_t *pxServer, const struct xSERVER_CONFIG *pxConfigs );
+	/* Pass a new connection to the least busy worker, returns pdFALSE if there
+	is no worker. */
+	static BaseType_t prvPassToWorker( TCPServer_t *pxServer, BaseType_t xIndex, Socket_t xNexSocket );
+	/* Take over the connections passed by the parent. */
+	static void prvReceiveFromParent( TCPServer_t *pxServer );
+	static void prvWorkerTask( void *pvParameters );
+#endif
+
 TCPServer_t *FreeRTOS_CreateTCPServer( const struct xSERVER_CONFIG *pxConfigs, BaseType_t xCount )
 {
 TCPServer_t *pxServer;
@@ -139,6 +162,12 @@ SocketSet_t xSocketSet;
 					}
 				}
 			}
+
+			#if( ipconfigTCP_SERVER_WORKERS > 0 )
+			{
+				prvCreateWorkers( pxServer, pxConfigs );
+			}
+			#endif
 		}
 		else
 		{
@@ -208,7 +237,10 @@ const char *pcType = "Unknown";
 		pxClient->pxNextClient = pxServer->pxClients;
 		pxClient->fWorkFunction = fWorkFunc;
 		pxClient->fDeleteFunction = fDeleteFunc;
+		/* Give the new client a first turn, e.g. to send a welcome message. */
+		pxClient->xPoll = pdTRUE;
 		pxServer->pxClients = pxClient;
+		pxServer->uxClientCount++;
 
 		FreeRTOS_FD_SET( xNexSocket, pxServer->xSocketSet, eSELECT_READ|eSELECT_EXCEPT );
 	}
@@ -241,10 +273,20 @@ void FreeRTOS_TCPServerWork( TCPServer_t *pxServer, TickType_t xBlockingTime )
 TCPClient_t **ppxClient;
 BaseType_t xIndex;
 BaseType_t xRc;
+BaseType_t xResult;
 
 	/* Let the server do one working cycle */
 	xRc = FreeRTOS_select( pxServer->xSocketSet, xBlockingTime );
 
+	#if( ipconfigTCP_SERVER_WORKERS > 0 )
+	{
+		if( pxServer->xNewClients != NULL )
+		{
+			prvReceiveFromParent( pxServer );
+		}
+	}
+	#endif
+
 	if( xRc != 0 )
 	{
 		for( xIndex = 0; xIndex < pxServer->xServerCount; xIndex++ )
@@ -253,8 +295,10 @@ BaseType_t xRc;
 		Socket_t xNexSocket;
 		socklen_t xSocketLength;
 
-			if( pxServer->xServers[ xIndex ].xSocket == FREERTOS_NO_SOCKET )
+			if( ( pxServer->xServers[ xIndex ].xSocket == FREERTOS_NO_SOCKET ) ||
+				( ( FreeRTOS_FD_ISSET( pxServer->xServers[ xIndex ].xSocket, pxServer->xSocketSet ) & eSELECT_READ ) == 0 ) )
 			{
+				/* No connection is waiting to be accepted. */
 				continue;
 			}
 
@@ -263,7 +307,19 @@ BaseType_t xRc;
 
 			if( ( xNexSocket != FREERTOS_NO_SOCKET ) && ( xNexSocket != FREERTOS_INVALID_SOCKET ) )
 			{
-				prvReceiveNewClient( pxServer, xIndex, xNexSocket );
+				#if( ipconfigTCP_SERVER_WORKERS > 0 )
+				{
+					/* The parent only serves a client itself when it has no workers. */
+					if( prvPassToWorker( pxServer, xIndex, xNexSocket ) == pdFALSE )
+					{
+						prvReceiveNewClient( pxServer, xIndex, xNexSocket );
+					}
+				}
+				#else
+				{
+					prvReceiveNewClient( pxServer, xIndex, xNexSocket );
+				}
+				#endif
 			}
 		}
 	}
@@ -274,12 +330,23 @@ BaseType_t xRc;
 	{
 	TCPClient_t *pxThis = *ppxClient;
 
-		/* Almost C++ */
-		xRc = pxThis->fWorkFunction( pxThis );
+		/* Only the clients of which the socket has an event, and the clients
+		that asked for it, get a turn.  Idle clients cost no more than a look
+		at their socket bits. */
+		xResult = 0;
+		if( ( pxThis->xPoll != pdFALSE ) ||
+			( ( xRc != 0 ) && ( FreeRTOS_FD_ISSET( pxThis->xSocket, pxServer->xSocketSet ) != 0 ) ) )
+		{
+			pxThis->xPoll = pdFALSE;
 
-		if (xRc < 0 )
+			/* Almost C++ */
+			xResult = pxThis->fWorkFunction( pxThis );
+		}
+
+		if( xResult < 0 )
 		{
 			*ppxClient = pxThis->pxNextClient;
+			pxServer->uxClientCount--;
 			/* Close handles, resources */
 			pxThis->fDeleteFunction( pxThis );
 			/* Free the space */
@@ -293,6 +360,167 @@ BaseType_t xRc;
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigTCP_SERVER_WORKERS > 0 )
+
+	static void prvCreateWorkers( TCPServer_t *pxServer, const struct xSERVER_CONFIG *pxConfigs )
+	{
+	TCPServer_t *pxWorker;
+	BaseType_t xSize;
+	BaseType_t xWorker;
+	BaseType_t xIndex;
+	UBaseType_t uxQueueLength = 1u;
+
+		xSize = sizeof( *pxServer ) - sizeof( pxServer->xServers ) + pxServer->xServerCount * sizeof( pxServer->xServers[ 0 ] );
+
+		/* A worker can have at most all connections of the backlogs waiting. */
+		for( xIndex = 0; xIndex < pxServer->xServerCount; xIndex++ )
+		{
+			uxQueueLength += ( UBaseType_t ) pxConfigs[ xIndex ].xBackLog;
+		}
+
+		for( xWorker = 0; xWorker < ipconfigTCP_SERVER_WORKERS; xWorker++ )
+		{
+			pxWorker = ( TCPServer_t * ) pvPortMallocLarge( xSize );
+			if( pxWorker == NULL )
+			{
+				break;
+			}
+
+			memset( pxWorker, '\0', xSize );
+			pxWorker->xServerCount = pxServer->xServerCount;
+			pxWorker->xSocketSet = FreeRTOS_CreateSocketSet();
+			pxWorker->xNewClients = xQueueCreate( uxQueueLength, sizeof( NewClient_t ) );
+
+			/* The parent signals this socket to interrupt the worker's select()
+			when it has queued a new client. */
+			pxWorker->xWakeSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+			if( pxWorker->xWakeSocket == FREERTOS_INVALID_SOCKET )
+			{
+				pxWorker->xWakeSocket = FREERTOS_NO_SOCKET;
+			}
+			else if( pxWorker->xSocketSet != NULL )
+			{
+				FreeRTOS_FD_SET( pxWorker->xWakeSocket, pxWorker->xSocketSet, eSELECT_READ );
+			}
+
+			/* The worker serves clients of all types, but it has no listening
+			sockets.  The root directories are shared with the parent. */
+			for( xIndex = 0; xIndex < pxServer->xServerCount; xIndex++ )
+			{
+				pxWorker->xServers[ xIndex ].eType = pxServer->xServers[ xIndex ].eType;
+				pxWorker->xServers[ xIndex ].pcRootDir = pxServer->xServers[ xIndex ].pcRootDir;
+				pxWorker->xServers[ xIndex ].xSocket = FREERTOS_NO_SOCKET;
+			}
+
+			if( ( pxWorker->xSocketSet == NULL ) || ( pxWorker->xNewClients == NULL ) || ( pxWorker->xWakeSocket == FREERTOS_NO_SOCKET ) ||
+				( xTaskCreate( prvWorkerTask, "TCPWorker", ipconfigTCP_SERVER_WORKER_STACK_SIZE, ( void * ) pxWorker,
+					uxTaskPriorityGet( NULL ), NULL ) != pdPASS ) )
+			{
+				FreeRTOS_printf( ( "TCP-server: could not create worker %d\n", ( int ) xWorker ) );
+				if( pxWorker->xWakeSocket != FREERTOS_NO_SOCKET )
+				{
+					FreeRTOS_closesocket( pxWorker->xWakeSocket );
+				}
+				if( pxWorker->xSocketSet != NULL )
+				{
+					FreeRTOS_DeleteSocketSet( pxWorker->xSocketSet );
+				}
+				if( pxWorker->xNewClients != NULL )
+				{
+					vQueueDelete( pxWorker->xNewClients );
+				}
+				vPortFreeLarge( pxWorker );
+				break;
+			}
+
+			pxServer->pxWorkers[ xWorker ] = pxWorker;
+		}
+	}
+
+#endif /* ipconfigTCP_SERVER_WORKERS */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_SERVER_WORKERS > 0 )
+
+	static BaseType_t prvPassToWorker( TCPServer_t *pxServer, BaseType_t xIndex, Socket_t xNexSocket )
+	{
+	TCPServer_t *pxWorker = NULL;
+	UBaseType_t uxLoad;
+	UBaseType_t uxLowest = ~0u;
+	NewClient_t xNewClient;
+	BaseType_t xWorker;
+
+		for( xWorker = 0; xWorker < ipconfigTCP_SERVER_WORKERS; xWorker++ )
+		{
+			if( pxServer->pxWorkers[ xWorker ] != NULL )
+			{
+				/* Also count the clients that are still in the queue. */
+				uxLoad = pxServer->pxWorkers[ xWorker ]->uxClientCount +
+					uxQueueMessagesWaiting( pxServer->pxWorkers[ xWorker ]->xNewClients );
+				if( uxLoad < uxLowest )
+				{
+					uxLowest = uxLoad;
+					pxWorker = pxServer->pxWorkers[ xWorker ];
+				}
+			}
+		}
+
+		if( pxWorker == NULL )
+		{
+			return pdFALSE;
+		}
+
+		/* The worker adds the socket to its own set once it has received it.
+		Signalling its wake socket interrupts the select() it is blocked in, the
+		signal is kept until the next select() if it is not blocked. */
+		xNewClient.xIndex = xIndex;
+		xNewClient.xSocket = xNexSocket;
+		if( xQueueSend( pxWorker->xNewClients, &xNewClient, 0 ) == pdPASS )
+		{
+			FreeRTOS_SignalSocket( pxWorker->xWakeSocket );
+		}
+		else
+		{
+			FreeRTOS_printf( ( "TCP-server: worker queue full, connection closed\n" ) );
+			FreeRTOS_closesocket( xNexSocket );
+		}
+
+		return pdTRUE;
+	}
+
+#endif /* ipconfigTCP_SERVER_WORKERS */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_SERVER_WORKERS > 0 )
+
+	static void prvReceiveFromParent( TCPServer_t *pxServer )
+	{
+	NewClient_t xNewClient;
+
+		while( xQueueReceive( pxServer->xNewClients, &xNewClient, 0 ) == pdPASS )
+		{
+			prvReceiveNewClient( pxServer, xNewClient.xIndex, xNewClient.xSocket );
+		}
+	}
+
+#endif /* ipconfigTCP_SERVER_WORKERS */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_SERVER_WORKERS > 0 )
+
+	static void prvWorkerTask( void *pvParameters )
+	{
+	TCPServer_t *pxServer = ( TCPServer_t * ) pvParameters;
+
+		for( ;; )
+		{
+			FreeRTOS_TCPServerWork( pxServer, ipconfigTCP_SERVER_WORKER_BLOCK_TIME );
+		}
+	}
+
+#endif /* ipconfigTCP_SERVER_WORKERS */
+/*-----------------------------------------------------------*/
+
 static char *strnew( const char *pcString )
 {
 BaseType_t xLength;
@@ -88,9 +88,12 @@
 #endif
 
 /*
- * ipconfigFTP_ZERO_COPY_ALIGNED_WRITES : experimental optimisation option.
- * If non-zero, receiving data will be done with the zero-copy method and also
- * writes to disk will be done with sector-alignment as much as possible.
+ * ipconfigFTP_ZERO_COPY_ALIGNED_WRITES : if non-zero, received data will be
+ * written to disk in multiples of ipconfigFTP_PREFERRED_WRITE_SIZE bytes,
+ * straight from the RX stream of the data socket.  Only data that wraps around
+ * the end of the RX stream is copied to the file buffer first, which frees that
+ * part of the RX stream before the data is written.  The last bytes of a file
+ * are written when the peer has closed the connection.
  */
 #ifndef ipconfigFTP_ZERO_COPY_ALIGNED_WRITES
 	#define ipconfigFTP_ZERO_COPY_ALIGNED_WRITES			0
@@ -258,9 +261,10 @@ BaseType_t xMakeAbsolute( FTPClient_t *pxClient, char *pcBuffer, BaseType_t xBuf
 ####     #### ####           ## ##   ####  ####    ##   ##
 
  *	xFTPClientWork()
- *	will be called by FreeRTOS_TCPServerWork(), after select has expired().
- *	FD_ISSET will not be used.  This work function will always be called at
- *	regular intervals, and also after a select() event has occurred.
+ *	will be called by FreeRTOS_TCPServerWork() when the command socket has an
+ *	event.  While a data connection is open, 'xPoll' is set so that it will
+ *	also be called after every select(), for the events and the time-outs of
+ *	the data connection.
  */
 BaseType_t xFTPClientWork( TCPClient_t *pxTCPClient )
 {
@@ -369,6 +373,9 @@ BaseType_t xRc;
 		}
 	}
 
+	/* The events of the data socket are not seen by FreeRTOS_TCPServerWork(). */
+	pxClient->xPoll = ( pxClient->xTransferSocket != FREERTOS_NO_SOCKET ) ? pdTRUE : pdFALSE;
+
 	return xRc;
 }
 /*-----------------------------------------------------------*/
@@ -1161,6 +1168,16 @@ static void prvTransferCloseFile( FTPClient_t *pxClient )
 		ff_fclose( pxClient->pxReadHandle );
 		pxClient->pxReadHandle = NULL;
 	}
+	#if( ipconfigFTP_READ_AHEAD_SIZE > 0 )
+	{
+		if( pxClient->pcReadAhead != NULL )
+		{
+			vPortFree( pxClient->pcReadAhead );
+			pxClient->pcReadAhead = NULL;
+		}
+		pxClient->uxReadAheadLength = 0u;
+	}
+	#endif
 	/* These two field are only used for logging / file-statistics */
 	pxClient->ulRecvBytes = 0ul;
 	pxClient->xStartTime = 0ul;
@@ -1480,6 +1497,10 @@ int iErrorNo;
 		#define ipconfigFTP_PREFERRED_WRITE_SIZE	512ul
 	#endif
 
+	#if( ipconfigTCP_FILE_BUFFER_SIZE < ipconfigFTP_PREFERRED_WRITE_SIZE )
+		#error ipconfigTCP_FILE_BUFFER_SIZE must be at least ipconfigFTP_PREFERRED_WRITE_SIZE
+	#endif
+
 	static BaseType_t prvStoreFileWork( FTPClient_t *pxClient )
 	{
 	BaseType_t xRc, xWritten;
@@ -1529,14 +1550,19 @@ int iErrorNo;
 					else
 					{
 						/* Now reading beyond the end of the circular buffer,
-						use a normal read. */
+						use a normal read.  The copy frees the RX stream before
+						the data is written. */
 						pcBuffer = pcFILE_BUFFER;
 						xRc = FreeRTOS_recvcount( pxClient->xTransferSocket );
+						if( xRc > ( BaseType_t ) sizeof( pcFILE_BUFFER ) )
+						{
+							xRc = sizeof( pcFILE_BUFFER );
+						}
 						xRc = ( xRc / ipconfigFTP_PREFERRED_WRITE_SIZE ) * ipconfigFTP_PREFERRED_WRITE_SIZE;
 						if( xRc > 0 )
 						{
 							xRc = FreeRTOS_recv( pxClient->xTransferSocket, ( void * ) pcBuffer,
-								sizeof( pcFILE_BUFFER ), FREERTOS_MSG_DONTWAIT );
+								xRc, FREERTOS_MSG_DONTWAIT );
 						}
 					}
 				}
@@ -1666,6 +1692,15 @@ size_t uxFileSize;
 		/* Prepare the ACK which will be sent when all data has been sent. */
 		snprintf( pxClient->pcClientAck, sizeof( pxClient->pcClientAck ), "%s", REPL_226 );
 
+		#if( ipconfigFTP_READ_AHEAD_SIZE > 0 )
+		{
+			/* Without this buffer, the file is only read when there is space
+			in the TX stream. */
+			pxClient->pcReadAhead = ( char * ) pvPortMalloc( ipconfigFTP_READ_AHEAD_SIZE );
+			pxClient->uxReadAheadLength = 0u;
+		}
+		#endif
+
 		/* To get some statistics about the performance. */
 		pxClient->xStartTime = xTaskGetTickCount( );
 		if( uxFileSize == 0ul )
@@ -1682,6 +1717,7 @@ static BaseType_t prvRetrieveFileWork( FTPClient_t *pxClient )
 {
 size_t uxSpace;
 size_t uxCount, uxItemsRead;
+size_t uxLeft;
 BaseType_t xRc = 0;
 BaseType_t xSetEvent = pdFALSE;
 
@@ -1697,12 +1733,57 @@ BaseType_t xSetEvent = pdFALSE;
 		read from the file) */
 		uxSpace = FreeRTOS_tx_space( pxClient->xTransferSocket );
 
-		if( uxSpace == 0 )
+		#if( ipconfigFTP_READ_AHEAD_SIZE > 0 )
 		{
-			FreeRTOS_FD_SET( pxClient->xTransferSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE | eSELECT_EXCEPT );
-			xRc = FreeRTOS_select( pxClient->pxParent->xSocketSet, 200 );
-			uxSpace = FreeRTOS_tx_space( pxClient->xTransferSocket );
+			if( pxClient->uxReadAheadLength > 0u )
+			{
+				/* First send the data that was read while the TX stream was
+				full. */
+				uxCount = FreeRTOS_min_uint32( pxClient->uxReadAheadLength, uxSpace );
+				if( uxCount == 0u )
+				{
+					break;
+				}
+
+				if( ( pxClient->uxBytesLeft == 0u ) && ( uxCount == pxClient->uxReadAheadLength ) )
+				{
+				BaseType_t xTrueValue = 1;
+
+					FreeRTOS_setsockopt( pxClient->xTransferSocket, 0, FREERTOS_SO_CLOSE_AFTER_SEND, ( void * ) &xTrueValue, sizeof( xTrueValue ) );
+				}
+
+				xRc = FreeRTOS_send( pxClient->xTransferSocket, pxClient->pcReadAhead + pxClient->uxReadAheadHead, uxCount, 0 );
+				if( xRc < 0 )
+				{
+					break;
+				}
+				pxClient->ulRecvBytes += xRc;
+				pxClient->uxReadAheadHead += ( size_t ) xRc;
+				pxClient->uxReadAheadLength -= ( size_t ) xRc;
+				continue;
+			}
+
+			if( ( uxSpace == 0u ) && ( pxClient->pcReadAhead != NULL ) && ( pxClient->uxBytesLeft > 0u ) )
+			{
+				/* The TX stream is full and is being sent by the IP-task.  Read
+				the next part of the file now, it will be queued as soon as
+				there is space. */
+				uxCount = FreeRTOS_min_uint32( pxClient->uxBytesLeft, ipconfigFTP_READ_AHEAD_SIZE );
+				uxItemsRead = ff_fread( pxClient->pcReadAhead, 1, uxCount, pxClient->pxReadHandle );
+				if( uxItemsRead != uxCount )
+				{
+					FreeRTOS_printf( ( "prvRetrieveFileWork: Got %u Expected %u\n", ( unsigned )uxItemsRead, ( unsigned ) uxCount ) );
+					xRc = FreeRTOS_shutdown( pxClient->xTransferSocket, FREERTOS_SHUT_RDWR );
+					pxClient->uxBytesLeft = 0u;
+					break;
+				}
+				pxClient->uxBytesLeft -= uxCount;
+				pxClient->uxReadAheadHead = 0u;
+				pxClient->uxReadAheadLength = uxCount;
+				break;
+			}
 		}
+		#endif /* ipconfigFTP_READ_AHEAD_SIZE */
 
 		uxCount = FreeRTOS_min_uint32( pxClient->uxBytesLeft, uxSpace );
 
@@ -1809,11 +1890,18 @@ BaseType_t xSetEvent = pdFALSE;
 		}
 	} while( uxCount > 0u );
 
+	uxLeft = pxClient->uxBytesLeft;
+	#if( ipconfigFTP_READ_AHEAD_SIZE > 0 )
+	{
+		uxLeft += pxClient->uxReadAheadLength;
+	}
+	#endif
+
 	if( xRc < 0 )
 	{
 		FreeRTOS_printf( ( "prvRetrieveFileWork: already disconnected\n" ) );
 	}
-	else if( pxClient->uxBytesLeft <= 0u )
+	else if( uxLeft == 0u )
 	{
 	BaseType_t x;
 
@@ -59,6 +59,8 @@ const char *webCodename (int aCode)
 		return "OK";
 	case WEB_NO_CONTENT:    // 204
 		return "No content";
+	case WEB_NOT_MODIFIED:	//  = 304,
+		return "Not Modified";
 	case WEB_BAD_REQUEST:	//  = 400,
 		return "Bad request";
 	case WEB_UNAUTHORIZED:	//  = 401,
@@ -71,6 +73,8 @@ const char *webCodename (int aCode)
 		return "Precondition Failed";
 	case WEB_INTERNAL_SERVER_ERROR:	//  = 500,
 		return "Internal Server Error";
+	case WEB_NOT_IMPLEMENTED:	//  = 501,
+		return "Not Implemented";
 	}
 	return "Unknown";
 }
@@ -59,6 +59,12 @@
 	#define USE_HTML_CHUNKS				( 0 )
 #endif
 
+/* When 1, files are read straight into the TX stream buffer of the socket,
+instead of being copied through pcFileBuffer. */
+#ifndef ipconfigHTTP_ZERO_COPY_TX
+	#define ipconfigHTTP_ZERO_COPY_TX	( 1 )
+#endif
+
 #if !defined( ARRAY_SIZE )
 	#define ARRAY_SIZE(x) ( BaseType_t ) (sizeof( x ) / sizeof( x )[ 0 ] )
 #endif
@@ -75,10 +81,27 @@
 /*_RB_ Need comment block, although fairly self evident. */
 static void prvFileClose( HTTPClient_t *pxClient );
 static BaseType_t prvProcessCmd( HTTPClient_t *pxClient, BaseType_t xIndex );
+static BaseType_t prvProcessRequest( HTTPClient_t *pxClient, char *pcBuffer, BaseType_t xRc );
 static const char *pcGetContentsType( const char *apFname );
 static BaseType_t prvOpenURL( HTTPClient_t *pxClient );
 static BaseType_t prvSendFile( HTTPClient_t *pxClient );
 static BaseType_t prvSendReply( HTTPClient_t *pxClient, BaseType_t xCode );
+static BaseType_t prvSendingFile( HTTPClient_t *pxClient );
+
+/* Copies the value of header pcName into pcValue, returns pdFALSE if the
+request does not have the header. */
+static BaseType_t prvGetHeader( const char *pcHeaders, const char *pcName, char *pcValue, size_t uxValueSize );
+
+#if( ffconfigTIME_SUPPORT == 1 )
+	/* Formats a time in seconds since 1970 as an HTTP date. */
+	static void prvFormatHTTPDate( uint32_t ulSeconds, char *pcBuffer, size_t uxBufferLength );
+#endif
+
+#if( ipconfigHTTP_FILE_CACHE_ENTRIES > 0 )
+	/* Returns the cache entry holding the current file, reading the file into
+	the cache if needed, or NULL if the file can not be served from the cache. */
+	static HTTPCacheEntry_t *prvCacheOpen( HTTPClient_t *pxClient, const FF_Stat_t *pxStat );
+#endif
 
 static const char pcEmptyString[1] = { '\0' };
 
@@ -117,6 +140,12 @@ HTTPClient_t *pxClient = ( HTTPClient_t * ) pxTCPClient;
 		pxClient->xSocket = FREERTOS_NO_SOCKET;
 	}
 	prvFileClose( pxClient );
+
+	if( pxClient->pcPending != NULL )
+	{
+		vPortFree( pxClient->pcPending );
+		pxClient->pcPending = NULL;
+	}
 }
 /*-----------------------------------------------------------*/
 
@@ -128,6 +157,33 @@ static void prvFileClose( HTTPClient_t *pxClient )
 		ff_fclose( pxClient->pxFileHandle );
 		pxClient->pxFileHandle = NULL;
 	}
+
+	#if( ipconfigHTTP_FILE_CACHE_ENTRIES > 0 )
+	{
+		if( pxClient->pxCacheEntry != NULL )
+		{
+			pxClient->pxCacheEntry->uxUsers--;
+			pxClient->pxCacheEntry = NULL;
+		}
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSendingFile( HTTPClient_t *pxClient )
+{
+BaseType_t xResult = ( pxClient->pxFileHandle != NULL ) ? pdTRUE : pdFALSE;
+
+	#if( ipconfigHTTP_FILE_CACHE_ENTRIES > 0 )
+	{
+		if( pxClient->pxCacheEntry != NULL )
+		{
+			xResult = pdTRUE;
+		}
+	}
+	#endif
+
+	return xResult;
 }
 /*-----------------------------------------------------------*/
 
@@ -145,11 +201,12 @@ BaseType_t xRc;
 		"Transfer-Encoding: chunked\r\n"
 #endif
 		"Content-Type: %s\r\n"
-		"Connection: keep-alive\r\n"
+		"Connection: %s\r\n"
 		"%s\r\n",
 		( int ) xCode,
 		webCodename (xCode),
 		pxParent->pcContentsType[0] ? pxParent->pcContentsType : "text/html",
+		pxClient->bits.bCloseAfterReply ? "close" : "keep-alive",
 		pxParent->pcExtraContents );
 
 	pxParent->pcContentsType[0] = '\0';
@@ -167,16 +224,16 @@ static BaseType_t prvSendFile( HTTPClient_t *pxClient )
 size_t uxSpace;
 size_t uxCount;
 BaseType_t xRc = 0;
+#if( ipconfigHTTP_ZERO_COPY_TX != 0 )
+	uint8_t *pucHead;
+	BaseType_t xHeadSpace;
+#endif
 
 	if( pxClient->bits.bReplySent == pdFALSE_UNSIGNED )
 	{
 		pxClient->bits.bReplySent = pdTRUE_UNSIGNED;
 
-		strcpy( pxClient->pxParent->pcContentsType, pcGetContentsType( pxClient->pcCurrentFilename ) );
-		snprintf( pxClient->pxParent->pcExtraContents, sizeof( pxClient->pxParent->pcExtraContents ),
-			"Content-Length: %d\r\n", ( int ) pxClient->uxBytesLeft );
-
-		/* "Requested file action OK". */
+		/* "Requested file action OK", the headers were prepared by prvOpenURL(). */
 		xRc = prvSendReply( pxClient, WEB_REPLY_OK );
 	}
 
@@ -193,7 +250,55 @@ BaseType_t xRc = 0;
 			uxCount = uxSpace;
 		}
 
-		if( uxCount > 0u )
+		if( uxCount == 0u )
+		{
+			break;
+		}
+
+		#if( ipconfigHTTP_FILE_CACHE_ENTRIES > 0 )
+		if( pxClient->pxCacheEntry != NULL )
+		{
+			/* A cached file is copied straight from RAM into the socket. */
+			xRc = FreeRTOS_send( pxClient->xSocket,
+				pxClient->pxCacheEntry->pucData + ( pxClient->pxCacheEntry->uxSize - pxClient->uxBytesLeft ), uxCount, 0 );
+			if( xRc < 0 )
+			{
+				break;
+			}
+			uxCount = ( size_t ) xRc;
+			pxClient->uxBytesLeft -= uxCount;
+			continue;
+		}
+		#endif /* ipconfigHTTP_FILE_CACHE_ENTRIES */
+
+		#if( ipconfigHTTP_ZERO_COPY_TX != 0 )
+		pucHead = FreeRTOS_get_tx_head( pxClient->xSocket, &xHeadSpace );
+		if( ( pucHead != NULL ) && ( xHeadSpace > 0 ) )
+		{
+			/* Read the file into the TX stream buffer, up to where the buffer
+			wraps.  Passing a NULL buffer to FreeRTOS_send() then only advances
+			the head of the stream. */
+			if( uxCount > ( size_t ) xHeadSpace )
+			{
+				uxCount = ( size_t ) xHeadSpace;
+			}
+			uxCount = ff_fread( pucHead, 1, uxCount, pxClient->pxFileHandle );
+			if( uxCount == 0u )
+			{
+				/* The file became shorter, stop sending. */
+				pxClient->uxBytesLeft = 0u;
+				break;
+			}
+			pxClient->uxBytesLeft -= uxCount;
+
+			xRc = FreeRTOS_send( pxClient->xSocket, NULL, uxCount, 0 );
+			if( xRc < 0 )
+			{
+				break;
+			}
+		}
+		else
+		#endif /* ipconfigHTTP_ZERO_COPY_TX */
 		{
 			if( uxCount > sizeof( pxClient->pxParent->pcFileBuffer ) )
 			{
@@ -230,8 +335,20 @@ static BaseType_t prvOpenURL( HTTPClient_t *pxClient )
 {
 BaseType_t xRc;
 char pcSlash[ 2 ];
+FF_Stat_t xStat;
+BaseType_t xGzip = pdFALSE;
+char *pcExtra = pxClient->pxParent->pcExtraContents;
+size_t uxExtraSize = sizeof( pxClient->pxParent->pcExtraContents );
+size_t uxLength;
+#if( ffconfigTIME_SUPPORT == 1 )
+	char pcETag[ 24 ];
+	char pcDate[ 32 ];
+	char pcValue[ 64 ];
+	BaseType_t xNotModified = pdFALSE;
+#endif
 
-	pxClient->bits.ulFlags = 0;
+	/* Release a file that was still being sent. */
+	prvFileClose( pxClient );
 
 	#if( ipconfigHTTP_HAS_HANDLE_REQUEST_HOOK != 0 )
 	{
@@ -274,6 +391,90 @@ char pcSlash[ 2 ];
 		pcSlash,
 		pxClient->pcUrlData);
 
+	/* The type follows from the requested name, also when a .gz companion is sent. */
+	strcpy( pxClient->pxParent->pcContentsType, pcGetContentsType( pxClient->pcCurrentFilename ) );
+	pcExtra[ 0 ] = '\0';
+
+	/* A precompressed "<name>.gz" is sent to clients that accept gzip. */
+	uxLength = strlen( pxClient->pcCurrentFilename );
+	if( uxLength + 4u <= sizeof( pxClient->pcCurrentFilename ) )
+	{
+		strcpy( pxClient->pcCurrentFilename + uxLength, ".gz" );
+		if( ff_stat( pxClient->pcCurrentFilename, &xStat ) == 0 )
+		{
+			/* The reply depends on Accept-Encoding, also when it is not compressed. */
+			strcpy( pcExtra, "Vary: Accept-Encoding\r\n" );
+			if( pxClient->bits.bAcceptGzip != pdFALSE_UNSIGNED )
+			{
+				strcat( pcExtra, "Content-Encoding: gzip\r\n" );
+				xGzip = pdTRUE;
+			}
+		}
+		if( xGzip == pdFALSE )
+		{
+			pxClient->pcCurrentFilename[ uxLength ] = '\0';
+		}
+	}
+
+	if( ( xGzip == pdFALSE ) && ( ff_stat( pxClient->pcCurrentFilename, &xStat ) != 0 ) )
+	{
+		FreeRTOS_printf( ( "Open file '%s': %s\n", pxClient->pcCurrentFilename, strerror( stdioGET_ERRNO() ) ) );
+
+		/* "404 File not found". */
+		pxClient->pxParent->pcContentsType[ 0 ] = '\0';
+		strcpy( pcExtra, "Content-Length: 0\r\n" );
+		return prvSendReply( pxClient, WEB_NOT_FOUND );
+	}
+
+	#if( ffconfigTIME_SUPPORT == 1 )
+	{
+		snprintf( pcETag, sizeof( pcETag ), "\"%lx-%lx\"", ( unsigned long ) xStat.st_size, ( unsigned long ) xStat.st_mtime );
+		prvFormatHTTPDate( xStat.st_mtime, pcDate, sizeof( pcDate ) );
+		uxLength = strlen( pcExtra );
+		snprintf( pcExtra + uxLength, uxExtraSize - uxLength, "ETag: %s\r\nLast-Modified: %s\r\n", pcETag, pcDate );
+
+		/* If-None-Match takes precedence over If-Modified-Since.  A date only
+		matches when it is the Last-Modified value sent earlier, which is what
+		browsers send back. */
+		if( prvGetHeader( pxClient->pcRestData, "If-None-Match", pcValue, sizeof( pcValue ) ) != pdFALSE )
+		{
+			xNotModified = ( ( strstr( pcValue, pcETag ) != NULL ) || ( strcmp( pcValue, "*" ) == 0 ) ) ? pdTRUE : pdFALSE;
+		}
+		else if( prvGetHeader( pxClient->pcRestData, "If-Modified-Since", pcValue, sizeof( pcValue ) ) != pdFALSE )
+		{
+			xNotModified = ( strcmp( pcValue, pcDate ) == 0 ) ? pdTRUE : pdFALSE;
+		}
+
+		if( xNotModified != pdFALSE )
+		{
+			/* "304 Not Modified", without a body. */
+			return prvSendReply( pxClient, WEB_NOT_MODIFIED );
+		}
+	}
+	#endif /* ffconfigTIME_SUPPORT */
+
+	uxLength = strlen( pcExtra );
+	snprintf( pcExtra + uxLength, uxExtraSize - uxLength, "Content-Length: %lu\r\n", ( unsigned long ) xStat.st_size );
+
+	if( pxClient->bits.bHeadOnly != pdFALSE_UNSIGNED )
+	{
+		/* HEAD: the headers of a GET, without the file. */
+		return prvSendReply( pxClient, WEB_REPLY_OK );
+	}
+
+	#if( ipconfigHTTP_FILE_CACHE_ENTRIES > 0 )
+	{
+		pxClient->pxCacheEntry = prvCacheOpen( pxClient, &xStat );
+		if( pxClient->pxCacheEntry != NULL )
+		{
+			pxClient->uxBytesLeft = pxClient->pxCacheEntry->uxSize;
+			/* Although against the coding standard of FreeRTOS, a return is
+			done here  to simplify this conditional code. */
+			return prvSendFile( pxClient );
+		}
+	}
+	#endif /* ipconfigHTTP_FILE_CACHE_ENTRIES */
+
 	pxClient->pxFileHandle = ff_fopen( pxClient->pcCurrentFilename, "rb" );
 
 	FreeRTOS_printf( ( "Open file '%s': %s\n", pxClient->pcCurrentFilename,
@@ -282,11 +483,13 @@ char pcSlash[ 2 ];
 	if( pxClient->pxFileHandle == NULL )
 	{
 		/* "404 File not found". */
+		pxClient->pxParent->pcContentsType[ 0 ] = '\0';
+		strcpy( pcExtra, "Content-Length: 0\r\n" );
 		xRc = prvSendReply( pxClient, WEB_NOT_FOUND );
 	}
 	else
 	{
-		pxClient->uxBytesLeft = ( size_t ) pxClient->pxFileHandle->ulFileSize;
+		pxClient->uxBytesLeft = ( size_t ) xStat.st_size;
 		xRc = prvSendFile( pxClient );
 	}
 
@@ -306,6 +509,10 @@ BaseType_t xResult = 0;
 		break;
 
 	case ECMD_HEAD:
+		pxClient->bits.bHeadOnly = pdTRUE_UNSIGNED;
+		xResult = prvOpenURL( pxClient );
+		break;
+
 	case ECMD_POST:
 	case ECMD_PUT:
 	case ECMD_DELETE:
@@ -317,6 +524,11 @@ BaseType_t xResult = 0;
 		{
 			FreeRTOS_printf( ( "prvProcessCmd: Not implemented: %s\n",
 				xWebCommands[xIndex].pcCommandName ) );
+
+			/* Every request gets a reply, or the requests pipelined behind
+			it would never be answered. */
+			strcpy( pxClient->pxParent->pcExtraContents, "Content-Length: 0\r\n" );
+			xResult = prvSendReply( pxClient, WEB_NOT_IMPLEMENTED );
 		}
 		break;
 	}
@@ -325,82 +537,408 @@ BaseType_t xResult = 0;
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t xHTTPClientWork( TCPClient_t *pxTCPClient )
+static BaseType_t prvProcessRequest( HTTPClient_t *pxClient, char *pcBuffer, BaseType_t xRc )
 {
-BaseType_t xRc;
-HTTPClient_t *pxClient = ( HTTPClient_t * ) pxTCPClient;
+BaseType_t xIndex;
+const char *pcEndOfCmd;
+const struct xWEB_COMMAND *curCmd;
+char pcValue[ 64 ];
+BaseType_t xHasConnection;
 
-	if( pxClient->pxFileHandle != NULL )
+	pxClient->bits.ulFlags = 0;
+
+	while( xRc && ( pcBuffer[ xRc - 1 ] == 13 || pcBuffer[ xRc - 1 ] == 10 ) )
 	{
-		prvSendFile( pxClient );
+		pcBuffer[ --xRc ] = '\0';
 	}
+	pcEndOfCmd = pcBuffer + xRc;
 
-	xRc = FreeRTOS_recv( pxClient->xSocket, ( void * )pcCOMMAND_BUFFER, sizeof( pcCOMMAND_BUFFER ), 0 );
+	curCmd = xWebCommands;
 
-	if( xRc > 0 )
+	/* Pointing to "/index.html HTTP/1.1". */
+	pxClient->pcUrlData = pcBuffer;
+
+	/* Pointing to "HTTP/1.1". */
+	pxClient->pcRestData = pcEmptyString;
+
+	/* Last entry is "ECMD_UNK". */
+	for( xIndex = 0; xIndex < WEB_CMD_COUNT - 1; xIndex++, curCmd++ )
 	{
-	BaseType_t xIndex;
-	const char *pcEndOfCmd;
-	const struct xWEB_COMMAND *curCmd;
-	char *pcBuffer = pcCOMMAND_BUFFER;
+	BaseType_t xLength;
 
-		if( xRc < ( BaseType_t ) sizeof( pcCOMMAND_BUFFER ) )
+		xLength = curCmd->xCommandLength;
+		if( ( xRc >= xLength ) && ( memcmp( curCmd->pcCommandName, pcBuffer, xLength ) == 0 ) )
 		{
-			pcBuffer[ xRc ] = '\0';
+		char *pcLastPtr;
+
+			pxClient->pcUrlData += xLength + 1;
+			for( pcLastPtr = (char *)pxClient->pcUrlData; pcLastPtr < pcEndOfCmd; pcLastPtr++ )
+			{
+				char ch = *pcLastPtr;
+				if( ( ch == '\0' ) || ( strchr( "\n\r \t", ch ) != NULL ) )
+				{
+					*pcLastPtr = '\0';
+					pxClient->pcRestData = pcLastPtr + 1;
+					break;
+				}
+			}
+			break;
 		}
-		while( xRc && ( pcBuffer[ xRc - 1 ] == 13 || pcBuffer[ xRc - 1 ] == 10 ) )
+	}
+
+	/* HTTP/1.1 keeps the connection open unless the client asks to close it,
+	older versions only when the client asks to keep it open. */
+	xHasConnection = prvGetHeader( pxClient->pcRestData, "Connection", pcValue, sizeof( pcValue ) );
+	if( strncmp( pxClient->pcRestData, "HTTP/1.1", 8 ) == 0 )
+	{
+		if( ( xHasConnection != pdFALSE ) && ( strcasecmp( pcValue, "close" ) == 0 ) )
 		{
-			pcBuffer[ --xRc ] = '\0';
+			pxClient->bits.bCloseAfterReply = pdTRUE_UNSIGNED;
 		}
-		pcEndOfCmd = pcBuffer + xRc;
+	}
+	else if( ( xHasConnection == pdFALSE ) || ( strcasecmp( pcValue, "keep-alive" ) != 0 ) )
+	{
+		pxClient->bits.bCloseAfterReply = pdTRUE_UNSIGNED;
+	}
+
+	if( ( prvGetHeader( pxClient->pcRestData, "Accept-Encoding", pcValue, sizeof( pcValue ) ) != pdFALSE ) &&
+		( strstr( pcValue, "gzip" ) != NULL ) )
+	{
+		pxClient->bits.bAcceptGzip = pdTRUE_UNSIGNED;
+	}
 
-		curCmd = xWebCommands;
+	/* A body is not used, but it has to be skipped to find the next request. */
+	if( prvGetHeader( pxClient->pcRestData, "Content-Length", pcValue, sizeof( pcValue ) ) != pdFALSE )
+	{
+		pxClient->uxBodyLeft = ( size_t ) strtoul( pcValue, NULL, 10 );
+	}
+
+	return prvProcessCmd( pxClient, xIndex );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xHTTPClientWork( TCPClient_t *pxTCPClient )
+{
+BaseType_t xRc = 0;
+HTTPClient_t *pxClient = ( HTTPClient_t * ) pxTCPClient;
+char *pcBuffer = pcCOMMAND_BUFFER;
+size_t uxLength = 0u;
+size_t uxCount;
+char *pcEnd;
+char cSaved;
 
-		/* Pointing to "/index.html HTTP/1.1". */
-		pxClient->pcUrlData = pcBuffer;
+	if( prvSendingFile( pxClient ) != pdFALSE )
+	{
+		prvSendFile( pxClient );
+	}
 
-		/* Pointing to "HTTP/1.1". */
-		pxClient->pcRestData = pcEmptyString;
+	if( pxClient->bits.bShutdown != pdFALSE_UNSIGNED )
+	{
+		/* Wait until the peer has closed the connection as well, FreeRTOS_recv()
+		then returns a negative value and the client will be deleted. */
+		return FreeRTOS_recv( pxClient->xSocket, ( void * ) pcBuffer, sizeof( pcCOMMAND_BUFFER ), 0 );
+	}
 
-		/* Last entry is "ECMD_UNK". */
-		for( xIndex = 0; xIndex < WEB_CMD_COUNT - 1; xIndex++, curCmd++ )
+	/* Requests are only read while no reply is being sent, so that the replies
+	to pipelined requests go out in order. */
+	if( ( prvSendingFile( pxClient ) == pdFALSE ) && ( pxClient->bits.bCloseAfterReply == pdFALSE_UNSIGNED ) )
+	{
+		/* Continue with the bytes left over by the previous call. */
+		if( pxClient->pcPending != NULL )
 		{
-		BaseType_t xLength;
+			uxLength = pxClient->uxPendingLength;
+			memcpy( pcBuffer, pxClient->pcPending, uxLength );
+			vPortFree( pxClient->pcPending );
+			pxClient->pcPending = NULL;
+			pxClient->uxPendingLength = 0u;
+		}
 
-			xLength = curCmd->xCommandLength;
-			if( ( xRc >= xLength ) && ( memcmp( curCmd->pcCommandName, pcBuffer, xLength ) == 0 ) )
+		/* Leave space to terminate the request. */
+		if( uxLength < sizeof( pcCOMMAND_BUFFER ) - 1u )
+		{
+			xRc = FreeRTOS_recv( pxClient->xSocket, ( void * ) ( pcBuffer + uxLength ), sizeof( pcCOMMAND_BUFFER ) - 1u - uxLength, 0 );
+			if( xRc > 0 )
 			{
-			char *pcLastPtr;
+				uxLength += ( size_t ) xRc;
+			}
+		}
+	}
 
-				pxClient->pcUrlData += xLength + 1;
-				for( pcLastPtr = (char *)pxClient->pcUrlData; pcLastPtr < pcEndOfCmd; pcLastPtr++ )
+	while( ( xRc >= 0 ) && ( uxLength > 0u ) &&
+		   ( prvSendingFile( pxClient ) == pdFALSE ) && ( pxClient->bits.bCloseAfterReply == pdFALSE_UNSIGNED ) )
+	{
+		if( pxClient->uxBodyLeft > 0u )
+		{
+			uxCount = ( pxClient->uxBodyLeft < uxLength ) ? pxClient->uxBodyLeft : uxLength;
+			pxClient->uxBodyLeft -= uxCount;
+		}
+		else
+		{
+			pcBuffer[ uxLength ] = '\0';
+			pcEnd = strstr( pcBuffer, "\r\n\r\n" );
+
+			if( pcEnd == NULL )
+			{
+				if( uxLength >= sizeof( pcCOMMAND_BUFFER ) - 1u )
 				{
-					char ch = *pcLastPtr;
-					if( ( ch == '\0' ) || ( strchr( "\n\r \t", ch ) != NULL ) )
-					{
-						*pcLastPtr = '\0';
-						pxClient->pcRestData = pcLastPtr + 1;
-						break;
-					}
+					/* The request does not fit in the command buffer. */
+					pxClient->bits.bCloseAfterReply = pdTRUE_UNSIGNED;
+					strcpy( pxClient->pxParent->pcExtraContents, "Content-Length: 0\r\n" );
+					xRc = prvSendReply( pxClient, WEB_BAD_REQUEST );
+					uxLength = 0u;
 				}
+				/* Else wait for the rest of the request. */
 				break;
 			}
+
+			/* Terminate the request, the byte after it is restored afterwards. */
+			uxCount = ( size_t ) ( pcEnd - pcBuffer ) + 4u;
+			cSaved = pcBuffer[ uxCount ];
+			pcBuffer[ uxCount ] = '\0';
+			xRc = prvProcessRequest( pxClient, pcBuffer, ( BaseType_t ) uxCount );
+			pcBuffer[ uxCount ] = cSaved;
 		}
 
-		if( xIndex < ( WEB_CMD_COUNT - 1 ) )
+		uxLength -= uxCount;
+		memmove( pcBuffer, pcBuffer + uxCount, uxLength );
+	}
+
+	if( ( xRc >= 0 ) && ( uxLength > 0u ) && ( pxClient->bits.bCloseAfterReply == pdFALSE_UNSIGNED ) )
+	{
+		/* Keep the rest: an incomplete request, or requests pipelined behind a
+		reply that is still being sent. */
+		pxClient->pcPending = ( char * ) pvPortMalloc( uxLength );
+		if( pxClient->pcPending != NULL )
 		{
-			xRc = prvProcessCmd( pxClient, xIndex );
+			memcpy( pxClient->pcPending, pcBuffer, uxLength );
+			pxClient->uxPendingLength = uxLength;
+		}
+		else
+		{
+			xRc = -pdFREERTOS_ERRNO_ENOMEM;
 		}
 	}
-	else if( xRc < 0 )
+
+	if( xRc < 0 )
 	{
 		/* The connection will be closed and the client will be deleted. */
 		FreeRTOS_printf( ( "xHTTPClientWork: rc = %ld\n", xRc ) );
 	}
+	else if( prvSendingFile( pxClient ) != pdFALSE )
+	{
+		/* Leave new requests in the socket until the reply has been sent,
+		select() would otherwise keep reporting them. */
+		FreeRTOS_FD_CLR( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_READ );
+	}
+	else
+	{
+		FreeRTOS_FD_SET( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_READ );
+
+		if( pxClient->bits.bCloseAfterReply != pdFALSE_UNSIGNED )
+		{
+			/* The reply is complete.  The FIN follows the data still in the
+			TX stream. */
+			FreeRTOS_shutdown( pxClient->xSocket, FREERTOS_SHUT_RDWR );
+			pxClient->bits.bShutdown = pdTRUE_UNSIGNED;
+		}
+	}
+
 	return xRc;
 }
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvGetHeader( const char *pcHeaders, const char *pcName, char *pcValue, size_t uxValueSize )
+{
+size_t uxNameLength = strlen( pcName );
+size_t uxLength = 0u;
+const char *pcLine = pcHeaders;
+BaseType_t xFound = pdFALSE;
+
+	/* The first line holds the HTTP version, each header starts on a new line. */
+	while( ( pcLine = strchr( pcLine, '\n' ) ) != NULL )
+	{
+		pcLine++;
+		if( ( strncasecmp( pcLine, pcName, uxNameLength ) == 0 ) && ( pcLine[ uxNameLength ] == ':' ) )
+		{
+			pcLine += uxNameLength + 1u;
+			while( ( *pcLine == ' ' ) || ( *pcLine == '\t' ) )
+			{
+				pcLine++;
+			}
+			while( ( uxLength < uxValueSize - 1u ) && ( pcLine[ uxLength ] != '\0' ) &&
+				   ( pcLine[ uxLength ] != '\r' ) && ( pcLine[ uxLength ] != '\n' ) )
+			{
+				uxLength++;
+			}
+			memcpy( pcValue, pcLine, uxLength );
+			pcValue[ uxLength ] = '\0';
+			xFound = pdTRUE;
+			break;
+		}
+	}
+
+	return xFound;
+}
+/*-----------------------------------------------------------*/
+
+#if( ffconfigTIME_SUPPORT == 1 )
+
+	static void prvFormatHTTPDate( uint32_t ulSeconds, char *pcBuffer, size_t uxBufferLength )
+	{
+	static const char pcDays[] = "ThuFriSatSunMonTueWed";	/* 1 January 1970 was a Thursday. */
+	static const char pcMonths[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+	static const uint8_t ucMonthDays[ 12 ] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+	uint32_t ulDays = ulSeconds / 86400UL;
+	uint32_t ulTime = ulSeconds % 86400UL;
+	uint32_t ulWeekDay = ulDays % 7UL;
+	uint32_t ulYear = 1970UL;
+	uint32_t ulMonth = 0UL;
+	uint32_t ulLength;
+	BaseType_t xLeap;
+
+		for( ;; )
+		{
+			xLeap = ( ( ( ulYear % 4UL ) == 0UL ) && ( ( ( ulYear % 100UL ) != 0UL ) || ( ( ulYear % 400UL ) == 0UL ) ) ) ? 1 : 0;
+			ulLength = 365UL + ( uint32_t ) xLeap;
+			if( ulDays < ulLength )
+			{
+				break;
+			}
+			ulDays -= ulLength;
+			ulYear++;
+		}
+
+		for( ;; )
+		{
+			ulLength = ucMonthDays[ ulMonth ] + ( ( ( ulMonth == 1UL ) && ( xLeap != 0 ) ) ? 1UL : 0UL );
+			if( ulDays < ulLength )
+			{
+				break;
+			}
+			ulDays -= ulLength;
+			ulMonth++;
+		}
+
+		/* e.g. "Sun, 06 Nov 1994 08:49:37 GMT" */
+		snprintf( pcBuffer, uxBufferLength, "%.3s, %02u %.3s %u %02u:%02u:%02u GMT",
+			pcDays + 3UL * ulWeekDay, ( unsigned ) ( ulDays + 1UL ), pcMonths + 3UL * ulMonth, ( unsigned ) ulYear,
+			( unsigned ) ( ulTime / 3600UL ), ( unsigned ) ( ( ulTime / 60UL ) % 60UL ), ( unsigned ) ( ulTime % 60UL ) );
+	}
+
+#endif /* ffconfigTIME_SUPPORT */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigHTTP_FILE_CACHE_ENTRIES > 0 )
+
+	static HTTPCacheEntry_t *prvCacheOpen( HTTPClient_t *pxClient, const FF_Stat_t *pxStat )
+	{
+	HTTPCacheEntry_t *pxCache = pxClient->pxParent->xFileCache;
+	HTTPCacheEntry_t *pxEntry = NULL;
+	HTTPCacheEntry_t *pxFree = NULL;
+	FF_FILE *pxFile;
+	uint32_t ulModified = 0u;
+	BaseType_t x;
+
+		if( pxStat->st_size > ipconfigHTTP_FILE_CACHE_MAX_SIZE )
+		{
+			return NULL;
+		}
+
+		#if( ffconfigTIME_SUPPORT == 1 )
+		{
+			ulModified = pxStat->st_mtime;
+		}
+		#endif
+
+		for( x = 0; x < ipconfigHTTP_FILE_CACHE_ENTRIES; x++ )
+		{
+			if( ( pxCache[ x ].pucData != NULL ) && ( strcmp( pxCache[ x ].pcFileName, pxClient->pcCurrentFilename ) == 0 ) )
+			{
+				if( ( pxCache[ x ].uxSize == pxStat->st_size ) && ( pxCache[ x ].ulModified == ulModified ) )
+				{
+					pxEntry = &( pxCache[ x ] );
+				}
+				else if( pxCache[ x ].uxUsers == 0u )
+				{
+					/* The file has changed, drop the old copy. */
+					vPortFree( pxCache[ x ].pucData );
+					pxCache[ x ].pucData = NULL;
+				}
+				else
+				{
+					/* The old copy is still being sent, serve the new one from the disk. */
+					return NULL;
+				}
+				break;
+			}
+		}
+
+		if( pxEntry == NULL )
+		{
+			/* Use a free entry, or else replace the least recently used one. */
+			for( x = 0; x < ipconfigHTTP_FILE_CACHE_ENTRIES; x++ )
+			{
+				if( pxCache[ x ].pucData == NULL )
+				{
+					pxFree = &( pxCache[ x ] );
+					break;
+				}
+				if( ( pxCache[ x ].uxUsers == 0u ) &&
+					( ( pxFree == NULL ) || ( ( TickType_t ) ( pxCache[ x ].xLastUsed - pxFree->xLastUsed ) > portMAX_DELAY / 2 ) ) )
+				{
+					pxFree = &( pxCache[ x ] );
+				}
+			}
+
+			if( pxFree == NULL )
+			{
+				return NULL;
+			}
+
+			if( pxFree->pucData != NULL )
+			{
+				vPortFree( pxFree->pucData );
+				pxFree->pucData = NULL;
+			}
+
+			pxFile = ff_fopen( pxClient->pcCurrentFilename, "rb" );
+			if( pxFile == NULL )
+			{
+				return NULL;
+			}
+
+			/* Allocate at least one byte, so that an empty file can be cached too. */
+			pxFree->pucData = ( uint8_t * ) pvPortMalloc( pxStat->st_size + 1u );
+			if( ( pxFree->pucData != NULL ) && ( ff_fread( pxFree->pucData, 1, pxStat->st_size, pxFile ) == pxStat->st_size ) )
+			{
+				FreeRTOS_printf( ( "Cached file: %s\n", pxClient->pcCurrentFilename ) );
+				strcpy( pxFree->pcFileName, pxClient->pcCurrentFilename );
+				pxFree->uxSize = pxStat->st_size;
+				pxFree->ulModified = ulModified;
+				pxFree->uxUsers = 0u;
+				pxEntry = pxFree;
+			}
+			else if( pxFree->pucData != NULL )
+			{
+				vPortFree( pxFree->pucData );
+				pxFree->pucData = NULL;
+			}
+
+			ff_fclose( pxFile );
+		}
+
+		if( pxEntry != NULL )
+		{
+			pxEntry->uxUsers++;
+			pxEntry->xLastUsed = xTaskGetTickCount();
+		}
+
+		return pxEntry;
+	}
+
+#endif /* ipconfigHTTP_FILE_CACHE_ENTRIES */
+/*-----------------------------------------------------------*/
+
 static const char *pcGetContentsType (const char *apFname)
 {
 	const char *slash = NULL;
@@ -35,18 +35,30 @@
  * An example of how to lookup a domain using DNS
  * And also how to send and receive UDP messages to get the NTP time
  *
+ * ntpSERVER_COUNT servers are polled in parallel.  Each reply gives the
+ * offset of the server's clock and the round trip delay, using all four
+ * timestamps of the exchange.  The sample with the lowest delay of the last
+ * ntpFILTER_SAMPLES is taken from each server, servers that disagree with the
+ * majority are dropped, and the rest are averaged, weighted by their delay.
+ *
+ * The result disciplines a local microsecond clock, read with llNTPGetTime().
+ * Small offsets are slewed out so the clock never jumps, large ones step it,
+ * and the rate of the clock is trimmed to follow the servers between polls.
+ *
  */
 
 /* Standard includes. */
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
+#include "queue.h"
 
 /* FreeRTOS+TCP includes. */
 #include "FreeRTOS_IP.h"
@@ -62,17 +74,150 @@
 
 #include "date_and_time.h"
 
+/* The number of servers that are polled in parallel.  Each takes the next
+name from pcTimeServers[], and is replaced by the name after that when it stops
+answering. */
+#ifndef ntpSERVER_COUNT
+	#define ntpSERVER_COUNT				4
+#endif
+
+/* The number of samples kept for each server.  The one with the lowest round
+trip delay is used, as it is the least disturbed by queuing in the network.
+Older samples count as having a longer delay, growing by ntpSAMPLE_AGE_PPM of
+their age (15 ppm, as RFC 5905), so a stale sample does not hide a drift of
+the clock. */
+#ifndef ntpFILTER_SAMPLES
+	#define ntpFILTER_SAMPLES			8
+#endif
+#ifndef ntpSAMPLE_AGE_PPM
+	#define ntpSAMPLE_AGE_PPM			15LL
+#endif
+
+/* The time between polls.  The first ntpFAST_POLL_COUNT polls use the
+shorter interval, to fill the filters and settle the rate quickly. */
+#ifndef ntpPOLL_INTERVAL_MS
+	#define ntpPOLL_INTERVAL_MS			64000U
+#endif
+#ifndef ntpFAST_POLL_INTERVAL_MS
+	#define ntpFAST_POLL_INTERVAL_MS	4000U
+#endif
+#ifndef ntpFAST_POLL_COUNT
+	#define ntpFAST_POLL_COUNT			ntpFILTER_SAMPLES
+#endif
+
+/* How long the servers have to answer a poll. */
+#ifndef ntpREPLY_TIMEOUT_MS
+	#define ntpREPLY_TIMEOUT_MS			1500U
+#endif
+
+/* How long the DNS client may take to look up a server name.  A lookup that
+is still pending after twice this time is given up, in case its callback is
+never called. */
+#ifndef ntpLOOKUP_TIMEOUT_MS
+	#define ntpLOOKUP_TIMEOUT_MS		1200U
+#endif
+
+/* A server is looked up again, under the next name, after missing this many
+polls in a row. */
+#define ntpMAX_MISSED_REPLIES			4
+
+/* Offsets larger than this step the clock, smaller ones are slewed out at no
+more than ntpMAX_SLEW_PPM.  The same limits as ntpd and adjtime(). */
+#ifndef ntpSTEP_THRESHOLD_US
+	#define ntpSTEP_THRESHOLD_US		128000LL
+#endif
+#define ntpMAX_SLEW_PPM					500LL
+
+/* The largest rate correction.  The rate is only estimated from corrections
+that are at least ntpMIN_FREQUENCY_INTERVAL_US apart, over shorter intervals
+the jitter of the samples dominates. */
+#define ntpMAX_FREQUENCY_PPB			500000L
+#define ntpMIN_FREQUENCY_INTERVAL_US	16000000LL
+
+/* The task wakes at least this often to time out replies and polls. */
+#define ntpWAKE_INTERVAL_MS				250U
+
+/* A monotonic microsecond counter that the local clock runs from.  The
+default is based on the tick count, and so only has the resolution of a tick.
+Define ntpGET_MONOTONIC_US() to read a free running hardware timer to get
+timestamps that are accurate to below a millisecond. */
+#ifndef ntpGET_MONOTONIC_US
+	#define ntpGET_MONOTONIC_US()		prvTickMonotonicUs()
+#endif
+
 enum EStatus {
 	EStatusLookup,
 	EStatusAsking,
+	EStatusWaiting,
 	EStatusPause,
 	EStatusFailed,
 };
 
+/* One measurement of a server.  The offset is relative to the local clock as
+it will be when any slew in progress has completed. */
+typedef struct xNTP_SAMPLE
+{
+	int64_t llOffset;					/* Server time minus local time, in us. */
+	int64_t llDelay;					/* Round trip delay, in us. */
+	int64_t llTime;						/* The local clock when the sample was taken. */
+} NTPSample_t;
+
+typedef struct xNTP_SERVER
+{
+	const char *pcName;
+	uint32_t ulIPAddress;				/* Zero until the name has been looked up. */
+	BaseType_t xLookupPending;
+	TickType_t xLookupTime;				/* When the pending lookup was started. */
+	BaseType_t xAwaitingReply;
+	SNtpTimestamp xRequestTimestamp;	/* The transmit timestamp of the outstanding request, which the reply must echo. */
+	int64_t llRequestTime;				/* The local clock when the request was sent. */
+	UBaseType_t uxMissedReplies;
+	UBaseType_t uxSampleCount;
+	UBaseType_t uxNextSample;
+	NTPSample_t xSamples[ ntpFILTER_SAMPLES ];
+} NTPServer_t;
+
+/* The disciplined clock.  It runs from ntpGET_MONOTONIC_US(), corrected by
+lFrequencyPPB, while llSlewRemaining is added at no more than ntpMAX_SLEW_PPM.
+It is only accessed from within a critical section. */
+typedef struct xNTP_CLOCK
+{
+	uint64_t ullBaseMonotonic;			/* The monotonic time of the last update, in us. */
+	int64_t llBaseTime;					/* The clock at ullBaseMonotonic, in us since 1970. */
+	int64_t llSlewRemaining;			/* Offset still to be slewed out, in us. */
+	int32_t lFrequencyPPB;				/* Rate correction, in parts per billion. */
+	BaseType_t xSet;					/* pdTRUE once a server has set the clock. */
+	int64_t llLastCorrection;			/* The clock at the last correction. */
+} NTPClock_t;
+
+/* The result of a DNS lookup, passed from the IP-task to the NTP task.  pcName
+is the entry of pcTimeServers[] that was looked up, so a result that arrives
+after the server slot moved on to another name can be recognised. */
+typedef struct xNTP_LOOKUP
+{
+	NTPServer_t *pxServer;
+	const char *pcName;
+	uint32_t ulIPAddress;
+} NTPLookup_t;
+
+#if( ipconfigUSE_CALLBACKS != 0 )
+
+	/* A reply passed from the UDP receive handler to the NTP task. */
+	typedef struct xNTP_REPLY
+	{
+		struct SNtpPacket xPacket;
+		uint32_t ulIPAddress;
+		int64_t llReceiveTime;
+	} NTPReply_t;
+
+#endif /* ipconfigUSE_CALLBACKS != 0 */
+
 static struct SNtpPacket xNTPPacket;
 
 #if( ipconfigUSE_CALLBACKS == 0 )
 	static char cRecvBuffer[ sizeof( struct SNtpPacket ) + 64 ];
+#else
+	static QueueHandle_t xReplyQueue = NULL;
 #endif
 
 static enum EStatus xStatus = EStatusLookup;
@@ -86,13 +231,19 @@ static const char *pcTimeServers[] = {
 	"0.north-america.pool.ntp.org"
 };
 
+static NTPServer_t xServers[ ntpSERVER_COUNT ];
+static BaseType_t xNextServerName = 0;
+static NTPClock_t xClock;
+static UBaseType_t uxPollCount = 0;
+static TickType_t xStateStartTime;
+
 static SemaphoreHandle_t xNTPWakeupSem = NULL;
-static uint32_t ulIPAddressFound;
+static QueueHandle_t xLookupQueue = NULL;
 static Socket_t xUDPSocket = NULL;
 static TaskHandle_t xNTPTaskhandle = NULL;
-static TickType_t uxSendTime;
 
 static void prvNTPTask( void *pvParameters );
+static uint64_t prvTickMonotonicUs( void );
 
 static void vSignalTask( void )
 {
@@ -110,11 +261,52 @@ static void vSignalTask( void )
 		xSemaphoreGive( xNTPWakeupSem );
 	}
 }
+/*-----------------------------------------------------------*/
+
+static void prvSetAddress( struct freertos_sockaddr *pxAddress, uint32_t ulIPAddress )
+{
+	#if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
+	{
+		pxAddress->sin_address.ulIP_IPv4 = ulIPAddress;
+	}
+	#else
+	{
+		pxAddress->sin_addr = ulIPAddress;
+	}
+	#endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvGetAddress( const struct freertos_sockaddr *pxAddress )
+{
+	#if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
+	{
+		return pxAddress->sin_address.ulIP_IPv4;
+	}
+	#else
+	{
+		return pxAddress->sin_addr;
+	}
+	#endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
+}
+/*-----------------------------------------------------------*/
+
+static void prvForgetServer( NTPServer_t *pxServer )
+{
+	/* Give the server slot the next name, to be looked up on the next poll. */
+	memset( pxServer, '\0', sizeof( *pxServer ) );
+	pxServer->pcName = pcTimeServers[ xNextServerName ];
+	if( ++xNextServerName == sizeof( pcTimeServers ) / sizeof( pcTimeServers[ 0 ] ) )
+	{
+		xNextServerName = 0;
+	}
+}
+/*-----------------------------------------------------------*/
 
 void vStartNTPTask( uint16_t usTaskStackSize, UBaseType_t uxTaskPriority )
 {
-	/* The only public function in this module: start a task to contact
-	some NTP server. */
+	/* Start a task to poll the NTP servers, or when it is already running,
+	poll them now. */
 
 	if( xNTPTaskhandle != NULL )
 	{
@@ -128,13 +320,21 @@ void vStartNTPTask( uint16_t usTaskStackSize, UBaseType_t uxTaskPriority )
 			FreeRTOS_printf( ( "NTP looking up server\n" ) );
 			break;
 		case EStatusAsking:
+		case EStatusWaiting:
 			FreeRTOS_printf( ( "NTP still asking\n" ) );
 			break;
 		case EStatusFailed:
-			FreeRTOS_printf( ( "NTP failed somehow\n" ) );
-			ulIPAddressFound = 0ul;
-			xStatus = EStatusLookup;
-			vSignalTask();
+			{
+			BaseType_t x;
+
+				FreeRTOS_printf( ( "NTP failed somehow\n" ) );
+				for( x = 0; x < ntpSERVER_COUNT; x++ )
+				{
+					prvForgetServer( &( xServers[ x ] ) );
+				}
+				xStatus = EStatusLookup;
+				vSignalTask();
+			}
 			break;
 		}
 	}
@@ -147,19 +347,10 @@ void vStartNTPTask( uint16_t usTaskStackSize, UBaseType_t uxTaskPriority )
 		#if( ipconfigUSE_CALLBACKS != 0 )
 			BaseType_t xReceiveTimeOut = pdMS_TO_TICKS( 0 );
 		#else
-			BaseType_t xReceiveTimeOut = pdMS_TO_TICKS( 5000 );
+			BaseType_t xReceiveTimeOut = pdMS_TO_TICKS( ntpWAKE_INTERVAL_MS );
 		#endif
 
-			#if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
-			{
-				xAddress.sin_address.ulIP_IPv4 = 0ul;
-			}
-			#else
-			{
-				xAddress.sin_addr = 0ul;
-			}
-			#endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
-
+			prvSetAddress( &xAddress, 0ul );
 			xAddress.sin_port = FreeRTOS_htons( NTP_PORT );
 			xAddress.sin_family = FREERTOS_AF_INET;
 
@@ -182,25 +373,237 @@ void vStartNTPTask( uint16_t usTaskStackSize, UBaseType_t uxTaskPriority )
 
 static void vDNS_callback( const char *pcName, void *pvSearchID, uint32_t ulIPAddress )
 {
+NTPLookup_t xLookup;
 char pcBuf[16];
+BaseType_t x;
 
-	/* The DNS lookup has a result, or it has reached the time-out. */
+	/* The DNS lookup has a result, or it has reached the time-out.  This runs
+	in the IP-task, so the result is only passed on, the NTP task applies it in
+	prvApplyLookups(). */
 	FreeRTOS_inet_ntoa( ulIPAddress, pcBuf );
 	FreeRTOS_printf( ( "IP address of %s found: %s\n", pcName, pcBuf ) );
-	if( ulIPAddressFound == 0ul )
+
+	xLookup.pxServer = ( NTPServer_t * ) pvSearchID;
+	xLookup.pcName = NULL;
+	xLookup.ulIPAddress = ulIPAddress;
+
+	for( x = 0; x < ( BaseType_t ) ( sizeof( pcTimeServers ) / sizeof( pcTimeServers[ 0 ] ) ); x++ )
 	{
-		ulIPAddressFound = ulIPAddress;
+		if( strcmp( pcTimeServers[ x ], pcName ) == 0 )
+		{
+			xLookup.pcName = pcTimeServers[ x ];
+			break;
+		}
 	}
-	/* For testing: in case DNS doen't respond, still try some NTP server
-	with a known IP-address. */
-	if( ulIPAddressFound == 0ul )
+
+	/* There is at most one lookup per server slot, so the queue does not
+	fill up. */
+	xQueueSend( xLookupQueue, &xLookup, 0 );
+	vSignalTask();
+}
+/*-----------------------------------------------------------*/
+
+static void prvApplyLookups( void )
+{
+NTPLookup_t xLookup;
+NTPServer_t *pxServer;
+uint32_t ulIPAddress;
+BaseType_t x;
+
+	while( xQueueReceive( xLookupQueue, &xLookup, 0 ) == pdPASS )
 	{
-		ulIPAddressFound = FreeRTOS_inet_addr_quick( 184, 105, 182, 7 );
-/*		ulIPAddressFound = FreeRTOS_inet_addr_quick( 103, 242,  70, 4 );	*/
+		pxServer = xLookup.pxServer;
+		ulIPAddress = xLookup.ulIPAddress;
+
+		if( ( pxServer->xLookupPending == pdFALSE ) || ( pxServer->pcName != xLookup.pcName ) )
+		{
+			/* The slot was given another name since the lookup started. */
+			continue;
+		}
+
+		if( ulIPAddress == 0ul )
+		{
+			/* For testing: in case DNS doen't respond, still try some NTP
+			server with a known IP-address, unless another server was found. */
+			ulIPAddress = FreeRTOS_inet_addr_quick( 184, 105, 182, 7 );
+			for( x = 0; x < ntpSERVER_COUNT; x++ )
+			{
+				if( xServers[ x ].ulIPAddress != 0ul )
+				{
+					ulIPAddress = 0ul;
+					break;
+				}
+			}
+		}
+
+		if( ulIPAddress == 0ul )
+		{
+			/* Try the next name on the next poll. */
+			prvForgetServer( pxServer );
+		}
+		else
+		{
+			pxServer->ulIPAddress = ulIPAddress;
+			pxServer->xLookupPending = pdFALSE;
+		}
+
+		if( xStatus == EStatusLookup )
+		{
+			xStatus = EStatusAsking;
+		}
 	}
-	xStatus = EStatusAsking;
+}
+/*-----------------------------------------------------------*/
 
-	vSignalTask();
+static void prvMissedReply( NTPServer_t *pxServer )
+{
+	/* The server did not answer the poll, or did not give a usable answer. */
+	pxServer->xAwaitingReply = pdFALSE;
+	if( ++pxServer->uxMissedReplies >= ntpMAX_MISSED_REPLIES )
+	{
+		FreeRTOS_printf( ( "NTP: %s does not answer\n", pxServer->pcName ) );
+		prvForgetServer( pxServer );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvTickMonotonicUs( void )
+{
+static TickType_t xLastTick = 0;
+static uint64_t ullTickOverflows = 0;
+TickType_t xTick;
+uint64_t ullTicks;
+
+	/* Extend the tick count to 64 bits, so the clock does not wrap. */
+	taskENTER_CRITICAL();
+	{
+		xTick = xTaskGetTickCount();
+		if( xTick < xLastTick )
+		{
+			ullTickOverflows += ( ( uint64_t ) portMAX_DELAY ) + 1u;
+		}
+		xLastTick = xTick;
+		ullTicks = ullTickOverflows + xTick;
+	}
+	taskEXIT_CRITICAL();
+
+	return ( ullTicks * 1000000ull ) / configTICK_RATE_HZ;
+}
+/*-----------------------------------------------------------*/
+
+static void prvClockAdvance( void )
+{
+uint64_t ullNow = ntpGET_MONOTONIC_US();
+int64_t llElapsed, llSlew, llMaxSlew;
+
+	/* Must be called from within a critical section.  Moves the base of the
+	clock to now, adding the rate correction and any slew for the time that
+	passed.  The slew is limited so the clock keeps moving forward. */
+	if( ullNow > xClock.ullBaseMonotonic )
+	{
+		llElapsed = ( int64_t ) ( ullNow - xClock.ullBaseMonotonic );
+
+		llMaxSlew = ( llElapsed * ntpMAX_SLEW_PPM ) / 1000000LL;
+		llSlew = xClock.llSlewRemaining;
+		if( llSlew > llMaxSlew )
+		{
+			llSlew = llMaxSlew;
+		}
+		else if( llSlew < -llMaxSlew )
+		{
+			llSlew = -llMaxSlew;
+		}
+		xClock.llSlewRemaining -= llSlew;
+
+		xClock.llBaseTime += llElapsed + ( ( llElapsed * xClock.lFrequencyPPB ) / 1000000000LL ) + llSlew;
+		xClock.ullBaseMonotonic = ullNow;
+	}
+}
+/*-----------------------------------------------------------*/
+
+int64_t llNTPGetTime( void )
+{
+int64_t llTime;
+
+	taskENTER_CRITICAL();
+	{
+		prvClockAdvance();
+		llTime = xClock.llBaseTime;
+	}
+	taskEXIT_CRITICAL();
+
+	return llTime;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvClockCorrect( int64_t llOffset )
+{
+int64_t llInterval, llFrequency;
+BaseType_t xStepped = pdFALSE;
+
+	/* Correct the clock by llOffset, relative to the time it will show once
+	the slew in progress has completed.  Returns pdTRUE if the clock was
+	stepped. */
+	taskENTER_CRITICAL();
+	{
+		prvClockAdvance();
+
+		if( ( xClock.xSet == pdFALSE ) || ( llOffset > ntpSTEP_THRESHOLD_US ) || ( llOffset < -ntpSTEP_THRESHOLD_US ) )
+		{
+			xClock.llBaseTime += xClock.llSlewRemaining + llOffset;
+			xClock.llSlewRemaining = 0;
+			xClock.xSet = pdTRUE;
+			xStepped = pdTRUE;
+		}
+		else
+		{
+			xClock.llSlewRemaining += llOffset;
+
+			/* The offset built up since the last correction is a rate error.
+			Only a quarter of it is taken, to average out the jitter. */
+			llInterval = xClock.llBaseTime + xClock.llSlewRemaining - xClock.llLastCorrection;
+			if( llInterval >= ntpMIN_FREQUENCY_INTERVAL_US )
+			{
+				llFrequency = xClock.lFrequencyPPB + ( ( llOffset * 1000000000LL ) / llInterval ) / 4;
+				if( llFrequency > ntpMAX_FREQUENCY_PPB )
+				{
+					llFrequency = ntpMAX_FREQUENCY_PPB;
+				}
+				else if( llFrequency < -ntpMAX_FREQUENCY_PPB )
+				{
+					llFrequency = -ntpMAX_FREQUENCY_PPB;
+				}
+				xClock.lFrequencyPPB = ( int32_t ) llFrequency;
+			}
+		}
+
+		xClock.llLastCorrection = xClock.llBaseTime + xClock.llSlewRemaining;
+	}
+	taskEXIT_CRITICAL();
+
+	return xStepped;
+}
+/*-----------------------------------------------------------*/
+
+static int64_t prvNTPToMicroseconds( const SNtpTimestamp *pxTimestamp )
+{
+int64_t llSeconds = ( int64_t ) pxTimestamp->seconds;
+
+	/* Timestamps with the top bit clear are after the NTP era rolls over, in
+	2036. */
+	if( ( pxTimestamp->seconds & 0x80000000ul ) == 0ul )
+	{
+		llSeconds += 0x100000000LL;
+	}
+
+	return ( ( llSeconds - ( int64_t ) TIME1970 ) * 1000000LL ) + ( int64_t ) ( ( ( uint64_t ) pxTimestamp->fraction * 1000000ull ) >> 32 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMicrosecondsToNTP( int64_t llTime, SNtpTimestamp *pxTimestamp )
+{
+	pxTimestamp->seconds = ( uint32_t ) ( ( llTime / 1000000LL ) + ( int64_t ) TIME1970 );
+	pxTimestamp->fraction = ( uint32_t ) ( ( ( uint64_t ) ( llTime % 1000000LL ) << 32 ) / 1000000ull );
 }
 /*-----------------------------------------------------------*/
 
@@ -224,7 +627,7 @@ static void prvSwapFields( struct SNtpPacket *pxPacket)
 }
 /*-----------------------------------------------------------*/
 
-static void prvNTPPacketInit( )
+static void prvNTPPacketInit( const SNtpTimestamp *pxTransmitTimestamp )
 {
 	memset (&xNTPPacket, '\0', sizeof( xNTPPacket ) );
 
@@ -234,93 +637,256 @@ static void prvNTPPacketInit( )
 	xNTPPacket.rootDelay = 0x5D2E;			/* 0x5D2E = 23854 or (23854/65535)= 0.3640 sec */
 	xNTPPacket.rootDispersion = 0x0008CAC8;	/* 0x0008CAC8 = 8.7912  seconds */
 
-	/* use the recorded NTP time */
-	time_t uxSecs = FreeRTOS_time( NULL );/* apTime may be NULL, returns seconds */
-
-	xNTPPacket.referenceTimestamp.seconds = uxSecs;	/* Current time */
-	xNTPPacket.transmitTimestamp.seconds = uxSecs + 3;
+	/* The server copies the transmit timestamp to the originate timestamp of
+	its reply, which ties the reply to this request. */
+	xNTPPacket.referenceTimestamp.seconds = pxTransmitTimestamp->seconds;
+	xNTPPacket.transmitTimestamp = *pxTransmitTimestamp;
 
 	/* Transform the contents of the fields from native to big endian. */
 	prvSwapFields( &xNTPPacket );
 }
 /*-----------------------------------------------------------*/
 
-static void prvReadTime( struct SNtpPacket * pxPacket )
+static void prvReadTime( struct SNtpPacket * pxPacket, uint32_t ulIPAddress, int64_t llReceiveTime )
 {
-	FF_TimeStruct_t xTimeStruct;
-	time_t uxPreviousSeconds;
-	time_t uxPreviousMS;
+NTPServer_t *pxServer = NULL;
+NTPSample_t *pxSample;
+int64_t llT2, llT3, llSlewRemaining;
+BaseType_t x;
 
-	time_t uxCurrentSeconds;
-	time_t uxCurrentMS;
+	/* Transform the contents of the fields from big to native endian. */
+	prvSwapFields( pxPacket );
 
-	const char *pcTimeUnit;
-	int32_t ilDiff;
-	TickType_t uxTravelTime;
+	for( x = 0; x < ntpSERVER_COUNT; x++ )
+	{
+		if( ( xServers[ x ].ulIPAddress == ulIPAddress ) && ( xServers[ x ].xAwaitingReply != pdFALSE ) )
+		{
+			pxServer = &( xServers[ x ] );
+			break;
+		}
+	}
 
-	uxTravelTime = xTaskGetTickCount() - uxSendTime;
+	if( ( pxServer == NULL ) ||
+		( pxPacket->originateTimestamp.seconds != pxServer->xRequestTimestamp.seconds ) ||
+		( pxPacket->originateTimestamp.fraction != pxServer->xRequestTimestamp.fraction ) )
+	{
+		FreeRTOS_printf( ( "NTP: unexpected reply ignored\n" ) );
+	}
+	else if( pxPacket->stratum == 0 )
+	{
+		/* A kiss-of-death, the server asks not to be polled any more. */
+		FreeRTOS_printf( ( "NTP: %s sent a kiss-of-death\n", pxServer->pcName ) );
+		prvForgetServer( pxServer );
+	}
+	else if( ( ( pxPacket->flags >> 6 ) == 3 ) || ( pxPacket->stratum > 15 ) || ( pxPacket->transmitTimestamp.seconds == 0ul ) )
+	{
+		/* The server is not synchronised, which counts as no answer. */
+		FreeRTOS_printf( ( "NTP: %s is not usable (stratum %u)\n", pxServer->pcName, ( unsigned ) pxPacket->stratum ) );
+		prvMissedReply( pxServer );
+	}
+	else
+	{
+		/* T1 and T4 are the local clock when the request was sent and the
+		reply received, T2 and T3 the server clock when it received the
+		request and sent the reply. */
+		llT2 = prvNTPToMicroseconds( &( pxPacket->receiveTimestamp ) );
+		llT3 = prvNTPToMicroseconds( &( pxPacket->transmitTimestamp ) );
 
-	/* Transform the contents of the fields from big to native endian. */
-	prvSwapFields( pxPacket );
+		taskENTER_CRITICAL();
+		{
+			llSlewRemaining = xClock.llSlewRemaining;
+		}
+		taskEXIT_CRITICAL();
 
-	uxCurrentSeconds = pxPacket->receiveTimestamp.seconds - TIME1970;
-	uxCurrentMS = pxPacket->receiveTimestamp.fraction / 4294967;
-	uxCurrentSeconds += uxCurrentMS / 1000;
-	uxCurrentMS = uxCurrentMS % 1000;
+		pxSample = &( pxServer->xSamples[ pxServer->uxNextSample ] );
+		pxSample->llOffset = ( ( llT2 - pxServer->llRequestTime ) + ( llT3 - llReceiveTime ) ) / 2 - llSlewRemaining;
+		pxSample->llDelay = ( llReceiveTime - pxServer->llRequestTime ) - ( llT3 - llT2 );
+		if( pxSample->llDelay < 0 )
+		{
+			pxSample->llDelay = 0;
+		}
+		pxSample->llTime = llReceiveTime;
+
+		if( ++pxServer->uxNextSample == ntpFILTER_SAMPLES )
+		{
+			pxServer->uxNextSample = 0;
+		}
+		if( pxServer->uxSampleCount < ntpFILTER_SAMPLES )
+		{
+			pxServer->uxSampleCount++;
+		}
+		pxServer->uxMissedReplies = 0;
+		pxServer->xAwaitingReply = pdFALSE;
+	}
+}
+/*-----------------------------------------------------------*/
 
-	// Get the last time recorded
-	uxPreviousSeconds = FreeRTOS_get_secs_msec( &uxPreviousMS );
+static BaseType_t prvCombineSamples( int64_t *pllOffset, int64_t *pllDelay, BaseType_t *pxServerCount )
+{
+NTPSample_t xCandidates[ ntpSERVER_COUNT ], xCandidate, xBest;
+const NTPSample_t *pxSample;
+const NTPSample_t *pxMedian;
+BaseType_t xCount = 0, xUsed = 0, x, y;
+UBaseType_t ux;
+int64_t llSum = 0, llWeightSum = 0, llWeight, llDelay = 0, llNow;
 
-	// Set the new time with precision in msec. */
-	FreeRTOS_set_secs_msec( &uxCurrentSeconds, &uxCurrentMS );
+	llNow = llNTPGetTime();
 
-	if( uxCurrentSeconds >= uxPreviousSeconds )
+	/* Take the sample with the lowest delay, after ageing, from each server. */
+	for( x = 0; x < ntpSERVER_COUNT; x++ )
 	{
-		ilDiff = ( int32_t ) ( uxCurrentSeconds - uxPreviousSeconds );
+		for( ux = 0; ux < xServers[ x ].uxSampleCount; ux++ )
+		{
+			pxSample = &( xServers[ x ].xSamples[ ux ] );
+			xCandidate = *pxSample;
+			xCandidate.llDelay += ( ( llNow - pxSample->llTime ) * ntpSAMPLE_AGE_PPM ) / 1000000LL;
+			if( ( ux == 0 ) || ( xCandidate.llDelay < xBest.llDelay ) )
+			{
+				xBest = xCandidate;
+			}
+		}
+
+		if( xServers[ x ].uxSampleCount > 0 )
+		{
+			/* Insert in order of offset. */
+			for( y = xCount; ( y > 0 ) && ( xCandidates[ y - 1 ].llOffset > xBest.llOffset ); y-- )
+			{
+				xCandidates[ y ] = xCandidates[ y - 1 ];
+			}
+			xCandidates[ y ] = xBest;
+			xCount++;
+		}
 	}
-	else
+
+	if( xCount > 0 )
 	{
-		ilDiff = 0 - ( int32_t ) ( uxPreviousSeconds - uxCurrentSeconds );
+		/* The true time lies within half the round trip delay of each
+		server's offset.  Servers whose range does not overlap that of the
+		median server disagree with the majority and are dropped.  The rest are
+		averaged, giving the servers with the lowest delay the most weight.
+		The average is taken relative to the median, as the offset can be
+		decades when the clock was never set. */
+		pxMedian = &( xCandidates[ xCount / 2 ] );
+		for( x = 0; x < xCount; x++ )
+		{
+			xCandidate = xCandidates[ x ];
+			if( ( xCandidate.llOffset - xCandidate.llDelay / 2 <= pxMedian->llOffset + pxMedian->llDelay / 2 ) &&
+				( xCandidate.llOffset + xCandidate.llDelay / 2 >= pxMedian->llOffset - pxMedian->llDelay / 2 ) )
+			{
+				llWeight = 1000000000LL / ( xCandidate.llDelay + 1000LL );
+				llSum += ( xCandidate.llOffset - pxMedian->llOffset ) * llWeight;
+				llWeightSum += llWeight;
+				llDelay += xCandidate.llDelay;
+				xUsed++;
+			}
+		}
+
+		*pllOffset = pxMedian->llOffset + ( llSum / llWeightSum );
+		*pllDelay = llDelay / xUsed;
 	}
+	*pxServerCount = xCount;
+
+	return xUsed;
+}
+/*-----------------------------------------------------------*/
+
+static void prvUpdateClock( void )
+{
+FF_TimeStruct_t xTimeStruct;
+BaseType_t xCount, xUsed, x;
+UBaseType_t ux;
+int64_t llOffset = 0, llDelay = 0, llTime;
+time_t uxCurrentSeconds;
+time_t uxCurrentMS;
+BaseType_t xStepped;
+
+	xUsed = prvCombineSamples( &llOffset, &llDelay, &xCount );
 
-	if( ( ilDiff < -5 ) || ( ilDiff > 5 ) )
+	if( xUsed == 0 )
 	{
-		/* More than 5 seconds difference. */
-		pcTimeUnit = "sec";
+		FreeRTOS_printf( ( "NTP: no replies\n" ) );
 	}
 	else
 	{
-		/* Less than or equal to 5 second difference. */
-		pcTimeUnit = "ms";
-		uint32_t ulLowest = ( uxCurrentSeconds <= uxPreviousSeconds ) ? uxCurrentSeconds : uxPreviousSeconds;
-		int32_t iCurMS = 1000 * ( uxCurrentSeconds - ulLowest ) + uxCurrentMS;
-		int32_t iPrevMS = 1000 * ( uxPreviousSeconds - ulLowest ) + uxPreviousMS;
-		ilDiff = iCurMS - iPrevMS;
-	}
-	uxCurrentSeconds -= iTimeZone;
-
-	FreeRTOS_gmtime_r( &uxCurrentSeconds, &xTimeStruct );
-
-	/*
-		378.067 [NTP client] NTP time: 9/11/2015 16:11:19.559 Diff -20 ms (289 ms)
-		379.441 [NTP client] NTP time: 9/11/2015 16:11:20.933 Diff 0 ms (263 ms)
-	*/
-
-	FreeRTOS_printf( ("NTP time: %d/%d/%02d %2d:%02d:%02d.%03u Diff %d %s (%lu ms)\n",
-		xTimeStruct.tm_mday,
-		xTimeStruct.tm_mon + 1,
-		xTimeStruct.tm_year + 1900,
-		xTimeStruct.tm_hour,
-		xTimeStruct.tm_min,
-		xTimeStruct.tm_sec,
-		( unsigned )uxCurrentMS,
-		( unsigned )ilDiff,
-		pcTimeUnit,
-		uxTravelTime ) );
-
-	/* Remove compiler warnings in case FreeRTOS_printf() is not used. */
-	( void ) pcTimeUnit;
-	( void ) uxTravelTime;
+		xStepped = prvClockCorrect( llOffset );
+
+		/* The clock was moved by llOffset, which the stored samples must follow. */
+		for( x = 0; x < ntpSERVER_COUNT; x++ )
+		{
+			for( ux = 0; ux < xServers[ x ].uxSampleCount; ux++ )
+			{
+				xServers[ x ].xSamples[ ux ].llOffset -= llOffset;
+				xServers[ x ].xSamples[ ux ].llTime += llOffset;
+			}
+		}
+
+		/* Keep the +FAT clock in step. */
+		llTime = llNTPGetTime();
+		uxCurrentSeconds = ( time_t ) ( llTime / 1000000LL );
+		uxCurrentMS = ( time_t ) ( ( llTime % 1000000LL ) / 1000LL );
+		FreeRTOS_set_secs_msec( &uxCurrentSeconds, &uxCurrentMS );
+
+		uxCurrentSeconds -= iTimeZone;
+
+		FreeRTOS_gmtime_r( &uxCurrentSeconds, &xTimeStruct );
+
+		/*
+			378.067 [NTP client] NTP time: 9/11/2015 16:11:19.559 Offset 412 us delay 23871 us (3 of 4) freq -8120 ppb
+		*/
+
+		FreeRTOS_printf( ("NTP time: %d/%d/%02d %2d:%02d:%02d.%03u Offset %ld %s delay %ld us (%d of %d) freq %ld ppb\n",
+			xTimeStruct.tm_mday,
+			xTimeStruct.tm_mon + 1,
+			xTimeStruct.tm_year + 1900,
+			xTimeStruct.tm_hour,
+			xTimeStruct.tm_min,
+			xTimeStruct.tm_sec,
+			( unsigned )uxCurrentMS,
+			( long ) ( ( xStepped != pdFALSE ) ? ( llOffset / 1000LL ) : llOffset ),
+			( xStepped != pdFALSE ) ? "ms (stepped)" : "us",
+			( long ) llDelay,
+			( int ) xUsed,
+			( int ) xCount,
+			( long ) xClock.lFrequencyPPB ) );
+
+		/* Remove compiler warnings in case FreeRTOS_printf() is not used. */
+		( void ) xStepped;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendRequests( void )
+{
+struct freertos_sockaddr xAddress;
+NTPServer_t *pxServer;
+char pcBuf[16];
+BaseType_t x;
+
+	xAddress.sin_port = FreeRTOS_htons( NTP_PORT );
+	xAddress.sin_family = FREERTOS_AF_INET;
+
+	for( x = 0; x < ntpSERVER_COUNT; x++ )
+	{
+		pxServer = &( xServers[ x ] );
+		if( pxServer->ulIPAddress == 0ul )
+		{
+			continue;
+		}
+
+		prvSetAddress( &xAddress, pxServer->ulIPAddress );
+		FreeRTOS_inet_ntoa( pxServer->ulIPAddress, pcBuf );
+		FreeRTOS_debug_printf( ( "Sending UDP message to %s:%u\n",
+			pcBuf,
+			FreeRTOS_ntohs( xAddress.sin_port ) ) );
+
+		/* The local clock when the request is sent is T1 of the exchange. */
+		pxServer->llRequestTime = llNTPGetTime();
+		prvMicrosecondsToNTP( pxServer->llRequestTime, &( pxServer->xRequestTimestamp ) );
+		prvNTPPacketInit( &( pxServer->xRequestTimestamp ) );
+		pxServer->xAwaitingReply = pdTRUE;
+
+		FreeRTOS_sendto( xUDPSocket, ( void * )&xNTPPacket, sizeof( xNTPPacket ), 0, &xAddress, sizeof( xAddress ) );
+	}
 }
 /*-----------------------------------------------------------*/
 
@@ -329,13 +895,16 @@ static void prvReadTime( struct SNtpPacket * pxPacket )
 	static BaseType_t xOnUDPReceive( Socket_t xSocket, void * pvData, size_t xLength,
 		const struct freertos_sockaddr *pxFrom, const struct freertos_sockaddr *pxDest )
 	{
+	NTPReply_t xReply;
+
 		if( xLength >= sizeof( xNTPPacket ) )
 		{
-			prvReadTime( ( struct SNtpPacket *)pvData );
-			if( xStatus != EStatusPause )
-			{
-				xStatus = EStatusPause;
-			}
+			/* Timestamp the reply here, in the IP-task, so the time the NTP
+			task needs to wake up is not counted as network delay. */
+			xReply.llReceiveTime = llNTPGetTime();
+			xReply.ulIPAddress = prvGetAddress( pxFrom );
+			memcpy( &( xReply.xPacket ), pvData, sizeof( xReply.xPacket ) );
+			xQueueSend( xReplyQueue, &xReply, 0 );
 		}
 		vSignalTask();
 		/* Tell the driver not to store the RX data */
@@ -347,12 +916,34 @@ static void prvReadTime( struct SNtpPacket * pxPacket )
 
 static void prvNTPTask( void *pvParameters )
 {
-BaseType_t xServerIndex = 3;
-struct freertos_sockaddr xAddress;
+BaseType_t x, xAwaiting, xKnown;
+TickType_t xInterval;
+uint32_t ulIPAddress;
+time_t uxSeconds;
+time_t uxMS;
 #if( ipconfigUSE_CALLBACKS != 0 )
 	F_TCP_UDP_Handler_t xHandler;
+	NTPReply_t xReply;
+#else
+	struct freertos_sockaddr xAddress;
 #endif /* ipconfigUSE_CALLBACKS != 0 */
 
+	/* Start the local clock from the +FAT time until a server answers. */
+	uxSeconds = FreeRTOS_get_secs_msec( &uxMS );
+	taskENTER_CRITICAL();
+	{
+		xClock.ullBaseMonotonic = ntpGET_MONOTONIC_US();
+		xClock.llBaseTime = ( ( int64_t ) uxSeconds * 1000000LL ) + ( ( int64_t ) uxMS * 1000LL );
+	}
+	taskEXIT_CRITICAL();
+
+	for( x = 0; x < ntpSERVER_COUNT; x++ )
+	{
+		prvForgetServer( &( xServers[ x ] ) );
+	}
+
+	xLookupQueue = xQueueCreate( ntpSERVER_COUNT, sizeof( NTPLookup_t ) );
+
 	xStatus = EStatusLookup;
 	#if( ipconfigSOCKET_HAS_USER_SEMAPHORE != 0 ) || ( ipconfigUSE_CALLBACKS != 0 )
 	{
@@ -362,6 +953,7 @@ struct freertos_sockaddr xAddress;
 
 	#if( ipconfigUSE_CALLBACKS != 0 )
 	{
+		xReplyQueue = xQueueCreate( ntpSERVER_COUNT, sizeof( NTPReply_t ) );
 		memset( &xHandler, '\0', sizeof( xHandler ) );
 		xHandler.pxOnUDPReceive = xOnUDPReceive;
 		FreeRTOS_setsockopt( xUDPSocket, 0, FREERTOS_SO_UDP_RECV_HANDLER, ( void * ) &xHandler, sizeof( xHandler ) );
@@ -374,56 +966,93 @@ struct freertos_sockaddr xAddress;
 	#endif
 	for( ; ; )
 	{
+		prvApplyLookups();
+
 		switch( xStatus )
 		{
 		case EStatusLookup:
-			if( ( ulIPAddressFound == 0ul ) || ( ulIPAddressFound == ~0ul ) )
+			xKnown = pdFALSE;
+			for( x = 0; x < ntpSERVER_COUNT; x++ )
 			{
-				if( ++xServerIndex == sizeof( pcTimeServers ) / sizeof( pcTimeServers[ 0 ] ) )
+				if( xServers[ x ].ulIPAddress != 0ul )
 				{
-					xServerIndex = 0;
+					xKnown = pdTRUE;
+				}
+				else if( xServers[ x ].xLookupPending == pdFALSE )
+				{
+					xServers[ x ].xLookupPending = pdTRUE;
+					xServers[ x ].xLookupTime = xTaskGetTickCount();
+					FreeRTOS_printf( ( "Looking up server '%s'\n", xServers[ x ].pcName ) );
+					ulIPAddress = FreeRTOS_gethostbyname_a( xServers[ x ].pcName, vDNS_callback, ( void * ) &( xServers[ x ] ), pdMS_TO_TICKS( ntpLOOKUP_TIMEOUT_MS ) );
+
+					/* A cached name or a dotted address is returned straight
+					away, the callback is not called for it. */
+					if( ulIPAddress != 0ul )
+					{
+						xServers[ x ].ulIPAddress = ulIPAddress;
+						xServers[ x ].xLookupPending = pdFALSE;
+						xKnown = pdTRUE;
+					}
+				}
+				else if( ( xTaskGetTickCount() - xServers[ x ].xLookupTime ) >= pdMS_TO_TICKS( 2U * ntpLOOKUP_TIMEOUT_MS ) )
+				{
+					/* The callback did not come, look up the next name on the
+					next pass. */
+					FreeRTOS_printf( ( "NTP: lookup of '%s' timed out\n", xServers[ x ].pcName ) );
+					prvForgetServer( &( xServers[ x ] ) );
 				}
-				FreeRTOS_printf( ( "Looking up server '%s'\n", pcTimeServers[ xServerIndex ] ) );
-				FreeRTOS_gethostbyname_a( pcTimeServers[ xServerIndex ], vDNS_callback, (void *)NULL, 1200 );
 			}
-			else
+
+			/* Ask the servers that are known already, the others join the
+			next poll.  With none known, prvApplyLookups() moves on. */
+			if( xKnown != pdFALSE )
 			{
 				xStatus = EStatusAsking;
 			}
 			break;
 
 		case EStatusAsking:
-			{
-			char pcBuf[16];
-
-				prvNTPPacketInit( );
+			prvSendRequests();
+			xStateStartTime = xTaskGetTickCount();
+			xStatus = EStatusWaiting;
+			break;
 
-				#if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
+		case EStatusWaiting:
+			xAwaiting = pdFALSE;
+			for( x = 0; x < ntpSERVER_COUNT; x++ )
+			{
+				if( xServers[ x ].xAwaitingReply != pdFALSE )
 				{
-					xAddress.sin_address.ulIP_IPv4 = ulIPAddressFound;
-					xAddress.sin_port = FreeRTOS_htons( NTP_PORT );
-					FreeRTOS_inet_ntoa( xAddress.sin_address.ulIP_IPv4, pcBuf );
+					xAwaiting = pdTRUE;
 				}
-				#else
+			}
+
+			if( ( xAwaiting == pdFALSE ) || ( ( xTaskGetTickCount() - xStateStartTime ) >= pdMS_TO_TICKS( ntpREPLY_TIMEOUT_MS ) ) )
+			{
+				for( x = 0; x < ntpSERVER_COUNT; x++ )
 				{
-					xAddress.sin_addr = ulIPAddressFound;
-					xAddress.sin_port = FreeRTOS_htons( NTP_PORT );
-					FreeRTOS_inet_ntoa( xAddress.sin_addr, pcBuf );
+					if( xServers[ x ].xAwaitingReply != pdFALSE )
+					{
+						prvMissedReply( &( xServers[ x ] ) );
+					}
 				}
-				#endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
 
-				xAddress.sin_family = FREERTOS_AF_INET;
-				
-				FreeRTOS_printf( ( "Sending UDP message to %s:%u\n",
-					pcBuf,
-					FreeRTOS_ntohs( xAddress.sin_port ) ) );
-
-				uxSendTime = xTaskGetTickCount( );
-				FreeRTOS_sendto( xUDPSocket, ( void * )&xNTPPacket, sizeof( xNTPPacket ), 0, &xAddress, sizeof( xAddress ) );
+				prvUpdateClock();
+				uxPollCount++;
+				xStateStartTime = xTaskGetTickCount();
+				xStatus = EStatusPause;
 			}
 			break;
 
 		case EStatusPause:
+			xInterval = ( uxPollCount < ntpFAST_POLL_COUNT ) ? pdMS_TO_TICKS( ntpFAST_POLL_INTERVAL_MS ) : pdMS_TO_TICKS( ntpPOLL_INTERVAL_MS );
+			if( ( xTaskGetTickCount() - xStateStartTime ) >= xInterval )
+			{
+				/* Look up the servers that were dropped, the lookup state
+				moves on to asking straight away when the others are known. */
+				xStatus = EStatusLookup;
+				vSignalTask();
+			}
 			break;
 
 		case EStatusFailed:
@@ -432,15 +1061,22 @@ struct freertos_sockaddr xAddress;
 
 		#if( ipconfigUSE_CALLBACKS != 0 )
 		{
-			xSemaphoreTake( xNTPWakeupSem, 5000 );
+			xSemaphoreTake( xNTPWakeupSem, pdMS_TO_TICKS( ntpWAKE_INTERVAL_MS ) );
+
+			while( xQueueReceive( xReplyQueue, &xReply, 0 ) == pdPASS )
+			{
+				prvReadTime( &( xReply.xPacket ), xReply.ulIPAddress, xReply.llReceiveTime );
+			}
 		}
 		#else
 		{
 		uint32_t xAddressSize;
 		BaseType_t xReturned;
+		int64_t llReceiveTime;
 
 			xAddressSize = sizeof( xAddress );
 			xReturned = FreeRTOS_recvfrom( xUDPSocket, ( void * ) cRecvBuffer, sizeof( cRecvBuffer ), 0, &xAddress, &xAddressSize );
+			llReceiveTime = llNTPGetTime();
 			switch( xReturned )
 			{
 			case 0:
@@ -448,17 +1084,13 @@ struct freertos_sockaddr xAddress;
 			case -pdFREERTOS_ERRNO_EINTR:
 				break;
 			default:
-				if( xReturned < sizeof( xNTPPacket ) )
+				if( xReturned < ( BaseType_t ) sizeof( xNTPPacket ) )
 				{
 					FreeRTOS_printf( ( "FreeRTOS_recvfrom: returns %ld\n", xReturned ) );
 				}
 				else
 				{
-					prvReadTime( ( struct SNtpPacket *)cRecvBuffer );
-					if( xStatus != EStatusPause )
-					{
-						xStatus = EStatusPause;
-					}
+					prvReadTime( ( struct SNtpPacket *)cRecvBuffer, prvGetAddress( &xAddress ), llReceiveTime );
 				}
 				break;
 			}
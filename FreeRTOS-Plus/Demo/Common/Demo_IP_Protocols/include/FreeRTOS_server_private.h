@@ -32,6 +32,9 @@
 
 #define FREERTOS_NO_SOCKET		NULL
 
+/* FreeRTOS includes. */
+#include "queue.h"
+
 /* FreeRTOS+FAT */
 #include "ff_stdio.h"
 
@@ -56,6 +59,59 @@
 	#define ipconfigTCP_FILE_BUFFER_SIZE	( 2048 )
 #endif
 
+/*
+ * ipconfigHTTP_FILE_CACHE_ENTRIES sets the number of files that each HTTP
+ * server keeps in RAM, 0 disables the cache.
+ *
+ * ipconfigHTTP_FILE_CACHE_MAX_SIZE sets the size of the largest file that
+ * will be cached.  The file contents are allocated with pvPortMalloc().
+ */
+
+#ifndef ipconfigHTTP_FILE_CACHE_ENTRIES
+	#define ipconfigHTTP_FILE_CACHE_ENTRIES		( 0 )
+#endif
+
+#ifndef ipconfigHTTP_FILE_CACHE_MAX_SIZE
+	#define ipconfigHTTP_FILE_CACHE_MAX_SIZE	( 4096 )
+#endif
+
+/*
+ * ipconfigFTP_READ_AHEAD_SIZE sets the size of a buffer that each FTP client
+ * allocates during a download.  While the TX stream of the data socket is full,
+ * the next part of the file is read into this buffer, so that reading the disk
+ * overlaps with sending the data.  0 disables the read-ahead.
+ */
+
+#ifndef ipconfigFTP_READ_AHEAD_SIZE
+	#define ipconfigFTP_READ_AHEAD_SIZE		ipconfigTCP_FILE_BUFFER_SIZE
+#endif
+
+/*
+ * ipconfigTCP_SERVER_WORKERS sets the number of worker tasks that serve the
+ * connected clients.  With 0, the task that calls FreeRTOS_TCPServerWork()
+ * serves all clients.  Otherwise that task only accepts new connections and
+ * passes each client to the worker with the fewest clients.  Every worker has
+ * its own socket set and its own buffers, so also its own HTTP file cache.
+ *
+ * ipconfigTCP_SERVER_WORKER_STACK_SIZE and ipconfigTCP_SERVER_WORKER_BLOCK_TIME
+ * set the stack size of a worker, and the maximum time that it blocks in
+ * FreeRTOS_select().  The workers run at the priority of the task that creates
+ * the server.  Workers need ipconfigSUPPORT_SIGNALS, a new client is handed
+ * over by signalling the select() of the worker.
+ */
+
+#ifndef ipconfigTCP_SERVER_WORKERS
+	#define ipconfigTCP_SERVER_WORKERS				( 0 )
+#endif
+
+#ifndef ipconfigTCP_SERVER_WORKER_STACK_SIZE
+	#define ipconfigTCP_SERVER_WORKER_STACK_SIZE	( configMINIMAL_STACK_SIZE * 8 )
+#endif
+
+#ifndef ipconfigTCP_SERVER_WORKER_BLOCK_TIME
+	#define ipconfigTCP_SERVER_WORKER_BLOCK_TIME	pdMS_TO_TICKS( 200U )
+#endif
+
 struct xTCP_CLIENT;
 
 typedef BaseType_t ( * FTCPWorkFunction ) ( struct xTCP_CLIENT * /* pxClient */ );
@@ -68,6 +124,7 @@ typedef void ( * FTCPDeleteFunction ) ( struct xTCP_CLIENT * /* pxClient */ );
 	const char *pcRootDir; \
 	FTCPWorkFunction fWorkFunction; \
 	FTCPDeleteFunction fDeleteFunction; \
+	BaseType_t xPoll; /* Call fWorkFunction() in the next cycle, also without a socket event. */ \
 	struct xTCP_CLIENT *pxNextClient
 
 typedef struct xTCP_CLIENT
@@ -89,10 +146,21 @@ struct xHTTP_CLIENT
 	char pcCurrentFilename[ ffconfigMAX_FILENAME ];
 	size_t uxBytesLeft;
 	FF_FILE *pxFileHandle;
+	#if( ipconfigHTTP_FILE_CACHE_ENTRIES > 0 )
+		/* Set instead of pxFileHandle while a cached file is sent. */
+		struct xHTTP_CACHE_ENTRY *pxCacheEntry;
+	#endif
+	char *pcPending;			/* Received bytes of requests which are not handled yet. */
+	size_t uxPendingLength;
+	size_t uxBodyLeft;			/* Bytes of a request body that must be skipped. */
 	union {
 		struct {
 			uint32_t
-				bReplySent : 1;
+				bReplySent : 1,
+				bCloseAfterReply : 1,	/* Close the connection once the reply has been sent. */
+				bHeadOnly : 1,
+				bAcceptGzip : 1,
+				bShutdown : 1;
 		};
 		uint32_t ulFlags;
 	} bits;
@@ -100,6 +168,18 @@ struct xHTTP_CLIENT
 
 typedef struct xHTTP_CLIENT HTTPClient_t;
 
+#if( ipconfigHTTP_FILE_CACHE_ENTRIES > 0 )
+	typedef struct xHTTP_CACHE_ENTRY
+	{
+		char pcFileName[ ffconfigMAX_FILENAME ];
+		uint8_t *pucData;		/* NULL when the entry is not used. */
+		size_t uxSize;
+		uint32_t ulModified;	/* st_mtime of the file when it was read. */
+		TickType_t xLastUsed;
+		UBaseType_t uxUsers;	/* Clients sending the entry, it can not be replaced before they are done. */
+	} HTTPCacheEntry_t;
+#endif
+
 struct xFTP_CLIENT
 {
 	/* This define contains fields which must come first within each of the client structs */
@@ -118,6 +198,11 @@ struct xFTP_CLIENT
 	FF_FindData_t xFindData;
 	FF_FILE *pxReadHandle;
 	FF_FILE *pxWriteHandle;
+	#if( ipconfigFTP_READ_AHEAD_SIZE > 0 )
+		char *pcReadAhead;			/* Data read from pxReadHandle, not yet sent. */
+		size_t uxReadAheadHead;		/* Offset of the first byte not yet sent. */
+		size_t uxReadAheadLength;	/* Number of bytes not yet sent. */
+	#endif
 	char pcCurrentDir[ ffconfigMAX_FILENAME ];
 	char pcFileName[ ffconfigMAX_FILENAME ];
 	char pcConnectionAck[ 128 ];
@@ -170,10 +255,21 @@ struct xTCP_SERVER
 	#endif
 	#if( ipconfigUSE_HTTP != 0 )
 		char pcContentsType[40];	/* Space for the msg: "text/javascript" */
-		char pcExtraContents[40];	/* Space for the msg: "Content-Length: 346500" */
+		char pcExtraContents[192];	/* Space for e.g. "Content-Length: 346500", "ETag" and "Last-Modified" */
+	#endif
+	#if( ipconfigUSE_HTTP != 0 ) && ( ipconfigHTTP_FILE_CACHE_ENTRIES > 0 )
+		HTTPCacheEntry_t xFileCache[ ipconfigHTTP_FILE_CACHE_ENTRIES ];
 	#endif
 	BaseType_t xServerCount;
 	TCPClient_t *pxClients;
+	volatile UBaseType_t uxClientCount;	/* Also read by the parent to choose a worker. */
+	#if( ipconfigTCP_SERVER_WORKERS > 0 )
+		/* The parent accepts the connections, a worker receives its new
+		clients through xNewClients. */
+		struct xTCP_SERVER *pxWorkers[ ipconfigTCP_SERVER_WORKERS ];
+		QueueHandle_t xNewClients;
+		Socket_t xWakeSocket;	/* In the worker's set, only to interrupt its select(). */
+	#endif
 	struct xSERVER
 	{
 		enum eSERVER_TYPE eType;		/* eSERVER_HTTP | eSERVER_FTP */
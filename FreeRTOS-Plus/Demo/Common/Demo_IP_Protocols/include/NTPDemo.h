@@ -8,4 +8,8 @@
 
 void vStartNTPTask( uint16_t usTaskStackSize, UBaseType_t uxTaskPriority );
 
+/* Returns the time kept by the NTP client, in microseconds since 1 Jan 1970
+(UTC).  Small corrections are slewed, so the time does not jump. */
+int64_t llNTPGetTime( void );
+
 #endif
\ No newline at end of file
@@ -58,6 +58,15 @@
  */
 static void prvCreateFileInfoString( char *pcBuffer, F_FIND *pxFindStruct );
 
+/*
+ * Used by the DIR and TYPE commands when their output is streamed.  They write
+ * the whole directory listing or file with FreeRTOS_CLIWrite() in a single
+ * call, using pcWriteBuffer as working space, so do not need to keep the find
+ * structure or file open between calls.
+ */
+static void prvStreamDirectory( char *pcWriteBuffer, size_t xWriteBufferLen );
+static void prvStreamFile( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcFileName );
+
 /*
  * Copies an existing file into a newly created file.
  */
@@ -190,8 +199,18 @@ size_t xColumns = 50U;
 		/* Sanity check something was returned. */
 		configASSERT( pcParameter );
 
-		/* Attempt to open the requested file. */
-		pxFile = f_open( pcParameter, "r" );
+		if( FreeRTOS_CLIOutputIsStreamed() != pdFALSE )
+		{
+			/* Write the whole file now, in chunks as large as the buffer,
+			leaving just the final new line in the buffer. */
+			prvStreamFile( pcWriteBuffer, xWriteBufferLen, pcParameter );
+			memset( pcWriteBuffer, 0x00, xWriteBufferLen );
+		}
+		else
+		{
+			/* Attempt to open the requested file. */
+			pxFile = f_open( pcParameter, "r" );
+		}
 	}
 
 	if( pxFile != NULL )
@@ -279,7 +298,14 @@ BaseType_t xReturn = pdFALSE;
 	configASSERT( xWriteBufferLen > ( strlen( cliNEW_LINE ) * 2 ) );
 	xWriteBufferLen -= strlen( cliNEW_LINE );
 
-	if( pxFindStruct == NULL )
+	if( ( pxFindStruct == NULL ) && ( FreeRTOS_CLIOutputIsStreamed() != pdFALSE ) )
+	{
+		/* Write the whole listing now, leaving just the final new line in the
+		buffer. */
+		prvStreamDirectory( pcWriteBuffer, xWriteBufferLen );
+		pcWriteBuffer[ 0 ] = 0x00;
+	}
+	else if( pxFindStruct == NULL )
 	{
 		/* This is the first time this function has been executed since the Dir
 		command was run.  Create the find structure. */
@@ -527,3 +553,74 @@ const char * pcAttrib;
 	attributes string. */
 	sprintf( pcBuffer, "%s [%s] [size=%d]", pxFindStruct->filename, pcAttrib, ( int ) pxFindStruct->filesize );
 }
+/*-----------------------------------------------------------*/
+
+static void prvStreamDirectory( char *pcWriteBuffer, size_t xWriteBufferLen )
+{
+F_FIND *pxFindStruct;
+unsigned char ucReturned;
+
+	pxFindStruct = ( F_FIND * ) pvPortMalloc( sizeof( F_FIND ) );
+
+	if( pxFindStruct != NULL )
+	{
+		ucReturned = f_findfirst( "*.*", pxFindStruct );
+
+		if( ucReturned != F_NO_ERROR )
+		{
+			snprintf( pcWriteBuffer, xWriteBufferLen, "Error: f_findfirst() failed." cliNEW_LINE );
+			( void ) FreeRTOS_CLIWrite( pcWriteBuffer, strlen( pcWriteBuffer ) );
+		}
+
+		/* Write one line per file, stopping early if the output can no longer
+		be written. */
+		while( ucReturned == F_NO_ERROR )
+		{
+			prvCreateFileInfoString( pcWriteBuffer, pxFindStruct );
+			strcat( pcWriteBuffer, cliNEW_LINE );
+
+			if( FreeRTOS_CLIWrite( pcWriteBuffer, strlen( pcWriteBuffer ) ) != pdPASS )
+			{
+				break;
+			}
+
+			ucReturned = f_findnext( pxFindStruct );
+		}
+
+		vPortFree( pxFindStruct );
+	}
+	else
+	{
+		snprintf( pcWriteBuffer, xWriteBufferLen, "Failed to allocate RAM (using heap_4.c will prevent fragmentation)." cliNEW_LINE );
+		( void ) FreeRTOS_CLIWrite( pcWriteBuffer, strlen( pcWriteBuffer ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvStreamFile( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcFileName )
+{
+F_FILE *pxFile;
+long lBytesRead;
+
+	pxFile = f_open( pcFileName, "r" );
+
+	if( pxFile != NULL )
+	{
+		do
+		{
+			lBytesRead = f_read( pcWriteBuffer, 1, ( long ) xWriteBufferLen, pxFile );
+
+			if( lBytesRead > 0 )
+			{
+				if( FreeRTOS_CLIWrite( pcWriteBuffer, ( size_t ) lBytesRead ) != pdPASS )
+				{
+					break;
+				}
+			}
+
+		} while( lBytesRead == ( long ) xWriteBufferLen );
+
+		f_close( pxFile );
+	}
+}
+/*-----------------------------------------------------------*/
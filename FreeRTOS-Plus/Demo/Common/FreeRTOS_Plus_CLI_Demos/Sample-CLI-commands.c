@@ -53,6 +53,25 @@
 	#define configINCLUDE_QUERY_HEAP_COMMAND 0
 #endif
 
+/* The log-level command needs Logging_Levels.c, and the logging macros built
+with LOGGING_RUNTIME_LEVELS set to 1. */
+#ifndef configINCLUDE_LOG_LEVEL_COMMAND
+	#define configINCLUDE_LOG_LEVEL_COMMAND 0
+#endif
+
+#if( configINCLUDE_LOG_LEVEL_COMMAND == 1 )
+	#include "logging_levels.h"
+	#include "logging.h"
+#endif
+
+/* The trace-histograms command needs the streaming recorder to be built with
+TRC_CFG_ENABLE_HISTOGRAMS set to 1. */
+#if( ( configINCLUDE_TRACE_RELATED_CLI_COMMANDS == 1 ) && defined( TRC_CFG_ENABLE_HISTOGRAMS ) && ( TRC_CFG_ENABLE_HISTOGRAMS == 1 ) )
+	#define cliINCLUDE_TRACE_HISTOGRAM_COMMAND 1
+#else
+	#define cliINCLUDE_TRACE_HISTOGRAM_COMMAND 0
+#endif
+
 /*
  * The function that registers the commands that are defined within this file.
  */
@@ -70,6 +89,15 @@ static BaseType_t prvTaskStatsCommand( char *pcWriteBuffer, size_t xWriteBufferL
 	static BaseType_t prvRunTimeStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
 #endif /* configGENERATE_RUN_TIME_STATS */
 
+/*
+ * Used by the task-stats and run-time-stats commands when their output is
+ * streamed.  Writes the rows of the table a task at a time with
+ * FreeRTOS_CLIWrite(), formatting each row in pcWriteBuffer, rather than
+ * building the whole table in pcWriteBuffer as vTaskList() and
+ * vTaskGetRunTimeStats() do.
+ */
+static void prvStreamTaskTable( char *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t xRunTimeStats );
+
 /*
  * Implements the echo-three-parameters command.
  */
@@ -94,6 +122,20 @@ static BaseType_t prvParameterEchoCommand( char *pcWriteBuffer, size_t xWriteBuf
 	static BaseType_t prvStartStopTraceCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
 #endif
 
+/*
+ * Implements the "trace-histograms" command.
+ */
+#if( cliINCLUDE_TRACE_HISTOGRAM_COMMAND == 1 )
+	static BaseType_t prvTraceHistogramsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+#endif
+
+/*
+ * Implements the "log-level" command.
+ */
+#if( configINCLUDE_LOG_LEVEL_COMMAND == 1 )
+	static BaseType_t prvLogLevelCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+#endif
+
 /* Structure that defines the "task-stats" command line command.  This generates
 a table that gives information on each task in the system. */
 static const CLI_Command_Definition_t xTaskStats =
@@ -161,6 +203,32 @@ static const CLI_Command_Definition_t xParameterEcho =
 	};
 #endif /* configINCLUDE_TRACE_RELATED_CLI_COMMANDS */
 
+#if( cliINCLUDE_TRACE_HISTOGRAM_COMMAND == 1 )
+	/* Structure that defines the "trace-histograms" command line command.  This
+	lists the latency histograms of the trace recorder, or clears them if the
+	optional "reset" parameter is given. */
+	static const CLI_Command_Definition_t xTraceHistograms =
+	{
+		"trace-histograms",
+		"\r\ntrace-histograms [reset]:\r\n Displays the count, min, max, mean and 99th percentile (us) of each trace histogram\r\n",
+		prvTraceHistogramsCommand, /* The function to run. */
+		-1 /* Zero or one parameter is expected. */
+	};
+#endif /* cliINCLUDE_TRACE_HISTOGRAM_COMMAND */
+
+#if( configINCLUDE_LOG_LEVEL_COMMAND == 1 )
+	/* Structure that defines the "log-level" command line command.  Without
+	parameters it lists the modules that have logged, with two parameters it sets
+	the run time log level of a module. */
+	static const CLI_Command_Definition_t xLogLevel =
+	{
+		"log-level",
+		"\r\nlog-level [<module | file | all> <none | error | warn | info | debug>]:\r\n Lists the run time log levels, or sets the level of a module\r\n",
+		prvLogLevelCommand, /* The function to run. */
+		-1 /* Zero or two parameters are expected. */
+	};
+#endif /* configINCLUDE_LOG_LEVEL_COMMAND */
+
 /*-----------------------------------------------------------*/
 
 void vRegisterSampleCLICommands( void )
@@ -187,6 +255,18 @@ void vRegisterSampleCLICommands( void )
 		FreeRTOS_CLIRegisterCommand( &xStartStopTrace );
 	}
 	#endif
+
+	#if( cliINCLUDE_TRACE_HISTOGRAM_COMMAND == 1 )
+	{
+		FreeRTOS_CLIRegisterCommand( &xTraceHistograms );
+	}
+	#endif
+
+	#if( configINCLUDE_LOG_LEVEL_COMMAND == 1 )
+	{
+		FreeRTOS_CLIRegisterCommand( &xLogLevel );
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -194,6 +274,7 @@ static BaseType_t prvTaskStatsCommand( char *pcWriteBuffer, size_t xWriteBufferL
 {
 const char *const pcHeader = "     State   Priority  Stack    #\r\n************************************************\r\n";
 BaseType_t xSpacePadding;
+char * const pcTable = pcWriteBuffer;
 
 	/* Remove compile time warnings about unused parameters, and check the
 	write buffer is not NULL.  NOTE - for simplicity, this example assumes the
@@ -219,7 +300,22 @@ BaseType_t xSpacePadding;
 		*pcWriteBuffer = 0x00;
 	}
 	strcpy( pcWriteBuffer, pcHeader );
-	vTaskList( pcWriteBuffer + strlen( pcHeader ) );
+
+	if( FreeRTOS_CLIOutputIsStreamed() != pdFALSE )
+	{
+		/* Send the heading, then the table a row at a time, so the size of
+		the table is not limited by the size of the write buffer. */
+		if( FreeRTOS_CLIWrite( pcTable, strlen( pcTable ) ) == pdPASS )
+		{
+			prvStreamTaskTable( pcTable, xWriteBufferLen, pdFALSE );
+		}
+
+		pcTable[ 0 ] = 0x00;
+	}
+	else
+	{
+		vTaskList( pcWriteBuffer + strlen( pcHeader ) );
+	}
 
 	/* There is no more data to return after this single string, so return
 	pdFALSE. */
@@ -254,6 +350,7 @@ BaseType_t xSpacePadding;
 	{
 	const char * const pcHeader = "  Abs Time      % Time\r\n****************************************\r\n";
 	BaseType_t xSpacePadding;
+	char * const pcTable = pcWriteBuffer;
 
 		/* Remove compile time warnings about unused parameters, and check the
 		write buffer is not NULL.  NOTE - for simplicity, this example assumes the
@@ -281,7 +378,20 @@ BaseType_t xSpacePadding;
 		}
 
 		strcpy( pcWriteBuffer, pcHeader );
-		vTaskGetRunTimeStats( pcWriteBuffer + strlen( pcHeader ) );
+
+		if( FreeRTOS_CLIOutputIsStreamed() != pdFALSE )
+		{
+			if( FreeRTOS_CLIWrite( pcTable, strlen( pcTable ) ) == pdPASS )
+			{
+				prvStreamTaskTable( pcTable, xWriteBufferLen, pdTRUE );
+			}
+
+			pcTable[ 0 ] = 0x00;
+		}
+		else
+		{
+			vTaskGetRunTimeStats( pcWriteBuffer + strlen( pcHeader ) );
+		}
 
 		/* There is no more data to return after this single string, so return
 		pdFALSE. */
@@ -291,11 +401,105 @@ BaseType_t xSpacePadding;
 #endif /* configGENERATE_RUN_TIME_STATS */
 /*-----------------------------------------------------------*/
 
+static void prvStreamTaskTable( char *pcWriteBuffer, size_t xWriteBufferLen, BaseType_t xRunTimeStats )
+{
+TaskStatus_t *pxTaskStatusArray;
+UBaseType_t uxArraySize, x;
+configRUN_TIME_COUNTER_TYPE ulTotalTime = 0, ulStatsAsPercentage;
+size_t xNameLength;
+char cStatus;
+BaseType_t xStatus = pdPASS;
+
+	/* Not used if configGENERATE_RUN_TIME_STATS is 0. */
+	( void ) ulStatsAsPercentage;
+	( void ) xRunTimeStats;
+
+	/* Take a snapshot of the state of the tasks.  A couple of spare entries
+	allow for tasks that are created while the array is being allocated. */
+	uxArraySize = uxTaskGetNumberOfTasks() + 2;
+	pxTaskStatusArray = ( TaskStatus_t * ) pvPortMalloc( uxArraySize * sizeof( TaskStatus_t ) );
+
+	if( pxTaskStatusArray == NULL )
+	{
+		snprintf( pcWriteBuffer, xWriteBufferLen, "Failed to allocate RAM for the task table.\r\n" );
+		( void ) FreeRTOS_CLIWrite( pcWriteBuffer, strlen( pcWriteBuffer ) );
+	}
+	else
+	{
+		uxArraySize = uxTaskGetSystemState( pxTaskStatusArray, uxArraySize, &ulTotalTime );
+
+		/* For percentage calculations. */
+		ulTotalTime /= 100UL;
+
+		for( x = 0; ( x < uxArraySize ) && ( xStatus == pdPASS ); x++ )
+		{
+			/* Pad the task name with spaces so the columns line up, as
+			vTaskList() and vTaskGetRunTimeStats() do. */
+			snprintf( pcWriteBuffer, xWriteBufferLen, "%-*s", ( int ) ( configMAX_TASK_NAME_LEN - 1 ), pxTaskStatusArray[ x ].pcTaskName );
+			xNameLength = strlen( pcWriteBuffer );
+
+			#if( configGENERATE_RUN_TIME_STATS == 1 )
+			if( xRunTimeStats != pdFALSE )
+			{
+				if( ulTotalTime == 0UL )
+				{
+					/* Avoid a divide by zero, as vTaskGetRunTimeStats() does. */
+					break;
+				}
+
+				ulStatsAsPercentage = pxTaskStatusArray[ x ].ulRunTimeCounter / ulTotalTime;
+
+				if( ulStatsAsPercentage > 0UL )
+				{
+					snprintf( pcWriteBuffer + xNameLength, xWriteBufferLen - xNameLength, "\t%lu\t\t%lu%%\r\n", ( unsigned long ) pxTaskStatusArray[ x ].ulRunTimeCounter, ( unsigned long ) ulStatsAsPercentage );
+				}
+				else
+				{
+					/* If the percentage is zero here then the task has
+					consumed less than 1% of the total run time. */
+					snprintf( pcWriteBuffer + xNameLength, xWriteBufferLen - xNameLength, "\t%lu\t\t<1%%\r\n", ( unsigned long ) pxTaskStatusArray[ x ].ulRunTimeCounter );
+				}
+			}
+			else
+			#endif /* configGENERATE_RUN_TIME_STATS */
+			{
+				switch( pxTaskStatusArray[ x ].eCurrentState )
+				{
+					case eRunning:		cStatus = 'X';
+										break;
+
+					case eReady:		cStatus = 'R';
+										break;
+
+					case eBlocked:		cStatus = 'B';
+										break;
+
+					case eSuspended:	cStatus = 'S';
+										break;
+
+					case eDeleted:		cStatus = 'D';
+										break;
+
+					default:			cStatus = '?';
+										break;
+				}
+
+				snprintf( pcWriteBuffer + xNameLength, xWriteBufferLen - xNameLength, "\t%c\t%u\t%u\t%u\r\n", cStatus, ( unsigned int ) pxTaskStatusArray[ x ].uxCurrentPriority, ( unsigned int ) pxTaskStatusArray[ x ].usStackHighWaterMark, ( unsigned int ) pxTaskStatusArray[ x ].xTaskNumber );
+			}
+
+			xStatus = FreeRTOS_CLIWrite( pcWriteBuffer, strlen( pcWriteBuffer ) );
+		}
+
+		vPortFree( pxTaskStatusArray );
+	}
+}
+/*-----------------------------------------------------------*/
+
 static BaseType_t prvThreeParameterEchoCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
 {
 const char *pcParameter;
 BaseType_t xParameterStringLength, xReturn;
-static UBaseType_t uxParameterNumber = 0;
+UBaseType_t * const puxParameterNumber = FreeRTOS_CLIGetCommandState();
 
 	/* Remove compile time warnings about unused parameters, and check the
 	write buffer is not NULL.  NOTE - for simplicity, this example assumes the
@@ -304,7 +508,7 @@ static UBaseType_t uxParameterNumber = 0;
 	( void ) xWriteBufferLen;
 	configASSERT( pcWriteBuffer );
 
-	if( uxParameterNumber == 0 )
+	if( *puxParameterNumber == 0 )
 	{
 		/* The first time the function is called after the command has been
 		entered just a header string is returned. */
@@ -312,7 +516,7 @@ static UBaseType_t uxParameterNumber = 0;
 
 		/* Next time the function is called the first parameter will be echoed
 		back. */
-		uxParameterNumber = 1U;
+		*puxParameterNumber = 1U;
 
 		/* There is more data to be returned as no parameters have been echoed
 		back yet. */
@@ -324,7 +528,7 @@ static UBaseType_t uxParameterNumber = 0;
 		pcParameter = FreeRTOS_CLIGetParameter
 						(
 							pcCommandString,		/* The command string itself. */
-							uxParameterNumber,		/* Return the next parameter. */
+							*puxParameterNumber,		/* Return the next parameter. */
 							&xParameterStringLength	/* Store the parameter string length. */
 						);
 
@@ -333,24 +537,24 @@ static UBaseType_t uxParameterNumber = 0;
 
 		/* Return the parameter string. */
 		memset( pcWriteBuffer, 0x00, xWriteBufferLen );
-		sprintf( pcWriteBuffer, "%d: ", ( int ) uxParameterNumber );
+		sprintf( pcWriteBuffer, "%d: ", ( int ) *puxParameterNumber );
 		strncat( pcWriteBuffer, pcParameter, ( size_t ) xParameterStringLength );
 		strncat( pcWriteBuffer, "\r\n", strlen( "\r\n" ) );
 
 		/* If this is the last of the three parameters then there are no more
 		strings to return after this one. */
-		if( uxParameterNumber == 3U )
+		if( *puxParameterNumber == 3U )
 		{
 			/* If this is the last of the three parameters then there are no more
 			strings to return after this one. */
 			xReturn = pdFALSE;
-			uxParameterNumber = 0;
+			*puxParameterNumber = 0;
 		}
 		else
 		{
 			/* There are more parameters to return after this one. */
 			xReturn = pdTRUE;
-			uxParameterNumber++;
+			( *puxParameterNumber )++;
 		}
 	}
 
@@ -362,7 +566,7 @@ static BaseType_t prvParameterEchoCommand( char *pcWriteBuffer, size_t xWriteBuf
 {
 const char *pcParameter;
 BaseType_t xParameterStringLength, xReturn;
-static UBaseType_t uxParameterNumber = 0;
+UBaseType_t * const puxParameterNumber = FreeRTOS_CLIGetCommandState();
 
 	/* Remove compile time warnings about unused parameters, and check the
 	write buffer is not NULL.  NOTE - for simplicity, this example assumes the
@@ -371,7 +575,7 @@ static UBaseType_t uxParameterNumber = 0;
 	( void ) xWriteBufferLen;
 	configASSERT( pcWriteBuffer );
 
-	if( uxParameterNumber == 0 )
+	if( *puxParameterNumber == 0 )
 	{
 		/* The first time the function is called after the command has been
 		entered just a header string is returned. */
@@ -379,7 +583,7 @@ static UBaseType_t uxParameterNumber = 0;
 
 		/* Next time the function is called the first parameter will be echoed
 		back. */
-		uxParameterNumber = 1U;
+		*puxParameterNumber = 1U;
 
 		/* There is more data to be returned as no parameters have been echoed
 		back yet. */
@@ -391,7 +595,7 @@ static UBaseType_t uxParameterNumber = 0;
 		pcParameter = FreeRTOS_CLIGetParameter
 						(
 							pcCommandString,		/* The command string itself. */
-							uxParameterNumber,		/* Return the next parameter. */
+							*puxParameterNumber,		/* Return the next parameter. */
 							&xParameterStringLength	/* Store the parameter string length. */
 						);
 
@@ -399,13 +603,13 @@ static UBaseType_t uxParameterNumber = 0;
 		{
 			/* Return the parameter string. */
 			memset( pcWriteBuffer, 0x00, xWriteBufferLen );
-			sprintf( pcWriteBuffer, "%d: ", ( int ) uxParameterNumber );
+			sprintf( pcWriteBuffer, "%d: ", ( int ) *puxParameterNumber );
 			strncat( pcWriteBuffer, ( char * ) pcParameter, ( size_t ) xParameterStringLength );
 			strncat( pcWriteBuffer, "\r\n", strlen( "\r\n" ) );
 
 			/* There might be more parameters to return after this one. */
 			xReturn = pdTRUE;
-			uxParameterNumber++;
+			( *puxParameterNumber )++;
 		}
 		else
 		{
@@ -417,7 +621,7 @@ static UBaseType_t uxParameterNumber = 0;
 			xReturn = pdFALSE;
 
 			/* Start over the next time this command is executed. */
-			uxParameterNumber = 0;
+			*puxParameterNumber = 0;
 		}
 	}
 
@@ -477,3 +681,165 @@ static UBaseType_t uxParameterNumber = 0;
 	}
 
 #endif /* configINCLUDE_TRACE_RELATED_CLI_COMMANDS */
+/*-----------------------------------------------------------*/
+
+#if( cliINCLUDE_TRACE_HISTOGRAM_COMMAND == 1 )
+
+	static uint32_t prvTicksToMicroseconds( uint32_t ulTicks, TraceUnsignedBaseType_t uxFrequency )
+	{
+		if( uxFrequency == 0 )
+		{
+			return ulTicks;
+		}
+
+		return ( uint32_t ) ( ( ( uint64_t ) ulTicks * 1000000ULL ) / uxFrequency );
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvTraceHistogramsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+	{
+	const char *pcParameter;
+	BaseType_t xParameterStringLength, xReturn;
+	UBaseType_t * const puxHistogramIndex = FreeRTOS_CLIGetCommandState();
+	UBaseType_t uxCleared = 0;
+	TraceHistogramHandle_t xHistogram;
+	TraceHistogramStats_t xStats;
+	TraceUnsignedBaseType_t uxFrequency = 0;
+
+		configASSERT( pcWriteBuffer );
+
+		if( *puxHistogramIndex == 0 )
+		{
+			/* The first time the function is called after the command has been
+			entered, either reset the histograms or return the header. */
+			pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+
+			if( ( pcParameter != NULL ) && ( strncmp( pcParameter, "reset", strlen( "reset" ) ) == 0 ) )
+			{
+				while( xTraceHistogramGetAtIndex( ( uint32_t ) uxCleared, &xHistogram ) == TRC_SUCCESS )
+				{
+					xTraceHistogramReset( xHistogram );
+					uxCleared++;
+				}
+
+				snprintf( pcWriteBuffer, xWriteBufferLen, "%u histograms cleared.\r\n", ( unsigned ) uxCleared );
+
+				return pdFALSE;
+			}
+
+			snprintf( pcWriteBuffer, xWriteBufferLen, "%-16s %10s %10s %10s %10s %10s\r\n", "Name", "Count", "Min", "Max", "Mean", "P99" );
+			*puxHistogramIndex = 1U;
+
+			return pdTRUE;
+		}
+
+		/* Return one histogram per call, as the write buffer may be small. */
+		if( xTraceHistogramGetAtIndex( ( uint32_t ) ( *puxHistogramIndex - 1U ), &xHistogram ) == TRC_SUCCESS )
+		{
+			xTraceTimestampGetFrequency( &uxFrequency );
+			xTraceHistogramGetStats( xHistogram, &xStats );
+
+			snprintf( pcWriteBuffer, xWriteBufferLen, "%-16s %10u %10u %10u %10u %10u\r\n",
+					  xStats.szName != NULL ? xStats.szName : "",
+					  ( unsigned ) xStats.uiCount,
+					  ( unsigned ) prvTicksToMicroseconds( xStats.uiMin, uxFrequency ),
+					  ( unsigned ) prvTicksToMicroseconds( xStats.uiMax, uxFrequency ),
+					  ( unsigned ) prvTicksToMicroseconds( xStats.uiMean, uxFrequency ),
+					  ( unsigned ) prvTicksToMicroseconds( xStats.uiP99, uxFrequency ) );
+
+			( *puxHistogramIndex )++;
+			xReturn = pdTRUE;
+		}
+		else
+		{
+			/* No more histograms.  Make sure the write buffer does not contain a
+			valid string, and start over the next time this command is executed. */
+			pcWriteBuffer[ 0 ] = 0x00;
+			*puxHistogramIndex = 0;
+			xReturn = pdFALSE;
+		}
+
+		return xReturn;
+	}
+
+#endif /* cliINCLUDE_TRACE_HISTOGRAM_COMMAND */
+/*-----------------------------------------------------------*/
+
+#if( configINCLUDE_LOG_LEVEL_COMMAND == 1 )
+
+	static BaseType_t prvLogLevelCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+	{
+	const char *pcModule, *pcLevel;
+	BaseType_t xModuleLength, xLevelLength, xReturn;
+	UBaseType_t * const puxModuleIndex = FreeRTOS_CLIGetCommandState();
+	const LoggingModule_t *pxModule;
+	char cName[ 32 ];
+	uint8_t ucLevel;
+
+		configASSERT( pcWriteBuffer );
+
+		if( *puxModuleIndex == 0 )
+		{
+			/* The first time the function is called after the command has been
+			entered, either set a level or return the header of the list. */
+			pcModule = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xModuleLength );
+			pcLevel = FreeRTOS_CLIGetParameter( pcCommandString, 2, &xLevelLength );
+
+			if( pcModule != NULL )
+			{
+				if( ( pcLevel == NULL ) || ( xLoggingParseLevel( pcLevel, ( size_t ) xLevelLength, &ucLevel ) == pdFALSE ) )
+				{
+					snprintf( pcWriteBuffer, xWriteBufferLen, "Valid levels are 'none', 'error', 'warn', 'info' and 'debug'.\r\n" );
+				}
+				else if( ( size_t ) xModuleLength >= sizeof( cName ) )
+				{
+					snprintf( pcWriteBuffer, xWriteBufferLen, "Module name too long.\r\n" );
+				}
+				else
+				{
+					/* The parameter is not terminated in the command string. */
+					memcpy( cName, pcModule, ( size_t ) xModuleLength );
+					cName[ xModuleLength ] = '\0';
+
+					/* Modules that have not logged yet pick the level up when
+					they do. */
+					snprintf( pcWriteBuffer, xWriteBufferLen, "%u modules set to %s, others follow when they first log.\r\n", ( unsigned ) uxLoggingSetLevel( cName, ucLevel ), pcLoggingLevelName( ucLevel ) );
+				}
+
+				return pdFALSE;
+			}
+
+			snprintf( pcWriteBuffer, xWriteBufferLen, "%-4s %-12s %-6s %s\r\n", "ID", "Module", "Level", "File" );
+			*puxModuleIndex = 1U;
+
+			return pdTRUE;
+		}
+
+		/* Return one module per call, as the write buffer may be small. */
+		pxModule = pxLoggingGetModule( *puxModuleIndex - 1U );
+
+		if( pxModule != NULL )
+		{
+			snprintf( pcWriteBuffer, xWriteBufferLen, "#%-3u %-12s %-6s %s\r\n",
+					  ( unsigned ) pxModule->usId,
+					  pxModule->pcName,
+					  pcLoggingLevelName( pxModule->ucLevel ),
+					  pxModule->pcFile );
+
+			( *puxModuleIndex )++;
+			xReturn = pdTRUE;
+		}
+		else
+		{
+			/* No more modules.  Make sure the write buffer does not contain a
+			valid string, and start over the next time this command is executed. */
+			pcWriteBuffer[ 0 ] = 0x00;
+			*puxModuleIndex = 0;
+			xReturn = pdFALSE;
+		}
+
+		return xReturn;
+	}
+
+#endif /* configINCLUDE_LOG_LEVEL_COMMAND */
+/*-----------------------------------------------------------*/
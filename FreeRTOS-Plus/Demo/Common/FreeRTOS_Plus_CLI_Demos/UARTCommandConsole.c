@@ -69,6 +69,12 @@ available. */
 static void prvUARTCommandConsoleTask( void *pvParameters );
 void vUARTCommandConsoleStart( uint16_t usStackSize, UBaseType_t uxPriority );
 
+/*
+ * Writes command output to the UART as FreeRTOS+CLI generates it.
+ * pvOutputContext points to the handle of the port.
+ */
+static BaseType_t prvUARTWriteOutput( void *pvOutputContext, const char *pcData, size_t xDataLength );
+
 /*-----------------------------------------------------------*/
 
 /* Const messages output by the command console. */
@@ -83,6 +89,11 @@ static SemaphoreHandle_t xTxMutex = NULL;
 /* The handle to the UART port, which is not used by all ports. */
 static xComPortHandle xPort = 0;
 
+/* The state of the commands run from the UART, kept separately from the state
+of commands run from any other console.  The consoles run commands at the same
+time if configCLI_SESSION_THREAD_LOCAL_INDEX is defined, else they take turns. */
+static CLI_Session_t xCLISession;
+
 /*-----------------------------------------------------------*/
 
 void vUARTCommandConsoleStart( uint16_t usStackSize, UBaseType_t uxPriority )
@@ -107,15 +118,15 @@ signed char cRxedChar;
 uint8_t ucInputIndex = 0;
 char *pcOutputString;
 static char cInputString[ cmdMAX_INPUT_SIZE ], cLastInputString[ cmdMAX_INPUT_SIZE ];
-BaseType_t xReturned;
 xComPortHandle xPort;
 
 	( void ) pvParameters;
 
 	/* Obtain the address of the output buffer.  Note there is no mutual
-	exclusion on this buffer as it is assumed only one command console interface
-	will be used at any one time. */
+	exclusion on this buffer as it is assumed no other command console interface
+	uses it. */
 	pcOutputString = FreeRTOS_CLIGetOutputBuffer();
+	FreeRTOS_CLIInitialiseSession( &xCLISession );
 
 	/* Initialise the UART. */
 	xPort = xSerialPortInitMinimal( configCLI_BAUD_RATE, cmdQUEUE_LENGTH );
@@ -151,18 +162,10 @@ xComPortHandle xPort;
 				}
 
 				/* Pass the received command to the command interpreter.  The
-				command interpreter is called repeatedly until it returns
-				pdFALSE	(indicating there is no more output) as it might
-				generate more than one string. */
-				do
-				{
-					/* Get the next output string from the command interpreter. */
-					xReturned = FreeRTOS_CLIProcessCommand( cInputString, pcOutputString, configCOMMAND_INT_MAX_OUTPUT_SIZE );
-
-					/* Write the generated string to the UART. */
-					vSerialPutString( xPort, ( signed char * ) pcOutputString, ( unsigned short ) strlen( pcOutputString ) );
-
-				} while( xReturned != pdFALSE );
+				output is written to the UART as it is generated, so commands
+				that stream their output, such as task-stats, are not limited
+				by the size of the output buffer. */
+				( void ) FreeRTOS_CLIProcessCommandStreamedInSession( &xCLISession, cInputString, prvUARTWriteOutput, &xPort, pcOutputString, configCOMMAND_INT_MAX_OUTPUT_SIZE );
 
 				/* All the strings generated by the input command have been
 				sent.  Clear the input string ready to receive the next command.
@@ -213,6 +216,16 @@ xComPortHandle xPort;
 }
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvUARTWriteOutput( void *pvOutputContext, const char *pcData, size_t xDataLength )
+{
+xComPortHandle *pxPort = ( xComPortHandle * ) pvOutputContext;
+
+	vSerialPutString( *pxPort, ( signed char * ) pcData, ( unsigned short ) xDataLength );
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
 void vOutputString( const char * const pcMessage )
 {
 	if( xSemaphoreTake( xTxMutex, cmdMAX_MUTEX_WAIT ) == pdPASS )
@@ -216,7 +216,7 @@ void vRegisterUDPCLICommands( void )
 
 	static BaseType_t prvDisplayIPDebugStats( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
 	{
-	static BaseType_t xIndex = -1;
+	UBaseType_t * const puxIndex = FreeRTOS_CLIGetCommandState();
 	extern xExampleDebugStatEntry_t xIPTraceValues[];
 	BaseType_t xReturn;
 
@@ -227,17 +227,16 @@ void vRegisterUDPCLICommands( void )
 		( void ) xWriteBufferLen;
 		configASSERT( pcWriteBuffer );
 
-		xIndex++;
-
-		if( xIndex < xExampleDebugStatEntries() )
+		if( *puxIndex < ( UBaseType_t ) xExampleDebugStatEntries() )
 		{
-			sprintf( pcWriteBuffer, "%s %d\r\n", ( char * ) xIPTraceValues[ xIndex ].pucDescription, ( int ) xIPTraceValues[ xIndex ].ulData );
+			sprintf( pcWriteBuffer, "%s %d\r\n", ( char * ) xIPTraceValues[ *puxIndex ].pucDescription, ( int ) xIPTraceValues[ *puxIndex ].ulData );
+			( *puxIndex )++;
 			xReturn = pdPASS;
 		}
 		else
 		{
 			/* Reset the index for the next time it is called. */
-			xIndex = -1;
+			*puxIndex = 0;
 
 			/* Ensure nothing remains in the write buffer. */
 			pcWriteBuffer[ 0 ] = 0x00;
@@ -252,7 +251,7 @@ void vRegisterUDPCLICommands( void )
 
 static BaseType_t prvDisplayIPConfig( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
 {
-static BaseType_t xIndex = 0;
+UBaseType_t * const puxIndex = FreeRTOS_CLIGetCommandState();
 BaseType_t xReturn;
 uint32_t ulAddress;
 
@@ -263,7 +262,7 @@ uint32_t ulAddress;
 	( void ) xWriteBufferLen;
 	configASSERT( pcWriteBuffer );
 
-	switch( xIndex )
+	switch( *puxIndex )
 	{
 		case 0 :
 		#if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
@@ -273,7 +272,7 @@ uint32_t ulAddress;
 		#endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
 			sprintf( pcWriteBuffer, "\r\nIP address " );
 			xReturn = pdTRUE;
-			xIndex++;
+			( *puxIndex )++;
 			break;
 
 		case 1 :
@@ -284,7 +283,7 @@ uint32_t ulAddress;
 		#endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
 			sprintf( pcWriteBuffer, "\r\nNet mask " );
 			xReturn = pdTRUE;
-			xIndex++;
+			( *puxIndex )++;
 			break;
 
 		case 2 :
@@ -295,7 +294,7 @@ uint32_t ulAddress;
 		#endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
 			sprintf( pcWriteBuffer, "\r\nGateway address " );
 			xReturn = pdTRUE;
-			xIndex++;
+			( *puxIndex )++;
 			break;
 
 		case 3 :
@@ -306,14 +305,14 @@ uint32_t ulAddress;
 		#endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
 			sprintf( pcWriteBuffer, "\r\nDNS server address " );
 			xReturn = pdTRUE;
-			xIndex++;
+			( *puxIndex )++;
 			break;
 
 		default :
 			ulAddress = 0;
 			sprintf( pcWriteBuffer, "\r\n\r\n" );
 			xReturn = pdFALSE;
-			xIndex = 0;
+			*puxIndex = 0;
 			break;
 	}
 
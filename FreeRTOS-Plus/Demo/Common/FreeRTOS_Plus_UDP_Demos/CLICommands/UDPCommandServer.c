@@ -79,6 +79,7 @@ void vUDPCommandInterpreterTask( void *pvParameters )
 long lBytes, lByte;
 signed char cInChar, cInputIndex = 0;
 static char cInputString[ cmdMAX_INPUT_SIZE ], cOutputString[ cmdMAX_OUTPUT_SIZE ], cLocalBuffer[ cmdSOCKET_INPUT_BUFFER_SIZE ];
+static CLI_Session_t xCLISession;
 BaseType_t xMoreDataToFollow;
 struct freertos_sockaddr xClient;
 socklen_t xClientAddressLength = 0; /* This is required as a parameter to maintain the sendto() Berkeley sockets API - but it is not actually used so can take any value. */
@@ -87,6 +88,12 @@ xSocket_t xSocket;
 	/* Just to prevent compiler warnings. */
 	( void ) pvParameters;
 
+	/* Commands entered over UDP keep their own state, and use their own
+	output buffer, so they are not disturbed by commands entered on any other
+	console.  They run at the same time as those commands if
+	configCLI_SESSION_THREAD_LOCAL_INDEX is defined, else they take turns. */
+	FreeRTOS_CLIInitialiseSession( &xCLISession );
+
 	/* Attempt to open the socket.  The port number is passed in the task
 	parameter.  The strange casting is to remove compiler warnings on 32-bit
 	machines. */
@@ -118,7 +125,7 @@ xSocket_t xSocket;
 						do
 						{
 							/* Pass the string to FreeRTOS+CLI. */
-							xMoreDataToFollow = FreeRTOS_CLIProcessCommand( cInputString, cOutputString, cmdMAX_OUTPUT_SIZE );
+							xMoreDataToFollow = FreeRTOS_CLIProcessCommandInSession( &xCLISession, cInputString, cOutputString, cmdMAX_OUTPUT_SIZE );
 
 							/* Send the output generated by the command's
 							implementation. */
@@ -0,0 +1,899 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Deferred logging backend for the LogError(), LogWarn(), LogInfo() and
+ * LogDebug() macros of logging_stack.h, used when LOGGING_DEFERRED is 1.
+ *
+ * The task that logs does not format anything.  vLoggingPrintfDeferred() walks
+ * the format strings only to find the type of each argument, and copies the
+ * format pointers and the raw argument values into a binary record in a ring
+ * buffer.  A low priority task takes the records from the ring buffer,
+ * formats them and writes them out.  Strings passed with %s are copied into the
+ * record, everything else is stored by value, so the formats themselves must be
+ * string literals (or otherwise remain valid until the record is printed).
+ *
+ * Space in the ring buffer is reserved with a single compare-and-swap on the
+ * head index, so any number of tasks can log concurrently without a mutex.
+ * A record is published by writing its length into its first word, which the
+ * logging task clears again when it consumes the record.  When the ring buffer
+ * is full the message is dropped and counted, and the number of dropped
+ * messages is printed with the next message that does fit.
+ *
+ * vLoggingPrintfDeferred() must not be called from interrupts.  Wide character
+ * conversions (%lc, %ls) are not supported.  The record is built on the stack
+ * of the task that logs, so every task that calls LogError(), LogWarn(),
+ * LogInfo() or LogDebug() needs about dlDEFERRED_MAX_RECORD_SIZE bytes more
+ * stack than it would otherwise.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "atomic.h"
+
+/* Demo includes. */
+#include "logging.h"
+
+/*-----------------------------------------------------------*/
+
+/* The size of the ring buffer that holds the records, must be a power of 2. */
+#ifndef dlDEFERRED_BUFFER_SIZE
+    #define dlDEFERRED_BUFFER_SIZE    8192U
+#endif
+
+/* The maximum size of one record.  Strings that do not fit are truncated. */
+#ifndef dlDEFERRED_MAX_RECORD_SIZE
+    #define dlDEFERRED_MAX_RECORD_SIZE    256U
+#endif
+
+/* Dimensions the array into which a record is formatted. */
+#ifndef dlMAX_PRINT_STRING_LENGTH
+    #define dlMAX_PRINT_STRING_LENGTH    255
+#endif
+
+/* Writes formatted messages out, called from the logging task only. */
+#ifndef dlDEFERRED_OUTPUT
+    #define dlDEFERRED_OUTPUT( pcString, xLength )    ( void ) fwrite( ( pcString ), 1U, ( xLength ), stdout )
+#endif
+
+/* Called by the logging task after writing out a batch of messages. */
+#ifndef dlDEFERRED_FLUSH
+    #define dlDEFERRED_FLUSH()    ( void ) fflush( stdout )
+#endif
+
+/* The logging task also wakes up periodically, in case a notification was
+ * missed while it was busy. */
+#define dlDEFERRED_POLL_TIME        pdMS_TO_TICKS( 100U )
+
+/* Records start on a 32-bit boundary, so that their length word can be
+ * written atomically. */
+#define dlRECORD_ALIGNMENT          sizeof( uint32_t )
+
+#if ( ( dlDEFERRED_BUFFER_SIZE & ( dlDEFERRED_BUFFER_SIZE - 1U ) ) != 0U )
+    #error dlDEFERRED_BUFFER_SIZE must be a power of 2
+#endif
+
+#if ( dlDEFERRED_MAX_RECORD_SIZE > ( dlDEFERRED_BUFFER_SIZE / 2U ) )
+    #error dlDEFERRED_MAX_RECORD_SIZE must not exceed half of dlDEFERRED_BUFFER_SIZE
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* The type of the value that a conversion specification consumes. */
+typedef enum
+{
+    eArgNone,       /* "%%", or a specification that is not understood. */
+    eArgInt,        /* d i o u x X c, optionally with hh or h. */
+    eArgLong,       /* With l. */
+    eArgLongLong,   /* With ll. */
+    eArgIntMax,     /* With j. */
+    eArgSize,       /* With z. */
+    eArgPtrDiff,    /* With t. */
+    eArgDouble,     /* f F e E g G a A. */
+    eArgLongDouble, /* With L. */
+    eArgString,     /* s, copied into the record. */
+    eArgPointer,    /* p. */
+    eArgIgnore      /* n, the pointer is consumed but nothing is stored. */
+} ArgType_t;
+
+/* A parsed conversion specification. */
+typedef struct xCONVERSION
+{
+    const char * pcEnd;     /* Points just beyond the specification. */
+    BaseType_t xStarCount;  /* The number of '*' (an int each) before the value. */
+    ArgType_t eType;        /* The type of the value itself. */
+} Conversion_t;
+
+/* The fixed part of a record, followed by the argument values. */
+typedef struct xRECORD_HEADER
+{
+    uint32_t ulLength;              /* Length of the record, zero until published.  The
+                                     * record occupies ulLength rounded up to
+                                     * dlRECORD_ALIGNMENT in the ring buffer. */
+    TickType_t xTimeStamp;          /* Tick count when the message was logged. */
+    const char * pcPrefixFormat;    /* The metadata prefix format. */
+    const char * pcFormat;          /* The message format. */
+} RecordHeader_t;
+
+/* A record as built or read back, the union aligns the header. */
+typedef union xRECORD
+{
+    RecordHeader_t xHeader;
+    uint8_t ucBytes[ dlDEFERRED_MAX_RECORD_SIZE ];
+} Record_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Parse the conversion specification that starts at pcFormat, which points to
+ * the '%'.
+ */
+static void prvParseConversion( const char * pcFormat,
+                                Conversion_t * pxConversion );
+
+/*
+ * Copy the values that pcFormat consumes from pxArgs into the record, starting
+ * at ucRecord[ xOffset ].  Returns the new offset.  Once a value does not fit,
+ * *pxLimit is lowered so that no further values are stored.
+ */
+static size_t prvStoreArguments( const char * pcFormat,
+                                 va_list * pxArgs,
+                                 uint8_t * pucRecord,
+                                 size_t xOffset,
+                                 size_t * pxLimit );
+
+/*
+ * Format pcFormat into pcTarget, taking the values from the record at
+ * *pxOffset.  Returns the new length of the string in pcTarget.  When the
+ * record was truncated, the output stops at the first missing value.
+ */
+static size_t prvFormatArguments( const char * pcFormat,
+                                  const uint8_t * pucRecord,
+                                  size_t xRecordLength,
+                                  size_t * pxOffset,
+                                  char * pcTarget,
+                                  size_t xLength );
+
+/*
+ * Format a complete record and write it out.
+ */
+static void prvOutputRecord( const uint8_t * pucRecord );
+
+/*
+ * Copy data into and out of the ring buffer, wrapping around its end.
+ */
+static void prvRingWrite( uint32_t ulIndex,
+                          const uint8_t * pucSource,
+                          size_t xLength );
+static void prvRingRead( uint32_t ulIndex,
+                         uint8_t * pucTarget,
+                         size_t xLength );
+
+/*
+ * Output and then free all records that have been published.
+ */
+static void prvFlushRecords( void );
+
+/*
+ * The low priority task that formats and writes out the records.
+ */
+static void prvLoggingTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+/* The ring buffer.  Declared as words so that every record, which starts on
+ * a 32-bit boundary, has an aligned length word. */
+static uint32_t ulRing[ dlDEFERRED_BUFFER_SIZE / sizeof( uint32_t ) ];
+
+/* Free running indexes into ulRing: ulRingHead is advanced by the tasks that
+ * reserve space, ulRingTail by the logging task when it frees a record. */
+static volatile uint32_t ulRingHead = 0U;
+static volatile uint32_t ulRingTail = 0U;
+
+/* The number of messages that did not fit in the ring buffer. */
+static volatile uint32_t ulDroppedMessages = 0U;
+
+/* The task that formats the records.  While it is NULL messages are formatted
+ * directly by the calling task. */
+static TaskHandle_t xLoggingTask = NULL;
+
+/*-----------------------------------------------------------*/
+
+void vLoggingDeferredInit( configSTACK_DEPTH_TYPE uxStackSize,
+                           UBaseType_t uxPriority )
+{
+    configASSERT( xLoggingTask == NULL );
+
+    xTaskCreate( prvLoggingTask, "Logging", uxStackSize, NULL, uxPriority, &( xLoggingTask ) );
+    configASSERT( xLoggingTask != NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingPrintfDeferred( const char * pcPrefixFormat,
+                             ... )
+{
+    Record_t xRecord;
+    RecordHeader_t * pxHeader = &( xRecord.xHeader );
+    size_t xOffset, xLimit = dlDEFERRED_MAX_RECORD_SIZE;
+    uint32_t ulSize, ulHead, ulTail;
+    BaseType_t xReserved = pdFALSE;
+    va_list xArgs;
+
+    va_start( xArgs, pcPrefixFormat );
+
+    /* The prefix arguments come first, then the message format and its
+     * arguments. */
+    pxHeader->ulLength = 0U;
+    pxHeader->xTimeStamp = xTaskGetTickCount();
+    pxHeader->pcPrefixFormat = pcPrefixFormat;
+    xOffset = prvStoreArguments( pcPrefixFormat, &( xArgs ), xRecord.ucBytes, sizeof( *pxHeader ), &( xLimit ) );
+    pxHeader->pcFormat = va_arg( xArgs, const char * );
+    xOffset = prvStoreArguments( pxHeader->pcFormat, &( xArgs ), xRecord.ucBytes, xOffset, &( xLimit ) );
+
+    va_end( xArgs );
+
+    if( ( xLoggingTask == NULL ) || ( xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED ) )
+    {
+        /* There is no task to hand the record to yet. */
+        pxHeader->ulLength = ( uint32_t ) xOffset;
+        prvOutputRecord( xRecord.ucBytes );
+    }
+    else
+    {
+        /* Reserve the space at the head of the ring buffer. */
+        ulSize = ( uint32_t ) ( ( xOffset + dlRECORD_ALIGNMENT - 1U ) & ~( dlRECORD_ALIGNMENT - 1U ) );
+
+        do
+        {
+            ulHead = ulRingHead;
+            ulTail = ulRingTail;
+
+            if( ( ulHead - ulTail ) + ulSize > ( uint32_t ) dlDEFERRED_BUFFER_SIZE )
+            {
+                ( void ) Atomic_Increment_u32( &( ulDroppedMessages ) );
+                break;
+            }
+
+            xReserved = ( Atomic_CompareAndSwap_u32( &( ulRingHead ), ulHead + ulSize, ulHead ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS ) ? pdTRUE : pdFALSE;
+        } while( xReserved == pdFALSE );
+
+        if( xReserved != pdFALSE )
+        {
+            /* Copy everything except the length word, then publish the record
+             * by setting its length. */
+            prvRingWrite( ulHead + sizeof( uint32_t ), &( xRecord.ucBytes[ sizeof( uint32_t ) ] ), xOffset - sizeof( uint32_t ) );
+            ( void ) Atomic_OR_u32( &( ulRing[ ( ulHead & ( dlDEFERRED_BUFFER_SIZE - 1U ) ) / sizeof( uint32_t ) ] ), ( uint32_t ) xOffset );
+
+            /* Wake the logging task when the ring buffer was empty, or when this
+             * record fills it past half way. */
+            if( ( ulHead == ulTail ) ||
+                ( ( ( ulHead - ulTail ) < ( dlDEFERRED_BUFFER_SIZE / 2U ) ) && ( ( ulHead - ulTail ) + ulSize >= ( dlDEFERRED_BUFFER_SIZE / 2U ) ) ) )
+            {
+                xTaskNotifyGive( xLoggingTask );
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvParseConversion( const char * pcFormat,
+                                Conversion_t * pxConversion )
+{
+    const char * pcSource = pcFormat + 1;
+    BaseType_t xLongs = 0;
+    char cLength = '\0';
+
+    pxConversion->xStarCount = 0;
+    pxConversion->eType = eArgNone;
+
+    /* Flags. */
+    while( ( *pcSource != '\0' ) && ( strchr( "-+ #0'", *pcSource ) != NULL ) )
+    {
+        pcSource++;
+    }
+
+    /* Width and precision. */
+    while( ( *pcSource != '\0' ) && ( strchr( "0123456789.*", *pcSource ) != NULL ) )
+    {
+        if( *pcSource == '*' )
+        {
+            pxConversion->xStarCount++;
+        }
+
+        pcSource++;
+    }
+
+    /* Length modifier. */
+    while( ( *pcSource != '\0' ) && ( strchr( "hlLjzt", *pcSource ) != NULL ) )
+    {
+        if( *pcSource == 'l' )
+        {
+            xLongs++;
+        }
+
+        cLength = *pcSource;
+        pcSource++;
+    }
+
+    switch( *pcSource )
+    {
+        case 'd':
+        case 'i':
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'c':
+
+            if( xLongs >= 2 )
+            {
+                pxConversion->eType = eArgLongLong;
+            }
+            else if( xLongs == 1 )
+            {
+                pxConversion->eType = eArgLong;
+            }
+            else if( cLength == 'j' )
+            {
+                pxConversion->eType = eArgIntMax;
+            }
+            else if( cLength == 'z' )
+            {
+                pxConversion->eType = eArgSize;
+            }
+            else if( cLength == 't' )
+            {
+                pxConversion->eType = eArgPtrDiff;
+            }
+            else
+            {
+                pxConversion->eType = eArgInt;
+            }
+
+            break;
+
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            pxConversion->eType = ( cLength == 'L' ) ? eArgLongDouble : eArgDouble;
+            break;
+
+        case 's':
+            pxConversion->eType = eArgString;
+            break;
+
+        case 'p':
+            pxConversion->eType = eArgPointer;
+            break;
+
+        case 'n':
+            pxConversion->eType = eArgIgnore;
+            break;
+
+        default:
+            /* "%%", or not understood.  Neither consumes a value. */
+            pxConversion->xStarCount = 0;
+            break;
+    }
+
+    if( *pcSource != '\0' )
+    {
+        pcSource++;
+    }
+
+    pxConversion->pcEnd = pcSource;
+}
+/*-----------------------------------------------------------*/
+
+/* Store one value of type 'type', if it fits in the record. */
+#define dlSTORE_VALUE( type, value )                                               \
+    do {                                                                           \
+        type xValue = ( value );                                                   \
+        if( xOffset + sizeof( xValue ) <= *pxLimit )                               \
+        {                                                                          \
+            memcpy( &( pucRecord[ xOffset ] ), &( xValue ), sizeof( xValue ) );    \
+            xOffset += sizeof( xValue );                                           \
+        }                                                                          \
+        else                                                                       \
+        {                                                                          \
+            *pxLimit = xOffset;                                                    \
+        }                                                                          \
+    } while( 0 )
+
+static size_t prvStoreArguments( const char * pcFormat,
+                                 va_list * pxArgs,
+                                 uint8_t * pucRecord,
+                                 size_t xOffset,
+                                 size_t * pxLimit )
+{
+    Conversion_t xConversion;
+    BaseType_t xStar;
+    const char * pcString;
+    const char * pcEnd;
+    size_t xLength;
+
+    while( ( pcFormat = strchr( pcFormat, '%' ) ) != NULL )
+    {
+        prvParseConversion( pcFormat, &( xConversion ) );
+        pcFormat = xConversion.pcEnd;
+
+        /* The values must be consumed from the va_list even when they no
+         * longer fit, to keep the list in step with the format. */
+        for( xStar = 0; xStar < xConversion.xStarCount; xStar++ )
+        {
+            dlSTORE_VALUE( int, va_arg( *pxArgs, int ) );
+        }
+
+        switch( xConversion.eType )
+        {
+            case eArgInt:
+                dlSTORE_VALUE( int, va_arg( *pxArgs, int ) );
+                break;
+
+            case eArgLong:
+                dlSTORE_VALUE( long, va_arg( *pxArgs, long ) );
+                break;
+
+            case eArgLongLong:
+                dlSTORE_VALUE( long long, va_arg( *pxArgs, long long ) );
+                break;
+
+            case eArgIntMax:
+                dlSTORE_VALUE( intmax_t, va_arg( *pxArgs, intmax_t ) );
+                break;
+
+            case eArgSize:
+                dlSTORE_VALUE( size_t, va_arg( *pxArgs, size_t ) );
+                break;
+
+            case eArgPtrDiff:
+                dlSTORE_VALUE( ptrdiff_t, va_arg( *pxArgs, ptrdiff_t ) );
+                break;
+
+            case eArgDouble:
+                dlSTORE_VALUE( double, va_arg( *pxArgs, double ) );
+                break;
+
+            case eArgLongDouble:
+                dlSTORE_VALUE( long double, va_arg( *pxArgs, long double ) );
+                break;
+
+            case eArgPointer:
+                dlSTORE_VALUE( void *, va_arg( *pxArgs, void * ) );
+                break;
+
+            case eArgIgnore:
+                ( void ) va_arg( *pxArgs, void * );
+                break;
+
+            case eArgString:
+                pcString = va_arg( *pxArgs, const char * );
+
+                if( pcString == NULL )
+                {
+                    pcString = "(null)";
+                }
+
+                /* Copied with its terminator, truncated to what fits. */
+                if( xOffset < *pxLimit )
+                {
+                    xLength = *pxLimit - xOffset - 1U;
+                    pcEnd = memchr( pcString, '\0', xLength );
+
+                    if( pcEnd != NULL )
+                    {
+                        xLength = ( size_t ) ( pcEnd - pcString );
+                    }
+
+                    memcpy( &( pucRecord[ xOffset ] ), pcString, xLength );
+                    pucRecord[ xOffset + xLength ] = '\0';
+                    xOffset += xLength + 1U;
+                }
+
+                break;
+
+            case eArgNone:
+            default:
+                break;
+        }
+    }
+
+    return xOffset;
+}
+/*-----------------------------------------------------------*/
+
+/* Load one value of type 'type', if the record holds it. */
+#define dlLOAD_VALUE( type, target )                                                  \
+    do {                                                                              \
+        if( *pxOffset + sizeof( type ) <= xRecordLength )                             \
+        {                                                                             \
+            memcpy( &( target ), &( pucRecord[ *pxOffset ] ), sizeof( type ) );       \
+            *pxOffset += sizeof( type );                                              \
+        }                                                                             \
+        else                                                                          \
+        {                                                                             \
+            xComplete = pdFALSE;                                                      \
+        }                                                                             \
+    } while( 0 )
+
+static size_t prvFormatArguments( const char * pcFormat,
+                                  const uint8_t * pucRecord,
+                                  size_t xRecordLength,
+                                  size_t * pxOffset,
+                                  char * pcTarget,
+                                  size_t xLength )
+{
+    Conversion_t xConversion;
+    const char * pcPercent;
+    const char * pcSource;
+    char cSpecification[ 32 ];
+    size_t xSpecLength;
+    BaseType_t xComplete = pdTRUE;
+    int iStar, iWritten = 0;
+
+    union
+    {
+        int iValue;
+        long lValue;
+        long long llValue;
+        intmax_t xIntMax;
+        size_t xSize;
+        ptrdiff_t xPtrDiff;
+        double dValue;
+        long double ldValue;
+        void * pvValue;
+        const char * pcString;
+    } xValue;
+
+    while( ( xLength < dlMAX_PRINT_STRING_LENGTH ) && ( *pcFormat != '\0' ) && ( xComplete != pdFALSE ) )
+    {
+        /* Copy the text up to the next conversion. */
+        pcPercent = strchr( pcFormat, '%' );
+
+        if( pcPercent == NULL )
+        {
+            pcPercent = pcFormat + strlen( pcFormat );
+        }
+
+        while( ( pcFormat < pcPercent ) && ( xLength < dlMAX_PRINT_STRING_LENGTH ) )
+        {
+            pcTarget[ xLength++ ] = *( pcFormat++ );
+        }
+
+        if( ( *pcFormat != '%' ) || ( xLength >= dlMAX_PRINT_STRING_LENGTH ) )
+        {
+            break;
+        }
+
+        prvParseConversion( pcFormat, &( xConversion ) );
+
+        /* Copy the specification, replacing every '*' with the stored value,
+         * so it can be passed to snprintf() with the value alone. */
+        xSpecLength = 0U;
+
+        for( pcSource = pcFormat; pcSource < xConversion.pcEnd; pcSource++ )
+        {
+            if( ( *pcSource == '*' ) && ( xConversion.eType != eArgNone ) )
+            {
+                iStar = 0;
+                dlLOAD_VALUE( int, iStar );
+
+                if( ( iStar < 0 ) && ( xSpecLength > 0U ) && ( cSpecification[ xSpecLength - 1U ] == '.' ) )
+                {
+                    /* A negative precision is taken as if it were omitted. */
+                    xSpecLength--;
+                }
+                else
+                {
+                    xSpecLength += ( size_t ) snprintf( &( cSpecification[ xSpecLength ] ), sizeof( cSpecification ) - xSpecLength, "%d", iStar );
+                }
+            }
+            else
+            {
+                cSpecification[ xSpecLength++ ] = *pcSource;
+            }
+
+            if( xSpecLength >= sizeof( cSpecification ) - 1U )
+            {
+                /* Far longer than any sensible specification. */
+                xComplete = pdFALSE;
+                break;
+            }
+        }
+
+        cSpecification[ xSpecLength ] = '\0';
+        pcFormat = xConversion.pcEnd;
+
+        switch( xConversion.eType )
+        {
+            case eArgInt:
+                dlLOAD_VALUE( int, xValue.iValue );
+                break;
+
+            case eArgLong:
+                dlLOAD_VALUE( long, xValue.lValue );
+                break;
+
+            case eArgLongLong:
+                dlLOAD_VALUE( long long, xValue.llValue );
+                break;
+
+            case eArgIntMax:
+                dlLOAD_VALUE( intmax_t, xValue.xIntMax );
+                break;
+
+            case eArgSize:
+                dlLOAD_VALUE( size_t, xValue.xSize );
+                break;
+
+            case eArgPtrDiff:
+                dlLOAD_VALUE( ptrdiff_t, xValue.xPtrDiff );
+                break;
+
+            case eArgDouble:
+                dlLOAD_VALUE( double, xValue.dValue );
+                break;
+
+            case eArgLongDouble:
+                dlLOAD_VALUE( long double, xValue.ldValue );
+                break;
+
+            case eArgPointer:
+                dlLOAD_VALUE( void *, xValue.pvValue );
+                break;
+
+            case eArgString:
+
+                if( *pxOffset < xRecordLength )
+                {
+                    xValue.pcString = ( const char * ) &( pucRecord[ *pxOffset ] );
+                    *pxOffset += strlen( xValue.pcString ) + 1U;
+                }
+                else
+                {
+                    xComplete = pdFALSE;
+                }
+
+                break;
+
+            case eArgIgnore:
+            case eArgNone:
+            default:
+                break;
+        }
+
+        if( xComplete == pdFALSE )
+        {
+            break;
+        }
+
+        switch( xConversion.eType )
+        {
+            case eArgInt:
+                iWritten = snprintf( &( pcTarget[ xLength ] ), dlMAX_PRINT_STRING_LENGTH + 1U - xLength, cSpecification, xValue.iValue );
+                break;
+
+            case eArgLong:
+                iWritten = snprintf( &( pcTarget[ xLength ] ), dlMAX_PRINT_STRING_LENGTH + 1U - xLength, cSpecification, xValue.lValue );
+                break;
+
+            case eArgLongLong:
+                iWritten = snprintf( &( pcTarget[ xLength ] ), dlMAX_PRINT_STRING_LENGTH + 1U - xLength, cSpecification, xValue.llValue );
+                break;
+
+            case eArgIntMax:
+                iWritten = snprintf( &( pcTarget[ xLength ] ), dlMAX_PRINT_STRING_LENGTH + 1U - xLength, cSpecification, xValue.xIntMax );
+                break;
+
+            case eArgSize:
+                iWritten = snprintf( &( pcTarget[ xLength ] ), dlMAX_PRINT_STRING_LENGTH + 1U - xLength, cSpecification, xValue.xSize );
+                break;
+
+            case eArgPtrDiff:
+                iWritten = snprintf( &( pcTarget[ xLength ] ), dlMAX_PRINT_STRING_LENGTH + 1U - xLength, cSpecification, xValue.xPtrDiff );
+                break;
+
+            case eArgDouble:
+                iWritten = snprintf( &( pcTarget[ xLength ] ), dlMAX_PRINT_STRING_LENGTH + 1U - xLength, cSpecification, xValue.dValue );
+                break;
+
+            case eArgLongDouble:
+                iWritten = snprintf( &( pcTarget[ xLength ] ), dlMAX_PRINT_STRING_LENGTH + 1U - xLength, cSpecification, xValue.ldValue );
+                break;
+
+            case eArgString:
+                iWritten = snprintf( &( pcTarget[ xLength ] ), dlMAX_PRINT_STRING_LENGTH + 1U - xLength, cSpecification, xValue.pcString );
+                break;
+
+            case eArgPointer:
+                iWritten = snprintf( &( pcTarget[ xLength ] ), dlMAX_PRINT_STRING_LENGTH + 1U - xLength, cSpecification, xValue.pvValue );
+                break;
+
+            case eArgIgnore:
+                iWritten = 0;
+                break;
+
+            case eArgNone:
+            default:
+                /* "%%" prints a '%', anything else is printed as it is. */
+                if( strcmp( cSpecification, "%%" ) == 0 )
+                {
+                    cSpecification[ 1 ] = '\0';
+                }
+
+                iWritten = snprintf( &( pcTarget[ xLength ] ), dlMAX_PRINT_STRING_LENGTH + 1U - xLength, "%s", cSpecification );
+                break;
+        }
+
+        if( iWritten > 0 )
+        {
+            xLength += ( size_t ) iWritten;
+
+            if( xLength > dlMAX_PRINT_STRING_LENGTH )
+            {
+                xLength = dlMAX_PRINT_STRING_LENGTH;
+            }
+        }
+    }
+
+    if( xComplete == pdFALSE )
+    {
+        /* Values are missing, so later formats of this record have none either. */
+        *pxOffset = xRecordLength;
+    }
+
+    pcTarget[ xLength ] = '\0';
+
+    return xLength;
+}
+/*-----------------------------------------------------------*/
+
+static void prvOutputRecord( const uint8_t * pucRecord )
+{
+    char cPrintString[ dlMAX_PRINT_STRING_LENGTH + 3 ];
+    const RecordHeader_t * pxHeader = ( const RecordHeader_t * ) pucRecord;
+    size_t xLength, xOffset = sizeof( *pxHeader );
+    uint32_t ulDropped;
+
+    /* Report lost messages first, so they are seen in sequence. */
+    ulDropped = ulDroppedMessages;
+
+    if( ulDropped != 0U )
+    {
+        ( void ) Atomic_Subtract_u32( &( ulDroppedMessages ), ulDropped );
+        xLength = ( size_t ) snprintf( cPrintString, sizeof( cPrintString ), "[WARN] %lu log messages dropped\r\n", ( unsigned long ) ulDropped );
+        dlDEFERRED_OUTPUT( cPrintString, xLength );
+    }
+
+    xLength = ( size_t ) snprintf( cPrintString, dlMAX_PRINT_STRING_LENGTH + 1U, "%lu ", ( unsigned long ) pxHeader->xTimeStamp );
+    xLength = prvFormatArguments( pxHeader->pcPrefixFormat, pucRecord, pxHeader->ulLength, &( xOffset ), cPrintString, xLength );
+    xLength = prvFormatArguments( pxHeader->pcFormat, pucRecord, pxHeader->ulLength, &( xOffset ), cPrintString, xLength );
+
+    /* Room for the line ending was left when cPrintString was dimensioned. */
+    cPrintString[ xLength++ ] = '\r';
+    cPrintString[ xLength++ ] = '\n';
+
+    dlDEFERRED_OUTPUT( cPrintString, xLength );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRingWrite( uint32_t ulIndex,
+                          const uint8_t * pucSource,
+                          size_t xLength )
+{
+    uint8_t * pucRing = ( uint8_t * ) ulRing;
+    size_t xOffset = ( size_t ) ( ulIndex & ( dlDEFERRED_BUFFER_SIZE - 1U ) );
+    size_t xFirst = dlDEFERRED_BUFFER_SIZE - xOffset;
+
+    if( xFirst > xLength )
+    {
+        xFirst = xLength;
+    }
+
+    memcpy( &( pucRing[ xOffset ] ), pucSource, xFirst );
+    memcpy( pucRing, &( pucSource[ xFirst ] ), xLength - xFirst );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRingRead( uint32_t ulIndex,
+                         uint8_t * pucTarget,
+                         size_t xLength )
+{
+    uint8_t * pucRing = ( uint8_t * ) ulRing;
+    size_t xOffset = ( size_t ) ( ulIndex & ( dlDEFERRED_BUFFER_SIZE - 1U ) );
+    size_t xFirst = dlDEFERRED_BUFFER_SIZE - xOffset;
+
+    if( xFirst > xLength )
+    {
+        xFirst = xLength;
+    }
+
+    memcpy( pucTarget, &( pucRing[ xOffset ] ), xFirst );
+    memcpy( &( pucTarget[ xFirst ] ), pucRing, xLength - xFirst );
+
+    /* Clear the space again, the length words of later records must read as
+     * zero until those records are published. */
+    memset( &( pucRing[ xOffset ] ), 0, xFirst );
+    memset( pucRing, 0, xLength - xFirst );
+}
+/*-----------------------------------------------------------*/
+
+static void prvFlushRecords( void )
+{
+    Record_t xRecord;
+    const volatile uint32_t * pulLength;
+    uint32_t ulLength, ulSize;
+
+    while( ulRingTail != ulRingHead )
+    {
+        pulLength = &( ulRing[ ( ulRingTail & ( dlDEFERRED_BUFFER_SIZE - 1U ) ) / sizeof( uint32_t ) ] );
+        ulLength = *pulLength;
+
+        if( ulLength == 0U )
+        {
+            /* Reserved, but the task that logs it has not published it yet. */
+            break;
+        }
+
+        ulSize = ( ulLength + dlRECORD_ALIGNMENT - 1U ) & ~( dlRECORD_ALIGNMENT - 1U );
+        configASSERT( ulSize <= sizeof( xRecord ) );
+
+        prvRingRead( ulRingTail, xRecord.ucBytes, ulSize );
+
+        /* The space is cleared, hand it back to the logging tasks. */
+        ( void ) Atomic_Add_u32( &( ulRingTail ), ulSize );
+
+        prvOutputRecord( xRecord.ucBytes );
+    }
+
+    dlDEFERRED_FLUSH();
+}
+/*-----------------------------------------------------------*/
+
+static void prvLoggingTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, dlDEFERRED_POLL_TIME );
+        prvFlushRecords();
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,298 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Run time log levels for the LogError(), LogWarn(), LogInfo() and LogDebug()
+ * macros of logging_stack.h, used when LOGGING_RUNTIME_LEVELS is 1.
+ *
+ * Every translation unit that includes logging_stack.h has its own
+ * LoggingModule_t.  The first time it logs, the module is added to a list here
+ * and given a small ID, which the log messages carry instead of a function or
+ * file name.  After that a disabled message costs a single comparison of the
+ * module's level.  The list is only walked when levels are changed or listed,
+ * for example by the log-level command of Sample-CLI-commands.c.
+ *
+ * A level set by name before any module of that name has logged is kept in a
+ * small table of pending levels, and applied when such a module registers.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Logging includes. */
+#include "logging_levels.h"
+#include "logging.h"
+
+/*-----------------------------------------------------------*/
+
+/* The number of levels set by name that are remembered for modules that have
+ * not registered yet. */
+#ifndef llPENDING_LEVELS
+    #define llPENDING_LEVELS    4U
+#endif
+
+/* The longest name, including its terminator, that can be remembered. */
+#ifndef llPENDING_NAME_LENGTH
+    #define llPENDING_NAME_LENGTH    32U
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* A level set by name, an empty name marks a free entry. */
+typedef struct xPENDING_LEVEL
+{
+    char cName[ llPENDING_NAME_LENGTH ];
+    uint8_t ucLevel;
+} PendingLevel_t;
+
+/*-----------------------------------------------------------*/
+
+/* The names of the levels, indexed by level. */
+static const char * const pcLevelNames[] = { "none", "error", "warn", "info", "debug" };
+
+/* The registered modules, the most recently registered first. */
+static LoggingModule_t * pxModuleList = NULL;
+
+/* The number of registered modules, which is also the last ID handed out. */
+static uint16_t usModuleCount = 0U;
+
+/* The level last set for "all", or LOG_LEVEL_UNREGISTERED if none was set. */
+static uint8_t ucAllLevel = LOG_LEVEL_UNREGISTERED;
+
+/* The levels last set by name, cleared when the level of "all" is set. */
+static PendingLevel_t xPendingLevels[ llPENDING_LEVELS ];
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Return pcFile without its directories.
+ */
+static const char * prvBaseName( const char * pcFile );
+
+/*
+ * Remember ucLevel for modules named pcName that register later.  Must be
+ * called from a critical section.
+ */
+static void prvSetPendingLevel( const char * pcName,
+                                uint8_t ucLevel );
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xLoggingRegisterModule( LoggingModule_t * pxModule,
+                                   const char * pcFile,
+                                   uint8_t ucLevel )
+{
+    LoggingModule_t * pxOther;
+    uint8_t ucStartLevel;
+    UBaseType_t uxIndex;
+
+    taskENTER_CRITICAL();
+    {
+        /* Another task may have registered the module in the meantime. */
+        if( pxModule->ucLevel == LOG_LEVEL_UNREGISTERED )
+        {
+            ucStartLevel = ( ucAllLevel != LOG_LEVEL_UNREGISTERED ) ? ucAllLevel : pxModule->ucDefaultLevel;
+
+            for( pxOther = pxModuleList; pxOther != NULL; pxOther = pxOther->pxNext )
+            {
+                if( strcmp( pxOther->pcName, pxModule->pcName ) == 0 )
+                {
+                    ucStartLevel = pxOther->ucLevel;
+                    break;
+                }
+            }
+
+            /* A level set by name takes precedence, it is newer than the level
+             * of "all" as setting "all" clears the table. */
+            for( uxIndex = 0U; uxIndex < llPENDING_LEVELS; uxIndex++ )
+            {
+                if( ( xPendingLevels[ uxIndex ].cName[ 0 ] != '\0' ) &&
+                    ( ( strcmp( xPendingLevels[ uxIndex ].cName, pxModule->pcName ) == 0 ) ||
+                      ( strcmp( xPendingLevels[ uxIndex ].cName, prvBaseName( pcFile ) ) == 0 ) ) )
+                {
+                    ucStartLevel = xPendingLevels[ uxIndex ].ucLevel;
+                }
+            }
+
+            usModuleCount++;
+            pxModule->usId = usModuleCount;
+            pxModule->pcFile = pcFile;
+            pxModule->pxNext = pxModuleList;
+            pxModuleList = pxModule;
+
+            /* Written last, the logging macros read it without the critical
+             * section. */
+            pxModule->ucLevel = ucStartLevel;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return ( pxModule->ucLevel >= ucLevel ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxLoggingSetLevel( const char * pcName,
+                               uint8_t ucLevel )
+{
+    LoggingModule_t * pxModule;
+    UBaseType_t uxCount = 0U;
+    BaseType_t xAll = ( strcmp( pcName, "all" ) == 0 ) ? pdTRUE : pdFALSE;
+
+    configASSERT( ucLevel <= LOG_DEBUG );
+
+    taskENTER_CRITICAL();
+    {
+        if( xAll != pdFALSE )
+        {
+            ucAllLevel = ucLevel;
+            memset( xPendingLevels, 0, sizeof( xPendingLevels ) );
+        }
+        else
+        {
+            prvSetPendingLevel( pcName, ucLevel );
+        }
+
+        for( pxModule = pxModuleList; pxModule != NULL; pxModule = pxModule->pxNext )
+        {
+            if( ( xAll != pdFALSE ) ||
+                ( strcmp( pxModule->pcName, pcName ) == 0 ) ||
+                ( strcmp( prvBaseName( pxModule->pcFile ), pcName ) == 0 ) )
+            {
+                pxModule->ucLevel = ucLevel;
+                uxCount++;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return uxCount;
+}
+/*-----------------------------------------------------------*/
+
+const LoggingModule_t * pxLoggingGetModule( UBaseType_t uxIndex )
+{
+    LoggingModule_t * pxModule;
+
+    /* Modules are never removed, so the list can be walked without a critical
+     * section.  New ones are added at the front, which would only shift the
+     * index of an ongoing listing by one. */
+    for( pxModule = pxModuleList; ( pxModule != NULL ) && ( uxIndex > 0U ); pxModule = pxModule->pxNext )
+    {
+        uxIndex--;
+    }
+
+    return pxModule;
+}
+/*-----------------------------------------------------------*/
+
+const char * pcLoggingLevelName( uint8_t ucLevel )
+{
+    const char * pcName = "?";
+
+    if( ucLevel < ( sizeof( pcLevelNames ) / sizeof( pcLevelNames[ 0 ] ) ) )
+    {
+        pcName = pcLevelNames[ ucLevel ];
+    }
+
+    return pcName;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xLoggingParseLevel( const char * pcName,
+                               size_t xLength,
+                               uint8_t * pucLevel )
+{
+    uint8_t ucLevel;
+    BaseType_t xReturn = pdFALSE;
+
+    for( ucLevel = 0U; ucLevel < ( sizeof( pcLevelNames ) / sizeof( pcLevelNames[ 0 ] ) ); ucLevel++ )
+    {
+        if( ( strlen( pcLevelNames[ ucLevel ] ) == xLength ) && ( strncmp( pcLevelNames[ ucLevel ], pcName, xLength ) == 0 ) )
+        {
+            *pucLevel = ucLevel;
+            xReturn = pdTRUE;
+            break;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static const char * prvBaseName( const char * pcFile )
+{
+    const char * pcBase = pcFile;
+
+    for( ; *pcFile != '\0'; pcFile++ )
+    {
+        if( ( *pcFile == '/' ) || ( *pcFile == '\\' ) )
+        {
+            pcBase = pcFile + 1;
+        }
+    }
+
+    return pcBase;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetPendingLevel( const char * pcName,
+                                uint8_t ucLevel )
+{
+    PendingLevel_t * pxEntry = NULL;
+    UBaseType_t uxIndex;
+
+    if( strlen( pcName ) < llPENDING_NAME_LENGTH )
+    {
+        /* Update the entry of the name, else take a free one. */
+        for( uxIndex = 0U; uxIndex < llPENDING_LEVELS; uxIndex++ )
+        {
+            if( strcmp( xPendingLevels[ uxIndex ].cName, pcName ) == 0 )
+            {
+                pxEntry = &( xPendingLevels[ uxIndex ] );
+                break;
+            }
+
+            if( ( pxEntry == NULL ) && ( xPendingLevels[ uxIndex ].cName[ 0 ] == '\0' ) )
+            {
+                pxEntry = &( xPendingLevels[ uxIndex ] );
+            }
+        }
+
+        /* When the table is full the level only reaches the modules that are
+         * already registered. */
+        if( pxEntry != NULL )
+        {
+            ( void ) strcpy( pxEntry->cName, pcName );
+            pxEntry->ucLevel = ucLevel;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
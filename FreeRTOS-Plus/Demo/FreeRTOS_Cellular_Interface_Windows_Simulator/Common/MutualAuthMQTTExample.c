@@ -46,6 +46,12 @@
  * state or call the MQTT_ProcessLoop() API function. Using an agent task
  * also enables multiple application tasks to more easily share a single
  * MQTT connection.
+ *
+ * At the end of every iteration the demo logs how many Cellular_SocketRecv()
+ * AT commands the cellular TCP sockets wrapper issued during the iteration,
+ * and how many of them were needed per KB received. Rebuild with
+ * CELLULAR_SOCKET_RECV_BUFFER_SIZE defined to 0 in cellular_config.h to compare
+ * against a wrapper that passes every TLS read to the modem.
  */
 
 /* Standard includes. */
@@ -68,6 +74,9 @@
 /* Transport interface implementation include header for TLS. */
 #include "transport_mbedtls.h"
 
+/* Cellular port of the TCP sockets wrapper, for its receive statistics. */
+#include "cellular_sockets_wrapper.h"
+
 /*-----------------------------------------------------------*/
 
 /* Compile time error for undefined configs. */
@@ -294,6 +303,15 @@ struct NetworkContext
  */
 static void prvMQTTDemoTask( void * pvParameters );
 
+/**
+ * @brief Log the number of AT commands used to receive data since the given
+ * statistics were taken, and the number of commands per KB received.
+ *
+ * @param[in] ulRecvCommandsStart Receive commands at the start of the measurement.
+ * @param[in] ulRecvBytesStart Received bytes at the start of the measurement.
+ */
+static void prvLogCellularRecvStatistics( uint32_t ulRecvCommandsStart,
+                                          uint32_t ulRecvBytesStart );
 
 /**
  * @brief Connect to MQTT broker with reconnection retries.
@@ -525,6 +543,7 @@ static void prvMQTTDemoTask( void * pvParameters )
     MQTTContext_t xMQTTContext = { 0 };
     MQTTStatus_t xMQTTStatus;
     TlsTransportStatus_t xNetworkStatus;
+    uint32_t ulRecvCommandsStart = 0U, ulRecvBytesStart = 0U;
 
     /* Remove compiler warnings about unused parameters. */
     ( void ) pvParameters;
@@ -541,6 +560,8 @@ static void prvMQTTDemoTask( void * pvParameters )
     for( ; ; )
     {
         LogInfo( ( "---------STARTING DEMO---------\r\n" ) );
+        TCP_Sockets_CellularGetRecvStatistics( &ulRecvCommandsStart, &ulRecvBytesStart );
+
         /****************************** Connect. ******************************/
 
         /* Attempt to establish TLS session with MQTT broker. If connection fails,
@@ -606,6 +627,8 @@ static void prvMQTTDemoTask( void * pvParameters )
         /* Close the network connection.  */
         TLS_FreeRTOS_Disconnect( &xNetworkContext );
 
+        prvLogCellularRecvStatistics( ulRecvCommandsStart, ulRecvBytesStart );
+
         /* Reset SUBACK status for each topic filter after completion of
          * subscription request cycle. */
         for( ulTopicCount = 0; ulTopicCount < mqttexampleTOPIC_COUNT; ulTopicCount++ )
@@ -754,7 +777,7 @@ static void prvCreateMQTTConnectionWithBroker( MQTTContext_t * pxMQTTContext,
     xTransport.pNetworkContext = pxNetworkContext;
     xTransport.send = TLS_FreeRTOS_send;
     xTransport.recv = TLS_FreeRTOS_recv;
-    xTransport.writev = NULL;
+    xTransport.writev = TLS_FreeRTOS_writev;
 
     /* Initialize MQTT library. */
     xResult = MQTT_Init( pxMQTTContext, &xTransport, prvGetTimeMs, prvEventCallback, &xBuffer );
@@ -1111,6 +1134,27 @@ static void prvEventCallback( MQTTContext_t * pxMQTTContext,
 
 /*-----------------------------------------------------------*/
 
+static void prvLogCellularRecvStatistics( uint32_t ulRecvCommandsStart,
+                                          uint32_t ulRecvBytesStart )
+{
+    uint32_t ulRecvCommands = 0U, ulRecvBytes = 0U;
+
+    TCP_Sockets_CellularGetRecvStatistics( &ulRecvCommands, &ulRecvBytes );
+
+    ulRecvCommands -= ulRecvCommandsStart;
+    ulRecvBytes -= ulRecvBytesStart;
+
+    /* Commands that returned no data are included, as they cost an AT
+     * round trip too. */
+    LogInfo( ( "Cellular receive: %u AT commands for %u bytes, %u.%02u commands per KB.\r\n",
+               ( unsigned int ) ulRecvCommands,
+               ( unsigned int ) ulRecvBytes,
+               ( ulRecvBytes > 0U ) ? ( unsigned int ) ( ( ( uint64_t ) ulRecvCommands * 1024U ) / ulRecvBytes ) : 0U,
+               ( ulRecvBytes > 0U ) ? ( unsigned int ) ( ( ( ( uint64_t ) ulRecvCommands * 102400U ) / ulRecvBytes ) % 100U ) : 0U ) );
+}
+
+/*-----------------------------------------------------------*/
+
 static uint32_t prvGetTimeMs( void )
 {
     TickType_t xTickCount = 0;
@@ -0,0 +1,494 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Measures the data transfer throughput of an FTP server over the FreeRTOS+TCP
+ * stack, for instance the FreeRTOS+TCP FTP server of
+ * FreeRTOS-Plus/Demo/Common/Demo_IP_Protocols running on a target, or an FTP
+ * server on the host.  The benchmark task logs in, then benchFTP_RUNS times:
+ *
+ * - STOR:  Uploads benchFTP_FILE_SIZE bytes in passive mode, and prints the MB/s
+ *          from the STOR command until the "226" reply.
+ * - RETR:  Downloads the same file, checks its length and contents, and prints
+ *          the MB/s from the RETR command until the "226" reply.
+ *
+ * The file is deleted and the program exits once all runs are done.  See
+ * README.txt for how to build the benchmark.
+ *
+ * As with the other demos on the Linux port, the figures are only meaningful
+ * when compared with each other, on the same host.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+/* Demo includes. */
+#include "FtpBenchmark.h"
+
+/* The address of the FTP server, by default the echo server address. */
+#ifndef benchFTP_SERVER_ADDR0
+    #define benchFTP_SERVER_ADDR0    configECHO_SERVER_ADDR0
+    #define benchFTP_SERVER_ADDR1    configECHO_SERVER_ADDR1
+    #define benchFTP_SERVER_ADDR2    configECHO_SERVER_ADDR2
+    #define benchFTP_SERVER_ADDR3    configECHO_SERVER_ADDR3
+#endif
+
+#ifndef benchFTP_PORT
+    #define benchFTP_PORT            ( 21U )
+#endif
+
+#ifndef benchFTP_USER
+    #define benchFTP_USER            "anonymous"
+#endif
+
+#ifndef benchFTP_PASSWORD
+    #define benchFTP_PASSWORD        "bench@"
+#endif
+
+/* The file that is stored, read back and deleted. */
+#define benchFTP_FILE_NAME           "ftpbench.bin"
+
+/* The size of the file, and the number of times it is transferred. */
+#define benchFTP_FILE_SIZE           ( 4U * 1024U * 1024U )
+#define benchFTP_RUNS                ( 3U )
+
+/* The size of the blocks sent and received by the benchmark. */
+#define benchBLOCK_SIZE              ( 8192U )
+
+/* The time after which a silent server is assumed to be gone. */
+#define benchTIMEOUT_MS              ( 5000U )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The task described at the top of this file.
+ */
+static void prvFtpBenchmarkTask( void * pvParameters );
+
+/*
+ * Connects a TCP socket to the FTP server on port usPort.  Returns the socket,
+ * or FREERTOS_INVALID_SOCKET on failure.
+ */
+static Socket_t prvConnect( uint16_t usPort );
+
+/*
+ * Sends the command pcCommand, if not NULL, and returns the code of the reply,
+ * or -1 when no reply was received.
+ */
+static BaseType_t prvCommand( Socket_t xControl,
+                              const char * pcCommand );
+
+/*
+ * Sends "PASV" and connects to the data port of the reply.
+ */
+static Socket_t prvOpenDataConnection( Socket_t xControl );
+
+/*
+ * Shuts down a data connection and waits until the server has closed it too.
+ */
+static void prvCloseDataConnection( Socket_t xData );
+
+/*
+ * Uploads or downloads the file, returns the elapsed time in microseconds or a
+ * negative value on failure.
+ */
+static double prvStore( Socket_t xControl );
+static double prvRetrieve( Socket_t xControl );
+
+/*
+ * Returns the time elapsed since pxStart in microseconds.
+ */
+static double prvElapsedUs( const struct timespec * pxStart );
+
+/*-----------------------------------------------------------*/
+
+/* The last reply received on the control connection. */
+static char cReply[ 512 ];
+
+static uint8_t ucTxBuffer[ benchBLOCK_SIZE ];
+static uint8_t ucRxBuffer[ benchBLOCK_SIZE ];
+
+/*-----------------------------------------------------------*/
+
+void vStartFtpBenchmarkTask( configSTACK_DEPTH_TYPE uxTaskStackSize,
+                             UBaseType_t uxTaskPriority )
+{
+    xTaskCreate( prvFtpBenchmarkTask, "FtpBench", uxTaskStackSize, NULL, uxTaskPriority, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvFtpBenchmarkTask( void * pvParameters )
+{
+    Socket_t xControl;
+    double dElapsedUs;
+    uint32_t ul;
+    size_t x;
+
+    ( void ) pvParameters;
+
+    /* The pattern repeats every 251 bytes, so that a block that is stored at
+     * the wrong offset does not go unnoticed. */
+    for( x = 0; x < sizeof( ucTxBuffer ); x++ )
+    {
+        ucTxBuffer[ x ] = ( uint8_t ) ( x % 251U );
+    }
+
+    xControl = prvConnect( benchFTP_PORT );
+
+    if( ( xControl == FREERTOS_INVALID_SOCKET ) || ( prvCommand( xControl, NULL ) != 220 ) )
+    {
+        printf( "Failed to connect to the FTP server %d.%d.%d.%d:%u\n",
+                benchFTP_SERVER_ADDR0, benchFTP_SERVER_ADDR1, benchFTP_SERVER_ADDR2, benchFTP_SERVER_ADDR3,
+                ( unsigned ) benchFTP_PORT );
+        exit( 1 );
+    }
+
+    if( ( prvCommand( xControl, "USER " benchFTP_USER ) == 331 ) &&
+        ( prvCommand( xControl, "PASS " benchFTP_PASSWORD ) != 230 ) )
+    {
+        printf( "Login failed: %s", cReply );
+        exit( 1 );
+    }
+
+    if( prvCommand( xControl, "TYPE I" ) != 200 )
+    {
+        printf( "TYPE I failed: %s", cReply );
+        exit( 1 );
+    }
+
+    printf( "%-8s %-10s %s\n", "Run", "Test", "Result" );
+
+    for( ul = 0; ul < benchFTP_RUNS; ul++ )
+    {
+        dElapsedUs = prvStore( xControl );
+
+        if( dElapsedUs > 0.0 )
+        {
+            /* Bytes per microsecond are MB per second. */
+            printf( "%-8u %-10s %.2f MB/s\n", ( unsigned ) ul, "STOR", ( double ) benchFTP_FILE_SIZE / dElapsedUs );
+        }
+        else
+        {
+            printf( "%-8u %-10s failed: %s", ( unsigned ) ul, "STOR", cReply );
+            break;
+        }
+
+        dElapsedUs = prvRetrieve( xControl );
+
+        if( dElapsedUs > 0.0 )
+        {
+            printf( "%-8u %-10s %.2f MB/s\n", ( unsigned ) ul, "RETR", ( double ) benchFTP_FILE_SIZE / dElapsedUs );
+        }
+        else
+        {
+            printf( "%-8u %-10s failed: %s", ( unsigned ) ul, "RETR", cReply );
+            break;
+        }
+    }
+
+    ( void ) prvCommand( xControl, "DELE " benchFTP_FILE_NAME );
+    ( void ) prvCommand( xControl, "QUIT" );
+    FreeRTOS_closesocket( xControl );
+
+    exit( 0 );
+}
+/*-----------------------------------------------------------*/
+
+static Socket_t prvConnect( uint16_t usPort )
+{
+    static const TickType_t xTimeOut = pdMS_TO_TICKS( benchTIMEOUT_MS );
+    struct freertos_sockaddr xAddress;
+    WinProperties_t xWinProps;
+    Socket_t xSocket;
+
+    memset( &xAddress, 0, sizeof( xAddress ) );
+    xAddress.sin_port = FreeRTOS_htons( usPort );
+    xAddress.sin_family = FREERTOS_AF_INET;
+
+    #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
+        {
+            xAddress.sin_address.ulIP_IPv4 = FreeRTOS_inet_addr_quick( benchFTP_SERVER_ADDR0, benchFTP_SERVER_ADDR1,
+                                                                       benchFTP_SERVER_ADDR2, benchFTP_SERVER_ADDR3 );
+        }
+    #else
+        {
+            xAddress.sin_addr = FreeRTOS_inet_addr_quick( benchFTP_SERVER_ADDR0, benchFTP_SERVER_ADDR1,
+                                                          benchFTP_SERVER_ADDR2, benchFTP_SERVER_ADDR3 );
+        }
+    #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
+
+    /* Large windows, the transfers are measured, not the defaults. */
+    xWinProps.lTxBufSize = 12 * ipconfigTCP_MSS;
+    xWinProps.lTxWinSize = 6;
+    xWinProps.lRxBufSize = 12 * ipconfigTCP_MSS;
+    xWinProps.lRxWinSize = 6;
+
+    xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+
+    if( xSocket != FREERTOS_INVALID_SOCKET )
+    {
+        FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, &xTimeOut, sizeof( xTimeOut ) );
+        FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_SNDTIMEO, &xTimeOut, sizeof( xTimeOut ) );
+        FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_WIN_PROPERTIES, ( void * ) &xWinProps, sizeof( xWinProps ) );
+
+        if( FreeRTOS_connect( xSocket, &xAddress, sizeof( xAddress ) ) != 0 )
+        {
+            FreeRTOS_closesocket( xSocket );
+            xSocket = FREERTOS_INVALID_SOCKET;
+        }
+    }
+
+    return xSocket;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCommand( Socket_t xControl,
+                              const char * pcCommand )
+{
+    char cLine[ 128 ];
+    size_t xLength = 0;
+    char * pcLine;
+    char * pcEnd;
+    BaseType_t xReturned;
+
+    if( pcCommand != NULL )
+    {
+        snprintf( cLine, sizeof( cLine ), "%s\r\n", pcCommand );
+
+        if( FreeRTOS_send( xControl, cLine, strlen( cLine ), 0 ) <= 0 )
+        {
+            cReply[ 0 ] = '\0';
+            return -1;
+        }
+    }
+
+    /* A reply may have several lines, "123-" continues, "123 " ends it. */
+    for( ; ; )
+    {
+        xReturned = FreeRTOS_recv( xControl, &( cReply[ xLength ] ), sizeof( cReply ) - 1U - xLength, 0 );
+
+        if( xReturned <= 0 )
+        {
+            cReply[ xLength ] = '\0';
+            return -1;
+        }
+
+        xLength += ( size_t ) xReturned;
+        cReply[ xLength ] = '\0';
+
+        for( pcLine = cReply; ( pcEnd = strstr( pcLine, "\r\n" ) ) != NULL; pcLine = pcEnd + 2 )
+        {
+            if( ( pcEnd - pcLine >= 4 ) && ( pcLine[ 3 ] == ' ' ) )
+            {
+                return ( BaseType_t ) strtol( pcLine, NULL, 10 );
+            }
+        }
+
+        if( xLength >= sizeof( cReply ) - 1U )
+        {
+            /* Keep the last incomplete line only. */
+            xLength = strlen( pcLine );
+            memmove( cReply, pcLine, xLength + 1U );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static Socket_t prvOpenDataConnection( Socket_t xControl )
+{
+    const char * pcNumbers;
+    unsigned int uxValues[ 6 ];
+
+    if( prvCommand( xControl, "PASV" ) != 227 )
+    {
+        return FREERTOS_INVALID_SOCKET;
+    }
+
+    /* "227 Entering Passive Mode (h1,h2,h3,h4,p1,p2)".  The address is not
+     * used, the data connection goes to the address of the control
+     * connection. */
+    pcNumbers = strchr( cReply, '(' );
+
+    if( ( pcNumbers == NULL ) ||
+        ( sscanf( pcNumbers + 1, "%u,%u,%u,%u,%u,%u", &uxValues[ 0 ], &uxValues[ 1 ], &uxValues[ 2 ],
+                  &uxValues[ 3 ], &uxValues[ 4 ], &uxValues[ 5 ] ) != 6 ) )
+    {
+        return FREERTOS_INVALID_SOCKET;
+    }
+
+    return prvConnect( ( uint16_t ) ( ( uxValues[ 4 ] << 8 ) | uxValues[ 5 ] ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCloseDataConnection( Socket_t xData )
+{
+    FreeRTOS_shutdown( xData, FREERTOS_SHUT_RDWR );
+
+    /* FreeRTOS_recv() returns a negative value once the server has closed the
+     * connection as well, or 0 after a time-out. */
+    while( FreeRTOS_recv( xData, ucRxBuffer, sizeof( ucRxBuffer ), 0 ) > 0 )
+    {
+    }
+
+    FreeRTOS_closesocket( xData );
+}
+/*-----------------------------------------------------------*/
+
+static double prvStore( Socket_t xControl )
+{
+    struct timespec xStart;
+    Socket_t xData;
+    size_t xSent = 0;
+    size_t xLength;
+    BaseType_t xReturned;
+    BaseType_t xCode;
+
+    xData = prvOpenDataConnection( xControl );
+
+    if( xData == FREERTOS_INVALID_SOCKET )
+    {
+        return -1.0;
+    }
+
+    clock_gettime( CLOCK_MONOTONIC, &xStart );
+
+    xCode = prvCommand( xControl, "STOR " benchFTP_FILE_NAME );
+
+    if( ( xCode != 125 ) && ( xCode != 150 ) )
+    {
+        FreeRTOS_closesocket( xData );
+        return -1.0;
+    }
+
+    while( xSent < benchFTP_FILE_SIZE )
+    {
+        xLength = benchFTP_FILE_SIZE - xSent;
+
+        if( xLength > sizeof( ucTxBuffer ) )
+        {
+            xLength = sizeof( ucTxBuffer );
+        }
+
+        xReturned = FreeRTOS_send( xData, ucTxBuffer, xLength, 0 );
+
+        if( xReturned <= 0 )
+        {
+            break;
+        }
+
+        xSent += ( size_t ) xReturned;
+    }
+
+    prvCloseDataConnection( xData );
+
+    if( ( xSent != benchFTP_FILE_SIZE ) || ( prvCommand( xControl, NULL ) != 226 ) )
+    {
+        return -1.0;
+    }
+
+    return prvElapsedUs( &xStart );
+}
+/*-----------------------------------------------------------*/
+
+static double prvRetrieve( Socket_t xControl )
+{
+    struct timespec xStart;
+    Socket_t xData;
+    size_t xReceived = 0;
+    size_t x;
+    BaseType_t xReturned;
+    BaseType_t xCode;
+    BaseType_t xIntact = pdTRUE;
+
+    xData = prvOpenDataConnection( xControl );
+
+    if( xData == FREERTOS_INVALID_SOCKET )
+    {
+        return -1.0;
+    }
+
+    clock_gettime( CLOCK_MONOTONIC, &xStart );
+
+    xCode = prvCommand( xControl, "RETR " benchFTP_FILE_NAME );
+
+    if( ( xCode != 125 ) && ( xCode != 150 ) )
+    {
+        FreeRTOS_closesocket( xData );
+        return -1.0;
+    }
+
+    /* Read until the server closes the data connection. */
+    for( ; ; )
+    {
+        xReturned = FreeRTOS_recv( xData, ucRxBuffer, sizeof( ucRxBuffer ), 0 );
+
+        if( xReturned <= 0 )
+        {
+            break;
+        }
+
+        for( x = 0; x < ( size_t ) xReturned; x++ )
+        {
+            if( ucRxBuffer[ x ] != ucTxBuffer[ ( xReceived + x ) % sizeof( ucTxBuffer ) ] )
+            {
+                xIntact = pdFALSE;
+            }
+        }
+
+        xReceived += ( size_t ) xReturned;
+    }
+
+    FreeRTOS_closesocket( xData );
+
+    if( ( xReceived != benchFTP_FILE_SIZE ) || ( xIntact == pdFALSE ) || ( prvCommand( xControl, NULL ) != 226 ) )
+    {
+        return -1.0;
+    }
+
+    return prvElapsedUs( &xStart );
+}
+/*-----------------------------------------------------------*/
+
+static double prvElapsedUs( const struct timespec * pxStart )
+{
+    struct timespec xEnd;
+
+    clock_gettime( CLOCK_MONOTONIC, &xEnd );
+
+    return ( ( double ) ( xEnd.tv_sec - pxStart->tv_sec ) * 1.0e6 ) + ( ( double ) ( xEnd.tv_nsec - pxStart->tv_nsec ) / 1.0e3 );
+}
+/*-----------------------------------------------------------*/
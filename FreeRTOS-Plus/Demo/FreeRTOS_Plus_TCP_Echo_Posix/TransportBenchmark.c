@@ -0,0 +1,425 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Measures the transports of FreeRTOS-Plus/Source/Application-Protocols/
+ * network_transport against an echo peer running on the host.  For each
+ * transport built in (see TransportBenchmark.h), and for each cipher suite the
+ * transport lists, the benchmark task:
+ *
+ * - Handshake:  Times benchHANDSHAKE_COUNT connects, TCP connect plus TLS
+ *               handshake if any, and prints the mean.
+ * - Bulk:       For each record size in xRecordSizes, sends benchBULK_BYTES in
+ *               records of that size and prints the payload MB/s.  Up to
+ *               benchBULK_WINDOW bytes are sent ahead of the echoed data, so
+ *               the figure is the transport throughput rather than one record
+ *               per round trip.
+ * - Latency:    Sends benchRTT_COUNT messages of benchRTT_MESSAGE_SIZE bytes,
+ *               one at a time, and prints the min, mean and max round trip.
+ *
+ * The echoed data is compared to the data sent, so a peer that does not echo
+ * is reported rather than measured.  The program exits once every transport
+ * has been measured.  See README.txt for how to build the benchmark and start
+ * the echo peers.
+ *
+ * As with the other demos on the Linux port, the figures are only meaningful
+ * when compared with each other, on the same host.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "TransportBenchmark.h"
+
+/* The number of connects timed per cipher suite. */
+#define benchHANDSHAKE_COUNT      ( 5U )
+
+/* The number of payload bytes sent per record size. */
+#define benchBULK_BYTES           ( 1024U * 1024U )
+
+/* The most bytes the bulk test sends before they are echoed, at least one
+ * record.  It must stay below what the peer and the host stack buffer, or the
+ * peer stops reading while it cannot send its echo. */
+#define benchBULK_WINDOW          ( 32U * 1024U )
+
+/* The largest record size in xRecordSizes. */
+#define benchMAX_RECORD_SIZE      ( 16384U )
+
+/* The number of round trips timed, and the size of each message. */
+#define benchRTT_COUNT            ( 100U )
+#define benchRTT_MESSAGE_SIZE     ( 32U )
+
+/* The number of consecutive zero length sends or receives, each one the
+ * transport's own timeout long, after which the peer is assumed to be gone. */
+#define benchMAX_IDLE_CALLS       ( 20U )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The task described at the top of this file.
+ */
+static void prvTransportBenchmarkTask( void * pvParameters );
+
+/*
+ * Runs every measurement on one transport and cipher suite.
+ */
+static void prvBenchmarkCipherSuite( const BenchmarkTransport_t * pxTransport,
+                                     const char * pcCipherSuite );
+
+/*
+ * Sends benchBULK_BYTES in records of xRecordSize bytes, keeping up to
+ * benchBULK_WINDOW bytes in flight, and reads the echo back.  Returns pdPASS if
+ * the same bytes came back.
+ */
+static BaseType_t prvBulk( const BenchmarkTransport_t * pxTransport,
+                           NetworkContext_t * pxNetworkContext,
+                           size_t xRecordSize );
+
+/*
+ * Sends the first xLength bytes of ucTxBuffer.  Returns pdPASS if all were
+ * sent.
+ */
+static BaseType_t prvSend( const BenchmarkTransport_t * pxTransport,
+                           NetworkContext_t * pxNetworkContext,
+                           size_t xLength );
+
+/*
+ * Sends xLength bytes of ucTxBuffer and reads them back into ucRxBuffer.
+ * Returns pdPASS if the same bytes came back.
+ */
+static BaseType_t prvEcho( const BenchmarkTransport_t * pxTransport,
+                           NetworkContext_t * pxNetworkContext,
+                           size_t xLength );
+
+/*
+ * Returns the time elapsed since pxStart in microseconds.
+ */
+static double prvElapsedUs( const struct timespec * pxStart );
+
+/*-----------------------------------------------------------*/
+
+/* The record sizes bulk throughput is measured with, each a multiple of 64
+ * (see prvBulk()). */
+static const size_t xRecordSizes[] = { 256U, 1024U, 4096U, benchMAX_RECORD_SIZE };
+
+#define benchNUM_RECORD_SIZES    ( sizeof( xRecordSizes ) / sizeof( xRecordSizes[ 0 ] ) )
+
+/* The transports measured, in order. */
+static const BenchmarkTransport_t * const pxTransports[] =
+{
+    &xPlaintextBenchmarkTransport,
+    #if ( benchUSE_TLS == 1 )
+        &xTlsBenchmarkTransport,
+    #endif
+};
+
+#define benchNUM_TRANSPORTS      ( sizeof( pxTransports ) / sizeof( pxTransports[ 0 ] ) )
+
+/* The echo peer, as a dotted decimal string. */
+static char cPeerAddress[ 16 ];
+
+static uint8_t ucTxBuffer[ benchMAX_RECORD_SIZE ];
+static uint8_t ucRxBuffer[ benchMAX_RECORD_SIZE ];
+
+/*-----------------------------------------------------------*/
+
+void vStartTransportBenchmarkTask( configSTACK_DEPTH_TYPE uxTaskStackSize,
+                                   UBaseType_t uxTaskPriority )
+{
+    xTaskCreate( prvTransportBenchmarkTask, "TransportBench", uxTaskStackSize, NULL, uxTaskPriority, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvTransportBenchmarkTask( void * pvParameters )
+{
+    const BenchmarkTransport_t * pxTransport;
+    const char * const * ppcCipherSuite;
+    size_t x;
+
+    ( void ) pvParameters;
+
+    snprintf( cPeerAddress, sizeof( cPeerAddress ), "%d.%d.%d.%d",
+              configECHO_SERVER_ADDR0, configECHO_SERVER_ADDR1,
+              configECHO_SERVER_ADDR2, configECHO_SERVER_ADDR3 );
+
+    for( x = 0; x < sizeof( ucTxBuffer ); x++ )
+    {
+        ucTxBuffer[ x ] = ( uint8_t ) ( '0' + ( x % 64U ) );
+    }
+
+    printf( "%-10s %-40s %-16s %s\n", "Transport", "Cipher suite", "Test", "Result" );
+
+    for( x = 0; x < benchNUM_TRANSPORTS; x++ )
+    {
+        pxTransport = pxTransports[ x ];
+
+        if( pxTransport->ppcCipherSuites == NULL )
+        {
+            prvBenchmarkCipherSuite( pxTransport, NULL );
+        }
+        else
+        {
+            for( ppcCipherSuite = pxTransport->ppcCipherSuites; *ppcCipherSuite != NULL; ppcCipherSuite++ )
+            {
+                prvBenchmarkCipherSuite( pxTransport, *ppcCipherSuite );
+            }
+        }
+    }
+
+    exit( 0 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkCipherSuite( const BenchmarkTransport_t * pxTransport,
+                                     const char * pcCipherSuite )
+{
+    NetworkContext_t * pxNetworkContext = NULL;
+    const char * pcSuiteName = ( pcCipherSuite != NULL ) ? pcCipherSuite : "default";
+    struct timespec xStart;
+    double dHandshakeUs = 0.0, dElapsedUs, dMinUs = 0.0, dMaxUs = 0.0, dTotalUs = 0.0;
+    size_t x, xRecordSize;
+    uint32_t ul;
+    BaseType_t xStatus = pdPASS;
+    char cTest[ 17 ];
+
+    /* Handshake.  The last connection is kept for the other measurements. */
+    for( ul = 0; ( ul < benchHANDSHAKE_COUNT ) && ( xStatus == pdPASS ); ul++ )
+    {
+        if( pxNetworkContext != NULL )
+        {
+            pxTransport->vDisconnect( pxNetworkContext );
+        }
+
+        clock_gettime( CLOCK_MONOTONIC, &xStart );
+        pxNetworkContext = pxTransport->pxConnect( cPeerAddress, pxTransport->usPort, pcCipherSuite );
+        dHandshakeUs += prvElapsedUs( &xStart );
+
+        if( pxNetworkContext == NULL )
+        {
+            xStatus = pdFAIL;
+        }
+    }
+
+    if( xStatus != pdPASS )
+    {
+        printf( "%-10s %-40s %-16s failed to connect to %s:%u\n",
+                pxTransport->pcName, pcSuiteName, "handshake", cPeerAddress, ( unsigned ) pxTransport->usPort );
+        return;
+    }
+
+    printf( "%-10s %-40s %-16s %.2f ms\n",
+            pxTransport->pcName, pcSuiteName, "handshake", dHandshakeUs / ( 1000.0 * benchHANDSHAKE_COUNT ) );
+
+    /* Bulk throughput. */
+    for( x = 0; ( x < benchNUM_RECORD_SIZES ) && ( xStatus == pdPASS ); x++ )
+    {
+        xRecordSize = xRecordSizes[ x ];
+        snprintf( cTest, sizeof( cTest ), "bulk %u B", ( unsigned ) xRecordSize );
+
+        clock_gettime( CLOCK_MONOTONIC, &xStart );
+        xStatus = prvBulk( pxTransport, pxNetworkContext, xRecordSize );
+        dElapsedUs = prvElapsedUs( &xStart );
+
+        if( xStatus == pdPASS )
+        {
+            /* Bytes per microsecond are MB per second. */
+            printf( "%-10s %-40s %-16s %.2f MB/s\n",
+                    pxTransport->pcName, pcSuiteName, cTest, ( double ) benchBULK_BYTES / dElapsedUs );
+        }
+        else
+        {
+            printf( "%-10s %-40s %-16s echo failed\n", pxTransport->pcName, pcSuiteName, cTest );
+        }
+    }
+
+    /* Small message round trip latency. */
+    snprintf( cTest, sizeof( cTest ), "rtt %u B", ( unsigned ) benchRTT_MESSAGE_SIZE );
+
+    for( ul = 0; ( ul < benchRTT_COUNT ) && ( xStatus == pdPASS ); ul++ )
+    {
+        clock_gettime( CLOCK_MONOTONIC, &xStart );
+        xStatus = prvEcho( pxTransport, pxNetworkContext, benchRTT_MESSAGE_SIZE );
+        dElapsedUs = prvElapsedUs( &xStart );
+
+        if( ( ul == 0 ) || ( dElapsedUs < dMinUs ) )
+        {
+            dMinUs = dElapsedUs;
+        }
+
+        if( dElapsedUs > dMaxUs )
+        {
+            dMaxUs = dElapsedUs;
+        }
+
+        dTotalUs += dElapsedUs;
+    }
+
+    if( xStatus == pdPASS )
+    {
+        printf( "%-10s %-40s %-16s min %.0f us, mean %.0f us, max %.0f us\n",
+                pxTransport->pcName, pcSuiteName, cTest, dMinUs, dTotalUs / benchRTT_COUNT, dMaxUs );
+    }
+    else
+    {
+        printf( "%-10s %-40s %-16s echo failed\n", pxTransport->pcName, pcSuiteName, cTest );
+    }
+
+    pxTransport->vDisconnect( pxNetworkContext );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvBulk( const BenchmarkTransport_t * pxTransport,
+                           NetworkContext_t * pxNetworkContext,
+                           size_t xRecordSize )
+{
+    size_t xSent = 0, xReceived = 0, xLength, x;
+    uint32_t ulIdleCalls = 0;
+    int32_t lResult;
+
+    while( xReceived < benchBULK_BYTES )
+    {
+        /* Fill the window.  The first record is always sent. */
+        while( ( xSent < benchBULK_BYTES ) &&
+               ( ( xSent == xReceived ) || ( ( xSent - xReceived ) + xRecordSize <= benchBULK_WINDOW ) ) )
+        {
+            if( prvSend( pxTransport, pxNetworkContext, xRecordSize ) != pdPASS )
+            {
+                return pdFAIL;
+            }
+
+            xSent += xRecordSize;
+        }
+
+        xLength = xSent - xReceived;
+        xLength = ( xLength < sizeof( ucRxBuffer ) ) ? xLength : sizeof( ucRxBuffer );
+        lResult = pxTransport->xRecv( pxNetworkContext, ucRxBuffer, xLength );
+
+        if( lResult < 0 )
+        {
+            return pdFAIL;
+        }
+
+        ulIdleCalls = ( lResult == 0 ) ? ( ulIdleCalls + 1U ) : 0U;
+
+        if( ulIdleCalls >= benchMAX_IDLE_CALLS )
+        {
+            return pdFAIL;
+        }
+
+        /* Every record size is a multiple of the 64 byte pattern of
+         * ucTxBuffer, so the stream offset tells which byte to expect. */
+        for( x = 0; x < ( size_t ) lResult; x++ )
+        {
+            if( ucRxBuffer[ x ] != ucTxBuffer[ ( xReceived + x ) % 64U ] )
+            {
+                return pdFAIL;
+            }
+        }
+
+        xReceived += ( size_t ) lResult;
+    }
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSend( const BenchmarkTransport_t * pxTransport,
+                           NetworkContext_t * pxNetworkContext,
+                           size_t xLength )
+{
+    size_t xDone = 0;
+    uint32_t ulIdleCalls = 0;
+    int32_t lResult;
+
+    while( ( xDone < xLength ) && ( ulIdleCalls < benchMAX_IDLE_CALLS ) )
+    {
+        lResult = pxTransport->xSend( pxNetworkContext, &( ucTxBuffer[ xDone ] ), xLength - xDone );
+
+        if( lResult < 0 )
+        {
+            return pdFAIL;
+        }
+
+        ulIdleCalls = ( lResult == 0 ) ? ( ulIdleCalls + 1U ) : 0U;
+        xDone += ( size_t ) lResult;
+    }
+
+    return ( xDone == xLength ) ? pdPASS : pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvEcho( const BenchmarkTransport_t * pxTransport,
+                           NetworkContext_t * pxNetworkContext,
+                           size_t xLength )
+{
+    size_t xDone;
+    uint32_t ulIdleCalls = 0;
+    int32_t lResult;
+
+    if( prvSend( pxTransport, pxNetworkContext, xLength ) != pdPASS )
+    {
+        return pdFAIL;
+    }
+
+    for( xDone = 0; ( xDone < xLength ) && ( ulIdleCalls < benchMAX_IDLE_CALLS ); )
+    {
+        lResult = pxTransport->xRecv( pxNetworkContext, &( ucRxBuffer[ xDone ] ), xLength - xDone );
+
+        if( lResult < 0 )
+        {
+            return pdFAIL;
+        }
+
+        ulIdleCalls = ( lResult == 0 ) ? ( ulIdleCalls + 1U ) : 0U;
+        xDone += ( size_t ) lResult;
+    }
+
+    if( ( xDone < xLength ) || ( memcmp( ucTxBuffer, ucRxBuffer, xLength ) != 0 ) )
+    {
+        return pdFAIL;
+    }
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static double prvElapsedUs( const struct timespec * pxStart )
+{
+    struct timespec xEnd;
+
+    clock_gettime( CLOCK_MONOTONIC, &xEnd );
+
+    return ( ( double ) ( xEnd.tv_sec - pxStart->tv_sec ) * 1.0e6 ) + ( ( double ) ( xEnd.tv_nsec - pxStart->tv_nsec ) / 1.0e3 );
+}
+/*-----------------------------------------------------------*/
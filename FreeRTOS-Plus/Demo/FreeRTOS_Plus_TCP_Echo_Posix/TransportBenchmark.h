@@ -0,0 +1,86 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef TRANSPORT_BENCHMARK_H
+#define TRANSPORT_BENCHMARK_H
+
+/* Set to 1 by the makefile when a TLS transport is built, see README.txt. */
+#ifndef benchUSE_TLS
+    #define benchUSE_TLS    0
+#endif
+
+/* Transport interface include. */
+#include "transport_interface.h"
+
+/*
+ * A transport measured by the benchmark.  Each transport is implemented in its
+ * own TransportBenchmark_<transport>.c file, as every file using a transport
+ * has to define the NetworkContext_t of that transport.
+ */
+typedef struct BenchmarkTransport
+{
+    /* Name printed in the results. */
+    const char * pcName;
+
+    /* Port of the echo peer, on the address set by configECHO_SERVER_ADDR0 to
+     * configECHO_SERVER_ADDR3. */
+    uint16_t usPort;
+
+    /* NULL terminated list of the cipher suites to measure, or NULL to measure
+     * the default configuration of the transport only. */
+    const char * const * ppcCipherSuites;
+
+    /* Connect to pcHostName:usPort.  pcCipherSuite is NULL or an entry of
+     * ppcCipherSuites.  Returns the network context, or NULL on failure. */
+    NetworkContext_t * ( *pxConnect )( const char * pcHostName,
+                                       uint16_t usPort,
+                                       const char * pcCipherSuite );
+
+    /* Close a connection opened by pxConnect. */
+    void ( * vDisconnect )( NetworkContext_t * pxNetworkContext );
+
+    /* Transport interface functions used on the connection. */
+    TransportRecv_t xRecv;
+    TransportSend_t xSend;
+} BenchmarkTransport_t;
+
+/* Defined in TransportBenchmark_Plaintext.c. */
+extern const BenchmarkTransport_t xPlaintextBenchmarkTransport;
+
+/* Defined in TransportBenchmark_mbedTLS.c or TransportBenchmark_wolfSSL.c,
+ * only one of which can be built as both implement TLS_FreeRTOS_Connect(). */
+#if ( benchUSE_TLS == 1 )
+    extern const BenchmarkTransport_t xTlsBenchmarkTransport;
+#endif
+
+/*
+ * Create the task measuring handshake time, bulk throughput and round-trip
+ * latency of each transport included in the build.
+ */
+void vStartTransportBenchmarkTask( configSTACK_DEPTH_TYPE uxTaskStackSize,
+                                   UBaseType_t uxTaskPriority );
+
+#endif /* TRANSPORT_BENCHMARK_H */
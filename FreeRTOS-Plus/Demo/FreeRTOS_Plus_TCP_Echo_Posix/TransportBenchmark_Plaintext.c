@@ -0,0 +1,97 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * The plain text transport, measured by TransportBenchmark.c against the echo
+ * service on port 7 of the host.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* Transport includes. */
+#include "transport_plaintext.h"
+
+/* Demo includes. */
+#include "TransportBenchmark.h"
+
+/* Send and receive timeouts of the connection. */
+#define benchPLAINTEXT_TIMEOUT_MS    ( 1000U )
+
+/*-----------------------------------------------------------*/
+
+struct NetworkContext
+{
+    PlaintextTransportParams_t * pParams;
+};
+
+static NetworkContext_t * prvConnect( const char * pcHostName,
+                                      uint16_t usPort,
+                                      const char * pcCipherSuite );
+static void prvDisconnect( NetworkContext_t * pxNetworkContext );
+
+/*-----------------------------------------------------------*/
+
+const BenchmarkTransport_t xPlaintextBenchmarkTransport =
+{
+    "plaintext",
+    7U,
+    NULL,
+    prvConnect,
+    prvDisconnect,
+    Plaintext_FreeRTOS_recv,
+    Plaintext_FreeRTOS_send
+};
+
+/* The benchmark uses one connection at a time. */
+static NetworkContext_t xNetworkContext;
+static PlaintextTransportParams_t xPlaintextTransportParams;
+
+/*-----------------------------------------------------------*/
+
+static NetworkContext_t * prvConnect( const char * pcHostName,
+                                      uint16_t usPort,
+                                      const char * pcCipherSuite )
+{
+    ( void ) pcCipherSuite;
+
+    xNetworkContext.pParams = &xPlaintextTransportParams;
+
+    if( Plaintext_FreeRTOS_Connect( &xNetworkContext, pcHostName, usPort,
+                                    benchPLAINTEXT_TIMEOUT_MS, benchPLAINTEXT_TIMEOUT_MS ) != PLAINTEXT_TRANSPORT_SUCCESS )
+    {
+        return NULL;
+    }
+
+    return &xNetworkContext;
+}
+/*-----------------------------------------------------------*/
+
+static void prvDisconnect( NetworkContext_t * pxNetworkContext )
+{
+    ( void ) Plaintext_FreeRTOS_Disconnect( pxNetworkContext );
+}
+/*-----------------------------------------------------------*/
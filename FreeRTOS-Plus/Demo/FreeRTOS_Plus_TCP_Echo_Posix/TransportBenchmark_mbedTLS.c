@@ -0,0 +1,205 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * The mbedTLS transport, measured by TransportBenchmark.c against a TLS echo
+ * peer on port 4433 of the host.  Each entry of pcCipherSuites is offered as
+ * the only cipher suite of a connection, so the peer has to accept all of them
+ * and present a certificate of the type (RSA here) their key exchange needs.
+ * The peer certificate is verified against the PEM file benchTLS_ROOT_CA_FILE,
+ * read from the working directory.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* Transport includes. */
+#include "transport_mbedtls.h"
+
+/* mbedTLS includes. */
+#include "mbedtls/ssl.h"
+
+/* Demo includes. */
+#include "TransportBenchmark.h"
+
+/* Send and receive timeouts of the connection. */
+#define benchTLS_TIMEOUT_MS      ( 1000U )
+
+/* The root CA the peer certificate must chain to. */
+#ifndef benchTLS_ROOT_CA_FILE
+    #define benchTLS_ROOT_CA_FILE    "benchmark_ca.pem"
+#endif
+
+/*-----------------------------------------------------------*/
+
+struct NetworkContext
+{
+    TlsTransportParams_t * pParams;
+};
+
+static NetworkContext_t * prvConnect( const char * pcHostName,
+                                      uint16_t usPort,
+                                      const char * pcCipherSuite );
+static void prvDisconnect( NetworkContext_t * pxNetworkContext );
+
+/*
+ * Reads benchTLS_ROOT_CA_FILE into a buffer allocated with pvPortMalloc(),
+ * with a terminating '\0' as mbedtls_x509_crt_parse() needs for PEM data.
+ */
+static BaseType_t prvLoadRootCa( void );
+
+/*-----------------------------------------------------------*/
+
+/* The cipher suites measured, in mbedTLS naming. */
+static const char * const pcCipherSuites[] =
+{
+    "TLS-ECDHE-RSA-WITH-AES-128-GCM-SHA256",
+    "TLS-ECDHE-RSA-WITH-AES-256-GCM-SHA384",
+    "TLS-ECDHE-RSA-WITH-CHACHA20-POLY1305-SHA256",
+    "TLS-ECDHE-RSA-WITH-AES-128-CBC-SHA256",
+    "TLS-RSA-WITH-AES-128-GCM-SHA256",
+    NULL
+};
+
+const BenchmarkTransport_t xTlsBenchmarkTransport =
+{
+    "mbedTLS",
+    4433U,
+    pcCipherSuites,
+    prvConnect,
+    prvDisconnect,
+    TLS_FreeRTOS_recv,
+    TLS_FreeRTOS_send
+};
+
+/* The benchmark uses one connection at a time. */
+static NetworkContext_t xNetworkContext;
+static TlsTransportParams_t xTlsTransportParams;
+static NetworkCredentials_t xNetworkCredentials;
+
+/* The cipher suite offered, as the 0 terminated list mbedTLS takes. */
+static int lCipherSuiteIds[ 2 ];
+
+static unsigned char * pucRootCa = NULL;
+static size_t xRootCaSize = 0;
+
+/*-----------------------------------------------------------*/
+
+static NetworkContext_t * prvConnect( const char * pcHostName,
+                                      uint16_t usPort,
+                                      const char * pcCipherSuite )
+{
+    if( ( pucRootCa == NULL ) && ( prvLoadRootCa() != pdPASS ) )
+    {
+        return NULL;
+    }
+
+    xNetworkCredentials.pRootCa = pucRootCa;
+    xNetworkCredentials.rootCaSize = xRootCaSize;
+
+    /* The peer is addressed by IP address. */
+    xNetworkCredentials.disableSni = pdTRUE;
+
+    if( pcCipherSuite != NULL )
+    {
+        lCipherSuiteIds[ 0 ] = mbedtls_ssl_get_ciphersuite_id( pcCipherSuite );
+        lCipherSuiteIds[ 1 ] = 0;
+
+        if( lCipherSuiteIds[ 0 ] == 0 )
+        {
+            printf( "%s is not enabled in the mbedTLS configuration.\n", pcCipherSuite );
+            return NULL;
+        }
+
+        xNetworkCredentials.pCiphersuites = lCipherSuiteIds;
+    }
+    else
+    {
+        xNetworkCredentials.pCiphersuites = NULL;
+    }
+
+    /* Start from clean parameters so that every connect is a full handshake. */
+    memset( &xTlsTransportParams, 0, sizeof( xTlsTransportParams ) );
+    xNetworkContext.pParams = &xTlsTransportParams;
+
+    if( TLS_FreeRTOS_Connect( &xNetworkContext, pcHostName, usPort, &xNetworkCredentials,
+                              benchTLS_TIMEOUT_MS, benchTLS_TIMEOUT_MS ) != TLS_TRANSPORT_SUCCESS )
+    {
+        return NULL;
+    }
+
+    return &xNetworkContext;
+}
+/*-----------------------------------------------------------*/
+
+static void prvDisconnect( NetworkContext_t * pxNetworkContext )
+{
+    TLS_FreeRTOS_Disconnect( pxNetworkContext );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvLoadRootCa( void )
+{
+    FILE * pxFile;
+    long lSize;
+    BaseType_t xReturn = pdFAIL;
+
+    pxFile = fopen( benchTLS_ROOT_CA_FILE, "rb" );
+
+    if( pxFile == NULL )
+    {
+        printf( "Could not open %s.\n", benchTLS_ROOT_CA_FILE );
+    }
+    else
+    {
+        if( ( fseek( pxFile, 0, SEEK_END ) == 0 ) && ( ( lSize = ftell( pxFile ) ) > 0 ) && ( fseek( pxFile, 0, SEEK_SET ) == 0 ) )
+        {
+            pucRootCa = pvPortMalloc( ( size_t ) lSize + 1U );
+
+            if( ( pucRootCa != NULL ) && ( fread( pucRootCa, 1, ( size_t ) lSize, pxFile ) == ( size_t ) lSize ) )
+            {
+                pucRootCa[ lSize ] = '\0';
+                xRootCaSize = ( size_t ) lSize + 1U;
+                xReturn = pdPASS;
+            }
+            else
+            {
+                vPortFree( pucRootCa );
+                pucRootCa = NULL;
+            }
+        }
+
+        fclose( pxFile );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,125 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * The wolfSSL transport, measured by TransportBenchmark.c against a TLS echo
+ * peer on port 4433 of the host.  transport_wolfSSL.c takes no cipher suite
+ * from its credentials, so only the suite wolfSSL negotiates by default is
+ * measured.  The transport loads the credentials from the files named below,
+ * read from the working directory, and always presents a client certificate.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* Transport includes. */
+#include "transport_wolfSSL.h"
+
+/* Demo includes. */
+#include "TransportBenchmark.h"
+
+/* Send and receive timeouts of the connection. */
+#define benchTLS_TIMEOUT_MS             ( 1000U )
+
+/* The root CA the peer certificate must chain to, and the client credentials. */
+#ifndef benchTLS_ROOT_CA_FILE
+    #define benchTLS_ROOT_CA_FILE        "benchmark_ca.pem"
+#endif
+#ifndef benchTLS_CLIENT_CERT_FILE
+    #define benchTLS_CLIENT_CERT_FILE    "benchmark_client.pem"
+#endif
+#ifndef benchTLS_CLIENT_KEY_FILE
+    #define benchTLS_CLIENT_KEY_FILE     "benchmark_client_key.pem"
+#endif
+
+/*-----------------------------------------------------------*/
+
+static NetworkContext_t * prvConnect( const char * pcHostName,
+                                      uint16_t usPort,
+                                      const char * pcCipherSuite );
+static void prvDisconnect( NetworkContext_t * pxNetworkContext );
+
+/*-----------------------------------------------------------*/
+
+const BenchmarkTransport_t xTlsBenchmarkTransport =
+{
+    "wolfSSL",
+    4433U,
+    NULL,
+    prvConnect,
+    prvDisconnect,
+    TLS_FreeRTOS_recv,
+    TLS_FreeRTOS_send
+};
+
+/* The benchmark uses one connection at a time. */
+static NetworkContext_t xNetworkContext;
+
+static const NetworkCredentials_t xNetworkCredentials =
+{
+    NULL,
+    pdTRUE, /* The peer is addressed by IP address. */
+    ( const unsigned char * ) benchTLS_ROOT_CA_FILE,
+    0,
+    ( const unsigned char * ) benchTLS_CLIENT_CERT_FILE,
+    0,
+    ( const unsigned char * ) benchTLS_CLIENT_KEY_FILE,
+    0,
+    NULL,
+    0,
+    NULL,
+    0
+};
+
+/*-----------------------------------------------------------*/
+
+static NetworkContext_t * prvConnect( const char * pcHostName,
+                                      uint16_t usPort,
+                                      const char * pcCipherSuite )
+{
+    ( void ) pcCipherSuite;
+
+    /* Not sharing a context, so every connect is a full handshake. */
+    memset( &xNetworkContext, 0, sizeof( xNetworkContext ) );
+
+    if( TLS_FreeRTOS_Connect( &xNetworkContext, pcHostName, usPort, &xNetworkCredentials,
+                              benchTLS_TIMEOUT_MS, benchTLS_TIMEOUT_MS ) != TLS_TRANSPORT_SUCCESS )
+    {
+        return NULL;
+    }
+
+    return &xNetworkContext;
+}
+/*-----------------------------------------------------------*/
+
+static void prvDisconnect( NetworkContext_t * pxNetworkContext )
+{
+    TLS_FreeRTOS_Disconnect( pxNetworkContext );
+}
+/*-----------------------------------------------------------*/
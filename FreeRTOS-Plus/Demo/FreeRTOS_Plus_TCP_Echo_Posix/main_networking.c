@@ -48,6 +48,12 @@
 /*#include "TCPEchoClient_SingleTasks.h" */
 /*#include "logging.h" */
 #include "TCPEchoClient_SingleTasks.h"
+#include "TransportBenchmark.h"
+#include "FtpBenchmark.h"
+
+#if ( LOGGING_DEFERRED == 1 )
+    #include "logging.h"
+#endif
 
 /* Simple UDP client and server task parameters. */
 #define mainSIMPLE_UDP_CLIENT_SERVER_TASK_PRIORITY    ( tskIDLE_PRIORITY )
@@ -61,6 +67,19 @@
 #define mainECHO_SERVER_TASK_STACK_SIZE               ( configMINIMAL_STACK_SIZE * 2 )
 #define mainECHO_SERVER_TASK_PRIORITY                 ( tskIDLE_PRIORITY + 1 )
 
+/* Transport benchmark task parameters.  The TLS handshakes need a deep stack. */
+#define mainTRANSPORT_BENCHMARK_TASK_STACK_SIZE       ( configMINIMAL_STACK_SIZE * 4 )
+#define mainTRANSPORT_BENCHMARK_TASK_PRIORITY         ( tskIDLE_PRIORITY + 1 )
+
+/* FTP benchmark task parameters. */
+#define mainFTP_BENCHMARK_TASK_STACK_SIZE             ( configMINIMAL_STACK_SIZE * 4 )
+#define mainFTP_BENCHMARK_TASK_PRIORITY               ( tskIDLE_PRIORITY + 1 )
+
+/* Deferred logging task parameters, the messages are printed when nothing
+ * else runs. */
+#define mainLOGGING_TASK_STACK_SIZE                   ( configMINIMAL_STACK_SIZE * 4 )
+#define mainLOGGING_TASK_PRIORITY                     ( tskIDLE_PRIORITY )
+
 /* Define a name that will be used for LLMNR and NBNS searches. */
 #define mainHOST_NAME                                 "RTOSDemo"
 #define mainDEVICE_NICK_NAME                          "linux_demo"
@@ -75,8 +94,30 @@
  * configECHO_SERVER_ADDR0 to configECHO_SERVER_ADDR3 constants in
  * FreeRTOSConfig.h.
  *
+ * mainCREATE_TRANSPORT_BENCHMARK:  When set to 1 the echo tasks are replaced by
+ * a task that measures the network transports against echo peers on the host,
+ * prints the results and exits, see TransportBenchmark.c.  The makefile sets
+ * this when built with TRANSPORT_BENCHMARK=1.
+ *
+ * mainCREATE_FTP_BENCHMARK:  When set to 1 the echo tasks are replaced by a
+ * task that measures the upload and download throughput of an FTP server,
+ * prints the results and exits, see FtpBenchmark.c.  The makefile sets this
+ * when built with FTP_BENCHMARK=1.
+ *
  */
-#define mainCREATE_TCP_ECHO_TASKS_SINGLE              1
+#ifndef mainCREATE_TRANSPORT_BENCHMARK
+    #define mainCREATE_TRANSPORT_BENCHMARK            0
+#endif
+
+#ifndef mainCREATE_FTP_BENCHMARK
+    #define mainCREATE_FTP_BENCHMARK                  0
+#endif
+
+#if ( mainCREATE_TRANSPORT_BENCHMARK == 1 ) || ( mainCREATE_FTP_BENCHMARK == 1 )
+    #define mainCREATE_TCP_ECHO_TASKS_SINGLE          0
+#else
+    #define mainCREATE_TCP_ECHO_TASKS_SINGLE          1
+#endif
 /*-----------------------------------------------------------*/
 
 /*
@@ -228,6 +269,18 @@ void main_tcp_echo_client_tasks( void )
                 }
             #endif /* mainCREATE_TCP_ECHO_TASKS_SINGLE */
 
+            #if ( mainCREATE_TRANSPORT_BENCHMARK == 1 )
+                {
+                    vStartTransportBenchmarkTask( mainTRANSPORT_BENCHMARK_TASK_STACK_SIZE, mainTRANSPORT_BENCHMARK_TASK_PRIORITY );
+                }
+            #endif /* mainCREATE_TRANSPORT_BENCHMARK */
+
+            #if ( mainCREATE_FTP_BENCHMARK == 1 )
+                {
+                    vStartFtpBenchmarkTask( mainFTP_BENCHMARK_TASK_STACK_SIZE, mainFTP_BENCHMARK_TASK_PRIORITY );
+                }
+            #endif /* mainCREATE_FTP_BENCHMARK */
+
             xTasksAlreadyCreated = pdTRUE;
         }
 
@@ -285,6 +338,13 @@ static void prvMiscInitialisation( void )
     FreeRTOS_debug_printf( ( "Seed for randomiser: %lu\n", xTimeNow ) );
     prvSRand( ( uint32_t ) xTimeNow );
 
+    #if ( LOGGING_DEFERRED == 1 )
+    {
+        /* The LogXxx() macros store their messages for this task to print. */
+        vLoggingDeferredInit( mainLOGGING_TASK_STACK_SIZE, mainLOGGING_TASK_PRIORITY );
+    }
+    #endif
+
     ( void ) xApplicationGetRandomNumber( &ulRandomNumbers[ 0 ] );
     ( void ) xApplicationGetRandomNumber( &ulRandomNumbers[ 1 ] );
     ( void ) xApplicationGetRandomNumber( &ulRandomNumbers[ 2 ] );
@@ -53,6 +53,42 @@
 #include "core_pkcs11_config.h"
 #include "core_pkcs11.h"
 
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Set to 1 to perform all PKCS #11 sign operations in a signing task.
+ *
+ * The task owns access to the token, so concurrent TLS handshakes queue for it
+ * and block instead of issuing C_SignInit/C_Sign on the token at the same time.
+ * Requests queued while the token is busy are signed back to back.
+ */
+#ifndef P11_PK_SIGN_TASK_ENABLED
+    #define P11_PK_SIGN_TASK_ENABLED    ( 0 )
+#endif
+
+/**
+ * @brief Number of sign requests that can wait for the signing task.
+ */
+#ifndef P11_PK_SIGN_QUEUE_LENGTH
+    #define P11_PK_SIGN_QUEUE_LENGTH    ( 4U )
+#endif
+
+/**
+ * @brief Stack size and priority of the signing task.
+ */
+#ifndef P11_PK_SIGN_TASK_STACK_SIZE
+    #define P11_PK_SIGN_TASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 4 )
+#endif
+#ifndef P11_PK_SIGN_TASK_PRIORITY
+    #define P11_PK_SIGN_TASK_PRIORITY    ( tskIDLE_PRIORITY + 2 )
+#endif
+
 /*-----------------------------------------------------------*/
 
 typedef struct P11PkCtx
@@ -60,6 +96,9 @@ typedef struct P11PkCtx
     CK_FUNCTION_LIST_PTR pxFunctionList;
     CK_SESSION_HANDLE xSessionHandle;
     CK_OBJECT_HANDLE xPkHandle;
+    #if ( P11_PK_SIGN_TASK_ENABLED == 1 )
+        SemaphoreHandle_t xSignDone; /**< Given by the signing task when a request of this context completes. */
+    #endif
 } P11PkCtx_t;
 
 typedef struct P11EcDsaCtx
@@ -74,6 +113,85 @@ typedef struct P11RsaCtx
     P11PkCtx_t xP11PkCtx;
 } P11RsaCtx_t;
 
+#if ( P11_PK_SIGN_TASK_ENABLED == 1 )
+
+/**
+ * @brief A sign operation handed to the signing task.
+ */
+    typedef struct P11SignRequest
+    {
+        const P11PkCtx_t * pxP11Ctx;  /**< Session and key to sign with. */
+        CK_MECHANISM_TYPE xMechanism; /**< Sign mechanism. */
+        CK_BYTE_PTR pucData;          /**< Data to sign. */
+        CK_ULONG ulDataLen;           /**< Length of pucData. */
+        CK_BYTE_PTR pucSig;           /**< Buffer receiving the signature. */
+        CK_ULONG ulSigLen;            /**< Size of pucSig, then length of the signature. */
+        CK_RV xResult;                /**< Result of the sign operation. */
+    } P11SignRequest_t;
+
+/**
+ * @brief Queue of pointers to the requests waiting for the signing task,
+ * NULL until the signing task is running.
+ */
+    static QueueHandle_t xSignQueue = NULL;
+
+/**
+ * @brief Set once the signing task has been started.
+ */
+    static BaseType_t xSignTaskStarted = pdFALSE;
+
+/**
+ * @brief Start the signing task on first use.
+ *
+ * @return pdTRUE if the signing task is running, else pdFALSE.
+ */
+    static BaseType_t prvStartSignTask( void );
+
+/**
+ * @brief Task performing the queued sign requests one after another.
+ *
+ * @param pvParameters The request queue.
+ */
+    static void prvSignTask( void * pvParameters );
+
+#endif /* if ( P11_PK_SIGN_TASK_ENABLED == 1 ) */
+
+/**
+ * @brief Perform a single part PKCS #11 sign operation.
+ *
+ * @param pxP11Ctx Session and key to sign with.
+ * @param xMechanism Sign mechanism.
+ * @param pucData Data to sign.
+ * @param ulDataLen Length of pucData.
+ * @param pucSig Buffer receiving the signature.
+ * @param pulSigLen Size of pucSig, set to the length of the signature.
+ * @return CKR_OK on success
+ */
+static CK_RV prvP11Sign( const P11PkCtx_t * pxP11Ctx,
+                         CK_MECHANISM_TYPE xMechanism,
+                         CK_BYTE_PTR pucData,
+                         CK_ULONG ulDataLen,
+                         CK_BYTE_PTR pucSig,
+                         CK_ULONG_PTR pulSigLen );
+
+/**
+ * @brief Sign with the signing task when it is enabled, else in the calling task.
+ *
+ * @param pxP11Ctx Session and key to sign with.
+ * @param xMechanism Sign mechanism.
+ * @param pucData Data to sign.
+ * @param ulDataLen Length of pucData.
+ * @param pucSig Buffer receiving the signature.
+ * @param pulSigLen Size of pucSig, set to the length of the signature.
+ * @return CKR_OK on success
+ */
+static CK_RV prvSign( const P11PkCtx_t * pxP11Ctx,
+                      CK_MECHANISM_TYPE xMechanism,
+                      CK_BYTE_PTR pucData,
+                      CK_ULONG ulDataLen,
+                      CK_BYTE_PTR pucSig,
+                      CK_ULONG_PTR pulSigLen );
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -402,6 +520,12 @@ static void * p11_ecdsa_ctx_alloc( void )
         pxP11EcDsa->xP11PkCtx.xSessionHandle = CK_INVALID_HANDLE;
         pxP11EcDsa->xP11PkCtx.xPkHandle = CK_INVALID_HANDLE;
 
+        #if ( P11_PK_SIGN_TASK_ENABLED == 1 )
+        {
+            pxP11EcDsa->xP11PkCtx.xSignDone = xSemaphoreCreateBinary();
+        }
+        #endif
+
         mbedtls_ecdsa_init( &( pxP11EcDsa->xMbedEcDsaCtx ) );
     }
 
@@ -416,6 +540,15 @@ static void p11_ecdsa_ctx_free( void * pvCtx )
 
         mbedtls_ecdsa_free( &( pxP11EcDsa->xMbedEcDsaCtx ) );
 
+        #if ( P11_PK_SIGN_TASK_ENABLED == 1 )
+        {
+            if( pxP11EcDsa->xP11PkCtx.xSignDone != NULL )
+            {
+                vSemaphoreDelete( pxP11EcDsa->xP11PkCtx.xSignDone );
+            }
+        }
+        #endif
+
         mbedtls_free( pvCtx );
     }
 }
@@ -537,6 +670,158 @@ static CK_RV p11_ecdsa_ctx_init( void * pvCtx,
 
 /*-----------------------------------------------------------*/
 
+static CK_RV prvP11Sign( const P11PkCtx_t * pxP11Ctx,
+                         CK_MECHANISM_TYPE xMechanism,
+                         CK_BYTE_PTR pucData,
+                         CK_ULONG ulDataLen,
+                         CK_BYTE_PTR pucSig,
+                         CK_ULONG_PTR pulSigLen )
+{
+    CK_RV xResult = CKR_OK;
+
+    CK_MECHANISM xMech =
+    {
+        .mechanism      = xMechanism,
+        .pParameter     = NULL,
+        .ulParameterLen = 0
+    };
+
+    /* Use the PKCS#11 module to sign. */
+    xResult = pxP11Ctx->pxFunctionList->C_SignInit( pxP11Ctx->xSessionHandle,
+                                                    &xMech,
+                                                    pxP11Ctx->xPkHandle );
+
+    if( CKR_OK == xResult )
+    {
+        xResult = pxP11Ctx->pxFunctionList->C_Sign( pxP11Ctx->xSessionHandle,
+                                                    pucData, ulDataLen,
+                                                    pucSig, pulSigLen );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( P11_PK_SIGN_TASK_ENABLED == 1 )
+
+    static BaseType_t prvStartSignTask( void )
+    {
+        BaseType_t xCreate = pdFALSE;
+        QueueHandle_t xQueue = NULL;
+
+        taskENTER_CRITICAL();
+        {
+            if( xSignTaskStarted == pdFALSE )
+            {
+                xSignTaskStarted = pdTRUE;
+                xCreate = pdTRUE;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( xCreate == pdTRUE )
+        {
+            xQueue = xQueueCreate( P11_PK_SIGN_QUEUE_LENGTH, sizeof( P11SignRequest_t * ) );
+
+            if( xQueue == NULL )
+            {
+                LogError( ( "Failed to create the sign request queue." ) );
+            }
+            else if( xTaskCreate( prvSignTask,
+                                  "P11Sign",
+                                  P11_PK_SIGN_TASK_STACK_SIZE,
+                                  xQueue,
+                                  P11_PK_SIGN_TASK_PRIORITY,
+                                  NULL ) != pdPASS )
+            {
+                LogError( ( "Failed to create the signing task." ) );
+                vQueueDelete( xQueue );
+            }
+            else
+            {
+                xSignQueue = xQueue;
+            }
+        }
+
+        /* Signatures requested while another task is still starting the
+         * signing task are made by the requesting task. */
+        return ( xSignQueue != NULL ) ? pdTRUE : pdFALSE;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void prvSignTask( void * pvParameters )
+    {
+        QueueHandle_t xQueue = ( QueueHandle_t ) pvParameters;
+        P11SignRequest_t * pxRequest = NULL;
+
+        for( ; ; )
+        {
+            if( xQueueReceive( xQueue, &pxRequest, portMAX_DELAY ) == pdTRUE )
+            {
+                pxRequest->xResult = prvP11Sign( pxRequest->pxP11Ctx,
+                                                 pxRequest->xMechanism,
+                                                 pxRequest->pucData,
+                                                 pxRequest->ulDataLen,
+                                                 pxRequest->pucSig,
+                                                 &( pxRequest->ulSigLen ) );
+
+                ( void ) xSemaphoreGive( pxRequest->pxP11Ctx->xSignDone );
+            }
+        }
+    }
+
+#endif /* if ( P11_PK_SIGN_TASK_ENABLED == 1 ) */
+
+/*-----------------------------------------------------------*/
+
+static CK_RV prvSign( const P11PkCtx_t * pxP11Ctx,
+                      CK_MECHANISM_TYPE xMechanism,
+                      CK_BYTE_PTR pucData,
+                      CK_ULONG ulDataLen,
+                      CK_BYTE_PTR pucSig,
+                      CK_ULONG_PTR pulSigLen )
+{
+    CK_RV xResult = CKR_OK;
+    BaseType_t xOffloaded = pdFALSE;
+
+    #if ( P11_PK_SIGN_TASK_ENABLED == 1 )
+    {
+        P11SignRequest_t xRequest;
+        P11SignRequest_t * pxRequest = &xRequest;
+
+        if( ( pxP11Ctx->xSignDone != NULL ) && ( prvStartSignTask() == pdTRUE ) )
+        {
+            xRequest.pxP11Ctx = pxP11Ctx;
+            xRequest.xMechanism = xMechanism;
+            xRequest.pucData = pucData;
+            xRequest.ulDataLen = ulDataLen;
+            xRequest.pucSig = pucSig;
+            xRequest.ulSigLen = *pulSigLen;
+            xRequest.xResult = CKR_FUNCTION_FAILED;
+
+            /* The request lives on this stack, so wait for its completion. */
+            ( void ) xQueueSend( xSignQueue, &pxRequest, portMAX_DELAY );
+            ( void ) xSemaphoreTake( pxP11Ctx->xSignDone, portMAX_DELAY );
+
+            *pulSigLen = xRequest.ulSigLen;
+            xResult = xRequest.xResult;
+            xOffloaded = pdTRUE;
+        }
+    }
+    #endif /* if ( P11_PK_SIGN_TASK_ENABLED == 1 ) */
+
+    if( xOffloaded == pdFALSE )
+    {
+        xResult = prvP11Sign( pxP11Ctx, xMechanism, pucData, ulDataLen, pucSig, pulSigLen );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
 static int prvASN1WriteBigIntFromOctetStr( unsigned char ** ppucPosition,
                                            const unsigned char * pucStart,
                                            const unsigned char * pucOctetStr,
@@ -672,13 +957,6 @@ static int p11_ecdsa_sign( void * pvCtx,
     const P11PkCtx_t * pxP11Ctx = NULL;
     unsigned char pucHashCopy[ MBEDTLS_MD_MAX_SIZE ];
 
-    CK_MECHANISM xMech =
-    {
-        .mechanism      = CKM_ECDSA,
-        .pParameter     = NULL,
-        .ulParameterLen = 0
-    };
-
     /* Unused parameters. */
     ( void ) ( xMdAlg );
     ( void ) ( plRng );
@@ -700,23 +978,15 @@ static int p11_ecdsa_sign( void * pvCtx,
         xResult = CKR_FUNCTION_FAILED;
     }
 
-    if( CKR_OK == xResult )
-    {
-        /* Use the PKCS#11 module to sign. */
-        xResult = pxP11Ctx->pxFunctionList->C_SignInit( pxP11Ctx->xSessionHandle,
-                                                        &xMech,
-                                                        pxP11Ctx->xPkHandle );
-    }
-
     if( CKR_OK == xResult )
     {
         CK_ULONG ulSigLen = xSigBufferSize;
 
         ( void ) memcpy( pucHashCopy, pucHash, xHashLen );
 
-        xResult = pxP11Ctx->pxFunctionList->C_Sign( pxP11Ctx->xSessionHandle,
-                                                    pucHashCopy, xHashLen,
-                                                    pucSig, &ulSigLen );
+        xResult = prvSign( pxP11Ctx, CKM_ECDSA,
+                           pucHashCopy, xHashLen,
+                           pucSig, &ulSigLen );
 
         if( xResult == CKR_OK )
         {
@@ -917,13 +1187,6 @@ static int p11_rsa_sign( void * pvCtx,
 
     CK_BYTE pxToBeSigned[ 256 ];
 
-    CK_MECHANISM xMech =
-    {
-        .mechanism      = CKM_RSA_PKCS,
-        .pParameter     = NULL,
-        .ulParameterLen = 0
-    };
-
     /* Unused parameters. */
     ( void ) ( plRng );
     ( void ) ( pvRng );
@@ -957,23 +1220,15 @@ static int p11_rsa_sign( void * pvCtx,
         xResult = vAppendSHA256AlgorithmIdentifierSequence( ( uint8_t * ) pucHash, pxToBeSigned );
     }
 
-    if( CKR_OK == xResult )
-    {
-        /* Use the PKCS#11 module to sign. */
-        xResult = pxP11Ctx->pxFunctionList->C_SignInit( pxP11Ctx->xSessionHandle,
-                                                        &xMech,
-                                                        pxP11Ctx->xPkHandle );
-    }
-
     if( CKR_OK == xResult )
     {
         CK_ULONG ulSigLen = sizeof( pxToBeSigned );
 
-        xResult = pxP11Ctx->pxFunctionList->C_Sign( pxP11Ctx->xSessionHandle,
-                                                    pxToBeSigned,
-                                                    pkcs11RSA_SIGNATURE_INPUT_LENGTH,
-                                                    pucSig,
-                                                    &ulSigLen );
+        xResult = prvSign( pxP11Ctx, CKM_RSA_PKCS,
+                           pxToBeSigned,
+                           pkcs11RSA_SIGNATURE_INPUT_LENGTH,
+                           pucSig,
+                           &ulSigLen );
 
         *pxSigLen = ( size_t ) ulSigLen;
     }
@@ -1019,6 +1274,12 @@ static void * p11_rsa_ctx_alloc( void )
         pxP11Rsa->xP11PkCtx.xSessionHandle = CK_INVALID_HANDLE;
         pxP11Rsa->xP11PkCtx.xPkHandle = CK_INVALID_HANDLE;
 
+        #if ( P11_PK_SIGN_TASK_ENABLED == 1 )
+        {
+            pxP11Rsa->xP11PkCtx.xSignDone = xSemaphoreCreateBinary();
+        }
+        #endif
+
         mbedtls_rsa_init( &( pxP11Rsa->xMbedRsaCtx ) );
     }
 
@@ -1088,6 +1349,15 @@ static void p11_rsa_ctx_free( void * pvCtx )
 
         mbedtls_rsa_free( &( pxP11Rsa->xMbedRsaCtx ) );
 
+        #if ( P11_PK_SIGN_TASK_ENABLED == 1 )
+        {
+            if( pxP11Rsa->xP11PkCtx.xSignDone != NULL )
+            {
+                vSemaphoreDelete( pxP11Rsa->xP11PkCtx.xSignDone );
+            }
+        }
+        #endif
+
         mbedtls_free( pvCtx );
     }
 }
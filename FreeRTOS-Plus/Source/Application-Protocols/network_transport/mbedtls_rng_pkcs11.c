@@ -36,18 +36,257 @@
  * @brief Implements an mbedtls RNG callback using the PKCS#11 API
  */
 
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* MbedTLS includes. */
+#include "mbedtls/ctr_drbg.h"
+
 #include "core_pkcs11_config.h"
 #include "core_pkcs11.h"
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Set to 1 to serve RNG requests from a CTR-DRBG seeded by the token,
+ * so small requests do not each cost a C_GenerateRandom() round trip.
+ * Set to 0 to read every request from the token.
+ */
+#ifndef PKCS11_RNG_DRBG_ENABLED
+    #define PKCS11_RNG_DRBG_ENABLED    ( 1 )
+#endif
+
+/**
+ * @brief Number of random bytes read from the token at a time to seed and
+ * reseed the DRBG.
+ */
+#ifndef PKCS11_RNG_ENTROPY_BLOCK_SIZE
+    #define PKCS11_RNG_ENTROPY_BLOCK_SIZE    ( 128U )
+#endif
+
+/**
+ * @brief Number of DRBG requests after which the DRBG is reseeded from the token.
+ */
+#ifndef PKCS11_RNG_DRBG_RESEED_INTERVAL
+    #define PKCS11_RNG_DRBG_RESEED_INTERVAL    ( 256 )
+#endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Read random bytes from the token.
+ *
+ * @param[in] xSessionHandle Session on the token.
+ * @param[out] pucOutput Buffer to fill with random data.
+ * @param[in] uxLen Length of pucOutput.
+ *
+ * @return 0 on success.
+ */
+static int prvGenerateRandom( CK_SESSION_HANDLE xSessionHandle,
+                              unsigned char * pucOutput,
+                              size_t uxLen );
+
+#if ( PKCS11_RNG_DRBG_ENABLED == 1 )
+
+/**
+ * @brief DRBG serving the RNG requests.
+ */
+    static mbedtls_ctr_drbg_context xDrbgContext;
+
+/**
+ * @brief Mutex guarding the DRBG and the entropy pool, NULL until the DRBG is seeded.
+ */
+    static SemaphoreHandle_t xDrbgMutex = NULL;
+
+/**
+ * @brief Set once the first RNG request has tried to seed the DRBG.
+ */
+    static BaseType_t xDrbgStarted = pdFALSE;
+
+/**
+ * @brief Random bytes read from the token and not yet used as entropy.
+ */
+    static unsigned char ucEntropyPool[ PKCS11_RNG_ENTROPY_BLOCK_SIZE ];
+
+/**
+ * @brief Number of bytes left in #ucEntropyPool.
+ */
+    static size_t uxEntropyAvailable = 0U;
+
+/**
+ * @brief Session used to refill #ucEntropyPool, the one of the current request.
+ */
+    static CK_SESSION_HANDLE xEntropySession = CK_INVALID_HANDLE;
+
+/**
+ * @brief Entropy callback of the DRBG, served from #ucEntropyPool.
+ *
+ * @param[in] pvCtx Unused.
+ * @param[out] pucOutput Buffer to fill with entropy.
+ * @param[in] uxLen Length of pucOutput.
+ *
+ * @return 0 on success.
+ */
+    static int prvEntropyCallback( void * pvCtx,
+                                   unsigned char * pucOutput,
+                                   size_t uxLen );
+
+/**
+ * @brief Seed the DRBG on first use.
+ *
+ * @param[in] xSessionHandle Session to read the seed from.
+ *
+ * @return pdTRUE if the DRBG is seeded, else pdFALSE.
+ */
+    static BaseType_t prvStartDrbg( CK_SESSION_HANDLE xSessionHandle );
+
+#endif /* if ( PKCS11_RNG_DRBG_ENABLED == 1 ) */
+
+/*-----------------------------------------------------------*/
+
+static int prvGenerateRandom( CK_SESSION_HANDLE xSessionHandle,
+                              unsigned char * pucOutput,
+                              size_t uxLen )
+{
+    int lRslt;
+    CK_FUNCTION_LIST_PTR pxFunctionList = NULL;
+
+    lRslt = ( int ) C_GetFunctionList( &pxFunctionList );
+
+    if( ( lRslt != CKR_OK ) ||
+        ( pxFunctionList == NULL ) ||
+        ( pxFunctionList->C_GenerateRandom == NULL ) )
+    {
+        lRslt = -1;
+    }
+    else
+    {
+        lRslt = ( int ) pxFunctionList->C_GenerateRandom( xSessionHandle, pucOutput, uxLen );
+    }
+
+    return lRslt;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( PKCS11_RNG_DRBG_ENABLED == 1 )
+
+    static int prvEntropyCallback( void * pvCtx,
+                                   unsigned char * pucOutput,
+                                   size_t uxLen )
+    {
+        int lRslt = 0;
+        size_t uxCopyLen;
+
+        ( void ) pvCtx;
+
+        while( ( lRslt == 0 ) && ( uxLen > 0U ) )
+        {
+            if( uxEntropyAvailable == 0U )
+            {
+                if( prvGenerateRandom( xEntropySession, ucEntropyPool, sizeof( ucEntropyPool ) ) == CKR_OK )
+                {
+                    uxEntropyAvailable = sizeof( ucEntropyPool );
+                }
+                else
+                {
+                    LogError( ( "Failed to read entropy from the token." ) );
+                    lRslt = MBEDTLS_ERR_CTR_DRBG_ENTROPY_SOURCE_FAILED;
+                }
+            }
+
+            if( lRslt == 0 )
+            {
+                uxCopyLen = ( uxLen < uxEntropyAvailable ) ? uxLen : uxEntropyAvailable;
+
+                /* Take the bytes from the end of the pool and wipe them, so
+                 * entropy is never handed out twice. */
+                uxEntropyAvailable -= uxCopyLen;
+                ( void ) memcpy( pucOutput, &( ucEntropyPool[ uxEntropyAvailable ] ), uxCopyLen );
+                ( void ) memset( &( ucEntropyPool[ uxEntropyAvailable ] ), 0, uxCopyLen );
+
+                pucOutput = &( pucOutput[ uxCopyLen ] );
+                uxLen -= uxCopyLen;
+            }
+        }
+
+        return lRslt;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvStartDrbg( CK_SESSION_HANDLE xSessionHandle )
+    {
+        static const char cPersonalization[] = "PKCS11 RNG";
+        BaseType_t xSeed = pdFALSE;
+        SemaphoreHandle_t xMutex = NULL;
+        int lRslt = 0;
+
+        taskENTER_CRITICAL();
+        {
+            if( xDrbgStarted == pdFALSE )
+            {
+                xDrbgStarted = pdTRUE;
+                xSeed = pdTRUE;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( xSeed == pdTRUE )
+        {
+            xMutex = xSemaphoreCreateMutex();
+
+            if( xMutex == NULL )
+            {
+                LogError( ( "Failed to create the DRBG mutex, reading every request from the token." ) );
+            }
+            else
+            {
+                mbedtls_ctr_drbg_init( &xDrbgContext );
+                xEntropySession = xSessionHandle;
+
+                lRslt = mbedtls_ctr_drbg_seed( &xDrbgContext,
+                                               prvEntropyCallback,
+                                               NULL,
+                                               ( const unsigned char * ) cPersonalization,
+                                               sizeof( cPersonalization ) - 1U );
+
+                if( lRslt != 0 )
+                {
+                    LogError( ( "Failed to seed the DRBG, reading every request from the token: mbedTLSError= %d.",
+                                lRslt ) );
+                    mbedtls_ctr_drbg_free( &xDrbgContext );
+                    vSemaphoreDelete( xMutex );
+                }
+                else
+                {
+                    mbedtls_ctr_drbg_set_reseed_interval( &xDrbgContext, PKCS11_RNG_DRBG_RESEED_INTERVAL );
+                    xDrbgMutex = xMutex;
+                }
+            }
+        }
+
+        /* Requests made while another task is still seeding the DRBG are read
+         * from the token. */
+        return ( xDrbgMutex != NULL ) ? pdTRUE : pdFALSE;
+    }
+
+#endif /* if ( PKCS11_RNG_DRBG_ENABLED == 1 ) */
+
+/*-----------------------------------------------------------*/
+
 int lMbedCryptoRngCallbackPKCS11( void * pvCtx,
                                   unsigned char * pucOutput,
                                   size_t uxLen )
 {
-    int lRslt;
-    CK_FUNCTION_LIST_PTR pxFunctionList = NULL;
+    int lRslt = 0;
     CK_SESSION_HANDLE * pxSessionHandle = ( CK_SESSION_HANDLE * ) pvCtx;
+    BaseType_t xFromDrbg = pdFALSE;
 
     if( pucOutput == NULL )
     {
@@ -60,18 +299,36 @@ int lMbedCryptoRngCallbackPKCS11( void * pvCtx,
     }
     else
     {
-        lRslt = ( int ) C_GetFunctionList( &pxFunctionList );
-    }
+        #if ( PKCS11_RNG_DRBG_ENABLED == 1 )
+        {
+            size_t uxRequestLen;
 
-    if( ( lRslt != CKR_OK ) ||
-        ( pxFunctionList == NULL ) ||
-        ( pxFunctionList->C_GenerateRandom == NULL ) )
-    {
-        lRslt = -1;
-    }
-    else
-    {
-        lRslt = ( int ) pxFunctionList->C_GenerateRandom( *pxSessionHandle, pucOutput, uxLen );
+            if( prvStartDrbg( *pxSessionHandle ) == pdTRUE )
+            {
+                ( void ) xSemaphoreTake( xDrbgMutex, portMAX_DELAY );
+                {
+                    /* A reseed during this request reads from the caller's session. */
+                    xEntropySession = *pxSessionHandle;
+
+                    while( ( lRslt == 0 ) && ( uxLen > 0U ) )
+                    {
+                        uxRequestLen = ( uxLen < MBEDTLS_CTR_DRBG_MAX_REQUEST ) ? uxLen : MBEDTLS_CTR_DRBG_MAX_REQUEST;
+                        lRslt = mbedtls_ctr_drbg_random( &xDrbgContext, pucOutput, uxRequestLen );
+                        pucOutput = &( pucOutput[ uxRequestLen ] );
+                        uxLen -= uxRequestLen;
+                    }
+                }
+                ( void ) xSemaphoreGive( xDrbgMutex );
+
+                xFromDrbg = pdTRUE;
+            }
+        }
+        #endif /* if ( PKCS11_RNG_DRBG_ENABLED == 1 ) */
+
+        if( xFromDrbg == pdFALSE )
+        {
+            lRslt = prvGenerateRandom( *pxSessionHandle, pucOutput, uxLen );
+        }
     }
 
     return lRslt;
@@ -39,6 +39,9 @@
 /* FreeRTOS Kernel includes. */
 #include "FreeRTOS.h"
 
+/* Transport interface include. */
+#include "transport_interface.h"
+
 /* Error codes. */
 #define TCP_SOCKETS_ERRNO_NONE                ( 0 )   /*!< No error. */
 #define TCP_SOCKETS_ERRNO_ERROR               ( -1 )  /*!< Catch-all sockets error code. */
@@ -81,9 +84,19 @@ BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
  * @brief End connection to server.
  *
  * @param[in] tcpSocket The socket descriptor.
+ *
+ * @note A port may finish the graceful shutdown and close the socket in the
+ * background after this function returns. The socket must not be used again.
  */
 void TCP_Sockets_Disconnect( Socket_t tcpSocket );
 
+/**
+ * @brief Check whether a socket is still connected to the server.
+ * @param[in] xSocket The socket descriptor.
+ * @return pdTRUE if the connection is established, else pdFALSE.
+ */
+BaseType_t TCP_Sockets_IsConnected( Socket_t xSocket );
+
 /**
  * @brief Transmit data to the remote socket.
  *
@@ -101,6 +114,21 @@ int32_t TCP_Sockets_Send( Socket_t xSocket,
                           const void * pvBuffer,
                           size_t xDataLength );
 
+/**
+ * @brief Transmit several buffers to the remote socket, in order.
+ * The socket must have already been created using a call to TCP_Sockets_Connect().
+ * @param[in] xSocket The handle of the sending socket.
+ * @param[in] pxIoVec The buffers containing the data to be sent.
+ * @param[in] xIoVecCount The number of buffers in pxIoVec.
+ * @return
+ * * On success, the number of bytes actually sent is returned. It is less than
+ *   the total length of the buffers if the socket could not take all of them.
+ * * If an error occurred before any byte was sent, a negative value is returned. @ref SocketsErrors
+ */
+int32_t TCP_Sockets_SendVector( Socket_t xSocket,
+                                const TransportOutVector_t * pxIoVec,
+                                size_t xIoVecCount );
+
 /**
  * @brief Receive data from a TCP socket.
  *
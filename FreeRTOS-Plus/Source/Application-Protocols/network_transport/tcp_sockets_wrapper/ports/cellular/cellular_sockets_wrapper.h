@@ -0,0 +1,51 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file cellular_sockets_wrapper.h
+ * @brief Functions of the cellular port of the TCP sockets wrapper that the
+ * other ports do not have.
+ */
+
+#ifndef CELLULAR_SOCKETS_WRAPPER_H
+#define CELLULAR_SOCKETS_WRAPPER_H
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* TCP sockets wrapper includes. */
+#include "tcp_sockets_wrapper.h"
+
+/**
+ * @brief Get the receive statistics of the cellular port, over all sockets.
+ *
+ * @param[out] pRecvCommands Number of Cellular_SocketRecv() commands issued. May be NULL.
+ * @param[out] pRecvBytes Number of bytes received by these commands. May be NULL.
+ */
+void TCP_Sockets_CellularGetRecvStatistics( uint32_t * pRecvCommands,
+                                            uint32_t * pRecvBytes );
+
+#endif /* ifndef CELLULAR_SOCKETS_WRAPPER_H */
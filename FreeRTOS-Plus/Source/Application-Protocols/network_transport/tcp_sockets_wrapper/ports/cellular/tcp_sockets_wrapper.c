@@ -61,6 +61,7 @@ extern void vLoggingPrintf( const char * pcFormatString,
 
 /* TCP sockets wrapper includes. */
 #include "tcp_sockets_wrapper.h"
+#include "cellular_sockets_wrapper.h"
 
 /* FreeRTOS Cellular Library api includes. */
 #include "cellular_config.h"
@@ -122,6 +123,20 @@ extern uint8_t CellularSocketPdnContextId;
 /* Invalid socket. */
 #define CELLULAR_INVALID_SOCKET                ( ( Socket_t ) ~0U )
 
+/* Size of the receive buffer of each socket. Every Cellular_SocketRecv() fills
+ * the buffer as far as the modem allows, and smaller reads are then served
+ * from RAM, so a TLS record header and its body do not cost one AT command
+ * each. Set to 0 to pass every read to the modem. */
+#ifndef CELLULAR_SOCKET_RECV_BUFFER_SIZE
+    #define CELLULAR_SOCKET_RECV_BUFFER_SIZE    ( CELLULAR_MAX_RECV_DATA_LEN )
+#endif
+
+/* Size of the stack buffer TCP_Sockets_SendVector() gathers small buffers in,
+ * so they are sent with one Cellular_SocketSend() instead of one each. */
+#ifndef CELLULAR_SOCKET_SEND_GATHER_SIZE
+    #define CELLULAR_SOCKET_SEND_GATHER_SIZE    ( 256U )
+#endif
+
 /*-----------------------------------------------------------*/
 
 typedef struct xSOCKET
@@ -133,10 +148,23 @@ typedef struct xSOCKET
     TickType_t sendTimeout;
 
     EventGroupHandle_t socketEventGroupHandle;
+
+    #if ( CELLULAR_SOCKET_RECV_BUFFER_SIZE > 0 )
+        uint8_t recvBuffer[ CELLULAR_SOCKET_RECV_BUFFER_SIZE ];
+        size_t recvBufferHead;   /* Index of the first unread byte in recvBuffer. */
+        size_t recvBufferLength; /* Number of unread bytes in recvBuffer. */
+    #endif
 } cellularSocketWrapper_t;
 
 /*-----------------------------------------------------------*/
 
+/* Number of Cellular_SocketRecv() commands issued to receive data, and the
+ * number of bytes they returned, over all sockets. */
+static uint32_t recvCommandCount = 0;
+static uint32_t recvByteCount = 0;
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Get the count of milliseconds since vTaskStartScheduler was called.
  *
@@ -164,6 +192,33 @@ static BaseType_t prvNetworkRecvCellular( const cellularSocketWrapper_t * pCellu
                                           uint8_t * buf,
                                           size_t len );
 
+/**
+ * @brief Receive data through the receive buffer of the socket.
+ *
+ * @param[in] pCellularSocketContext Cellular socket wrapper context for socket operations.
+ * @param[out] buf The data buffer for receiving data.
+ * @param[in] len The length of the data buffer
+ *
+ * @note Buffered data is returned without waiting. Otherwise, reads smaller
+ * than the receive buffer refill it with one Cellular_SocketRecv(), and larger
+ * reads are passed to prvNetworkRecvCellular directly.
+ *
+ * @return Positive value indicate the number of bytes received. Otherwise, error code defined
+ * in sockets_wrapper.h is returned.
+ */
+static BaseType_t prvNetworkRecvBuffered( cellularSocketWrapper_t * pCellularSocketContext,
+                                          uint8_t * buf,
+                                          size_t len );
+
+/**
+ * @brief Get the number of received bytes not yet read from the socket.
+ *
+ * @param[in] pCellularSocketContext Cellular socket wrapper context for socket operations.
+ *
+ * @return The number of bytes in the receive buffer of the socket.
+ */
+static size_t prvBufferedLength( const cellularSocketWrapper_t * pCellularSocketContext );
+
 /**
  * @brief Callback used to inform about the status of socket open.
  *
@@ -306,6 +361,7 @@ static BaseType_t prvNetworkRecvCellular( const cellularSocketWrapper_t * pCellu
     ( void ) xEventGroupClearBits( pCellularSocketContext->socketEventGroupHandle,
                                    SOCKET_DATA_RECEIVED_CALLBACK_BIT );
     socketStatus = Cellular_SocketRecv( CellularHandle, cellularSocketHandle, buf, len, &recvLength );
+    recvCommandCount++;
 
     /* Calculate remain recvTimeout. */
     if( recvTimeout != portMAX_DELAY )
@@ -336,6 +392,7 @@ static BaseType_t prvNetworkRecvCellular( const cellularSocketWrapper_t * pCellu
         else if( ( waitEventBits & SOCKET_DATA_RECEIVED_CALLBACK_BIT ) != 0U )
         {
             socketStatus = Cellular_SocketRecv( CellularHandle, cellularSocketHandle, buf, len, &recvLength );
+            recvCommandCount++;
         }
         else
         {
@@ -348,6 +405,7 @@ static BaseType_t prvNetworkRecvCellular( const cellularSocketWrapper_t * pCellu
     if( socketStatus == CELLULAR_SUCCESS )
     {
         retRecvLength = ( BaseType_t ) recvLength;
+        recvByteCount += recvLength;
     }
     else if( socketStatus == CELLULAR_SOCKET_CLOSED )
     {
@@ -365,6 +423,78 @@ static BaseType_t prvNetworkRecvCellular( const cellularSocketWrapper_t * pCellu
 
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvNetworkRecvBuffered( cellularSocketWrapper_t * pCellularSocketContext,
+                                          uint8_t * buf,
+                                          size_t len )
+{
+    BaseType_t retRecvLength = 0;
+
+    #if ( CELLULAR_SOCKET_RECV_BUFFER_SIZE > 0 )
+        size_t copyLength = 0;
+
+        if( pCellularSocketContext->recvBufferLength == 0U )
+        {
+            if( len >= CELLULAR_SOCKET_RECV_BUFFER_SIZE )
+            {
+                /* The read is as large as the buffer, copying gains nothing. */
+                retRecvLength = prvNetworkRecvCellular( pCellularSocketContext, buf, len );
+            }
+            else
+            {
+                retRecvLength = prvNetworkRecvCellular( pCellularSocketContext,
+                                                        pCellularSocketContext->recvBuffer,
+                                                        CELLULAR_SOCKET_RECV_BUFFER_SIZE );
+
+                if( retRecvLength > 0 )
+                {
+                    pCellularSocketContext->recvBufferHead = 0U;
+                    pCellularSocketContext->recvBufferLength = ( size_t ) retRecvLength;
+                }
+            }
+        }
+
+        if( pCellularSocketContext->recvBufferLength > 0U )
+        {
+            if( len < pCellularSocketContext->recvBufferLength )
+            {
+                copyLength = len;
+            }
+            else
+            {
+                copyLength = pCellularSocketContext->recvBufferLength;
+            }
+
+            ( void ) memcpy( buf,
+                             &pCellularSocketContext->recvBuffer[ pCellularSocketContext->recvBufferHead ],
+                             copyLength );
+            pCellularSocketContext->recvBufferHead += copyLength;
+            pCellularSocketContext->recvBufferLength -= copyLength;
+            retRecvLength = ( BaseType_t ) copyLength;
+        }
+    #else /* if ( CELLULAR_SOCKET_RECV_BUFFER_SIZE > 0 ) */
+        retRecvLength = prvNetworkRecvCellular( pCellularSocketContext, buf, len );
+    #endif /* if ( CELLULAR_SOCKET_RECV_BUFFER_SIZE > 0 ) */
+
+    return retRecvLength;
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t prvBufferedLength( const cellularSocketWrapper_t * pCellularSocketContext )
+{
+    size_t bufferedLength = 0;
+
+    #if ( CELLULAR_SOCKET_RECV_BUFFER_SIZE > 0 )
+        bufferedLength = pCellularSocketContext->recvBufferLength;
+    #else
+        ( void ) pCellularSocketContext;
+    #endif
+
+    return bufferedLength;
+}
+
+/*-----------------------------------------------------------*/
+
 static void prvCellularSocketOpenCallback( CellularUrcEvent_t urcEvent,
                                            CellularSocketHandle_t socketHandle,
                                            void * pCallbackContext )
@@ -807,6 +937,28 @@ void TCP_Sockets_Disconnect( Socket_t xSocket )
 
 /*-----------------------------------------------------------*/
 
+BaseType_t TCP_Sockets_IsConnected( Socket_t xSocket )
+{
+    const cellularSocketWrapper_t * pCellularSocketContext = ( const cellularSocketWrapper_t * ) xSocket;
+    BaseType_t connected = pdFALSE;
+
+    /* xSocket need to be check against SOCKET_INVALID_SOCKET. */
+    /* coverity[misra_c_2012_rule_11_4_violation] */
+    if( ( pCellularSocketContext != NULL ) && ( xSocket != CELLULAR_INVALID_SOCKET ) )
+    {
+        /* The closed callback clears the connect flag. */
+        if( ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_OPEN_FLAG ) != 0U ) &&
+            ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_CONNECT_FLAG ) != 0U ) )
+        {
+            connected = pdTRUE;
+        }
+    }
+
+    return connected;
+}
+
+/*-----------------------------------------------------------*/
+
 int32_t TCP_Sockets_Recv( Socket_t xSocket,
                           void * pvBuffer,
                           size_t xBufferLength )
@@ -820,16 +972,19 @@ int32_t TCP_Sockets_Recv( Socket_t xSocket,
         LogError( ( "Cellular prvNetworkRecv Invalid xSocket %p", pCellularSocketContext ) );
         retRecvLength = ( BaseType_t ) TCP_SOCKETS_ERRNO_EINVAL;
     }
-    else if( ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_OPEN_FLAG ) == 0U ) ||
-             ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_CONNECT_FLAG ) == 0U ) )
+    else if( ( ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_OPEN_FLAG ) == 0U ) ||
+               ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_CONNECT_FLAG ) == 0U ) ) &&
+             ( prvBufferedLength( pCellularSocketContext ) == 0U ) )
     {
+        /* Data received before the remote end closed the connection is still
+         * returned from the receive buffer. */
         LogError( ( "Cellular prvNetworkRecv Invalid xSocket flag %p %u",
                     pCellularSocketContext, pCellularSocketContext->ulFlags ) );
         retRecvLength = ( BaseType_t ) TCP_SOCKETS_ERRNO_ENOTCONN;
     }
     else
     {
-        retRecvLength = ( BaseType_t ) prvNetworkRecvCellular( pCellularSocketContext, buf, xBufferLength );
+        retRecvLength = ( BaseType_t ) prvNetworkRecvBuffered( pCellularSocketContext, buf, xBufferLength );
     }
 
     return retRecvLength;
@@ -923,3 +1078,90 @@ int32_t TCP_Sockets_Send( Socket_t xSocket,
 }
 
 /*-----------------------------------------------------------*/
+
+/* Consecutive buffers shorter than CELLULAR_SOCKET_SEND_GATHER_SIZE are copied
+ * together and sent with one TCP_Sockets_Send(). Sending stops at the first
+ * send that does not complete. */
+int32_t TCP_Sockets_SendVector( Socket_t xSocket,
+                                const TransportOutVector_t * pxIoVec,
+                                size_t xIoVecCount )
+{
+    uint8_t gatherBuffer[ CELLULAR_SOCKET_SEND_GATHER_SIZE ];
+    size_t gatheredLength = 0;
+    size_t vectorIndex = 0;
+    const uint8_t * pFragment = NULL;
+    size_t fragmentLength = 0;
+    int32_t sendStatus = 0;
+    int32_t retSendLength = 0;
+    BaseType_t keepSending = pdTRUE;
+
+    configASSERT( pxIoVec != NULL );
+
+    /* Walk one vector past the end to flush what is left in the gather buffer. */
+    for( vectorIndex = 0; ( vectorIndex <= xIoVecCount ) && ( keepSending == pdTRUE ); vectorIndex++ )
+    {
+        pFragment = ( vectorIndex < xIoVecCount ) ? ( const uint8_t * ) pxIoVec[ vectorIndex ].iov_base : NULL;
+        fragmentLength = ( vectorIndex < xIoVecCount ) ? pxIoVec[ vectorIndex ].iov_len : 0U;
+
+        if( ( gatheredLength > 0U ) &&
+            ( ( vectorIndex == xIoVecCount ) || ( ( gatheredLength + fragmentLength ) > sizeof( gatherBuffer ) ) ) )
+        {
+            sendStatus = TCP_Sockets_Send( xSocket, gatherBuffer, gatheredLength );
+            keepSending = ( sendStatus == ( int32_t ) gatheredLength ) ? pdTRUE : pdFALSE;
+            gatheredLength = 0;
+
+            if( sendStatus > 0 )
+            {
+                retSendLength += sendStatus;
+            }
+            else if( retSendLength == 0 )
+            {
+                retSendLength = sendStatus;
+            }
+        }
+
+        if( ( keepSending == pdFALSE ) || ( fragmentLength == 0U ) )
+        {
+            /* Nothing to send from this vector. */
+        }
+        else if( fragmentLength >= sizeof( gatherBuffer ) )
+        {
+            sendStatus = TCP_Sockets_Send( xSocket, pFragment, fragmentLength );
+            keepSending = ( sendStatus == ( int32_t ) fragmentLength ) ? pdTRUE : pdFALSE;
+
+            if( sendStatus > 0 )
+            {
+                retSendLength += sendStatus;
+            }
+            else if( retSendLength == 0 )
+            {
+                retSendLength = sendStatus;
+            }
+        }
+        else
+        {
+            ( void ) memcpy( &gatherBuffer[ gatheredLength ], pFragment, fragmentLength );
+            gatheredLength += fragmentLength;
+        }
+    }
+
+    return retSendLength;
+}
+
+/*-----------------------------------------------------------*/
+
+void TCP_Sockets_CellularGetRecvStatistics( uint32_t * pRecvCommands,
+                                            uint32_t * pRecvBytes )
+{
+    if( pRecvCommands != NULL )
+    {
+        *pRecvCommands = recvCommandCount;
+    }
+
+    if( pRecvBytes != NULL )
+    {
+        *pRecvBytes = recvByteCount;
+    }
+}
+
+/*-----------------------------------------------------------*/
@@ -50,6 +50,8 @@ extern void vLoggingPrintf( const char * pcFormatString,
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
 
 /* FreeRTOS+TCP includes. */
 #include "FreeRTOS_IP.h"
@@ -73,6 +75,464 @@ extern void vLoggingPrintf( const char * pcFormatString,
  */
 #define FREERTOS_SOCKETS_WRAPPER_NETWORK_ERROR    ( -1 )
 
+/**
+ * @brief Set to 1 to let TCP_Sockets_SendVector() copy the buffers straight
+ * into the TX stream of the socket, so they are queued with a single call to
+ * FreeRTOS_send().
+ */
+#ifndef FREERTOS_SOCKETS_WRAPPER_ZERO_COPY_TX
+    #define FREERTOS_SOCKETS_WRAPPER_ZERO_COPY_TX    ( 1 )
+#endif
+
+/**
+ * @brief Number of host names whose DNS result TCP_Sockets_Connect() caches.
+ * Set to 0 to resolve the host name on every connection.
+ *
+ * FreeRTOS_gethostbyname() does not report the TTL of the record, so cached
+ * results expire after the fixed times below.
+ */
+#ifndef FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_ENTRIES
+    #define FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_ENTRIES    ( 4 )
+#endif
+
+/**
+ * @brief Time (in milliseconds) for which a resolved address is reused.
+ */
+#ifndef FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_TTL_MS
+    #define FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_TTL_MS    ( 300000U )
+#endif
+
+/**
+ * @brief Time (in milliseconds) for which a failed resolution is remembered,
+ * so connection retries fail fast instead of waiting for the DNS timeout each time.
+ */
+#ifndef FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_NEGATIVE_TTL_MS
+    #define FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_NEGATIVE_TTL_MS    ( 10000U )
+#endif
+
+/**
+ * @brief Longest host name that is cached.
+ */
+#ifndef FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_MAX_HOSTNAME_LENGTH
+    #define FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_MAX_HOSTNAME_LENGTH    ( 64U )
+#endif
+
+/**
+ * @brief Set to 1 to let TCP_Sockets_Disconnect() return right after starting
+ * the graceful shutdown. A reaper task then waits for the peer to close the
+ * connection and closes the socket.
+ */
+#ifndef FREERTOS_SOCKETS_WRAPPER_ASYNC_DISCONNECT
+    #define FREERTOS_SOCKETS_WRAPPER_ASYNC_DISCONNECT    ( 0 )
+#endif
+
+/**
+ * @brief Time (in milliseconds) the reaper task waits for the peer to complete
+ * the graceful shutdown before closing the socket anyway. Set to 0 to close the
+ * socket as soon as the reaper task picks it up.
+ */
+#ifndef FREERTOS_SOCKETS_WRAPPER_LINGER_MS
+    #define FREERTOS_SOCKETS_WRAPPER_LINGER_MS    ( 2000U )
+#endif
+
+/**
+ * @brief Maximum number of sockets waiting for the reaper task. When they are
+ * all taken, TCP_Sockets_Disconnect() closes the socket itself.
+ */
+#ifndef FREERTOS_SOCKETS_WRAPPER_REAPER_MAX_SOCKETS
+    #define FREERTOS_SOCKETS_WRAPPER_REAPER_MAX_SOCKETS    ( 4U )
+#endif
+
+/**
+ * @brief Interval (in milliseconds) at which the reaper task checks whether
+ * the lingering sockets have been shut down.
+ */
+#ifndef FREERTOS_SOCKETS_WRAPPER_REAPER_POLL_MS
+    #define FREERTOS_SOCKETS_WRAPPER_REAPER_POLL_MS    ( 50U )
+#endif
+
+/**
+ * @brief Stack size and priority of the reaper task.
+ */
+#ifndef FREERTOS_SOCKETS_WRAPPER_REAPER_STACK_SIZE
+    #define FREERTOS_SOCKETS_WRAPPER_REAPER_STACK_SIZE    ( configMINIMAL_STACK_SIZE )
+#endif
+#ifndef FREERTOS_SOCKETS_WRAPPER_REAPER_PRIORITY
+    #define FREERTOS_SOCKETS_WRAPPER_REAPER_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+#endif
+
+#if ( FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_ENTRIES > 0 )
+
+/**
+ * @brief Cached result of a host name resolution.
+ */
+    typedef struct DnsCacheEntry
+    {
+        char cHostName[ FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_MAX_HOSTNAME_LENGTH + 1U ]; /**< @brief Host name, empty if the entry is unused. */
+        uint32_t ulIPAddress;                                                           /**< @brief Resolved address, or 0 if the resolution failed. */
+        TickType_t xResolvedTime;                                                       /**< @brief Tick count when the host name was resolved. */
+    } DnsCacheEntry_t;
+
+/**
+ * @brief DNS results cached by TCP_Sockets_Connect().
+ */
+    static DnsCacheEntry_t xDnsCache[ FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_ENTRIES ];
+
+/**
+ * @brief Look a host name up in the DNS cache.
+ *
+ * @param[in] pHostName Host name to look up.
+ * @param[out] pulIPAddress Cached address, 0 for a cached failure.
+ *
+ * @return pdTRUE if an unexpired entry was found, else pdFALSE.
+ */
+    static BaseType_t prvDnsCacheLookup( const char * pHostName,
+                                         uint32_t * pulIPAddress );
+
+/**
+ * @brief Store the result of a host name resolution in the DNS cache,
+ * replacing the oldest entry if the cache is full.
+ *
+ * @param[in] pHostName Resolved host name.
+ * @param[in] ulIPAddress Resolved address, 0 if the resolution failed.
+ */
+    static void prvDnsCacheStore( const char * pHostName,
+                                  uint32_t ulIPAddress );
+
+/**
+ * @brief Remove a host name from the DNS cache.
+ *
+ * @param[in] pHostName Host name to remove.
+ */
+    static void prvDnsCacheRemove( const char * pHostName );
+
+#endif /* if ( FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_ENTRIES > 0 ) */
+
+#if ( FREERTOS_SOCKETS_WRAPPER_ASYNC_DISCONNECT == 1 )
+
+/**
+ * @brief Queue of the sockets handed to the reaper task, NULL until the
+ * reaper task is running.
+ */
+    static QueueHandle_t xReaperQueue = NULL;
+
+/**
+ * @brief Set once the first disconnect has tried to start the reaper task.
+ */
+    static BaseType_t xReaperStarted = pdFALSE;
+
+/**
+ * @brief Start the reaper task on first use.
+ *
+ * @return pdTRUE if the reaper task is running, else pdFALSE.
+ */
+    static BaseType_t prvStartReaper( void );
+
+/**
+ * @brief Task closing the sockets handed over by TCP_Sockets_Disconnect()
+ * once the peer has shut down the connection or the linger time has passed.
+ *
+ * @param[in] pvParameters Unused.
+ */
+    static void prvReaperTask( void * pvParameters );
+
+#endif /* if ( FREERTOS_SOCKETS_WRAPPER_ASYNC_DISCONNECT == 1 ) */
+
+/**
+ * @brief Resolve a host name, using the DNS cache when it is enabled.
+ *
+ * @param[in] pHostName Host name to resolve.
+ * @param[out] pxFromCache Set to pdTRUE if the result came from the cache.
+ *
+ * @return IPv4 address in network byte order, or 0 if the resolution failed.
+ */
+static uint32_t prvResolveHostName( const char * pHostName,
+                                    BaseType_t * pxFromCache );
+
+/**
+ * @brief Convert the return value of FreeRTOS_send() to a sockets wrapper
+ * error code.
+ *
+ * @param[in] xSendStatus Return value of FreeRTOS_send().
+ *
+ * @return Number of bytes sent, or a negative value. @ref SocketsErrors
+ */
+static int32_t prvSendStatusToErrno( BaseType_t xSendStatus );
+
+static int32_t prvSendStatusToErrno( BaseType_t xSendStatus )
+{
+    int xReturnStatus = TCP_SOCKETS_ERRNO_ERROR;
+
+    switch( xSendStatus )
+    {
+        /* Socket was closed or just got closed. */
+        case -pdFREERTOS_ERRNO_ENOTCONN:
+            xReturnStatus = TCP_SOCKETS_ERRNO_ENOTCONN;
+            break;
+
+        /* Not enough memory for the socket to create either an Rx or Tx stream. */
+        case -pdFREERTOS_ERRNO_ENOMEM:
+            xReturnStatus = TCP_SOCKETS_ERRNO_ENOMEM;
+            break;
+
+        /* Socket is not valid, is not a TCP socket, or is not bound. */
+        case -pdFREERTOS_ERRNO_EINVAL:
+            xReturnStatus = TCP_SOCKETS_ERRNO_EINVAL;
+            break;
+
+        /* Socket received a signal, causing the read operation to be aborted. */
+        case -pdFREERTOS_ERRNO_EINTR:
+            xReturnStatus = TCP_SOCKETS_ERRNO_EINTR;
+            break;
+
+        /* A timeout occurred before any data could be sent as the TCP buffer was full. */
+        case -pdFREERTOS_ERRNO_ENOSPC:
+            xReturnStatus = TCP_SOCKETS_ERRNO_ENOSPC;
+            break;
+
+        default:
+            xReturnStatus = ( int ) xSendStatus;
+            break;
+    }
+
+    return xReturnStatus;
+}
+
+#if ( FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_ENTRIES > 0 )
+
+    static BaseType_t prvDnsCacheLookup( const char * pHostName,
+                                         uint32_t * pulIPAddress )
+    {
+        BaseType_t xFound = pdFALSE;
+        TickType_t xTimeToLive;
+        size_t uxIndex;
+
+        taskENTER_CRITICAL();
+        {
+            for( uxIndex = 0U; uxIndex < ( size_t ) FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_ENTRIES; uxIndex++ )
+            {
+                if( ( xDnsCache[ uxIndex ].cHostName[ 0 ] != '\0' ) &&
+                    ( strcmp( xDnsCache[ uxIndex ].cHostName, pHostName ) == 0 ) )
+                {
+                    xTimeToLive = ( xDnsCache[ uxIndex ].ulIPAddress != 0U ) ?
+                                  pdMS_TO_TICKS( FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_TTL_MS ) :
+                                  pdMS_TO_TICKS( FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_NEGATIVE_TTL_MS );
+
+                    if( ( xTaskGetTickCount() - xDnsCache[ uxIndex ].xResolvedTime ) < xTimeToLive )
+                    {
+                        *pulIPAddress = xDnsCache[ uxIndex ].ulIPAddress;
+                        xFound = pdTRUE;
+                    }
+                    else
+                    {
+                        /* Expired. */
+                        xDnsCache[ uxIndex ].cHostName[ 0 ] = '\0';
+                    }
+
+                    break;
+                }
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        return xFound;
+    }
+
+    static void prvDnsCacheStore( const char * pHostName,
+                                  uint32_t ulIPAddress )
+    {
+        TickType_t xNow;
+        TickType_t xOldestAge = 0U;
+        size_t uxIndex;
+        size_t uxSlot = 0U;
+        size_t uxHostNameLength = strlen( pHostName );
+
+        if( uxHostNameLength <= FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_MAX_HOSTNAME_LENGTH )
+        {
+            taskENTER_CRITICAL();
+            {
+                xNow = xTaskGetTickCount();
+
+                /* Reuse the entry of the same host name or a free one, else
+                 * replace the oldest. */
+                for( uxIndex = 0U; uxIndex < ( size_t ) FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_ENTRIES; uxIndex++ )
+                {
+                    if( ( xDnsCache[ uxIndex ].cHostName[ 0 ] == '\0' ) ||
+                        ( strcmp( xDnsCache[ uxIndex ].cHostName, pHostName ) == 0 ) )
+                    {
+                        uxSlot = uxIndex;
+                        break;
+                    }
+
+                    if( ( xNow - xDnsCache[ uxIndex ].xResolvedTime ) >= xOldestAge )
+                    {
+                        xOldestAge = xNow - xDnsCache[ uxIndex ].xResolvedTime;
+                        uxSlot = uxIndex;
+                    }
+                }
+
+                ( void ) memcpy( xDnsCache[ uxSlot ].cHostName, pHostName, uxHostNameLength + 1U );
+                xDnsCache[ uxSlot ].ulIPAddress = ulIPAddress;
+                xDnsCache[ uxSlot ].xResolvedTime = xNow;
+            }
+            taskEXIT_CRITICAL();
+        }
+    }
+
+    static void prvDnsCacheRemove( const char * pHostName )
+    {
+        size_t uxIndex;
+
+        taskENTER_CRITICAL();
+        {
+            for( uxIndex = 0U; uxIndex < ( size_t ) FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_ENTRIES; uxIndex++ )
+            {
+                if( strcmp( xDnsCache[ uxIndex ].cHostName, pHostName ) == 0 )
+                {
+                    xDnsCache[ uxIndex ].cHostName[ 0 ] = '\0';
+                }
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+
+#endif /* if ( FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_ENTRIES > 0 ) */
+
+#if ( FREERTOS_SOCKETS_WRAPPER_ASYNC_DISCONNECT == 1 )
+
+    static BaseType_t prvStartReaper( void )
+    {
+        BaseType_t xCreate = pdFALSE;
+        QueueHandle_t xQueue = NULL;
+
+        taskENTER_CRITICAL();
+        {
+            if( xReaperStarted == pdFALSE )
+            {
+                xReaperStarted = pdTRUE;
+                xCreate = pdTRUE;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( xCreate == pdTRUE )
+        {
+            xQueue = xQueueCreate( FREERTOS_SOCKETS_WRAPPER_REAPER_MAX_SOCKETS, sizeof( Socket_t ) );
+
+            if( xQueue == NULL )
+            {
+                LogWarn( ( "Failed to create the reaper queue, sockets are closed synchronously." ) );
+            }
+            else if( xTaskCreate( prvReaperTask,
+                                  "SocketReaper",
+                                  FREERTOS_SOCKETS_WRAPPER_REAPER_STACK_SIZE,
+                                  xQueue,
+                                  FREERTOS_SOCKETS_WRAPPER_REAPER_PRIORITY,
+                                  NULL ) != pdPASS )
+            {
+                LogWarn( ( "Failed to create the reaper task, sockets are closed synchronously." ) );
+                vQueueDelete( xQueue );
+            }
+            else
+            {
+                xReaperQueue = xQueue;
+            }
+        }
+
+        /* Sockets disconnected while another task is still starting the reaper
+         * task are closed synchronously. */
+        return ( xReaperQueue != NULL ) ? pdTRUE : pdFALSE;
+    }
+
+    static void prvReaperTask( void * pvParameters )
+    {
+        QueueHandle_t xQueue = ( QueueHandle_t ) pvParameters;
+        Socket_t xLingering[ FREERTOS_SOCKETS_WRAPPER_REAPER_MAX_SOCKETS ];
+        TickType_t xShutdownTime[ FREERTOS_SOCKETS_WRAPPER_REAPER_MAX_SOCKETS ];
+        size_t uxCount = 0U;
+        size_t uxIndex;
+        TickType_t xBlockTime;
+        BaseType_t xReceived;
+        uint8_t pDummyBuffer[ 2 ];
+
+        for( ; ; )
+        {
+            /* Block until a socket is handed over when none is lingering. */
+            xBlockTime = ( uxCount == 0U ) ? portMAX_DELAY : pdMS_TO_TICKS( FREERTOS_SOCKETS_WRAPPER_REAPER_POLL_MS );
+
+            if( uxCount < FREERTOS_SOCKETS_WRAPPER_REAPER_MAX_SOCKETS )
+            {
+                if( xQueueReceive( xQueue, &( xLingering[ uxCount ] ), xBlockTime ) == pdTRUE )
+                {
+                    xShutdownTime[ uxCount ] = xTaskGetTickCount();
+                    uxCount++;
+                }
+            }
+            else
+            {
+                /* Leave further sockets in the queue until one is closed. */
+                vTaskDelay( xBlockTime );
+            }
+
+            uxIndex = 0U;
+
+            while( uxIndex < uxCount )
+            {
+                /* FreeRTOS_recv() fails with an error other than EWOULDBLOCK once
+                 * the connection is closed. */
+                xReceived = FreeRTOS_recv( xLingering[ uxIndex ], pDummyBuffer, sizeof( pDummyBuffer ), FREERTOS_MSG_DONTWAIT );
+
+                if( ( ( xReceived < 0 ) && ( xReceived != -pdFREERTOS_ERRNO_EWOULDBLOCK ) ) ||
+                    ( ( xTaskGetTickCount() - xShutdownTime[ uxIndex ] ) >= pdMS_TO_TICKS( FREERTOS_SOCKETS_WRAPPER_LINGER_MS ) ) )
+                {
+                    ( void ) FreeRTOS_closesocket( xLingering[ uxIndex ] );
+
+                    /* Move the last lingering socket into the freed place. */
+                    uxCount--;
+                    xLingering[ uxIndex ] = xLingering[ uxCount ];
+                    xShutdownTime[ uxIndex ] = xShutdownTime[ uxCount ];
+                }
+                else
+                {
+                    uxIndex++;
+                }
+            }
+        }
+    }
+
+#endif /* if ( FREERTOS_SOCKETS_WRAPPER_ASYNC_DISCONNECT == 1 ) */
+
+static uint32_t prvResolveHostName( const char * pHostName,
+                                    BaseType_t * pxFromCache )
+{
+    uint32_t ulIPAddress = 0U;
+
+    *pxFromCache = pdFALSE;
+
+    #if ( FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_ENTRIES > 0 )
+    {
+        *pxFromCache = prvDnsCacheLookup( pHostName, &ulIPAddress );
+    }
+    #endif
+
+    if( *pxFromCache == pdFALSE )
+    {
+        ulIPAddress = ( uint32_t ) FreeRTOS_gethostbyname( pHostName );
+
+        #if ( FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_ENTRIES > 0 )
+        {
+            prvDnsCacheStore( pHostName, ulIPAddress );
+        }
+        #endif
+    }
+    else
+    {
+        LogDebug( ( "Using cached DNS result for %s.", pHostName ) );
+    }
+
+    return ulIPAddress;
+}
+
 /**
  * @brief Establish a connection to server.
  *
@@ -96,6 +556,8 @@ BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
     BaseType_t socketStatus = 0;
     struct freertos_sockaddr serverAddress = { 0 };
     TickType_t transportTimeout = 0;
+    uint32_t ulServerAddress = 0U;
+    BaseType_t xAddressFromCache = pdFALSE;
 
     configASSERT( pTcpSocket != NULL );
     configASSERT( pHostName != NULL );
@@ -117,16 +579,16 @@ BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
         serverAddress.sin_port = FreeRTOS_htons( port );
         serverAddress.sin_len = ( uint8_t ) sizeof( serverAddress );
 
+        ulServerAddress = prvResolveHostName( pHostName, &xAddressFromCache );
+
 #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
-        serverAddress.sin_address.ulIP_IPv4 = ( uint32_t ) FreeRTOS_gethostbyname( pHostName );
-        /* Check for errors from DNS lookup. */
-        if( serverAddress.sin_address.ulIP_IPv4 == 0U )
+        serverAddress.sin_address.ulIP_IPv4 = ulServerAddress;
 #else
-        serverAddress.sin_addr = ( uint32_t ) FreeRTOS_gethostbyname( pHostName );
-        /* Check for errors from DNS lookup. */
-        if( serverAddress.sin_addr == 0U )
+        serverAddress.sin_addr = ulServerAddress;
 #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
 
+        /* Check for errors from DNS lookup. */
+        if( ulServerAddress == 0U )
         {
             LogError( ( "Failed to connect to server: DNS resolution failed: Hostname=%s.",
                         pHostName ) );
@@ -147,6 +609,17 @@ BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
                         socketStatus,
                         pHostName,
                         port ) );
+
+            #if ( FREERTOS_SOCKETS_WRAPPER_DNS_CACHE_ENTRIES > 0 )
+            {
+                /* The server may have moved, so resolve the host name again
+                 * on the next attempt. */
+                if( xAddressFromCache == pdTRUE )
+                {
+                    prvDnsCacheRemove( pHostName );
+                }
+            }
+            #endif
         }
     }
 
@@ -198,6 +671,7 @@ BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
 void TCP_Sockets_Disconnect( Socket_t tcpSocket )
 {
     BaseType_t waitForShutdownLoopCount = 0;
+    BaseType_t xHandedOver = pdFALSE;
     uint8_t pDummyBuffer[ 2 ];
 
     if( ( tcpSocket != NULL ) && ( tcpSocket != FREERTOS_INVALID_SOCKET ) )
@@ -205,20 +679,52 @@ void TCP_Sockets_Disconnect( Socket_t tcpSocket )
         /* Initiate graceful shutdown. */
         ( void ) FreeRTOS_shutdown( tcpSocket, FREERTOS_SHUT_RDWR );
 
-        /* Wait for the socket to disconnect gracefully (indicated by FreeRTOS_recv()
-         * returning a FREERTOS_EINVAL error) before closing the socket. */
-        while( FreeRTOS_recv( tcpSocket, pDummyBuffer, sizeof( pDummyBuffer ), 0 ) >= 0 )
+        #if ( FREERTOS_SOCKETS_WRAPPER_ASYNC_DISCONNECT == 1 )
         {
-            /* We don't need to delay since FreeRTOS_recv should already have a timeout. */
+            /* Let the reaper task wait for the shutdown and close the socket. */
+            if( prvStartReaper() == pdTRUE )
+            {
+                xHandedOver = xQueueSend( xReaperQueue, &tcpSocket, 0 );
+            }
+        }
+        #endif
 
-            if( ++waitForShutdownLoopCount >= FREERTOS_SOCKETS_WRAPPER_SHUTDOWN_LOOPS )
+        if( xHandedOver != pdTRUE )
+        {
+            /* Wait for the socket to disconnect gracefully (indicated by FreeRTOS_recv()
+             * returning a FREERTOS_EINVAL error) before closing the socket. */
+            while( FreeRTOS_recv( tcpSocket, pDummyBuffer, sizeof( pDummyBuffer ), 0 ) >= 0 )
             {
-                break;
+                /* We don't need to delay since FreeRTOS_recv should already have a timeout. */
+
+                if( ++waitForShutdownLoopCount >= FREERTOS_SOCKETS_WRAPPER_SHUTDOWN_LOOPS )
+                {
+                    break;
+                }
             }
+
+            ( void ) FreeRTOS_closesocket( tcpSocket );
         }
+    }
+}
+
+/**
+ * @brief Check whether a socket is still connected to the server.
+ *
+ * @param[in] xSocket The socket descriptor.
+ *
+ * @return pdTRUE if the connection is established, else pdFALSE.
+ */
+BaseType_t TCP_Sockets_IsConnected( Socket_t xSocket )
+{
+    BaseType_t xConnected = pdFALSE;
 
-        ( void ) FreeRTOS_closesocket( tcpSocket );
+    if( ( xSocket != NULL ) && ( xSocket != FREERTOS_INVALID_SOCKET ) )
+    {
+        xConnected = ( FreeRTOS_issocketconnected( xSocket ) == pdTRUE ) ? pdTRUE : pdFALSE;
     }
+
+    return xConnected;
 }
 
 /**
@@ -239,46 +745,105 @@ int32_t TCP_Sockets_Send( Socket_t xSocket,
                           size_t xBufferLength )
 {
     BaseType_t xSendStatus;
-    int xReturnStatus = TCP_SOCKETS_ERRNO_ERROR;
 
     configASSERT( xSocket != NULL );
     configASSERT( pvBuffer != NULL );
 
     xSendStatus = FreeRTOS_send( xSocket, pvBuffer, xBufferLength, 0 );
 
-    switch( xSendStatus )
+    return prvSendStatusToErrno( xSendStatus );
+}
+
+/**
+ * @brief Transmit several buffers to the remote socket, in order.
+ *
+ * The socket must have already been created using a call to TCP_Sockets_Connect().
+ *
+ * When the TX stream of the socket has room for all the buffers in one
+ * contiguous block, they are copied straight into it and queued together.
+ * Otherwise they are sent one by one with FreeRTOS_send().
+ *
+ * @param[in] xSocket The handle of the sending socket.
+ * @param[in] pxIoVec The buffers containing the data to be sent.
+ * @param[in] xIoVecCount The number of buffers in pxIoVec.
+ *
+ * @return
+ * * On success, the number of bytes actually sent is returned.
+ * * If an error occurred before any byte was sent, a negative value is returned. @ref SocketsErrors
+ */
+int32_t TCP_Sockets_SendVector( Socket_t xSocket,
+                                const TransportOutVector_t * pxIoVec,
+                                size_t xIoVecCount )
+{
+    size_t xIndex;
+    size_t xTotalLength = 0U;
+    int32_t xSendStatus = 0;
+    int32_t xBytesSent = 0;
+    BaseType_t xQueued = pdFALSE;
+
+    #if ( FREERTOS_SOCKETS_WRAPPER_ZERO_COPY_TX == 1 )
+        uint8_t * pucTxHead;
+        BaseType_t xTxSpace = 0;
+    #endif
+
+    configASSERT( xSocket != NULL );
+    configASSERT( pxIoVec != NULL );
+
+    for( xIndex = 0U; xIndex < xIoVecCount; xIndex++ )
     {
-        /* Socket was closed or just got closed. */
-        case -pdFREERTOS_ERRNO_ENOTCONN:
-            xReturnStatus = TCP_SOCKETS_ERRNO_ENOTCONN;
-            break;
+        xTotalLength += pxIoVec[ xIndex ].iov_len;
+    }
 
-        /* Not enough memory for the socket to create either an Rx or Tx stream. */
-        case -pdFREERTOS_ERRNO_ENOMEM:
-            xReturnStatus = TCP_SOCKETS_ERRNO_ENOMEM;
-            break;
+    #if ( FREERTOS_SOCKETS_WRAPPER_ZERO_COPY_TX == 1 )
+    {
+        pucTxHead = FreeRTOS_get_tx_head( xSocket, &xTxSpace );
 
-        /* Socket is not valid, is not a TCP socket, or is not bound. */
-        case -pdFREERTOS_ERRNO_EINVAL:
-            xReturnStatus = TCP_SOCKETS_ERRNO_EINVAL;
-            break;
+        if( ( pucTxHead != NULL ) && ( xTotalLength > 0U ) && ( xTxSpace > 0 ) &&
+            ( ( size_t ) xTxSpace >= xTotalLength ) )
+        {
+            for( xIndex = 0U; xIndex < xIoVecCount; xIndex++ )
+            {
+                ( void ) memcpy( pucTxHead, pxIoVec[ xIndex ].iov_base, pxIoVec[ xIndex ].iov_len );
+                pucTxHead = &( pucTxHead[ pxIoVec[ xIndex ].iov_len ] );
+            }
 
-        /* Socket received a signal, causing the read operation to be aborted. */
-        case -pdFREERTOS_ERRNO_EINTR:
-            xReturnStatus = TCP_SOCKETS_ERRNO_EINTR;
-            break;
+            /* A NULL buffer only moves the head of the TX stream over the
+             * bytes copied above. */
+            xBytesSent = prvSendStatusToErrno( FreeRTOS_send( xSocket, NULL, xTotalLength, 0 ) );
+            xQueued = pdTRUE;
+        }
+    }
+    #endif /* if ( FREERTOS_SOCKETS_WRAPPER_ZERO_COPY_TX == 1 ) */
 
-        /* A timeout occurred before any data could be sent as the TCP buffer was full. */
-        case -pdFREERTOS_ERRNO_ENOSPC:
-            xReturnStatus = TCP_SOCKETS_ERRNO_ENOSPC;
-            break;
+    /* Fall back to one send per buffer, stopping at the first one that is not
+     * sent completely. */
+    for( xIndex = 0U; ( xIndex < xIoVecCount ) && ( xQueued == pdFALSE ); xIndex++ )
+    {
+        if( pxIoVec[ xIndex ].iov_len > 0U )
+        {
+            xSendStatus = TCP_Sockets_Send( xSocket, pxIoVec[ xIndex ].iov_base, pxIoVec[ xIndex ].iov_len );
 
-        default:
-            xReturnStatus = ( int ) xSendStatus;
-            break;
+            if( xSendStatus > 0 )
+            {
+                xBytesSent += xSendStatus;
+            }
+            else if( xBytesSent == 0 )
+            {
+                xBytesSent = xSendStatus;
+            }
+            else
+            {
+                /* Report the bytes sent before the failure. */
+            }
+
+            if( xSendStatus != ( int32_t ) pxIoVec[ xIndex ].iov_len )
+            {
+                xQueued = pdTRUE;
+            }
+        }
     }
 
-    return xReturnStatus;
+    return xBytesSent;
 }
 
 /**
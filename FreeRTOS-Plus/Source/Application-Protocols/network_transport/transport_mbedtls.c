@@ -42,6 +42,7 @@
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
+#include "task.h"
 
 /* MbedTLS Bio TCP sockets wrapper include. */
 #include "mbedtls_bio_tcp_sockets_wrapper.h"
@@ -94,6 +95,21 @@ static const char * pNoLowLevelMbedTlsCodeStr = "<No-Low-Level-Code>";
     ( mbedtls_low_level_strerr( mbedTlsCode ) != NULL ) ? \
     mbedtls_low_level_strerr( mbedTlsCode ) : pNoLowLevelMbedTlsCodeStr
 
+#if ( TLS_TRANSPORT_SESSION_CACHE == 1 )
+
+/**
+ * @brief The master secret of a TLS 1.2 session, which stays the same when the
+ * session is resumed. mbedTLS 3.x has no accessor for it, and mbedTLS 2.x has
+ * no MBEDTLS_PRIVATE macro.
+ */
+    #if MBEDTLS_VERSION_NUMBER < 0x03000000
+        #define sessionMasterSecret( session )    ( ( session ).master )
+    #else
+        #define sessionMasterSecret( session )    ( ( session ).MBEDTLS_PRIVATE( master ) )
+    #endif
+
+#endif /* if ( TLS_TRANSPORT_SESSION_CACHE == 1 ) */
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -171,16 +187,48 @@ static int32_t setCredentials( SSLContext_t * pSslContext,
 /**
  * @brief Set optional configurations for the TLS connection.
  *
- * This function is used to set SNI and ALPN protocols.
+ * This function is used to set ALPN protocols and the maximum fragment length.
  *
  * @param[in] pSslContext SSL context to which the optional configurations are to be set.
- * @param[in] pHostName Remote host name, used for server name indication.
  * @param[in] pNetworkCredentials TLS setup parameters.
  */
 static void setOptionalConfigurations( SSLContext_t * pSslContext,
-                                       const char * pHostName,
                                        const NetworkCredentials_t * pNetworkCredentials );
 
+/**
+ * @brief Set the server name of a connection, unless SNI is disabled.
+ *
+ * @param[in] pContext SSL context of the connection.
+ * @param[in] pHostName Remote host name, used for server name indication.
+ * @param[in] pNetworkCredentials TLS setup parameters.
+ */
+static void setServerName( mbedtls_ssl_context * pContext,
+                           const char * pHostName,
+                           const NetworkCredentials_t * pNetworkCredentials );
+
+/**
+ * @brief Initialize the contexts of an SSL context, build its SSL configuration
+ * and parse the credentials into it.
+ *
+ * The random number generator of the SSL context must already be seeded.
+ *
+ * @param[in] pSslContext SSL context to set up.
+ * @param[in] pNetworkCredentials TLS setup parameters.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS, #TLS_TRANSPORT_INSUFFICIENT_MEMORY, or
+ * #TLS_TRANSPORT_INVALID_CREDENTIALS.
+ */
+static TlsTransportStatus_t sslConfigSetup( SSLContext_t * pSslContext,
+                                            const NetworkCredentials_t * pNetworkCredentials );
+
+/**
+ * @brief Free the SSL context of a connection, and release the shared
+ * context if the connection uses one.
+ *
+ * @param[in] pTlsTransportParams Parameters of the connection.
+ */
+static void tlsContextFree( TlsTransportParams_t * pTlsTransportParams );
+
 /**
  * @brief Setup TLS by initializing contexts and setting configurations.
  *
@@ -217,6 +265,79 @@ static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pNetworkContext,
 static TlsTransportStatus_t initMbedtls( mbedtls_entropy_context * pEntropyContext,
                                          mbedtls_ctr_drbg_context * pCtrDrgbContext );
 
+/**
+ * @brief Write data with a single call to mbedtls_ssl_write.
+ *
+ * @param[in] pTlsTransportParams Parameters of the connection.
+ * @param[in] pBuffer Buffer containing the bytes to send.
+ * @param[in] bytesToSend Number of bytes to send from the buffer.
+ *
+ * @return Number of bytes (> 0) sent; 0 if the write can be retried;
+ * else a negative mbed TLS error code.
+ */
+static int32_t tlsWrite( TlsTransportParams_t * pTlsTransportParams,
+                         const uint8_t * pBuffer,
+                         size_t bytesToSend );
+
+/**
+ * @brief Write a buffer, calling mbedtls_ssl_write until all of it is sent or
+ * no more progress can be made.
+ *
+ * @param[in] pTlsTransportParams Parameters of the connection.
+ * @param[in] pBuffer Buffer containing the bytes to send.
+ * @param[in] bytesToSend Number of bytes to send from the buffer.
+ *
+ * @return Number of bytes sent, less than @p bytesToSend if the write timed out;
+ * a negative mbed TLS error code if an error occurred before any byte was sent.
+ */
+static int32_t tlsWriteAll( TlsTransportParams_t * pTlsTransportParams,
+                            const uint8_t * pBuffer,
+                            size_t bytesToSend );
+
+/**
+ * @brief Add the result of a write to the result of the writes before it.
+ *
+ * @param[in] bytesSent Bytes sent so far, or an error code.
+ * @param[in] writeStatus Return value of #tlsWriteAll.
+ *
+ * @return Total number of bytes sent, or the error code if no byte was sent.
+ */
+static int32_t accumulateWrite( int32_t bytesSent,
+                                int32_t writeStatus );
+
+#if ( TLS_TRANSPORT_SESSION_CACHE == 1 )
+
+/**
+ * @brief Discard the saved session unless it was established with the given
+ * host name and port, and remember them for the session of this connection.
+ *
+ * @param[in] pSessionCache Session cache of the connection.
+ * @param[in] pHostName Remote host name.
+ * @param[in] port Remote port.
+ */
+    static void sessionCacheSelect( TlsSessionCache_t * pSessionCache,
+                                    const char * pHostName,
+                                    uint16_t port );
+
+/**
+ * @brief Save the session of a completed handshake and count the handshake
+ * as full or resumed.
+ *
+ * @param[in] pSessionCache Session cache of the connection.
+ * @param[in] pSslContext SSL context that completed the handshake.
+ */
+    static void sessionCacheSave( TlsSessionCache_t * pSessionCache,
+                                  const mbedtls_ssl_context * pSslContext );
+
+/**
+ * @brief Free the saved session.
+ *
+ * @param[in] pSessionCache Session cache to clear.
+ */
+    static void sessionCacheClear( TlsSessionCache_t * pSessionCache );
+
+#endif /* if ( TLS_TRANSPORT_SESSION_CACHE == 1 ) */
+
 /*-----------------------------------------------------------*/
 
 static void sslContextInit( SSLContext_t * pSslContext )
@@ -389,13 +510,11 @@ static int32_t setCredentials( SSLContext_t * pSslContext,
 /*-----------------------------------------------------------*/
 
 static void setOptionalConfigurations( SSLContext_t * pSslContext,
-                                       const char * pHostName,
                                        const NetworkCredentials_t * pNetworkCredentials )
 {
     int32_t mbedtlsError = -1;
 
     configASSERT( pSslContext != NULL );
-    configASSERT( pHostName != NULL );
     configASSERT( pNetworkCredentials != NULL );
 
     if( pNetworkCredentials->pAlpnProtos != NULL )
@@ -413,18 +532,10 @@ static void setOptionalConfigurations( SSLContext_t * pSslContext,
         }
     }
 
-    /* Enable SNI if requested. */
-    if( pNetworkCredentials->disableSni == pdFALSE )
+    if( pNetworkCredentials->pCiphersuites != NULL )
     {
-        mbedtlsError = mbedtls_ssl_set_hostname( &( pSslContext->context ),
-                                                 pHostName );
-
-        if( mbedtlsError != 0 )
-        {
-            LogError( ( "Failed to set server name: mbedTLSError= %s : %s.",
-                        mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
-                        mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
-        }
+        mbedtls_ssl_conf_ciphersuites( &( pSslContext->config ),
+                                       pNetworkCredentials->pCiphersuites );
     }
 
     /* Set Maximum Fragment Length if enabled. */
@@ -443,28 +554,56 @@ static void setOptionalConfigurations( SSLContext_t * pSslContext,
                         mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
         }
     #endif /* ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
+
+    #if ( TLS_TRANSPORT_SESSION_CACHE == 1 ) && defined( MBEDTLS_SSL_SESSION_TICKETS )
+        /* Ask the server for a session ticket, so the session can be resumed
+         * even if the server does not keep a session ID cache. */
+        mbedtls_ssl_conf_session_tickets( &( pSslContext->config ),
+                                          MBEDTLS_SSL_SESSION_TICKETS_ENABLED );
+    #endif
 }
 /*-----------------------------------------------------------*/
 
-static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
-                                      const char * pHostName,
-                                      const NetworkCredentials_t * pNetworkCredentials )
+static void setServerName( mbedtls_ssl_context * pContext,
+                           const char * pHostName,
+                           const NetworkCredentials_t * pNetworkCredentials )
+{
+    int32_t mbedtlsError = -1;
+
+    configASSERT( pContext != NULL );
+    configASSERT( pHostName != NULL );
+    configASSERT( pNetworkCredentials != NULL );
+
+    /* Enable SNI if requested. */
+    if( pNetworkCredentials->disableSni == pdFALSE )
+    {
+        mbedtlsError = mbedtls_ssl_set_hostname( pContext,
+                                                 pHostName );
+
+        if( mbedtlsError != 0 )
+        {
+            LogError( ( "Failed to set server name: mbedTLSError= %s : %s.",
+                        mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
+                        mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static TlsTransportStatus_t sslConfigSetup( SSLContext_t * pSslContext,
+                                            const NetworkCredentials_t * pNetworkCredentials )
 {
-    TlsTransportParams_t * pTlsTransportParams = NULL;
     TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
     int32_t mbedtlsError = 0;
 
-    configASSERT( pNetworkContext != NULL );
-    configASSERT( pNetworkContext->pParams != NULL );
-    configASSERT( pHostName != NULL );
+    configASSERT( pSslContext != NULL );
     configASSERT( pNetworkCredentials != NULL );
     configASSERT( pNetworkCredentials->pRootCa != NULL );
 
-    pTlsTransportParams = pNetworkContext->pParams;
     /* Initialize the mbed TLS context structures. */
-    sslContextInit( &( pTlsTransportParams->sslContext ) );
+    sslContextInit( pSslContext );
 
-    mbedtlsError = mbedtls_ssl_config_defaults( &( pTlsTransportParams->sslContext.config ),
+    mbedtlsError = mbedtls_ssl_config_defaults( &( pSslContext->config ),
                                                 MBEDTLS_SSL_IS_CLIENT,
                                                 MBEDTLS_SSL_TRANSPORT_STREAM,
                                                 MBEDTLS_SSL_PRESET_DEFAULT );
@@ -481,7 +620,7 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
 
     if( returnStatus == TLS_TRANSPORT_SUCCESS )
     {
-        mbedtlsError = setCredentials( &( pTlsTransportParams->sslContext ),
+        mbedtlsError = setCredentials( pSslContext,
                                        pNetworkCredentials );
 
         if( mbedtlsError != 0 )
@@ -490,9 +629,8 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
         }
         else
         {
-            /* Optionally set SNI and ALPN protocols. */
-            setOptionalConfigurations( &( pTlsTransportParams->sslContext ),
-                                       pHostName,
+            /* Optionally set ALPN protocols. */
+            setOptionalConfigurations( pSslContext,
                                        pNetworkCredentials );
         }
     }
@@ -501,11 +639,80 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
 }
 /*-----------------------------------------------------------*/
 
+static void tlsContextFree( TlsTransportParams_t * pTlsTransportParams )
+{
+    configASSERT( pTlsTransportParams != NULL );
+
+    if( pTlsTransportParams->pSharedContext != NULL )
+    {
+        /* Only the SSL context belongs to the connection. */
+        mbedtls_ssl_free( &( pTlsTransportParams->sslContext.context ) );
+
+        taskENTER_CRITICAL();
+        {
+            configASSERT( pTlsTransportParams->pSharedContext->referenceCount > 0U );
+            pTlsTransportParams->pSharedContext->referenceCount--;
+        }
+        taskEXIT_CRITICAL();
+    }
+    else
+    {
+        sslContextFree( &( pTlsTransportParams->sslContext ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
+                                      const char * pHostName,
+                                      const NetworkCredentials_t * pNetworkCredentials )
+{
+    TlsTransportParams_t * pTlsTransportParams = NULL;
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+
+    configASSERT( pNetworkContext != NULL );
+    configASSERT( pNetworkContext->pParams != NULL );
+    configASSERT( pHostName != NULL );
+    configASSERT( pNetworkCredentials != NULL );
+    configASSERT( pNetworkCredentials->pRootCa != NULL );
+
+    pTlsTransportParams = pNetworkContext->pParams;
+
+    if( pTlsTransportParams->pSharedContext != NULL )
+    {
+        /* The configuration and credentials are already set up, only the
+         * SSL context of the connection is needed. */
+        taskENTER_CRITICAL();
+        {
+            pTlsTransportParams->pSharedContext->referenceCount++;
+        }
+        taskEXIT_CRITICAL();
+
+        mbedtls_ssl_init( &( pTlsTransportParams->sslContext.context ) );
+    }
+    else
+    {
+        returnStatus = sslConfigSetup( &( pTlsTransportParams->sslContext ),
+                                       pNetworkCredentials );
+    }
+
+    if( returnStatus == TLS_TRANSPORT_SUCCESS )
+    {
+        /* Optionally set SNI. */
+        setServerName( &( pTlsTransportParams->sslContext.context ),
+                       pHostName,
+                       pNetworkCredentials );
+    }
+
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
+
 static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pNetworkContext,
                                           const NetworkCredentials_t * pNetworkCredentials )
 {
     TlsTransportParams_t * pTlsTransportParams = NULL;
     TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+    const mbedtls_ssl_config * pConfig = NULL;
     int32_t mbedtlsError = 0;
 
     configASSERT( pNetworkContext != NULL );
@@ -513,9 +720,19 @@ static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pNetworkContext,
     configASSERT( pNetworkCredentials != NULL );
 
     pTlsTransportParams = pNetworkContext->pParams;
+
+    if( pTlsTransportParams->pSharedContext != NULL )
+    {
+        pConfig = &( pTlsTransportParams->pSharedContext->sslContext.config );
+    }
+    else
+    {
+        pConfig = &( pTlsTransportParams->sslContext.config );
+    }
+
     /* Initialize the mbed TLS secured connection context. */
     mbedtlsError = mbedtls_ssl_setup( &( pTlsTransportParams->sslContext.context ),
-                                      &( pTlsTransportParams->sslContext.config ) );
+                                      pConfig );
 
     if( mbedtlsError != 0 )
     {
@@ -543,6 +760,29 @@ static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pNetworkContext,
                              xMbedTLSBioTCPSocketsWrapperSend,
                              xMbedTLSBioTCPSocketsWrapperRecv,
                              NULL );
+
+        #if ( TLS_TRANSPORT_SESSION_CACHE == 1 )
+            pTlsTransportParams->sessionCache.sessionOffered = pdFALSE;
+
+            if( pTlsTransportParams->sessionCache.sessionValid == pdTRUE )
+            {
+                /* Offer the saved session. The server may still choose to
+                 * perform a full handshake. */
+                mbedtlsError = mbedtls_ssl_set_session( &( pTlsTransportParams->sslContext.context ),
+                                                        &( pTlsTransportParams->sessionCache.session ) );
+
+                if( mbedtlsError != 0 )
+                {
+                    LogWarn( ( "Failed to set saved TLS session, performing a full handshake: mbedTLSError= %s : %s.",
+                               mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
+                               mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
+                }
+                else
+                {
+                    pTlsTransportParams->sessionCache.sessionOffered = pdTRUE;
+                }
+            }
+        #endif /* if ( TLS_TRANSPORT_SESSION_CACHE == 1 ) */
     }
 
     if( returnStatus == TLS_TRANSPORT_SUCCESS )
@@ -561,11 +801,21 @@ static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pNetworkContext,
                         mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
 
             returnStatus = TLS_TRANSPORT_HANDSHAKE_FAILED;
+
+            #if ( TLS_TRANSPORT_SESSION_CACHE == 1 )
+                /* Do not offer a session the server may have rejected again. */
+                sessionCacheClear( &( pTlsTransportParams->sessionCache ) );
+            #endif
         }
         else
         {
             LogInfo( ( "(Network connection %p) TLS handshake successful.",
                        pNetworkContext ) );
+
+            #if ( TLS_TRANSPORT_SESSION_CACHE == 1 )
+                sessionCacheSave( &( pTlsTransportParams->sessionCache ),
+                                  &( pTlsTransportParams->sslContext.context ) );
+            #endif
         }
     }
 
@@ -623,6 +873,221 @@ static TlsTransportStatus_t initMbedtls( mbedtls_entropy_context * pEntropyConte
 }
 /*-----------------------------------------------------------*/
 
+static int32_t tlsWrite( TlsTransportParams_t * pTlsTransportParams,
+                         const uint8_t * pBuffer,
+                         size_t bytesToSend )
+{
+    int32_t tlsStatus = 0;
+
+    configASSERT( pTlsTransportParams != NULL );
+    configASSERT( pBuffer != NULL );
+
+    tlsStatus = ( int32_t ) mbedtls_ssl_write( &( pTlsTransportParams->sslContext.context ),
+                                               pBuffer,
+                                               bytesToSend );
+
+    if( ( tlsStatus == MBEDTLS_ERR_SSL_TIMEOUT ) ||
+        ( tlsStatus == MBEDTLS_ERR_SSL_WANT_READ ) ||
+        ( tlsStatus == MBEDTLS_ERR_SSL_WANT_WRITE ) )
+    {
+        LogDebug( ( "Failed to send data. However, send can be retried on this error. "
+                    "mbedTLSError= %s : %s.",
+                    mbedtlsHighLevelCodeOrDefault( tlsStatus ),
+                    mbedtlsLowLevelCodeOrDefault( tlsStatus ) ) );
+
+        /* Mark these set of errors as a timeout. The libraries may retry send
+         * on these errors. */
+        tlsStatus = 0;
+    }
+    else if( tlsStatus < 0 )
+    {
+        LogError( ( "Failed to send data:  mbedTLSError= %s : %s.",
+                    mbedtlsHighLevelCodeOrDefault( tlsStatus ),
+                    mbedtlsLowLevelCodeOrDefault( tlsStatus ) ) );
+    }
+    else
+    {
+        /* Empty else marker. */
+    }
+
+    return tlsStatus;
+}
+/*-----------------------------------------------------------*/
+
+static int32_t tlsWriteAll( TlsTransportParams_t * pTlsTransportParams,
+                            const uint8_t * pBuffer,
+                            size_t bytesToSend )
+{
+    size_t bytesSent = 0U;
+    int32_t tlsStatus = 1;
+
+    /* mbedtls_ssl_write sends at most one record, so a buffer larger than the
+     * maximum fragment length needs several calls. */
+    while( ( bytesSent < bytesToSend ) && ( tlsStatus > 0 ) )
+    {
+        tlsStatus = tlsWrite( pTlsTransportParams,
+                              &( pBuffer[ bytesSent ] ),
+                              bytesToSend - bytesSent );
+
+        if( tlsStatus > 0 )
+        {
+            bytesSent += ( size_t ) tlsStatus;
+        }
+    }
+
+    if( ( tlsStatus >= 0 ) || ( bytesSent > 0U ) )
+    {
+        tlsStatus = ( int32_t ) bytesSent;
+    }
+
+    return tlsStatus;
+}
+/*-----------------------------------------------------------*/
+
+static int32_t accumulateWrite( int32_t bytesSent,
+                                int32_t writeStatus )
+{
+    int32_t total = bytesSent;
+
+    if( writeStatus > 0 )
+    {
+        total += writeStatus;
+    }
+    else if( ( writeStatus < 0 ) && ( bytesSent == 0 ) )
+    {
+        /* Report the error only if nothing was sent before it. */
+        total = writeStatus;
+    }
+    else
+    {
+        /* Empty else marker. */
+    }
+
+    return total;
+}
+/*-----------------------------------------------------------*/
+
+#if ( TLS_TRANSPORT_SESSION_CACHE == 1 )
+
+    static void sessionCacheSelect( TlsSessionCache_t * pSessionCache,
+                                    const char * pHostName,
+                                    uint16_t port )
+    {
+        size_t hostNameLength = 0;
+
+        configASSERT( pSessionCache != NULL );
+        configASSERT( pHostName != NULL );
+
+        hostNameLength = strlen( pHostName );
+
+        if( ( pSessionCache->sessionValid == pdTRUE ) &&
+            ( pSessionCache->port == port ) &&
+            ( strcmp( pSessionCache->hostName, pHostName ) == 0 ) )
+        {
+            LogDebug( ( "Resuming TLS session with %s:%u.",
+                        pHostName,
+                        ( unsigned int ) port ) );
+        }
+        else
+        {
+            sessionCacheClear( pSessionCache );
+
+            /* An empty host name means the session of this connection is not saved. */
+            if( hostNameLength <= TLS_TRANSPORT_SESSION_CACHE_MAX_HOSTNAME_LENGTH )
+            {
+                ( void ) memcpy( pSessionCache->hostName, pHostName, hostNameLength + 1U );
+                pSessionCache->port = port;
+            }
+            else
+            {
+                LogWarn( ( "Host name longer than TLS_TRANSPORT_SESSION_CACHE_MAX_HOSTNAME_LENGTH, "
+                           "the TLS session will not be resumed." ) );
+            }
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+    static void sessionCacheSave( TlsSessionCache_t * pSessionCache,
+                                  const mbedtls_ssl_context * pSslContext )
+    {
+        mbedtls_ssl_session newSession;
+        BaseType_t isResumed = pdFALSE;
+        int32_t mbedtlsError = 0;
+
+        configASSERT( pSessionCache != NULL );
+        configASSERT( pSslContext != NULL );
+
+        mbedtls_ssl_session_init( &newSession );
+
+        mbedtlsError = mbedtls_ssl_get_session( pSslContext, &newSession );
+
+        if( mbedtlsError != 0 )
+        {
+            LogWarn( ( "Failed to save TLS session: mbedTLSError= %s : %s.",
+                       mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
+                       mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
+        }
+
+        #if defined( MBEDTLS_SSL_PROTO_TLS1_2 )
+            /* The handshake could only resume the session if it was offered.
+             * A resumed session keeps the master secret of the offered session,
+             * whereas a server that falls back to a full handshake derives a
+             * new one. */
+            if( ( mbedtlsError == 0 ) &&
+                ( pSessionCache->sessionOffered == pdTRUE ) &&
+                ( memcmp( sessionMasterSecret( newSession ),
+                          sessionMasterSecret( pSessionCache->session ),
+                          sizeof( sessionMasterSecret( newSession ) ) ) == 0 ) )
+            {
+                isResumed = pdTRUE;
+            }
+        #endif
+
+        pSessionCache->sessionOffered = pdFALSE;
+
+        if( isResumed == pdTRUE )
+        {
+            pSessionCache->resumedHandshakes++;
+        }
+        else
+        {
+            pSessionCache->fullHandshakes++;
+        }
+
+        LogDebug( ( "TLS handshake %s: full=%u resumed=%u.",
+                    ( isResumed == pdTRUE ) ? "resumed" : "full",
+                    ( unsigned int ) pSessionCache->fullHandshakes,
+                    ( unsigned int ) pSessionCache->resumedHandshakes ) );
+
+        if( ( mbedtlsError == 0 ) && ( pSessionCache->hostName[ 0 ] != '\0' ) )
+        {
+            /* The saved session takes ownership of the memory of newSession,
+             * which may hold a new ticket. */
+            mbedtls_ssl_session_free( &( pSessionCache->session ) );
+            pSessionCache->session = newSession;
+            pSessionCache->sessionValid = pdTRUE;
+        }
+        else
+        {
+            mbedtls_ssl_session_free( &newSession );
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+    static void sessionCacheClear( TlsSessionCache_t * pSessionCache )
+    {
+        configASSERT( pSessionCache != NULL );
+
+        mbedtls_ssl_session_free( &( pSessionCache->session ) );
+        pSessionCache->sessionValid = pdFALSE;
+        pSessionCache->sessionOffered = pdFALSE;
+        pSessionCache->hostName[ 0 ] = '\0';
+        pSessionCache->port = 0;
+    }
+    /*-----------------------------------------------------------*/
+
+#endif /* if ( TLS_TRANSPORT_SESSION_CACHE == 1 ) */
+
 TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
                                            const char * pHostName,
                                            uint16_t port,
@@ -680,13 +1145,16 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
         }
     }
 
-    /* Initialize mbedtls. */
+    /* Initialize mbedtls, unless the shared context of the connection already did. */
     if( returnStatus == TLS_TRANSPORT_SUCCESS )
     {
         isSocketConnected = pdTRUE;
 
-        returnStatus = initMbedtls( &( pTlsTransportParams->sslContext.entropyContext ),
-                                    &( pTlsTransportParams->sslContext.ctrDrgbContext ) );
+        if( pTlsTransportParams->pSharedContext == NULL )
+        {
+            returnStatus = initMbedtls( &( pTlsTransportParams->sslContext.entropyContext ),
+                                        &( pTlsTransportParams->sslContext.ctrDrgbContext ) );
+        }
     }
 
     /* Initialize TLS contexts and set credentials. */
@@ -700,6 +1168,10 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
     {
         isTlsSetup = pdTRUE;
 
+        #if ( TLS_TRANSPORT_SESSION_CACHE == 1 )
+            sessionCacheSelect( &( pTlsTransportParams->sessionCache ), pHostName, port );
+        #endif
+
         returnStatus = tlsHandshake( pNetworkContext, pNetworkCredentials );
     }
 
@@ -709,7 +1181,7 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
         /* Free SSL context if it's setup. */
         if( isTlsSetup == pdTRUE )
         {
-            sslContextFree( &( pTlsTransportParams->sslContext ) );
+            tlsContextFree( pTlsTransportParams );
         }
 
         /* Call Sockets_Disconnect if socket was connected. */
@@ -771,7 +1243,7 @@ void TLS_FreeRTOS_Disconnect( NetworkContext_t * pNetworkContext )
         TCP_Sockets_Disconnect( pTlsTransportParams->tcpSocket );
 
         /* Free mbed TLS contexts. */
-        sslContextFree( &( pTlsTransportParams->sslContext ) );
+        tlsContextFree( pTlsTransportParams );
     }
 }
 /*-----------------------------------------------------------*/
@@ -861,35 +1333,202 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
     {
         pTlsTransportParams = pNetworkContext->pParams;
 
-        tlsStatus = ( int32_t ) mbedtls_ssl_write( &( pTlsTransportParams->sslContext.context ),
-                                                   pBuffer,
-                                                   bytesToSend );
+        tlsStatus = tlsWrite( pTlsTransportParams,
+                              pBuffer,
+                              bytesToSend );
+    }
+
+    return tlsStatus;
+}
+/*-----------------------------------------------------------*/
 
-        if( ( tlsStatus == MBEDTLS_ERR_SSL_TIMEOUT ) ||
-            ( tlsStatus == MBEDTLS_ERR_SSL_WANT_READ ) ||
-            ( tlsStatus == MBEDTLS_ERR_SSL_WANT_WRITE ) )
+int32_t TLS_FreeRTOS_writev( NetworkContext_t * pNetworkContext,
+                             TransportOutVector_t * pIoVec,
+                             size_t ioVecCount )
+{
+    TlsTransportParams_t * pTlsTransportParams = NULL;
+    uint8_t gatherBuffer[ TLS_TRANSPORT_WRITEV_BUFFER_SIZE ];
+    size_t gatheredBytes = 0U;
+    size_t vectorIndex = 0U;
+    const uint8_t * pFragment = NULL;
+    size_t fragmentLength = 0U;
+    int32_t writeStatus = 0;
+    int32_t bytesSent = 0;
+    BaseType_t keepSending = pdTRUE;
+
+    if( ( pNetworkContext == NULL ) || ( pNetworkContext->pParams == NULL ) )
+    {
+        LogError( ( "invalid input, pNetworkContext=%p", pNetworkContext ) );
+        bytesSent = -1;
+    }
+    else if( ( pIoVec == NULL ) || ( ioVecCount == 0U ) )
+    {
+        LogError( ( "invalid input, pIoVec=%p, ioVecCount=%u",
+                    pIoVec,
+                    ( unsigned int ) ioVecCount ) );
+        bytesSent = -1;
+    }
+    else
+    {
+        pTlsTransportParams = pNetworkContext->pParams;
+
+        /* Walk one vector past the end to flush what is left in the gather buffer. */
+        for( vectorIndex = 0U; ( vectorIndex <= ioVecCount ) && ( keepSending == pdTRUE ); vectorIndex++ )
         {
-            LogDebug( ( "Failed to send data. However, send can be retried on this error. "
-                        "mbedTLSError= %s : %s.",
-                        mbedtlsHighLevelCodeOrDefault( tlsStatus ),
-                        mbedtlsLowLevelCodeOrDefault( tlsStatus ) ) );
+            if( vectorIndex < ioVecCount )
+            {
+                pFragment = ( const uint8_t * ) pIoVec[ vectorIndex ].iov_base;
+                fragmentLength = pIoVec[ vectorIndex ].iov_len;
+            }
+            else
+            {
+                pFragment = NULL;
+                fragmentLength = 0U;
+            }
 
-            /* Mark these set of errors as a timeout. The libraries may retry send
-             * on these errors. */
-            tlsStatus = 0;
+            /* Flush the gathered fragments when the next one does not fit
+             * behind them, or after the last one. */
+            if( ( gatheredBytes > 0U ) &&
+                ( ( pFragment == NULL ) || ( ( gatheredBytes + fragmentLength ) > sizeof( gatherBuffer ) ) ) )
+            {
+                writeStatus = tlsWriteAll( pTlsTransportParams, gatherBuffer, gatheredBytes );
+                keepSending = ( writeStatus == ( int32_t ) gatheredBytes ) ? pdTRUE : pdFALSE;
+                gatheredBytes = 0U;
+                bytesSent = accumulateWrite( bytesSent, writeStatus );
+            }
+
+            if( ( keepSending == pdFALSE ) || ( fragmentLength == 0U ) )
+            {
+                /* Nothing to send from this vector. */
+            }
+            else if( fragmentLength >= sizeof( gatherBuffer ) )
+            {
+                /* Large fragments are not worth copying. */
+                writeStatus = tlsWriteAll( pTlsTransportParams, pFragment, fragmentLength );
+                keepSending = ( writeStatus == ( int32_t ) fragmentLength ) ? pdTRUE : pdFALSE;
+                bytesSent = accumulateWrite( bytesSent, writeStatus );
+            }
+            else
+            {
+                ( void ) memcpy( &( gatherBuffer[ gatheredBytes ] ), pFragment, fragmentLength );
+                gatheredBytes += fragmentLength;
+            }
         }
-        else if( tlsStatus < 0 )
+    }
+
+    return bytesSent;
+}
+/*-----------------------------------------------------------*/
+
+TlsTransportStatus_t TLS_FreeRTOS_SharedContextInit( TlsSharedContext_t * pSharedContext,
+                                                     const NetworkCredentials_t * pNetworkCredentials )
+{
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+
+    if( ( pSharedContext == NULL ) ||
+        ( pNetworkCredentials == NULL ) ||
+        ( pNetworkCredentials->pRootCa == NULL ) )
+    {
+        LogError( ( "Invalid input parameter(s): pSharedContext=%p, pNetworkCredentials=%p.",
+                    pSharedContext,
+                    pNetworkCredentials ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+
+    if( returnStatus == TLS_TRANSPORT_SUCCESS )
+    {
+        pSharedContext->referenceCount = 0;
+
+        returnStatus = initMbedtls( &( pSharedContext->sslContext.entropyContext ),
+                                    &( pSharedContext->sslContext.ctrDrgbContext ) );
+
+        if( returnStatus == TLS_TRANSPORT_SUCCESS )
         {
-            LogError( ( "Failed to send data:  mbedTLSError= %s : %s.",
-                        mbedtlsHighLevelCodeOrDefault( tlsStatus ),
-                        mbedtlsLowLevelCodeOrDefault( tlsStatus ) ) );
+            returnStatus = sslConfigSetup( &( pSharedContext->sslContext ),
+                                           pNetworkCredentials );
+
+            if( returnStatus != TLS_TRANSPORT_SUCCESS )
+            {
+                sslContextFree( &( pSharedContext->sslContext ) );
+            }
         }
         else
         {
-            /* Empty else marker. */
+            mbedtls_entropy_free( &( pSharedContext->sslContext.entropyContext ) );
+            mbedtls_ctr_drbg_free( &( pSharedContext->sslContext.ctrDrgbContext ) );
         }
     }
 
-    return tlsStatus;
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
+
+TlsTransportStatus_t TLS_FreeRTOS_SharedContextFree( TlsSharedContext_t * pSharedContext )
+{
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+
+    if( pSharedContext == NULL )
+    {
+        LogError( ( "Invalid input parameter: pSharedContext cannot be NULL." ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+    else if( pSharedContext->referenceCount != 0U )
+    {
+        LogError( ( "Shared TLS context is still used by %u connection(s).",
+                    ( unsigned int ) pSharedContext->referenceCount ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+    else
+    {
+        sslContextFree( &( pSharedContext->sslContext ) );
+    }
+
+    return returnStatus;
 }
 /*-----------------------------------------------------------*/
+
+#if ( TLS_TRANSPORT_SESSION_CACHE == 1 )
+
+    void TLS_FreeRTOS_SessionCacheInit( NetworkContext_t * pNetworkContext )
+    {
+        TlsSessionCache_t * pSessionCache = NULL;
+
+        configASSERT( pNetworkContext != NULL );
+        configASSERT( pNetworkContext->pParams != NULL );
+
+        pSessionCache = &( pNetworkContext->pParams->sessionCache );
+
+        mbedtls_ssl_session_init( &( pSessionCache->session ) );
+        pSessionCache->sessionValid = pdFALSE;
+        pSessionCache->sessionOffered = pdFALSE;
+        pSessionCache->hostName[ 0 ] = '\0';
+        pSessionCache->port = 0;
+        pSessionCache->fullHandshakes = 0;
+        pSessionCache->resumedHandshakes = 0;
+    }
+    /*-----------------------------------------------------------*/
+
+    void TLS_FreeRTOS_SessionCacheFree( NetworkContext_t * pNetworkContext )
+    {
+        if( ( pNetworkContext != NULL ) && ( pNetworkContext->pParams != NULL ) )
+        {
+            sessionCacheClear( &( pNetworkContext->pParams->sessionCache ) );
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+    void TLS_FreeRTOS_GetHandshakeCounts( NetworkContext_t * pNetworkContext,
+                                          uint32_t * pFullHandshakes,
+                                          uint32_t * pResumedHandshakes )
+    {
+        configASSERT( pNetworkContext != NULL );
+        configASSERT( pNetworkContext->pParams != NULL );
+        configASSERT( pFullHandshakes != NULL );
+        configASSERT( pResumedHandshakes != NULL );
+
+        *pFullHandshakes = pNetworkContext->pParams->sessionCache.fullHandshakes;
+        *pResumedHandshakes = pNetworkContext->pParams->sessionCache.resumedHandshakes;
+    }
+    /*-----------------------------------------------------------*/
+
+#endif /* if ( TLS_TRANSPORT_SESSION_CACHE == 1 ) */
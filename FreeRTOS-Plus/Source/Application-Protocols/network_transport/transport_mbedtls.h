@@ -100,6 +100,77 @@ typedef struct SSLContext
     mbedtls_ctr_drbg_context ctrDrgbContext; /**< @brief CTR DRBG context for random number generation. */
 } SSLContext_t;
 
+/**
+ * @brief TLS configuration, credentials and random number generator shared by
+ * several connections.
+ *
+ * #TLS_FreeRTOS_SharedContextInit seeds the random number generator, parses the
+ * credentials and builds the SSL configuration once. A connection whose
+ * #TlsTransportParams_t.pSharedContext points to the shared context only
+ * allocates its own SSL context in #TLS_FreeRTOS_Connect.
+ *
+ * @note Connections used from different tasks share the random number
+ * generator, so MBEDTLS_THREADING_C must then be enabled.
+ */
+typedef struct TlsSharedContext
+{
+    SSLContext_t sslContext;    /**< @brief Shared contexts, the SSL connection context is unused. */
+    UBaseType_t referenceCount; /**< @brief Number of connections using the shared context. */
+} TlsSharedContext_t;
+
+/**
+ * @brief Size of the stack buffer #TLS_FreeRTOS_writev uses to gather small
+ * fragments into a single TLS record.
+ *
+ * Fragments shorter than this are copied into the buffer and written together,
+ * so for example an MQTT header and a short payload go out in one record and
+ * one TCP segment. Larger fragments are written directly from the caller's
+ * memory.
+ */
+#ifndef TLS_TRANSPORT_WRITEV_BUFFER_SIZE
+    #define TLS_TRANSPORT_WRITEV_BUFFER_SIZE    256U
+#endif
+
+/**
+ * @brief Set to 1 to resume TLS sessions when reconnecting to the same server.
+ *
+ * Resumption uses session tickets (RFC 5077) when #MBEDTLS_SSL_SESSION_TICKETS
+ * is defined, and session IDs otherwise, so a reconnect skips the key exchange
+ * and the certificate verification of a full handshake.
+ */
+#ifndef TLS_TRANSPORT_SESSION_CACHE
+    #define TLS_TRANSPORT_SESSION_CACHE    0
+#endif
+
+/**
+ * @brief Longest host name for which a TLS session is cached.
+ */
+#ifndef TLS_TRANSPORT_SESSION_CACHE_MAX_HOSTNAME_LENGTH
+    #define TLS_TRANSPORT_SESSION_CACHE_MAX_HOSTNAME_LENGTH    128U
+#endif
+
+#if ( TLS_TRANSPORT_SESSION_CACHE == 1 )
+
+    /**
+     * @brief TLS session saved from the last connection, and handshake counters.
+     *
+     * The cache lives in #TlsTransportParams_t and is kept across
+     * #TLS_FreeRTOS_Disconnect, so reusing the same parameters for the next
+     * #TLS_FreeRTOS_Connect resumes the session if the host name and port match.
+     */
+    typedef struct TlsSessionCache
+    {
+        BaseType_t sessionValid;                                               /**< @brief pdTRUE if session can be offered to the server. */
+        BaseType_t sessionOffered;                                             /**< @brief pdTRUE if session was set on the SSL context of the current handshake. */
+        char hostName[ TLS_TRANSPORT_SESSION_CACHE_MAX_HOSTNAME_LENGTH + 1U ]; /**< @brief Host name the session was established with. */
+        uint16_t port;                                                         /**< @brief Port the session was established with. */
+        mbedtls_ssl_session session;                                           /**< @brief Saved session. */
+        uint32_t fullHandshakes;                                               /**< @brief Number of full handshakes performed. */
+        uint32_t resumedHandshakes;                                            /**< @brief Number of handshakes that resumed the saved session. */
+    } TlsSessionCache_t;
+
+#endif /* if ( TLS_TRANSPORT_SESSION_CACHE == 1 ) */
+
 /**
  * @brief Parameters for the network context of the transport interface
  * implementation that uses mbedTLS and FreeRTOS+TCP sockets.
@@ -108,6 +179,10 @@ typedef struct TlsTransportParams
 {
     Socket_t tcpSocket;
     SSLContext_t sslContext;
+    TlsSharedContext_t * pSharedContext; /**< @brief Shared context to use, or NULL to set up the connection on its own. */
+    #if ( TLS_TRANSPORT_SESSION_CACHE == 1 )
+        TlsSessionCache_t sessionCache;
+    #endif
 } TlsTransportParams_t;
 
 /**
@@ -130,6 +205,14 @@ typedef struct NetworkCredentials
      */
     BaseType_t disableSni;
 
+    /**
+     * @brief To restrict the cipher suites offered in the ClientHello, set
+     * this to a 0-terminated list of mbedTLS cipher suite IDs in decreasing
+     * order of preference. The list is not copied and must remain valid while
+     * connections use it. NULL offers all cipher suites enabled in mbedTLS.
+     */
+    const int * pCiphersuites;
+
     const uint8_t * pRootCa;     /**< @brief String representing a trusted server root certificate. */
     size_t rootCaSize;           /**< @brief Size associated with #NetworkCredentials.pRootCa. */
     const uint8_t * pClientCert; /**< @brief String representing the client certificate. */
@@ -216,4 +299,83 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
                            const void * pBuffer,
                            size_t bytesToSend );
 
+/**
+ * @brief Sends several buffers over an established TLS connection.
+ *
+ * This is the TLS version of the transport interface's
+ * #TransportWritev_t function. Consecutive fragments shorter than
+ * #TLS_TRANSPORT_WRITEV_BUFFER_SIZE are sent in one TLS record.
+ *
+ * @param[in] pNetworkContext The network context.
+ * @param[in] pIoVec Array of buffers to send, in order.
+ * @param[in] ioVecCount Number of buffers in @p pIoVec.
+ *
+ * @return Number of bytes (> 0) sent on success;
+ * 0 if the socket times out without sending any bytes;
+ * else a negative value to represent error.
+ */
+int32_t TLS_FreeRTOS_writev( NetworkContext_t * pNetworkContext,
+                             TransportOutVector_t * pIoVec,
+                             size_t ioVecCount );
+
+/**
+ * @brief Set up a TLS context that can be shared by several connections.
+ *
+ * @param[out] pSharedContext Shared context to set up.
+ * @param[in] pNetworkCredentials Credentials used by all connections sharing the context.
+ * #NetworkCredentials_t.disableSni is still taken from the credentials passed to
+ * #TLS_FreeRTOS_Connect.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS, #TLS_TRANSPORT_INVALID_PARAMETER, #TLS_TRANSPORT_INSUFFICIENT_MEMORY,
+ * #TLS_TRANSPORT_INVALID_CREDENTIALS, or #TLS_TRANSPORT_INTERNAL_ERROR.
+ */
+TlsTransportStatus_t TLS_FreeRTOS_SharedContextInit( TlsSharedContext_t * pSharedContext,
+                                                     const NetworkCredentials_t * pNetworkCredentials );
+
+/**
+ * @brief Free a shared TLS context.
+ *
+ * @param[in] pSharedContext Shared context, no longer used by any connection.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS, or #TLS_TRANSPORT_INVALID_PARAMETER if a
+ * connection still uses the shared context.
+ */
+TlsTransportStatus_t TLS_FreeRTOS_SharedContextFree( TlsSharedContext_t * pSharedContext );
+
+#if ( TLS_TRANSPORT_SESSION_CACHE == 1 )
+
+    /**
+     * @brief Initialize the TLS session cache of a network context.
+     *
+     * Must be called once before the first #TLS_FreeRTOS_Connect with the
+     * parameters of the network context.
+     *
+     * @param[in] pNetworkContext Network context.
+     */
+    void TLS_FreeRTOS_SessionCacheInit( NetworkContext_t * pNetworkContext );
+
+    /**
+     * @brief Forget the saved TLS session of a network context, so the next
+     * #TLS_FreeRTOS_Connect performs a full handshake, and free its memory.
+     *
+     * The handshake counters are kept.
+     *
+     * @param[in] pNetworkContext Network context.
+     */
+    void TLS_FreeRTOS_SessionCacheFree( NetworkContext_t * pNetworkContext );
+
+    /**
+     * @brief Get the number of full and resumed handshakes performed with a
+     * network context.
+     *
+     * @param[in] pNetworkContext Network context.
+     * @param[out] pFullHandshakes Number of full handshakes.
+     * @param[out] pResumedHandshakes Number of resumed handshakes.
+     */
+    void TLS_FreeRTOS_GetHandshakeCounts( NetworkContext_t * pNetworkContext,
+                                          uint32_t * pFullHandshakes,
+                                          uint32_t * pResumedHandshakes );
+
+#endif /* if ( TLS_TRANSPORT_SESSION_CACHE == 1 ) */
+
 #endif /* ifndef USING_MBEDTLS */
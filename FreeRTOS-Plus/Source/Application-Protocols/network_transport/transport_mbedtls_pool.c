@@ -0,0 +1,464 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file transport_mbedtls_pool.c
+ * @brief Pool of TLS connections that are kept open between uses.
+ */
+
+#include "logging_levels.h"
+
+#define LIBRARY_LOG_NAME     "MbedtlsTransportPool"
+#define LIBRARY_LOG_LEVEL    LOG_INFO
+
+#include "logging_stack.h"
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* TLS connection pool header. */
+#include "transport_mbedtls_pool.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Each compilation unit that consumes the NetworkContext must define it.
+ * It should contain a single pointer as seen below whenever the header file
+ * of this transport implementation is included to your project.
+ */
+struct NetworkContext
+{
+    TlsTransportParams_t * pParams;
+};
+
+/**
+ * @brief State of a connection in the pool.
+ */
+typedef enum PoolSlotState
+{
+    POOL_SLOT_FREE = 0, /**< @brief Not connected. */
+    POOL_SLOT_IDLE,     /**< @brief Connected and available. */
+    POOL_SLOT_IN_USE    /**< @brief Handed out by #TLS_FreeRTOS_PoolAcquire. */
+} PoolSlotState_t;
+
+/**
+ * @brief A connection in the pool and the endpoint it was opened to.
+ */
+typedef struct PoolSlot
+{
+    PoolSlotState_t state;                             /**< @brief State of the connection. */
+    NetworkContext_t networkContext;                   /**< @brief Network context handed out to users. */
+    TlsTransportParams_t tlsTransportParams;           /**< @brief Parameters of the connection. */
+    char hostName[ TLS_POOL_MAX_HOSTNAME_LENGTH + 1 ]; /**< @brief Host name of the endpoint. */
+    uint16_t port;                                     /**< @brief Port of the endpoint. */
+    NetworkCredentials_t credentials;                  /**< @brief Credentials the connection was opened with. */
+    TickType_t releaseTime;                            /**< @brief Tick count when the connection became idle. */
+} PoolSlot_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The connections of the pool.
+ */
+static PoolSlot_t poolSlots[ TLS_POOL_MAX_CONNECTIONS ];
+
+/**
+ * @brief Counts the free and idle connections, bounding the number of
+ * connections in use.
+ */
+static SemaphoreHandle_t poolAvailableSemaphore = NULL;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check whether a connection was opened to an endpoint.
+ *
+ * @param[in] pSlot Connection to check.
+ * @param[in] pHostName Host name of the endpoint.
+ * @param[in] port Port of the endpoint.
+ * @param[in] pNetworkCredentials Credentials for the endpoint.
+ *
+ * @return pdTRUE if the host name, port and credentials match, else pdFALSE.
+ */
+static BaseType_t slotMatches( const PoolSlot_t * pSlot,
+                               const char * pHostName,
+                               uint16_t port,
+                               const NetworkCredentials_t * pNetworkCredentials );
+
+/**
+ * @brief Choose a connection for an endpoint and mark it in use. Called in a
+ * critical section, with a count taken from #poolAvailableSemaphore.
+ *
+ * In order of preference: an idle connection to the endpoint, an unused slot,
+ * the least recently used idle connection.
+ *
+ * @param[in] pHostName Host name of the endpoint.
+ * @param[in] port Port of the endpoint.
+ * @param[in] pNetworkCredentials Credentials for the endpoint.
+ * @param[out] pPreviousState State of the chosen slot before it was marked in use.
+ *
+ * @return The chosen connection.
+ */
+static PoolSlot_t * claimSlot( const char * pHostName,
+                               uint16_t port,
+                               const NetworkCredentials_t * pNetworkCredentials,
+                               PoolSlotState_t * pPreviousState );
+
+/**
+ * @brief Check whether an idle connection can still be used.
+ *
+ * @param[in] pSlot Idle connection.
+ *
+ * @return pdTRUE if the connection has not timed out and is still connected.
+ */
+static BaseType_t slotIsHealthy( const PoolSlot_t * pSlot );
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t slotMatches( const PoolSlot_t * pSlot,
+                               const char * pHostName,
+                               uint16_t port,
+                               const NetworkCredentials_t * pNetworkCredentials )
+{
+    BaseType_t matches = pdFALSE;
+
+    /* Credentials are compared by reference, the certificate and key buffers
+     * are not parsed again to compare them. */
+    if( ( pSlot->port == port ) &&
+        ( strcmp( pSlot->hostName, pHostName ) == 0 ) &&
+        ( pSlot->credentials.pAlpnProtos == pNetworkCredentials->pAlpnProtos ) &&
+        ( pSlot->credentials.disableSni == pNetworkCredentials->disableSni ) &&
+        ( pSlot->credentials.pCiphersuites == pNetworkCredentials->pCiphersuites ) &&
+        ( pSlot->credentials.pRootCa == pNetworkCredentials->pRootCa ) &&
+        ( pSlot->credentials.rootCaSize == pNetworkCredentials->rootCaSize ) &&
+        ( pSlot->credentials.pClientCert == pNetworkCredentials->pClientCert ) &&
+        ( pSlot->credentials.clientCertSize == pNetworkCredentials->clientCertSize ) &&
+        ( pSlot->credentials.pPrivateKey == pNetworkCredentials->pPrivateKey ) &&
+        ( pSlot->credentials.privateKeySize == pNetworkCredentials->privateKeySize ) )
+    {
+        matches = pdTRUE;
+    }
+
+    return matches;
+}
+/*-----------------------------------------------------------*/
+
+static PoolSlot_t * claimSlot( const char * pHostName,
+                               uint16_t port,
+                               const NetworkCredentials_t * pNetworkCredentials,
+                               PoolSlotState_t * pPreviousState )
+{
+    PoolSlot_t * pMatching = NULL;
+    PoolSlot_t * pFree = NULL;
+    PoolSlot_t * pOldestIdle = NULL;
+    PoolSlot_t * pSlot = NULL;
+    TickType_t now = xTaskGetTickCount();
+    size_t i;
+
+    for( i = 0; i < TLS_POOL_MAX_CONNECTIONS; i++ )
+    {
+        if( poolSlots[ i ].state == POOL_SLOT_IDLE )
+        {
+            if( ( pMatching == NULL ) &&
+                ( slotMatches( &( poolSlots[ i ] ), pHostName, port, pNetworkCredentials ) == pdTRUE ) )
+            {
+                pMatching = &( poolSlots[ i ] );
+            }
+
+            if( ( pOldestIdle == NULL ) ||
+                ( ( now - poolSlots[ i ].releaseTime ) > ( now - pOldestIdle->releaseTime ) ) )
+            {
+                pOldestIdle = &( poolSlots[ i ] );
+            }
+        }
+        else if( ( poolSlots[ i ].state == POOL_SLOT_FREE ) && ( pFree == NULL ) )
+        {
+            pFree = &( poolSlots[ i ] );
+        }
+        else
+        {
+            /* Connection in use. */
+        }
+    }
+
+    if( pMatching != NULL )
+    {
+        pSlot = pMatching;
+    }
+    else if( pFree != NULL )
+    {
+        pSlot = pFree;
+    }
+    else
+    {
+        pSlot = pOldestIdle;
+    }
+
+    /* The semaphore count guarantees a free or idle slot. */
+    configASSERT( pSlot != NULL );
+
+    *pPreviousState = pSlot->state;
+    pSlot->state = POOL_SLOT_IN_USE;
+
+    return pSlot;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t slotIsHealthy( const PoolSlot_t * pSlot )
+{
+    BaseType_t healthy = pdFALSE;
+
+    if( ( xTaskGetTickCount() - pSlot->releaseTime ) >= pdMS_TO_TICKS( TLS_POOL_IDLE_TIMEOUT_MS ) )
+    {
+        LogDebug( ( "Idle connection to %s:%u timed out.",
+                    pSlot->hostName,
+                    ( unsigned int ) pSlot->port ) );
+    }
+    else if( TCP_Sockets_IsConnected( pSlot->tlsTransportParams.tcpSocket ) != pdTRUE )
+    {
+        LogDebug( ( "Idle connection to %s:%u was closed by the server.",
+                    pSlot->hostName,
+                    ( unsigned int ) pSlot->port ) );
+    }
+    else
+    {
+        healthy = pdTRUE;
+    }
+
+    return healthy;
+}
+/*-----------------------------------------------------------*/
+
+TlsTransportStatus_t TLS_FreeRTOS_PoolInit( void )
+{
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+    size_t i;
+
+    configASSERT( poolAvailableSemaphore == NULL );
+
+    ( void ) memset( poolSlots, 0, sizeof( poolSlots ) );
+
+    for( i = 0; i < TLS_POOL_MAX_CONNECTIONS; i++ )
+    {
+        poolSlots[ i ].networkContext.pParams = &( poolSlots[ i ].tlsTransportParams );
+    }
+
+    poolAvailableSemaphore = xSemaphoreCreateCounting( TLS_POOL_MAX_CONNECTIONS,
+                                                       TLS_POOL_MAX_CONNECTIONS );
+
+    if( poolAvailableSemaphore == NULL )
+    {
+        LogError( ( "Failed to create the connection pool semaphore." ) );
+        returnStatus = TLS_TRANSPORT_INSUFFICIENT_MEMORY;
+    }
+
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
+
+TlsTransportStatus_t TLS_FreeRTOS_PoolAcquire( NetworkContext_t ** ppNetworkContext,
+                                               const char * pHostName,
+                                               uint16_t port,
+                                               const NetworkCredentials_t * pNetworkCredentials,
+                                               uint32_t receiveTimeoutMs,
+                                               uint32_t sendTimeoutMs )
+{
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+    PoolSlot_t * pSlot = NULL;
+    PoolSlotState_t previousState = POOL_SLOT_FREE;
+    BaseType_t reuse = pdFALSE;
+
+    if( ( ppNetworkContext == NULL ) ||
+        ( pHostName == NULL ) ||
+        ( pNetworkCredentials == NULL ) )
+    {
+        LogError( ( "Invalid input parameter(s): Arguments cannot be NULL. ppNetworkContext=%p, "
+                    "pHostName=%p, pNetworkCredentials=%p.",
+                    ppNetworkContext,
+                    pHostName,
+                    pNetworkCredentials ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+    else if( strlen( pHostName ) > TLS_POOL_MAX_HOSTNAME_LENGTH )
+    {
+        LogError( ( "Host name %s is longer than TLS_POOL_MAX_HOSTNAME_LENGTH.",
+                    pHostName ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+    else if( xSemaphoreTake( poolAvailableSemaphore, pdMS_TO_TICKS( TLS_POOL_ACQUIRE_TIMEOUT_MS ) ) != pdTRUE )
+    {
+        LogError( ( "All %u pooled connections are in use.",
+                    ( unsigned int ) TLS_POOL_MAX_CONNECTIONS ) );
+        returnStatus = TLS_TRANSPORT_CONNECT_FAILURE;
+    }
+    else
+    {
+        taskENTER_CRITICAL();
+        {
+            pSlot = claimSlot( pHostName, port, pNetworkCredentials, &previousState );
+        }
+        taskEXIT_CRITICAL();
+
+        if( previousState == POOL_SLOT_IDLE )
+        {
+            if( ( slotMatches( pSlot, pHostName, port, pNetworkCredentials ) == pdTRUE ) &&
+                ( slotIsHealthy( pSlot ) == pdTRUE ) )
+            {
+                reuse = pdTRUE;
+            }
+            else
+            {
+                TLS_FreeRTOS_Disconnect( &( pSlot->networkContext ) );
+            }
+        }
+
+        if( reuse == pdTRUE )
+        {
+            LogDebug( ( "Reusing connection to %s:%u.",
+                        pHostName,
+                        ( unsigned int ) port ) );
+        }
+        else
+        {
+            ( void ) strcpy( pSlot->hostName, pHostName );
+            pSlot->port = port;
+            pSlot->credentials = *pNetworkCredentials;
+
+            /* The parameters are not cleared, so a session cached by the
+             * previous connection of this slot can be resumed. */
+            returnStatus = TLS_FreeRTOS_Connect( &( pSlot->networkContext ),
+                                                 pHostName,
+                                                 port,
+                                                 pNetworkCredentials,
+                                                 receiveTimeoutMs,
+                                                 sendTimeoutMs );
+
+            if( returnStatus != TLS_TRANSPORT_SUCCESS )
+            {
+                pSlot->hostName[ 0 ] = '\0';
+                pSlot->state = POOL_SLOT_FREE;
+                ( void ) xSemaphoreGive( poolAvailableSemaphore );
+            }
+        }
+
+        if( returnStatus == TLS_TRANSPORT_SUCCESS )
+        {
+            *ppNetworkContext = &( pSlot->networkContext );
+        }
+    }
+
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
+
+void TLS_FreeRTOS_PoolRelease( NetworkContext_t * pNetworkContext,
+                               BaseType_t keepAlive )
+{
+    PoolSlot_t * pSlot = NULL;
+    size_t i;
+
+    for( i = 0; i < TLS_POOL_MAX_CONNECTIONS; i++ )
+    {
+        if( pNetworkContext == &( poolSlots[ i ].networkContext ) )
+        {
+            pSlot = &( poolSlots[ i ] );
+        }
+    }
+
+    if( ( pSlot == NULL ) || ( pSlot->state != POOL_SLOT_IN_USE ) )
+    {
+        LogError( ( "Network context %p was not acquired from the pool.",
+                    pNetworkContext ) );
+    }
+    else
+    {
+        if( ( keepAlive == pdTRUE ) &&
+            ( TCP_Sockets_IsConnected( pSlot->tlsTransportParams.tcpSocket ) == pdTRUE ) )
+        {
+            pSlot->releaseTime = xTaskGetTickCount();
+            pSlot->state = POOL_SLOT_IDLE;
+        }
+        else
+        {
+            TLS_FreeRTOS_Disconnect( pNetworkContext );
+            pSlot->hostName[ 0 ] = '\0';
+            pSlot->state = POOL_SLOT_FREE;
+        }
+
+        ( void ) xSemaphoreGive( poolAvailableSemaphore );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void TLS_FreeRTOS_PoolCloseIdle( void )
+{
+    PoolSlot_t * pSlot = NULL;
+    BaseType_t claimed = pdFALSE;
+    size_t i;
+
+    for( i = 0; i < TLS_POOL_MAX_CONNECTIONS; i++ )
+    {
+        pSlot = &( poolSlots[ i ] );
+        claimed = pdFALSE;
+
+        /* Take a count like #TLS_FreeRTOS_PoolAcquire does, so an acquire
+         * running at the same time still finds a free or idle slot. */
+        if( xSemaphoreTake( poolAvailableSemaphore, 0 ) == pdTRUE )
+        {
+            taskENTER_CRITICAL();
+            {
+                if( pSlot->state == POOL_SLOT_IDLE )
+                {
+                    pSlot->state = POOL_SLOT_IN_USE;
+                    claimed = pdTRUE;
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if( claimed == pdTRUE )
+            {
+                if( slotIsHealthy( pSlot ) == pdTRUE )
+                {
+                    pSlot->state = POOL_SLOT_IDLE;
+                }
+                else
+                {
+                    TLS_FreeRTOS_Disconnect( &( pSlot->networkContext ) );
+                    pSlot->hostName[ 0 ] = '\0';
+                    pSlot->state = POOL_SLOT_FREE;
+                }
+            }
+
+            ( void ) xSemaphoreGive( poolAvailableSemaphore );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
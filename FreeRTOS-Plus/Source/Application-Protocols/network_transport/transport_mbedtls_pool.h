@@ -0,0 +1,126 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file transport_mbedtls_pool.h
+ * @brief Pool of TLS connections that are kept open between uses.
+ */
+
+#ifndef TRANSPORT_MBEDTLS_POOL_H
+#define TRANSPORT_MBEDTLS_POOL_H
+
+/* TLS transport header. */
+#include "transport_mbedtls.h"
+
+/**
+ * @brief Maximum number of connections in the pool, idle or in use.
+ *
+ * #TLS_FreeRTOS_PoolAcquire blocks while this many connections are in use.
+ */
+#ifndef TLS_POOL_MAX_CONNECTIONS
+    #define TLS_POOL_MAX_CONNECTIONS    2U
+#endif
+
+/**
+ * @brief Time (in milliseconds) after which an idle connection is closed
+ * instead of being reused.
+ */
+#ifndef TLS_POOL_IDLE_TIMEOUT_MS
+    #define TLS_POOL_IDLE_TIMEOUT_MS    60000U
+#endif
+
+/**
+ * @brief Time (in milliseconds) #TLS_FreeRTOS_PoolAcquire waits for a
+ * connection to be released when all of them are in use.
+ */
+#ifndef TLS_POOL_ACQUIRE_TIMEOUT_MS
+    #define TLS_POOL_ACQUIRE_TIMEOUT_MS    30000U
+#endif
+
+/**
+ * @brief Longest host name the pool can connect to.
+ */
+#ifndef TLS_POOL_MAX_HOSTNAME_LENGTH
+    #define TLS_POOL_MAX_HOSTNAME_LENGTH    128U
+#endif
+
+/**
+ * @brief Create the pool. Must be called once before any other pool function.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS, or #TLS_TRANSPORT_INSUFFICIENT_MEMORY.
+ */
+TlsTransportStatus_t TLS_FreeRTOS_PoolInit( void );
+
+/**
+ * @brief Get a TLS connection to a server, reusing an idle one when possible.
+ *
+ * An idle connection is reused if it was opened to the same host name and port
+ * with the same credentials, it has been idle for less than
+ * #TLS_POOL_IDLE_TIMEOUT_MS and its socket is still connected. Otherwise a new
+ * connection is opened, closing the least recently used idle connection if the
+ * pool is full.
+ *
+ * The credentials are compared and kept by reference, so the buffers they
+ * point to must stay valid while the connection is in the pool.
+ *
+ * @param[out] ppNetworkContext Set to the network context of the connection.
+ * @param[in] pHostName The hostname of the remote endpoint.
+ * @param[in] port The destination port.
+ * @param[in] pNetworkCredentials Credentials for the TLS connection.
+ * @param[in] receiveTimeoutMs Receive socket timeout of a new connection.
+ * @param[in] sendTimeoutMs Send socket timeout of a new connection.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS, #TLS_TRANSPORT_INVALID_PARAMETER,
+ * #TLS_TRANSPORT_CONNECT_FAILURE if no connection became free in time, or
+ * an error of #TLS_FreeRTOS_Connect.
+ */
+TlsTransportStatus_t TLS_FreeRTOS_PoolAcquire( NetworkContext_t ** ppNetworkContext,
+                                               const char * pHostName,
+                                               uint16_t port,
+                                               const NetworkCredentials_t * pNetworkCredentials,
+                                               uint32_t receiveTimeoutMs,
+                                               uint32_t sendTimeoutMs );
+
+/**
+ * @brief Give a connection back to the pool.
+ *
+ * @param[in] pNetworkContext Network context returned by #TLS_FreeRTOS_PoolAcquire.
+ * @param[in] keepAlive pdTRUE to keep the connection open for the next
+ * #TLS_FreeRTOS_PoolAcquire, pdFALSE to close it, for example after a
+ * transport error or when the server asked to close the connection.
+ */
+void TLS_FreeRTOS_PoolRelease( NetworkContext_t * pNetworkContext,
+                               BaseType_t keepAlive );
+
+/**
+ * @brief Close idle connections that timed out or were closed by the server.
+ *
+ * #TLS_FreeRTOS_PoolAcquire checks idle connections before reusing them, so
+ * calling this function is only needed to free their memory earlier.
+ */
+void TLS_FreeRTOS_PoolCloseIdle( void );
+
+#endif /* ifndef TRANSPORT_MBEDTLS_POOL_H */
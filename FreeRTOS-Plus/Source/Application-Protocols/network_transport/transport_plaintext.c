@@ -181,3 +181,36 @@ int32_t Plaintext_FreeRTOS_send( NetworkContext_t * pNetworkContext,
 
     return socketStatus;
 }
+
+int32_t Plaintext_FreeRTOS_writev( NetworkContext_t * pNetworkContext,
+                                   TransportOutVector_t * pIoVec,
+                                   size_t ioVecCount )
+{
+    PlaintextTransportParams_t * pPlaintextTransportParams = NULL;
+    int32_t socketStatus = 0;
+
+    if( ( pNetworkContext == NULL ) || ( pNetworkContext->pParams == NULL ) )
+    {
+        LogError( ( "invalid input, pNetworkContext=%p", pNetworkContext ) );
+        socketStatus = -1;
+    }
+    else if( pIoVec == NULL )
+    {
+        LogError( ( "invalid input, pIoVec == NULL" ) );
+        socketStatus = -1;
+    }
+    else if( ioVecCount == 0 )
+    {
+        LogError( ( "invalid input, ioVecCount == 0" ) );
+        socketStatus = -1;
+    }
+    else
+    {
+        pPlaintextTransportParams = pNetworkContext->pParams;
+        socketStatus = TCP_Sockets_SendVector( pPlaintextTransportParams->tcpSocket,
+                                               pIoVec,
+                                               ioVecCount );
+    }
+
+    return socketStatus;
+}
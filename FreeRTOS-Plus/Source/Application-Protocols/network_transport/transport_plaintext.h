@@ -149,4 +149,18 @@ int32_t Plaintext_FreeRTOS_send( NetworkContext_t * pNetworkContext,
                                  const void * pBuffer,
                                  size_t bytesToSend );
 
+/**
+ * @brief Sends several buffers over an established TCP connection.
+ *
+ * @param[in] pNetworkContext The network context containing the TCP socket
+ * handle.
+ * @param[in] pIoVec Array of buffers to send, in order.
+ * @param[in] ioVecCount Number of buffers in @p pIoVec.
+ *
+ * @return Number of bytes sent on success; else a negative value.
+ */
+int32_t Plaintext_FreeRTOS_writev( NetworkContext_t * pNetworkContext,
+                                   TransportOutVector_t * pIoVec,
+                                   size_t ioVecCount );
+
 #endif /* ifndef USING_PLAINTEXT_H */
@@ -35,6 +35,7 @@
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
+#include "task.h"
 
 /* FreeRTOS+TCP includes. */
 #include "FreeRTOS_IP.h"
@@ -120,14 +121,22 @@ static int wolfSSL_IOSendGlue( WOLFSSL * ssl,
 /*
  *  @brief  Load credentials from file/buffer
  *
- *  @param[in] pNetCtx  NetworkContext_t
+ *  @param[in] pCtx     WOLFSSL_CTX to load the credentials into
  *  @param[in] pNetCred NetworkCredentials_t
  *
  *  @return #TLS_TRANSPORT_SUCCESS, #TLS_TRANSPORT_INVALID_CREDENTIALS.
  */
-static TlsTransportStatus_t loadCredentials( NetworkContext_t * pNetCtx,
+static TlsTransportStatus_t loadCredentials( WOLFSSL_CTX * pCtx,
                                              const NetworkCredentials_t * pNetCred );
 
+/*
+ *  @brief  Free the WOLFSSL_CTX of a connection, or release the shared
+ *          context if the connection uses one
+ *
+ *  @param[in] pNetCtx  NetworkContext_t
+ */
+static void releaseContext( NetworkContext_t * pNetCtx );
+
 /*-----------------------------------------------------------*/
 static int wolfSSL_IORecvGlue( WOLFSSL * ssl,
                                char * buf,
@@ -199,24 +208,24 @@ static TlsTransportStatus_t initTLS( void )
 }
 
 /*-----------------------------------------------------------*/
-static TlsTransportStatus_t loadCredentials( NetworkContext_t * pNetCtx,
+static TlsTransportStatus_t loadCredentials( WOLFSSL_CTX * pCtx,
                                              const NetworkCredentials_t * pNetCred )
 {
     TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
 
-    configASSERT( pNetCtx != NULL );
+    configASSERT( pCtx != NULL );
     configASSERT( pNetCred != NULL );
 
     #if defined( democonfigCREDENTIALS_IN_BUFFER )
-        if( wolfSSL_CTX_load_verify_buffer( pNetCtx->sslContext.ctx,
+        if( wolfSSL_CTX_load_verify_buffer( pCtx,
                                             ( const byte * ) ( pNetCred->pRootCa ), ( long ) ( pNetCred->rootCaSize ),
                                             SSL_FILETYPE_PEM ) == SSL_SUCCESS )
         {
-            if( wolfSSL_CTX_use_certificate_buffer( pNetCtx->sslContext.ctx,
+            if( wolfSSL_CTX_use_certificate_buffer( pCtx,
                                                     ( const byte * ) ( pNetCred->pClientCert ), ( long ) ( pNetCred->clientCertSize ),
                                                     SSL_FILETYPE_PEM ) == SSL_SUCCESS )
             {
-                if( wolfSSL_CTX_use_PrivateKey_buffer( pNetCtx->sslContext.ctx,
+                if( wolfSSL_CTX_use_PrivateKey_buffer( pCtx,
                                                        ( const byte * ) ( pNetCred->pPrivateKey ), ( long ) ( pNetCred->privateKeySize ),
                                                        SSL_FILETYPE_PEM ) == SSL_SUCCESS )
                 {
@@ -242,14 +251,14 @@ static TlsTransportStatus_t loadCredentials( NetworkContext_t * pNetCtx,
 
         return returnStatus;
     #else /* if defined( democonfigCREDENTIALS_IN_BUFFER ) */
-        if( wolfSSL_CTX_load_verify_locations( pNetCtx->sslContext.ctx,
+        if( wolfSSL_CTX_load_verify_locations( pCtx,
                                                ( const char * ) ( pNetCred->pRootCa ), NULL ) == SSL_SUCCESS )
         {
-            if( wolfSSL_CTX_use_certificate_file( pNetCtx->sslContext.ctx,
+            if( wolfSSL_CTX_use_certificate_file( pCtx,
                                                   ( const char * ) ( pNetCred->pClientCert ), SSL_FILETYPE_PEM )
                 == SSL_SUCCESS )
             {
-                if( wolfSSL_CTX_use_PrivateKey_file( pNetCtx->sslContext.ctx,
+                if( wolfSSL_CTX_use_PrivateKey_file( pCtx,
                                                      ( const char * ) ( pNetCred->pPrivateKey ), SSL_FILETYPE_PEM )
                     == SSL_SUCCESS )
                 {
@@ -276,6 +285,28 @@ static TlsTransportStatus_t loadCredentials( NetworkContext_t * pNetCtx,
     #endif /* if defined( democonfigCREDENTIALS_IN_BUFFER ) */
 }
 
+/*-----------------------------------------------------------*/
+static void releaseContext( NetworkContext_t * pNetCtx )
+{
+    configASSERT( pNetCtx != NULL );
+
+    if( pNetCtx->pSharedContext != NULL )
+    {
+        taskENTER_CRITICAL();
+        {
+            configASSERT( pNetCtx->pSharedContext->referenceCount > 0U );
+            pNetCtx->pSharedContext->referenceCount--;
+        }
+        taskEXIT_CRITICAL();
+    }
+    else
+    {
+        wolfSSL_CTX_free( pNetCtx->sslContext.ctx );
+    }
+
+    pNetCtx->sslContext.ctx = NULL;
+}
+
 /*-----------------------------------------------------------*/
 
 static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetCtx,
@@ -291,7 +322,18 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetCtx,
     configASSERT( pNetCred->pRootCa != NULL );
     configASSERT( pNetCtx->tcpSocket != NULL );
 
-    if( pNetCtx->sslContext.ctx == NULL )
+    if( pNetCtx->pSharedContext != NULL )
+    {
+        /* The credentials are already loaded into the shared context. */
+        taskENTER_CRITICAL();
+        {
+            pNetCtx->pSharedContext->referenceCount++;
+        }
+        taskEXIT_CRITICAL();
+
+        pNetCtx->sslContext.ctx = pNetCtx->pSharedContext->ctx;
+    }
+    else if( pNetCtx->sslContext.ctx == NULL )
     {
         /* Attempt to create a context that uses the TLS 1.3 or 1.2 */
         pNetCtx->sslContext.ctx =
@@ -301,7 +343,8 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetCtx,
     if( pNetCtx->sslContext.ctx != NULL )
     {
         /* load credentials from file */
-        if( loadCredentials( pNetCtx, pNetCred ) == TLS_TRANSPORT_SUCCESS )
+        if( ( pNetCtx->pSharedContext != NULL ) ||
+            ( loadCredentials( pNetCtx->sslContext.ctx, pNetCred ) == TLS_TRANSPORT_SUCCESS ) )
         {
             /* create a ssl object */
             pNetCtx->sslContext.ssl =
@@ -332,8 +375,7 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetCtx,
                     wolfSSL_shutdown( pNetCtx->sslContext.ssl );
                     wolfSSL_free( pNetCtx->sslContext.ssl );
                     pNetCtx->sslContext.ssl = NULL;
-                    wolfSSL_CTX_free( pNetCtx->sslContext.ctx );
-                    pNetCtx->sslContext.ctx = NULL;
+                    releaseContext( pNetCtx );
 
                     LogError( ( "Failed to establish a TLS connection" ) );
                     returnStatus = TLS_TRANSPORT_HANDSHAKE_FAILED;
@@ -341,8 +383,7 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetCtx,
             }
             else
             {
-                wolfSSL_CTX_free( pNetCtx->sslContext.ctx );
-                pNetCtx->sslContext.ctx = NULL;
+                releaseContext( pNetCtx );
 
                 LogError( ( "Failed to create wolfSSL object" ) );
                 returnStatus = TLS_TRANSPORT_INTERNAL_ERROR;
@@ -350,8 +391,7 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetCtx,
         }
         else
         {
-            wolfSSL_CTX_free( pNetCtx->sslContext.ctx );
-            pNetCtx->sslContext.ctx = NULL;
+            releaseContext( pNetCtx );
 
             LogError( ( "Failed to load credentials" ) );
             returnStatus = TLS_TRANSPORT_INVALID_CREDENTIALS;
@@ -359,6 +399,8 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetCtx,
     }
     else
     {
+        releaseContext( pNetCtx );
+
         LogError( ( "Failed to create a wolfSSL_CTX" ) );
         returnStatus = TLS_TRANSPORT_CONNECT_FAILURE;
     }
@@ -457,7 +499,6 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
 void TLS_FreeRTOS_Disconnect( NetworkContext_t * pNetworkContext )
 {
     WOLFSSL * pSsl = pNetworkContext->sslContext.ssl;
-    WOLFSSL_CTX * pCtx = NULL;
 
     /* shutdown an active TLS connection */
     wolfSSL_shutdown( pSsl );
@@ -469,11 +510,8 @@ void TLS_FreeRTOS_Disconnect( NetworkContext_t * pNetworkContext )
     /* Call socket shutdown function to close connection. */
     TCP_Sockets_Disconnect( pNetworkContext->tcpSocket );
 
-    /* free WOLFSSL_CTX object*/
-    pCtx = pNetworkContext->sslContext.ctx;
-
-    wolfSSL_CTX_free( pCtx );
-    pNetworkContext->sslContext.ctx = NULL;
+    /* free WOLFSSL_CTX object, unless it is shared */
+    releaseContext( pNetworkContext );
 
     wolfSSL_Cleanup();
 }
@@ -578,3 +616,87 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
     return tlsStatus;
 }
 /*-----------------------------------------------------------*/
+
+TlsTransportStatus_t TLS_FreeRTOS_SharedContextInit( TlsSharedContext_t * pSharedContext,
+                                                     const NetworkCredentials_t * pNetworkCredentials )
+{
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+
+    if( ( pSharedContext == NULL ) ||
+        ( pNetworkCredentials == NULL ) ||
+        ( pNetworkCredentials->pRootCa == NULL ) )
+    {
+        LogError( ( "Invalid input parameter(s): pSharedContext=%p, pNetworkCredentials=%p.",
+                    pSharedContext,
+                    pNetworkCredentials ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+
+    if( returnStatus == TLS_TRANSPORT_SUCCESS )
+    {
+        pSharedContext->referenceCount = 0;
+
+        /* Balanced by wolfSSL_Cleanup() in TLS_FreeRTOS_SharedContextFree(). */
+        returnStatus = initTLS();
+    }
+
+    if( returnStatus == TLS_TRANSPORT_SUCCESS )
+    {
+        /* Attempt to create a context that uses the TLS 1.3 or 1.2 */
+        pSharedContext->ctx = wolfSSL_CTX_new( wolfSSLv23_client_method_ex( NULL ) );
+
+        if( pSharedContext->ctx == NULL )
+        {
+            LogError( ( "Failed to create a wolfSSL_CTX" ) );
+            returnStatus = TLS_TRANSPORT_INSUFFICIENT_MEMORY;
+        }
+        else if( loadCredentials( pSharedContext->ctx, pNetworkCredentials ) != TLS_TRANSPORT_SUCCESS )
+        {
+            wolfSSL_CTX_free( pSharedContext->ctx );
+            pSharedContext->ctx = NULL;
+
+            LogError( ( "Failed to load credentials" ) );
+            returnStatus = TLS_TRANSPORT_INVALID_CREDENTIALS;
+        }
+        else
+        {
+            /* Empty else for MISRA 15.7 compliance. */
+        }
+
+        if( returnStatus != TLS_TRANSPORT_SUCCESS )
+        {
+            wolfSSL_Cleanup();
+        }
+    }
+
+    return returnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+TlsTransportStatus_t TLS_FreeRTOS_SharedContextFree( TlsSharedContext_t * pSharedContext )
+{
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+
+    if( pSharedContext == NULL )
+    {
+        LogError( ( "Invalid input parameter: pSharedContext cannot be NULL." ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+    else if( pSharedContext->referenceCount != 0U )
+    {
+        LogError( ( "Shared wolfSSL context is still used by %u connection(s).",
+                    ( unsigned int ) pSharedContext->referenceCount ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+    else
+    {
+        wolfSSL_CTX_free( pSharedContext->ctx );
+        pSharedContext->ctx = NULL;
+
+        wolfSSL_Cleanup();
+    }
+
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
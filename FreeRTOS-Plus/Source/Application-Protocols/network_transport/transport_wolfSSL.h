@@ -75,6 +75,20 @@ typedef struct SSLContext
     WOLFSSL* ssl;                         /**< @brief wolfSSL ssl session context */
 } SSLContext_t;
 
+/**
+ * @brief wolfSSL context with loaded credentials, shared by several connections.
+ *
+ * #TLS_FreeRTOS_SharedContextInit creates the WOLFSSL_CTX and loads the
+ * credentials into it once. A connection whose NetworkContext.pSharedContext
+ * points to the shared context only creates its own WOLFSSL object in
+ * #TLS_FreeRTOS_Connect.
+ */
+typedef struct TlsSharedContext
+{
+    WOLFSSL_CTX* ctx;               /**< @brief Shared wolfSSL context */
+    UBaseType_t referenceCount;     /**< @brief Number of connections using the shared context */
+} TlsSharedContext_t;
+
 /**
  * @brief Definition of the network context for the transport interface
  * implementation that uses mbedTLS and FreeRTOS+TLS sockets.
@@ -83,6 +97,7 @@ struct NetworkContext
 {
     Socket_t tcpSocket;
     SSLContext_t sslContext;
+    TlsSharedContext_t * pSharedContext; /**< @brief Shared context to use, or NULL to set up the connection on its own. */
 };
 
 /**
@@ -196,4 +211,26 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
                            const void * pBuffer,
                            size_t bytesToSend );
 
+/**
+ * @brief Set up a wolfSSL context that can be shared by several connections.
+ *
+ * @param[out] pSharedContext Shared context to set up.
+ * @param[in] pNetworkCredentials Credentials used by all connections sharing the context.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS, #TLS_TRANSPORT_INVALID_PARAMETER, #TLS_TRANSPORT_INSUFFICIENT_MEMORY,
+ * or #TLS_TRANSPORT_INVALID_CREDENTIALS.
+ */
+TlsTransportStatus_t TLS_FreeRTOS_SharedContextInit( TlsSharedContext_t * pSharedContext,
+                                                     const NetworkCredentials_t * pNetworkCredentials );
+
+/**
+ * @brief Free a shared wolfSSL context.
+ *
+ * @param[in] pSharedContext Shared context, no longer used by any connection.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS, or #TLS_TRANSPORT_INVALID_PARAMETER if a
+ * connection still uses the shared context.
+ */
+TlsTransportStatus_t TLS_FreeRTOS_SharedContextFree( TlsSharedContext_t * pSharedContext );
+
 #endif /* ifndef USING_WOLFSSL_H */
@@ -35,6 +35,14 @@
 /* Utils includes. */
 #include "FreeRTOS_CLI.h"
 
+#if( !defined( configCLI_SESSION_THREAD_LOCAL_INDEX ) && ( configUSE_MUTEXES == 1 ) )
+	#include "semphr.h"
+#endif
+
+#if( configCLI_INCLUDE_STREAM_BUFFER_OUTPUT == 1 )
+	#include "stream_buffer.h"
+#endif
+
 /* If the application writer needs to place the buffer used by the CLI at a
 fixed address then set configAPPLICATION_PROVIDES_cOutputBuffer to 1 in
 FreeRTOSConfig.h, then declare an array with the following name and size in
@@ -45,6 +53,23 @@ one of the application files:
 	#define configAPPLICATION_PROVIDES_cOutputBuffer 0
 #endif
 
+/* Registered commands are found by hashing the first word of the command
+string into one of configCLI_COMMAND_HASH_SIZE buckets, so only the commands in
+that bucket are compared.  Must be a power of 2. */
+#ifndef configCLI_COMMAND_HASH_SIZE
+	#define configCLI_COMMAND_HASH_SIZE 16
+#endif
+
+#if( ( configCLI_COMMAND_HASH_SIZE & ( configCLI_COMMAND_HASH_SIZE - 1 ) ) != 0 )
+	#error configCLI_COMMAND_HASH_SIZE must be a power of 2
+#endif
+
+/* The maximum time FreeRTOS_CLIStreamBufferOutput() waits for space in the
+stream buffer. */
+#ifndef configCLI_STREAM_BUFFER_OUTPUT_WAIT
+	#define configCLI_STREAM_BUFFER_OUTPUT_WAIT portMAX_DELAY
+#endif
+
 /*
  * Register the command passed in using the pxCommandToRegister parameter
  * and using pxCliDefinitionListItemBuffer as the memory for command line
@@ -62,9 +87,45 @@ static void prvRegisterCommand( const CLI_Command_Definition_t * const pxCommand
 static BaseType_t prvHelpCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
 
 /*
- * Return the number of parameters that follow the command name.
+ * Return the hash bucket of the first space delimited word in pcCommandString.
+ */
+static UBaseType_t prvHashCommandWord( const char *pcCommandString );
+
+/*
+ * Add a list item to the end of its hash bucket, so commands that share a
+ * bucket are still matched in the order they were registered.
+ */
+static void prvAddToHashTable( CLI_Definition_List_Item_t *pxListItem );
+
+/*
+ * Add the help command to the hash table, if it has not been added already.
+ * Must be called from a critical section.
  */
-static int8_t prvGetNumberOfParameters( const char *pcCommandString );
+static void prvInitialiseHashTable( void );
+
+/*
+ * Return the registered command that pcCommandInput starts with, or NULL if
+ * there is not one.
+ */
+static const CLI_Definition_List_Item_t *prvFindCommand( const char * const pcCommandInput );
+
+/*
+ * Record or return the session of the command being run by the calling task.
+ * prvGetCurrentSession() returns the default session if the task is not
+ * running a command.  Without configCLI_SESSION_THREAD_LOCAL_INDEX there is
+ * only one current session, so prvSetCurrentSession() waits until no other
+ * task is running a command, and prvReleaseCurrentSession() lets the next one
+ * run.
+ */
+static void prvSetCurrentSession( CLI_Session_t *pxSession );
+static void prvReleaseCurrentSession( void );
+static CLI_Session_t *prvGetCurrentSession( void );
+
+/*
+ * The body of FreeRTOS_CLIProcessCommandInSession(), called once the session
+ * has been made the current session.
+ */
+static BaseType_t prvProcessCommand( CLI_Session_t *pxSession, const char * const pcCommandInput, char * pcWriteBuffer, size_t xWriteBufferLen );
 
 /* The definition of the "help" command.  This command is always at the front
 of the list of registered commands. */
@@ -81,17 +142,50 @@ added to this list. */
 static CLI_Definition_List_Item_t xRegisteredCommands =
 {
 	&xHelpCommand,	/* The first command in the list is always the help command, defined in this file. */
-	NULL			/* The next pointer is initialised to NULL, as there are no other registered commands yet. */
+	NULL,			/* The next pointer is initialised to NULL, as there are no other registered commands yet. */
+	NULL			/* The help command is added to the hash table by prvInitialiseHashTable(). */
 };
 
+/* The registered commands, by the hash of their first word.  Each bucket is a
+list linked through the pxNextInBucket members. */
+static CLI_Definition_List_Item_t *pxCommandHashTable[ configCLI_COMMAND_HASH_SIZE ] = { NULL };
+
+/* Set to pdTRUE once the help command has been added to pxCommandHashTable. */
+static volatile BaseType_t xHashTableInitialised = pdFALSE;
+
+/* The session used by FreeRTOS_CLIProcessCommand() and
+FreeRTOS_CLIProcessCommandStreamed(), for applications that only have one
+command console. */
+static CLI_Session_t xDefaultSession;
+
+#ifndef configCLI_SESSION_THREAD_LOCAL_INDEX
+	/* The session of the command being run.  Without a thread local storage
+	pointer to hold it only one session can run a command at a time. */
+	static CLI_Session_t *pxCurrentSession = &xDefaultSession;
+
+	#if( configUSE_MUTEXES == 1 )
+		/* Held while a command runs, so commands run from different sessions
+		take turns.  Created the first time a command is run. */
+		static SemaphoreHandle_t xSessionMutex = NULL;
+
+		#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+			static StaticSemaphore_t xSessionMutexBuffer;
+		#endif
+	#else
+		/* Set while a command runs.  Without mutexes a second session cannot
+		wait for its turn, so it must not be used at the same time. */
+		static volatile BaseType_t xSessionBusy = pdFALSE;
+	#endif
+#endif
+
 /* A buffer into which command outputs can be written is declared here, rather
 than in the command console implementation, to allow multiple command consoles
 to share the same buffer.  For example, an application may allow access to the
 command interpreter by UART and by Ethernet.  Sharing a buffer is done purely
-to save RAM.  Note, however, that the command console itself is not re-entrant,
-so only one command interpreter interface can be used at any one time.  For that
-reason, no attempt at providing mutual exclusion to the cOutputBuffer array is
-attempted.
+to save RAM.  Note, however, that consoles that share the buffer can only be
+used one at a time, and no attempt at providing mutual exclusion to the
+cOutputBuffer array is attempted.  Consoles that run commands at the same time,
+each in its own CLI_Session_t, must each provide their own buffer.
 
 configAPPLICATION_PROVIDES_cOutputBuffer is provided to allow the application
 writer to provide their own cOutputBuffer declaration in cases where the
@@ -148,68 +242,84 @@ buffer needs to be placed at a fixed address (rather than by the linker). */
 #endif /* #if ( configSUPPORT_STATIC_ALLOCATION == 1 ) */
 /*-----------------------------------------------------------*/
 
+void FreeRTOS_CLIInitialiseSession( CLI_Session_t *pxSession )
+{
+	configASSERT( pxSession != NULL );
+
+	memset( ( void * ) pxSession, 0x00, sizeof( CLI_Session_t ) );
+}
+/*-----------------------------------------------------------*/
+
 BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput, char * pcWriteBuffer, size_t xWriteBufferLen  )
 {
-static const CLI_Definition_List_Item_t *pxCommand = NULL;
-BaseType_t xReturn = pdTRUE;
-const char *pcRegisteredCommandString;
-size_t xCommandStringLength;
+	return FreeRTOS_CLIProcessCommandInSession( &xDefaultSession, pcCommandInput, pcWriteBuffer, xWriteBufferLen );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_CLIProcessCommandInSession( CLI_Session_t *pxSession, const char * const pcCommandInput, char * pcWriteBuffer, size_t xWriteBufferLen )
+{
+BaseType_t xReturn;
 
-	/* Note:  This function is not re-entrant.  It must not be called from more
-	thank one task. */
+	configASSERT( pxSession != NULL );
+
+	/* Note:  A session must not be used by more than one task at a time, but
+	tasks that use different sessions can run commands at the same time if
+	configCLI_SESSION_THREAD_LOCAL_INDEX is defined, and take turns if it is
+	not. */
+	prvSetCurrentSession( pxSession );
+	xReturn = prvProcessCommand( pxSession, pcCommandInput, pcWriteBuffer, xWriteBufferLen );
+	prvReleaseCurrentSession();
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvProcessCommand( CLI_Session_t *pxSession, const char * const pcCommandInput, char * pcWriteBuffer, size_t xWriteBufferLen )
+{
+BaseType_t xReturn = pdTRUE;
 
-	if( pxCommand == NULL )
+	if( pxSession->pxCommand == NULL )
 	{
-		/* Search for the command string in the list of registered commands. */
-		for( pxCommand = &xRegisteredCommands; pxCommand != NULL; pxCommand = pxCommand->pxNext )
+		/* Find the parameters once, both to check their number below and to
+		answer the calls the command makes to FreeRTOS_CLIGetParameter(). */
+		( void ) FreeRTOS_CLIGetParameters( pcCommandInput, &( pxSession->xParameters ) );
+
+		pxSession->pxCommand = prvFindCommand( pcCommandInput );
+		pxSession->uxCommandState = 0;
+
+		/* If the command was found, check it has the expected number of
+		parameters.  If cExpectedNumberOfParameters is -1, then there could be
+		a variable number of parameters and no check is made. */
+		if( pxSession->pxCommand != NULL )
 		{
-			pcRegisteredCommandString = pxCommand->pxCommandLineDefinition->pcCommand;
-			xCommandStringLength = strlen( pcRegisteredCommandString );
-
-			/* To ensure the string lengths match exactly, so as not to pick up
-			a sub-string of a longer command, check the byte after the expected
-			end of the string is either the end of the string or a space before
-			a parameter. */
-			if( strncmp( pcCommandInput, pcRegisteredCommandString, xCommandStringLength ) == 0 )
+			if( pxSession->pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters >= 0 )
 			{
-				if( ( pcCommandInput[ xCommandStringLength ] == ' ' ) || ( pcCommandInput[ xCommandStringLength ] == 0x00 ) )
+				if( pxSession->xParameters.uxNumberOfParameters != ( UBaseType_t ) pxSession->pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters )
 				{
-					/* The command has been found.  Check it has the expected
-					number of parameters.  If cExpectedNumberOfParameters is -1,
-					then there could be a variable number of parameters and no
-					check is made. */
-					if( pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters >= 0 )
-					{
-						if( prvGetNumberOfParameters( pcCommandInput ) != pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters )
-						{
-							xReturn = pdFALSE;
-						}
-					}
-
-					break;
+					xReturn = pdFALSE;
 				}
 			}
 		}
 	}
 
-	if( ( pxCommand != NULL ) && ( xReturn == pdFALSE ) )
+	if( ( pxSession->pxCommand != NULL ) && ( xReturn == pdFALSE ) )
 	{
 		/* The command was found, but the number of parameters with the command
 		was incorrect. */
 		strncpy( pcWriteBuffer, "Incorrect command parameter(s).  Enter \"help\" to view a list of available commands.\r\n\r\n", xWriteBufferLen );
-		pxCommand = NULL;
+		pxSession->pxCommand = NULL;
 	}
-	else if( pxCommand != NULL )
+	else if( pxSession->pxCommand != NULL )
 	{
 		/* Call the callback function that is registered to this command. */
-		xReturn = pxCommand->pxCommandLineDefinition->pxCommandInterpreter( pcWriteBuffer, xWriteBufferLen, pcCommandInput );
+		xReturn = pxSession->pxCommand->pxCommandLineDefinition->pxCommandInterpreter( pcWriteBuffer, xWriteBufferLen, pcCommandInput );
 
 		/* If xReturn is pdFALSE, then no further strings will be returned
 		after this one, and	pxCommand can be reset to NULL ready to search
 		for the next entered command. */
 		if( xReturn == pdFALSE )
 		{
-			pxCommand = NULL;
+			pxSession->pxCommand = NULL;
 		}
 	}
 	else
@@ -219,10 +329,127 @@ size_t xCommandStringLength;
 		xReturn = pdFALSE;
 	}
 
+	if( pxSession->pxCommand == NULL )
+	{
+		/* The command has completed, so its parameters are no longer valid. */
+		pxSession->xParameters.pcCommandString = NULL;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_CLIProcessCommandStreamed( const char * const pcCommandInput, pdCOMMAND_OUTPUT_CALLBACK pxOutputFunction, void *pvOutputContext, char *pcWriteBuffer, size_t xWriteBufferLen )
+{
+	return FreeRTOS_CLIProcessCommandStreamedInSession( &xDefaultSession, pcCommandInput, pxOutputFunction, pvOutputContext, pcWriteBuffer, xWriteBufferLen );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_CLIProcessCommandStreamedInSession( CLI_Session_t *pxSession, const char * const pcCommandInput, pdCOMMAND_OUTPUT_CALLBACK pxOutputFunction, void *pvOutputContext, char *pcWriteBuffer, size_t xWriteBufferLen )
+{
+BaseType_t xMoreDataToFollow, xReturn;
+
+	configASSERT( pxSession != NULL );
+	configASSERT( pxOutputFunction != NULL );
+	configASSERT( pcWriteBuffer != NULL );
+	configASSERT( xWriteBufferLen > 0 );
+
+	pxSession->pxOutputFunction = pxOutputFunction;
+	pxSession->pvOutputContext = pvOutputContext;
+	pxSession->xOutputStatus = pdPASS;
+
+	do
+	{
+		/* Commands that stream their output write it with FreeRTOS_CLIWrite()
+		while they run.  Anything left in the buffer is written afterwards, so
+		start each call with an empty buffer. */
+		pcWriteBuffer[ 0 ] = 0x00;
+		prvSetCurrentSession( pxSession );
+		xMoreDataToFollow = prvProcessCommand( pxSession, pcCommandInput, pcWriteBuffer, xWriteBufferLen );
+
+		/* The buffer might not be terminated if the command filled it.  It is
+		written before the session is released, as FreeRTOS_CLIWrite() finds
+		the output function through the current session. */
+		pcWriteBuffer[ xWriteBufferLen - 1 ] = 0x00;
+		( void ) FreeRTOS_CLIWrite( pcWriteBuffer, strlen( pcWriteBuffer ) );
+		prvReleaseCurrentSession();
+
+	} while( xMoreDataToFollow != pdFALSE );
+
+	xReturn = pxSession->xOutputStatus;
+	pxSession->pxOutputFunction = NULL;
+	pxSession->pvOutputContext = NULL;
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_CLIWrite( const char *pcData, size_t xDataLength )
+{
+CLI_Session_t *pxSession = prvGetCurrentSession();
+BaseType_t xReturn = pdFAIL;
+
+	/* If the output is not being streamed it must be returned in the write
+	buffer instead. */
+	if( pxSession->pxOutputFunction != NULL )
+	{
+		if( ( pxSession->xOutputStatus == pdPASS ) && ( xDataLength > 0 ) )
+		{
+			pxSession->xOutputStatus = pxSession->pxOutputFunction( pxSession->pvOutputContext, pcData, xDataLength );
+		}
+
+		xReturn = pxSession->xOutputStatus;
+	}
+
 	return xReturn;
 }
 /*-----------------------------------------------------------*/
 
+BaseType_t FreeRTOS_CLIOutputIsStreamed( void )
+{
+	return ( prvGetCurrentSession()->pxOutputFunction != NULL ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t *FreeRTOS_CLIGetCommandState( void )
+{
+	return &( prvGetCurrentSession()->uxCommandState );
+}
+/*-----------------------------------------------------------*/
+
+#if( configCLI_INCLUDE_STREAM_BUFFER_OUTPUT == 1 )
+
+	BaseType_t FreeRTOS_CLIStreamBufferOutput( void *pvOutputContext, const char *pcData, size_t xDataLength )
+	{
+	StreamBufferHandle_t xStreamBuffer = ( StreamBufferHandle_t ) pvOutputContext;
+	size_t xBytesSent;
+	BaseType_t xReturn = pdPASS;
+
+		configASSERT( xStreamBuffer != NULL );
+
+		/* Data longer than the stream buffer is sent as the reader makes space
+		for it. */
+		while( xDataLength > 0 )
+		{
+			xBytesSent = xStreamBufferSend( xStreamBuffer, pcData, xDataLength, configCLI_STREAM_BUFFER_OUTPUT_WAIT );
+
+			if( xBytesSent == 0 )
+			{
+				/* Timed out without the reader making any space. */
+				xReturn = pdFAIL;
+				break;
+			}
+
+			pcData += xBytesSent;
+			xDataLength -= xBytesSent;
+		}
+
+		return xReturn;
+	}
+
+#endif /* configCLI_INCLUDE_STREAM_BUFFER_OUTPUT */
+/*-----------------------------------------------------------*/
+
 char *FreeRTOS_CLIGetOutputBuffer( void )
 {
 	return cOutputBuffer;
@@ -233,55 +460,121 @@ const char *FreeRTOS_CLIGetParameter( const char *pcCommandString, UBaseType_t u
 {
 UBaseType_t uxParametersFound = 0;
 const char *pcReturn = NULL;
+const CLI_Parameters_t *pxParameters = &( prvGetCurrentSession()->xParameters );
 
 	*pxParameterStringLength = 0;
 
-	while( uxParametersFound < uxWantedParameter )
+	if( ( pcCommandString == pxParameters->pcCommandString ) && ( uxWantedParameter > 0 ) && ( uxWantedParameter <= configCLI_MAX_PARAMETERS ) )
 	{
-		/* Index the character pointer past the current word.  If this is the start
-		of the command string then the first word is the command itself. */
-		while( ( ( *pcCommandString ) != 0x00 ) && ( ( *pcCommandString ) != ' ' ) )
+		/* The parameters of the command being processed were found when the
+		command was entered. */
+		if( uxWantedParameter <= pxParameters->uxNumberOfParameters )
 		{
-			pcCommandString++;
+			pcReturn = pxParameters->pcParameter[ uxWantedParameter - 1 ];
+			*pxParameterStringLength = pxParameters->xParameterLength[ uxWantedParameter - 1 ];
 		}
-
-		/* Find the start of the next string. */
-		while( ( ( *pcCommandString ) != 0x00 ) && ( ( *pcCommandString ) == ' ' ) )
+	}
+	else
+	{
+		while( uxParametersFound < uxWantedParameter )
 		{
-			pcCommandString++;
-		}
+			/* Index the character pointer past the current word.  If this is the start
+			of the command string then the first word is the command itself. */
+			while( ( ( *pcCommandString ) != 0x00 ) && ( ( *pcCommandString ) != ' ' ) )
+			{
+				pcCommandString++;
+			}
 
-		/* Was a string found? */
-		if( *pcCommandString != 0x00 )
-		{
-			/* Is this the start of the required parameter? */
-			uxParametersFound++;
+			/* Find the start of the next string. */
+			while( ( ( *pcCommandString ) != 0x00 ) && ( ( *pcCommandString ) == ' ' ) )
+			{
+				pcCommandString++;
+			}
 
-			if( uxParametersFound == uxWantedParameter )
+			/* Was a string found? */
+			if( *pcCommandString != 0x00 )
 			{
-				/* How long is the parameter? */
-				pcReturn = pcCommandString;
-				while( ( ( *pcCommandString ) != 0x00 ) && ( ( *pcCommandString ) != ' ' ) )
-				{
-					( *pxParameterStringLength )++;
-					pcCommandString++;
-				}
+				/* Is this the start of the required parameter? */
+				uxParametersFound++;
 
-				if( *pxParameterStringLength == 0 )
+				if( uxParametersFound == uxWantedParameter )
 				{
-					pcReturn = NULL;
-				}
+					/* How long is the parameter? */
+					pcReturn = pcCommandString;
+					while( ( ( *pcCommandString ) != 0x00 ) && ( ( *pcCommandString ) != ' ' ) )
+					{
+						( *pxParameterStringLength )++;
+						pcCommandString++;
+					}
 
+					if( *pxParameterStringLength == 0 )
+					{
+						pcReturn = NULL;
+					}
+
+					break;
+				}
+			}
+			else
+			{
 				break;
 			}
 		}
-		else
+	}
+
+	return pcReturn;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t FreeRTOS_CLIGetParameters( const char *pcCommandString, CLI_Parameters_t *pxParameters )
+{
+UBaseType_t uxParametersFound = 0;
+const char *pcParameter;
+
+	configASSERT( pcCommandString != NULL );
+	configASSERT( pxParameters != NULL );
+
+	pxParameters->pcCommandString = pcCommandString;
+
+	/* Index the character pointer past the command itself. */
+	while( ( ( *pcCommandString ) != 0x00 ) && ( ( *pcCommandString ) != ' ' ) )
+	{
+		pcCommandString++;
+	}
+
+	for( ;; )
+	{
+		/* Find the start of the next parameter. */
+		while( ( *pcCommandString ) == ' ' )
+		{
+			pcCommandString++;
+		}
+
+		if( *pcCommandString == 0x00 )
 		{
 			break;
 		}
+
+		/* Find its end. */
+		pcParameter = pcCommandString;
+		while( ( ( *pcCommandString ) != 0x00 ) && ( ( *pcCommandString ) != ' ' ) )
+		{
+			pcCommandString++;
+		}
+
+		/* Parameters past the end of the table are only counted. */
+		if( uxParametersFound < configCLI_MAX_PARAMETERS )
+		{
+			pxParameters->pcParameter[ uxParametersFound ] = pcParameter;
+			pxParameters->xParameterLength[ uxParametersFound ] = ( BaseType_t ) ( pcCommandString - pcParameter );
+		}
+
+		uxParametersFound++;
 	}
 
-	return pcReturn;
+	pxParameters->uxNumberOfParameters = uxParametersFound;
+
+	return uxParametersFound;
 }
 /*-----------------------------------------------------------*/
 
@@ -310,6 +603,10 @@ static CLI_Definition_List_Item_t *pxLastCommandInList = &xRegisteredCommands;
 
 		/* Set the end of list marker to the new list item. */
 		pxLastCommandInList = pxCliDefinitionListItemBuffer;
+
+		/* Make the command findable by FreeRTOS_CLIProcessCommand(). */
+		prvInitialiseHashTable();
+		prvAddToHashTable( pxCliDefinitionListItemBuffer );
 	}
 	taskEXIT_CRITICAL();
 }
@@ -317,23 +614,23 @@ static CLI_Definition_List_Item_t *pxLastCommandInList = &xRegisteredCommands;
 
 static BaseType_t prvHelpCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
 {
-static const CLI_Definition_List_Item_t * pxCommand = NULL;
+CLI_Session_t *pxSession = prvGetCurrentSession();
 BaseType_t xReturn;
 
 	( void ) pcCommandString;
 
-	if( pxCommand == NULL )
+	if( pxSession->pxHelpCommand == NULL )
 	{
-		/* Reset the pxCommand pointer back to the start of the list. */
-		pxCommand = &xRegisteredCommands;
+		/* Reset the pxHelpCommand pointer back to the start of the list. */
+		pxSession->pxHelpCommand = &xRegisteredCommands;
 	}
 
 	/* Return the next command help string, before moving the pointer on to
 	the next command in the list. */
-	strncpy( pcWriteBuffer, pxCommand->pxCommandLineDefinition->pcHelpString, xWriteBufferLen );
-	pxCommand = pxCommand->pxNext;
+	strncpy( pcWriteBuffer, pxSession->pxHelpCommand->pxCommandLineDefinition->pcHelpString, xWriteBufferLen );
+	pxSession->pxHelpCommand = pxSession->pxHelpCommand->pxNext;
 
-	if( pxCommand == NULL )
+	if( pxSession->pxHelpCommand == NULL )
 	{
 		/* There are no more commands in the list, so there will be no more
 		strings to return after this one and pdFALSE should be returned. */
@@ -348,39 +645,208 @@ BaseType_t xReturn;
 }
 /*-----------------------------------------------------------*/
 
-static int8_t prvGetNumberOfParameters( const char *pcCommandString )
+static UBaseType_t prvHashCommandWord( const char *pcCommandString )
+{
+uint32_t ulHash = 2166136261UL;
+
+	/* FNV-1a of the characters up to the first space or the end of the
+	string. */
+	while( ( ( *pcCommandString ) != 0x00 ) && ( ( *pcCommandString ) != ' ' ) )
+	{
+		ulHash ^= ( uint8_t ) *pcCommandString;
+		ulHash *= 16777619UL;
+		pcCommandString++;
+	}
+
+	return ( UBaseType_t ) ( ulHash & ( configCLI_COMMAND_HASH_SIZE - 1 ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvAddToHashTable( CLI_Definition_List_Item_t *pxListItem )
+{
+CLI_Definition_List_Item_t **ppxBucket;
+
+	ppxBucket = &( pxCommandHashTable[ prvHashCommandWord( pxListItem->pxCommandLineDefinition->pcCommand ) ] );
+
+	while( *ppxBucket != NULL )
+	{
+		ppxBucket = &( ( *ppxBucket )->pxNextInBucket );
+	}
+
+	/* The item is complete before it is linked in, as the bucket may be
+	walked by FreeRTOS_CLIProcessCommand() outside of a critical section. */
+	pxListItem->pxNextInBucket = NULL;
+	*ppxBucket = pxListItem;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseHashTable( void )
+{
+	if( xHashTableInitialised == pdFALSE )
+	{
+		prvAddToHashTable( &xRegisteredCommands );
+		xHashTableInitialised = pdTRUE;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static const CLI_Definition_List_Item_t *prvFindCommand( const char * const pcCommandInput )
 {
-int8_t cParameters = 0;
-BaseType_t xLastCharacterWasSpace = pdFALSE;
+const CLI_Definition_List_Item_t *pxCommand;
+const char *pcRegisteredCommandString;
+size_t xCommandStringLength;
 
-	/* Count the number of space delimited words in pcCommandString. */
-	while( *pcCommandString != 0x00 )
+	if( xHashTableInitialised == pdFALSE )
 	{
-		if( ( *pcCommandString ) == ' ' )
+		taskENTER_CRITICAL();
 		{
-			if( xLastCharacterWasSpace != pdTRUE )
+			prvInitialiseHashTable();
+		}
+		taskEXIT_CRITICAL();
+	}
+
+	/* Only the commands whose first word hashes to the same bucket as the
+	first word of the input can match. */
+	for( pxCommand = pxCommandHashTable[ prvHashCommandWord( pcCommandInput ) ]; pxCommand != NULL; pxCommand = pxCommand->pxNextInBucket )
+	{
+		pcRegisteredCommandString = pxCommand->pxCommandLineDefinition->pcCommand;
+		xCommandStringLength = strlen( pcRegisteredCommandString );
+
+		/* To ensure the string lengths match exactly, so as not to pick up
+		a sub-string of a longer command, check the byte after the expected
+		end of the string is either the end of the string or a space before
+		a parameter. */
+		if( strncmp( pcCommandInput, pcRegisteredCommandString, xCommandStringLength ) == 0 )
+		{
+			if( ( pcCommandInput[ xCommandStringLength ] == ' ' ) || ( pcCommandInput[ xCommandStringLength ] == 0x00 ) )
 			{
-				cParameters++;
-				xLastCharacterWasSpace = pdTRUE;
+				break;
 			}
 		}
-		else
+	}
+
+	return pxCommand;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetCurrentSession( CLI_Session_t *pxSession )
+{
+	#ifdef configCLI_SESSION_THREAD_LOCAL_INDEX
+	{
+		vTaskSetThreadLocalStoragePointer( NULL, configCLI_SESSION_THREAD_LOCAL_INDEX, ( void * ) pxSession );
+	}
+	#elif( configUSE_MUTEXES == 1 )
+	{
+	SemaphoreHandle_t xMutex;
+
+		taskENTER_CRITICAL();
 		{
-			xLastCharacterWasSpace = pdFALSE;
+			#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+			{
+				if( xSessionMutex == NULL )
+				{
+					xSessionMutex = xSemaphoreCreateMutexStatic( &xSessionMutexBuffer );
+				}
+			}
+			#endif
+
+			xMutex = xSessionMutex;
 		}
+		taskEXIT_CRITICAL();
 
-		pcCommandString++;
+		#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+		{
+		SemaphoreHandle_t xNewMutex;
+
+			if( xMutex == NULL )
+			{
+				/* Created outside of the critical section.  If another task
+				created one in the meantime the spare is deleted again. */
+				xNewMutex = xSemaphoreCreateMutex();
+				configASSERT( xNewMutex != NULL );
+
+				taskENTER_CRITICAL();
+				{
+					if( xSessionMutex == NULL )
+					{
+						xSessionMutex = xNewMutex;
+						xNewMutex = NULL;
+					}
+
+					xMutex = xSessionMutex;
+				}
+				taskEXIT_CRITICAL();
+
+				if( xNewMutex != NULL )
+				{
+					vSemaphoreDelete( xNewMutex );
+				}
+			}
+		}
+		#endif
+
+		( void ) xSemaphoreTake( xMutex, portMAX_DELAY );
+		pxCurrentSession = pxSession;
+	}
+	#else
+	{
+		taskENTER_CRITICAL();
+		{
+			/* Another task is running a command, see xSessionBusy. */
+			configASSERT( xSessionBusy == pdFALSE );
+			xSessionBusy = pdTRUE;
+		}
+		taskEXIT_CRITICAL();
+
+		pxCurrentSession = pxSession;
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvReleaseCurrentSession( void )
+{
+	#ifdef configCLI_SESSION_THREAD_LOCAL_INDEX
+	{
+		vTaskSetThreadLocalStoragePointer( NULL, configCLI_SESSION_THREAD_LOCAL_INDEX, NULL );
 	}
+	#else
+	{
+		pxCurrentSession = &xDefaultSession;
 
-	/* If the command string ended with spaces, then there will have been too
-	many parameters counted. */
-	if( xLastCharacterWasSpace == pdTRUE )
+		#if( configUSE_MUTEXES == 1 )
+		{
+			( void ) xSemaphoreGive( xSessionMutex );
+		}
+		#else
+		{
+			xSessionBusy = pdFALSE;
+		}
+		#endif
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+static CLI_Session_t *prvGetCurrentSession( void )
+{
+CLI_Session_t *pxSession;
+
+	#ifdef configCLI_SESSION_THREAD_LOCAL_INDEX
+	{
+		pxSession = ( CLI_Session_t * ) pvTaskGetThreadLocalStoragePointer( NULL, configCLI_SESSION_THREAD_LOCAL_INDEX );
+
+		if( pxSession == NULL )
+		{
+			pxSession = &xDefaultSession;
+		}
+	}
+	#else
 	{
-		cParameters--;
+		pxSession = pxCurrentSession;
 	}
+	#endif
 
-	/* The value returned is one less than the number of space delimited words,
-	as the first word should be the command itself. */
-	return cParameters;
+	return pxSession;
 }
 /*-----------------------------------------------------------*/
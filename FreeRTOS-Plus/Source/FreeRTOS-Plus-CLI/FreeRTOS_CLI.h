@@ -40,6 +40,14 @@ the pcWriteBuffer buffer, and pcCommandString is the entire string as input by
 the user (from which parameters can be extracted).*/
 typedef BaseType_t (*pdCOMMAND_LINE_CALLBACK)( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
 
+/* The prototype to which functions that FreeRTOS_CLIProcessCommandStreamed()
+writes command output to must comply.  pvOutputContext is the value passed to
+FreeRTOS_CLIProcessCommandStreamed(), for example a UART or socket handle, and
+pcData is xDataLength bytes of output, which is not null terminated.  Returns
+pdPASS if the data was written, or pdFAIL if the output can no longer be
+written, for example because the connection was closed. */
+typedef BaseType_t (*pdCOMMAND_OUTPUT_CALLBACK)( void *pvOutputContext, const char *pcData, size_t xDataLength );
+
 /* The structure that defines command line commands.  A command line command
 should be defined by declaring a const structure of this type. */
 typedef struct xCOMMAND_LINE_INPUT
@@ -55,8 +63,43 @@ typedef struct xCOMMAND_INPUT_LIST
 {
 	const CLI_Command_Definition_t *pxCommandLineDefinition;
 	struct xCOMMAND_INPUT_LIST *pxNext;
+	struct xCOMMAND_INPUT_LIST *pxNextInBucket;	/* The next command in the same hash bucket, used by FreeRTOS_CLIProcessCommand() to find commands. */
 } CLI_Definition_List_Item_t;
 
+/* The maximum number of parameters FreeRTOS_CLIGetParameters() records.  Any
+further parameters are counted, and FreeRTOS_CLIGetParameter() still finds them
+by scanning the command string. */
+#ifndef configCLI_MAX_PARAMETERS
+	#define configCLI_MAX_PARAMETERS 8
+#endif
+
+/* The parameters of a command string, as found by FreeRTOS_CLIGetParameters(). */
+typedef struct xCLI_PARAMETERS
+{
+	const char *pcCommandString;							/* The command string the parameters were found in. */
+	UBaseType_t uxNumberOfParameters;						/* The number of parameters after the command, which may exceed configCLI_MAX_PARAMETERS. */
+	const char *pcParameter[ configCLI_MAX_PARAMETERS ];	/* The start of each parameter.  pcParameter[ 0 ] is the first parameter, not the command. */
+	BaseType_t xParameterLength[ configCLI_MAX_PARAMETERS ];	/* The length of each parameter. */
+} CLI_Parameters_t;
+
+/* The state of one command console.  Consoles that run commands at the same
+time as each other, for example a UART console and a network console each
+served by its own task, each declare a session, initialise it with
+FreeRTOS_CLIInitialiseSession(), then pass it to
+FreeRTOS_CLIProcessCommandInSession() or
+FreeRTOS_CLIProcessCommandStreamedInSession().  The members are only accessed
+by FreeRTOS_CLI.c. */
+typedef struct xCLI_SESSION
+{
+	const CLI_Definition_List_Item_t *pxCommand;		/* The command being run, or NULL if the next call starts a new command. */
+	const CLI_Definition_List_Item_t *pxHelpCommand;	/* The next command listed by "help". */
+	UBaseType_t uxCommandState;							/* Returned by FreeRTOS_CLIGetCommandState(). */
+	CLI_Parameters_t xParameters;						/* The parameters of the command being run. */
+	pdCOMMAND_OUTPUT_CALLBACK pxOutputFunction;			/* Where FreeRTOS_CLIWrite() writes, or NULL if the output is not being streamed. */
+	void *pvOutputContext;								/* Passed to pxOutputFunction. */
+	BaseType_t xOutputStatus;							/* Set to pdFAIL once pxOutputFunction fails. */
+} CLI_Session_t;
+
 /* For backward compatibility. */
 #define xCommandLineInput CLI_Command_Definition_t
 
@@ -87,11 +130,99 @@ typedef struct xCOMMAND_INPUT_LIST
  *
  * FreeRTOS_CLIProcessCommand should be called repeatedly until it returns pdFALSE.
  *
- * pcCmdIntProcessCommand is not reentrant.  It must not be called from more
- * than one task - or at least - by more than one task at a time.
+ * FreeRTOS_CLIProcessCommand uses a single default session, so is not
+ * reentrant.  It must not be called from more than one task - or at least - by
+ * more than one task at a time.  Use FreeRTOS_CLIProcessCommandInSession() to
+ * run commands from more than one task at the same time.
  */
 BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput, char * pcWriteBuffer, size_t xWriteBufferLen  );
 
+/*
+ * Prepare a session for use by FreeRTOS_CLIProcessCommandInSession().
+ */
+void FreeRTOS_CLIInitialiseSession( CLI_Session_t *pxSession );
+
+/*
+ * As FreeRTOS_CLIProcessCommand(), but keeps the state of the command being
+ * run in *pxSession, so tasks that use different sessions can run commands at
+ * the same time.  A session must only be used by one task at a time.
+ *
+ * Commands find their parameters, output stream and state through the session
+ * of the task that calls them.  For more than one task to run commands at the
+ * same time, define configCLI_SESSION_THREAD_LOCAL_INDEX in FreeRTOSConfig.h to
+ * the index of a thread local storage pointer (see
+ * configNUM_THREAD_LOCAL_STORAGE_POINTERS) that FreeRTOS+CLI can use to
+ * remember the session of each task.  Without it commands run from different
+ * sessions take turns, using a mutex if configUSE_MUTEXES is 1.  If
+ * configUSE_MUTEXES is 0 they must not be run at the same time at all, which
+ * is checked with configASSERT().
+ */
+BaseType_t FreeRTOS_CLIProcessCommandInSession( CLI_Session_t *pxSession, const char * const pcCommandInput, char * pcWriteBuffer, size_t xWriteBufferLen );
+
+/*
+ * Runs the command interpreter for the command string "pcCommandInput" to
+ * completion, passing the output to pxOutputFunction as it is generated rather
+ * than returning it a buffer at a time.  pcWriteBuffer is only used as working
+ * space, so its size bounds the memory used however much output the command
+ * generates.
+ *
+ * While the command runs it can write any amount of output directly with
+ * FreeRTOS_CLIWrite().  Whatever it leaves in pcWriteBuffer is written after
+ * each time it is called, so commands written for FreeRTOS_CLIProcessCommand()
+ * work unchanged.
+ *
+ * Returns pdPASS if all the output was written, or pdFAIL if pxOutputFunction
+ * failed.  In that case the command is still run to completion, so it can free
+ * any resources it holds, but its remaining output is discarded.
+ *
+ * The same restrictions on reentrancy as FreeRTOS_CLIProcessCommand() apply.
+ */
+BaseType_t FreeRTOS_CLIProcessCommandStreamed( const char * const pcCommandInput, pdCOMMAND_OUTPUT_CALLBACK pxOutputFunction, void *pvOutputContext, char *pcWriteBuffer, size_t xWriteBufferLen );
+
+/*
+ * As FreeRTOS_CLIProcessCommandStreamed(), but in the session *pxSession.  See
+ * FreeRTOS_CLIProcessCommandInSession().
+ */
+BaseType_t FreeRTOS_CLIProcessCommandStreamedInSession( CLI_Session_t *pxSession, const char * const pcCommandInput, pdCOMMAND_OUTPUT_CALLBACK pxOutputFunction, void *pvOutputContext, char *pcWriteBuffer, size_t xWriteBufferLen );
+
+/*
+ * Called by a command to write xDataLength bytes from pcData to the output of
+ * FreeRTOS_CLIProcessCommandStreamed().  Returns pdFAIL if the output is not
+ * being streamed, or if it can no longer be written, in which case the command
+ * should stop generating output.
+ */
+BaseType_t FreeRTOS_CLIWrite( const char *pcData, size_t xDataLength );
+
+/*
+ * Returns pdTRUE if the command being run was started by
+ * FreeRTOS_CLIProcessCommandStreamed(), and can therefore write its output with
+ * FreeRTOS_CLIWrite() instead of returning it in pcWriteBuffer.
+ */
+BaseType_t FreeRTOS_CLIOutputIsStreamed( void );
+
+/*
+ * Returns a pointer to a variable a command can use to remember how far it has
+ * got between the calls made to it for one command, in place of a static
+ * variable, so the command can be run in more than one session at the same
+ * time.  The variable is set to 0 before the first call.
+ */
+UBaseType_t *FreeRTOS_CLIGetCommandState( void );
+
+/*
+ * Set configCLI_INCLUDE_STREAM_BUFFER_OUTPUT to 1 in FreeRTOSConfig.h to
+ * include an output function that writes command output to a stream buffer,
+ * from which another task can pass it to the transport.  pvOutputContext is the
+ * StreamBufferHandle_t.  Blocks for up to configCLI_STREAM_BUFFER_OUTPUT_WAIT
+ * ticks for space in the stream buffer.
+ */
+#ifndef configCLI_INCLUDE_STREAM_BUFFER_OUTPUT
+	#define configCLI_INCLUDE_STREAM_BUFFER_OUTPUT 0
+#endif
+
+#if( configCLI_INCLUDE_STREAM_BUFFER_OUTPUT == 1 )
+	BaseType_t FreeRTOS_CLIStreamBufferOutput( void *pvOutputContext, const char *pcData, size_t xDataLength );
+#endif
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -99,19 +230,30 @@ BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput, char *
  * main command interpreter, rather than in the command console implementation,
  * to allow application that provide access to the command console via multiple
  * interfaces to share a buffer, and therefore save RAM.  Note, however, that
- * the command interpreter itself is not re-entrant, so only one command
- * console interface can be used at any one time.  For that reason, no attempt
+ * consoles that share the buffer can only be used one at a time, so no attempt
  * is made to provide any mutual exclusion mechanism on the output buffer.
+ * Consoles that run commands at the same time, each in its own session, must
+ * each use their own buffer.
  *
  * FreeRTOS_CLIGetOutputBuffer() returns the address of the output buffer.
  */
 char *FreeRTOS_CLIGetOutputBuffer( void );
 
 /*
- * Return a pointer to the xParameterNumber'th word in pcCommandString.
+ * Return a pointer to the xParameterNumber'th word in pcCommandString.  While a
+ * command is being processed, the parameters of its command string are found
+ * in the table FreeRTOS_CLIProcessCommand() built, rather than by scanning the
+ * string again.
  */
 const char *FreeRTOS_CLIGetParameter( const char *pcCommandString, UBaseType_t uxWantedParameter, BaseType_t *pxParameterStringLength );
 
+/*
+ * Find all the parameters in pcCommandString in a single pass, and store where
+ * they start and their lengths in *pxParameters.  Returns the number of
+ * parameters, which does not include the command itself.
+ */
+UBaseType_t FreeRTOS_CLIGetParameters( const char *pcCommandString, CLI_Parameters_t *pxParameters );
+
 /* *INDENT-OFF* */
 #ifdef __cplusplus
     }
@@ -34,9 +34,10 @@
 
 /* Command codes for TzCtrl task */
 #define CMD_SET_ACTIVE      1 /* Start (param1 = 1) or Stop (param1 = 0) */
+#define CMD_SET_FILTER_RULE 2 /* Rule index (param1), action (param2), event code LSB/MSB (param3/param4), N (param5). Matches a single event code, or all events if the code is 0. */
 
 /* The final command code, used to validate commands. */
-#define CMD_LAST_COMMAND 1
+#define CMD_LAST_COMMAND 2
 
 #define TRC_RECORDER_MODE_SNAPSHOT		0
 #define TRC_RECORDER_MODE_STREAMING		1
@@ -105,6 +106,8 @@
 #define TRC_RECORDER_COMPONENT_TASK						0x00100000
 #define TRC_RECORDER_COMPONENT_TIMESTAMP				0x00200000
 #define TRC_RECORDER_COMPONENT_COUNTER					0x00400000
+#define TRC_RECORDER_COMPONENT_FILTER					0x00800000
+#define TRC_RECORDER_COMPONENT_HISTOGRAM				0x01000000
 
 /* Filter Groups */
 #define FilterGroup0 (uint16_t)0x0001
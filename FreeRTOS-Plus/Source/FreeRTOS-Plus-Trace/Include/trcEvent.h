@@ -291,7 +291,8 @@ traceResult xTraceEventBeginRawOfflineBlocking(uint32_t uiSize, TraceEventHandle
  * @brief Begins a trace event.
  * 
  * This routine begins a trace event with specified size. Must call xTraceEventEnd()
- * to finalize event creation. Does not care about RecorderEnabled.
+ * to finalize event creation. Fails if the recorder is not enabled or if the
+ * event is dropped by a filter rule (see trcFilter.h).
  * 
  * @param[in] uiSize Size.
  * @param[in] pxEventHandle Pointer to initialized trace event.
@@ -300,7 +301,24 @@ traceResult xTraceEventBeginRawOfflineBlocking(uint32_t uiSize, TraceEventHandle
  * @retval TRC_SUCCESS Success
  */
 #define xTraceEventBegin(uiEventCode, uiTotalPayloadSize, pxEventHandle) \
-	(xTraceIsRecorderEnabled() ? xTraceEventBeginOffline(uiEventCode, uiTotalPayloadSize, pxEventHandle) : TRC_FAIL)
+	xTraceEventBeginForObject(uiEventCode, 0, uiTotalPayloadSize, pxEventHandle)
+
+/**
+ * @brief Begins a trace event concerning an object.
+ * 
+ * Same as xTraceEventBegin(), but the object handle is also matched against
+ * filter rules with TRC_FILTER_MATCH_OBJECT.
+ * 
+ * @param[in] uiEventCode Event code.
+ * @param[in] pvObject Object handle.
+ * @param[in] uiTotalPayloadSize Payload size.
+ * @param[in] pxEventHandle Pointer to initialized trace event.
+ * 
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+#define xTraceEventBeginForObject(uiEventCode, pvObject, uiTotalPayloadSize, pxEventHandle) \
+	((xTraceIsRecorderEnabled() && xTraceFilterCheck(uiEventCode, pvObject) == TRC_SUCCESS) ? xTraceEventBeginOffline(uiEventCode, uiTotalPayloadSize, pxEventHandle) : TRC_FAIL)
 
 /**
  * @internal Ends a trace event offline. 
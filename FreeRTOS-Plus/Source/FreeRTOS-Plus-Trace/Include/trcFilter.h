@@ -0,0 +1,220 @@
+/*
+* Percepio Trace Recorder for Tracealyzer v4.6.0
+* Copyright 2021 Percepio AB
+* www.percepio.com
+*
+* SPDX-License-Identifier: Apache-2.0
+*/
+
+/**
+ * @file
+ *
+ * @brief Public trace filter APIs.
+ */
+
+#ifndef TRC_FILTER_H
+#define TRC_FILTER_H
+
+#if (TRC_USE_TRACEALYZER_RECORDER == 1)
+
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
+
+#include <trcTypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup trace_filter_apis Trace Filter APIs
+ * @ingroup trace_recorder_apis
+ * @{
+ */
+
+#ifndef TRC_CFG_ENABLE_FILTER
+#define TRC_CFG_ENABLE_FILTER 0
+#endif
+
+#ifndef TRC_CFG_FILTER_MAX_RULES
+#define TRC_CFG_FILTER_MAX_RULES 8
+#endif
+
+/* Rule match criteria, all criteria set in uiMatch must match */
+#define TRC_FILTER_MATCH_EVENT_CODE		0x00000001	/**< Event code within uiEventCodeFirst..uiEventCodeLast */
+#define TRC_FILTER_MATCH_OBJECT			0x00000002	/**< Event concerns pvObject (queue, semaphore, ISR, ...) */
+#define TRC_FILTER_MATCH_TASK			0x00000004	/**< Event is stored while pvTask is the current task */
+
+/* Rule actions */
+#define TRC_FILTER_ACTION_NONE			0	/**< Unused rule */
+#define TRC_FILTER_ACTION_INCLUDE		1	/**< Store all matching events */
+#define TRC_FILTER_ACTION_EXCLUDE		2	/**< Drop all matching events */
+#define TRC_FILTER_ACTION_SAMPLE		3	/**< Store 1 in uiParam matching events */
+#define TRC_FILTER_ACTION_RATE_LIMIT	4	/**< Store at most uiParam matching events per xTraceTzCtrl() period */
+
+/**
+ * @brief Trace filter rule.
+ *
+ * Rules are evaluated in index order, the first matching rule decides what
+ * happens to the event. Events not matching any rule are stored.
+ */
+typedef struct TraceFilterRule
+{
+	uint32_t uiMatch;				/**< TRC_FILTER_MATCH_* flags */
+	uint16_t uiEventCodeFirst;		/**< First event code (PSF_EVENT_*) */
+	uint16_t uiEventCodeLast;		/**< Last event code (PSF_EVENT_*) */
+	void* pvObject;					/**< Object handle */
+	void* pvTask;					/**< Task handle */
+	uint32_t uiAction;				/**< TRC_FILTER_ACTION_* */
+	uint32_t uiParam;				/**< N for TRC_FILTER_ACTION_SAMPLE and TRC_FILTER_ACTION_RATE_LIMIT */
+	uint32_t uiCounter;				/**< Internal, reset when the rule is set */
+} TraceFilterRule_t;
+
+#if ((TRC_CFG_ENABLE_FILTER) == 1)
+
+/**
+ * @internal Trace Filter Data Structure
+ */
+typedef struct TraceFilterData
+{
+	uint32_t uiRuleCount;									/**< Highest used rule index + 1 */
+	uint32_t uiFilteredEvents;								/**< Events dropped by rules */
+	TraceFilterRule_t xRules[TRC_CFG_FILTER_MAX_RULES];		/**< */
+} TraceFilterData_t;
+
+#define TRC_FILTER_BUFFER_SIZE (sizeof(TraceFilterData_t))
+
+/**
+ * @internal Trace Filter Buffer Structure
+ */
+typedef struct TraceFilterBuffer
+{
+	uint32_t buffer[(TRC_FILTER_BUFFER_SIZE) / sizeof(uint32_t)];
+} TraceFilterBuffer_t;
+
+extern TraceFilterData_t* pxTraceFilterData;
+
+/**
+ * @internal Initialize trace filter system.
+ *
+ * @param[in] pxBuffer Pointer to memory that will be used by the trace
+ * filter system.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceFilterInitialize(TraceFilterBuffer_t* pxBuffer);
+
+/**
+ * @brief Sets the filter rule at index.
+ *
+ * Example, only store every 10th queue send event from ISRs and drop all
+ * events from a noisy task:
+ *	 TraceFilterRule_t xRule = { 0 };
+ *	 xRule.uiMatch = TRC_FILTER_MATCH_EVENT_CODE;
+ *	 xRule.uiEventCodeFirst = PSF_EVENT_QUEUE_SEND_FROMISR;
+ *	 xRule.uiEventCodeLast = PSF_EVENT_QUEUE_SEND_FROMISR;
+ *	 xRule.uiAction = TRC_FILTER_ACTION_SAMPLE;
+ *	 xRule.uiParam = 10;
+ *	 xTraceFilterSetRule(0, &xRule);
+ *
+ *	 xRule.uiMatch = TRC_FILTER_MATCH_TASK;
+ *	 xRule.pvTask = xNoisyTask;
+ *	 xRule.uiAction = TRC_FILTER_ACTION_EXCLUDE;
+ *	 xTraceFilterSetRule(1, &xRule);
+ *
+ * Rules can also be set from the host with the CMD_SET_FILTER_RULE command,
+ * see trcDefines.h.
+ *
+ * @param[in] uiIndex Rule index.
+ * @param[in] pxRule Rule, copied by the recorder.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceFilterSetRule(uint32_t uiIndex, const TraceFilterRule_t* pxRule);
+
+/**
+ * @brief Clears all filter rules.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceFilterClear(void);
+
+/**
+ * @brief Gets the number of events dropped by filter rules.
+ *
+ * @param[out] puiFilteredEvents Filtered events.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceFilterGetFilteredEvents(uint32_t* puiFilteredEvents);
+
+/**
+ * @internal Evaluates the filter rules for an event.
+ *
+ * @param[in] uiEventCode Event code.
+ * @param[in] pvObject Object handle, or 0 if the event concerns no object.
+ *
+ * @retval TRC_FAIL Event is filtered out
+ * @retval TRC_SUCCESS Event should be stored
+ */
+traceResult xTraceFilterEvaluate(uint32_t uiEventCode, void* pvObject);
+
+/**
+ * @internal Starts a new period for TRC_FILTER_ACTION_RATE_LIMIT rules.
+ * Called from xTraceTzCtrl().
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceFilterNextPeriod(void);
+
+/**
+ * @internal Checks an event against the filter rules. Only calls
+ * xTraceFilterEvaluate(...) if there are rules.
+ *
+ * @param[in] uiEventCode Event code.
+ * @param[in] pvObject Object handle, or 0 if the event concerns no object.
+ *
+ * @retval TRC_FAIL Event is filtered out
+ * @retval TRC_SUCCESS Event should be stored
+ */
+#define xTraceFilterCheck(uiEventCode, pvObject) (pxTraceFilterData->uiRuleCount == 0 ? TRC_SUCCESS : xTraceFilterEvaluate(uiEventCode, (void*)(pvObject)))
+
+#else /* ((TRC_CFG_ENABLE_FILTER) == 1) */
+
+/**
+ * @internal Dummy Trace Filter Buffer Structure
+ */
+typedef struct TraceFilterBuffer
+{
+	uint32_t buffer[1];
+} TraceFilterBuffer_t;
+
+#define xTraceFilterInitialize(pxBuffer) ((void)pxBuffer, TRC_SUCCESS)
+
+#define xTraceFilterSetRule(uiIndex, pxRule) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_3((void)uiIndex, (void)pxRule, TRC_FAIL)
+
+#define xTraceFilterClear() TRC_COMMA_EXPR_TO_STATEMENT_EXPR_1(TRC_SUCCESS)
+
+#define xTraceFilterGetFilteredEvents(puiFilteredEvents) (puiFilteredEvents != 0 ? *puiFilteredEvents = 0 : 0, puiFilteredEvents != 0 ? TRC_SUCCESS : TRC_FAIL)
+
+#define xTraceFilterNextPeriod() TRC_COMMA_EXPR_TO_STATEMENT_EXPR_1(TRC_SUCCESS)
+
+#define xTraceFilterCheck(uiEventCode, pvObject) TRC_SUCCESS
+
+#endif /* ((TRC_CFG_ENABLE_FILTER) == 1) */
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
+
+#endif /* (TRC_USE_TRACEALYZER_RECORDER == 1) */
+
+#endif /* TRC_FILTER_H */
@@ -0,0 +1,220 @@
+/*
+* Percepio Trace Recorder for Tracealyzer v4.6.0
+* Copyright 2021 Percepio AB
+* www.percepio.com
+*
+* SPDX-License-Identifier: Apache-2.0
+*/
+
+/**
+ * @file
+ *
+ * @brief Public trace histogram APIs.
+ */
+
+#ifndef TRC_HISTOGRAM_H
+#define TRC_HISTOGRAM_H
+
+#if (TRC_USE_TRACEALYZER_RECORDER == 1)
+
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
+
+#include <trcTypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup trace_histogram_apis Trace Histogram APIs
+ * @ingroup trace_recorder_apis
+ * @{
+ */
+
+#ifndef TRC_CFG_ENABLE_HISTOGRAMS
+#define TRC_CFG_ENABLE_HISTOGRAMS 0
+#endif
+
+#ifndef TRC_CFG_HISTOGRAM_MAX_COUNT
+#define TRC_CFG_HISTOGRAM_MAX_COUNT 8
+#endif
+
+/* One bucket per power of two, bucket n holds values in [2^n, 2^(n+1)) and bucket 0 also holds 0 */
+#define TRC_HISTOGRAM_BUCKETS 32
+
+/**
+ * @brief Trace histogram statistics. All values are in timestamp ticks, see
+ * xTraceTimestampGetFrequency().
+ */
+typedef struct TraceHistogramStats
+{
+	const char* szName;		/**< Name */
+	uint32_t uiCount;		/**< Number of samples */
+	uint32_t uiMin;			/**< Smallest sample */
+	uint32_t uiMax;			/**< Largest sample */
+	uint32_t uiMean;		/**< Mean */
+	uint32_t uiP99;			/**< 99th percentile, upper bound of its bucket (at most uiMax) */
+} TraceHistogramStats_t;
+
+#if ((TRC_CFG_ENABLE_HISTOGRAMS) == 1)
+
+/**
+ * @internal Trace Histogram Structure
+ */
+typedef struct TraceHistogram
+{
+	const char* szName;								/**< */
+	uint32_t uiCount;								/**< */
+	uint32_t uiMin;									/**< */
+	uint32_t uiMax;									/**< */
+	uint32_t uiSumLow;								/**< */
+	uint32_t uiSumHigh;								/**< */
+	uint32_t uiBuckets[TRC_HISTOGRAM_BUCKETS];		/**< */
+} TraceHistogram_t;
+
+/**
+ * @internal Trace Histogram Data Structure
+ */
+typedef struct TraceHistogramData
+{
+	uint32_t uiHistogramCount;								/**< */
+	TraceHistogram_t xHistograms[TRC_CFG_HISTOGRAM_MAX_COUNT];	/**< */
+} TraceHistogramData_t;
+
+#define TRC_HISTOGRAM_BUFFER_SIZE (sizeof(TraceHistogramData_t))
+
+/**
+ * @internal Trace Histogram Buffer Structure
+ */
+typedef struct TraceHistogramBuffer
+{
+	uint32_t buffer[(TRC_HISTOGRAM_BUFFER_SIZE) / sizeof(uint32_t)];
+} TraceHistogramBuffer_t;
+
+/**
+ * @internal Initialize trace histogram system.
+ *
+ * @param[in] pxBuffer Pointer to memory that will be used by the trace
+ * histogram system.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceHistogramInitialize(TraceHistogramBuffer_t* pxBuffer);
+
+/**
+ * @brief Creates trace histogram.
+ *
+ * Histograms aggregate durations on target, so latency distributions can be
+ * read without streaming every event. Attach a histogram to an interval with
+ * xTraceIntervalSetHistogram() to record the time from xTraceIntervalStart()
+ * to xTraceIntervalStop(), or to a state machine state with
+ * xTraceStateMachineStateSetHistogram() to record the time spent in the
+ * state. Examples:
+ * - ISR-to-task latency: start an interval in the ISR that gives a semaphore
+ *   and stop it in the task when the take returns.
+ * - Queue blocking time: start an interval before a blocking xQueueReceive()
+ *   and stop it after.
+ * - Mutex hold time: start an interval after xSemaphoreTake() on the mutex
+ *   and stop it before xSemaphoreGive().
+ *
+ * @param[in] szName Name, must remain valid.
+ * @param[out] pxHistogramHandle Pointer to uninitialized trace histogram handle.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceHistogramCreate(const char* szName, TraceHistogramHandle_t* pxHistogramHandle);
+
+/**
+ * @brief Adds a sample to trace histogram.
+ *
+ * @param[in] xHistogramHandle Initialized trace histogram handle.
+ * @param[in] uiValue Sample, in timestamp ticks.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceHistogramAdd(TraceHistogramHandle_t xHistogramHandle, uint32_t uiValue);
+
+/**
+ * @brief Gets trace histogram statistics.
+ *
+ * @param[in] xHistogramHandle Initialized trace histogram handle.
+ * @param[out] pxStats Statistics.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceHistogramGetStats(TraceHistogramHandle_t xHistogramHandle, TraceHistogramStats_t* pxStats);
+
+/**
+ * @brief Gets trace histogram bucket count.
+ *
+ * @param[in] xHistogramHandle Initialized trace histogram handle.
+ * @param[in] uiBucket Bucket index (< TRC_HISTOGRAM_BUCKETS).
+ * @param[out] puiCount Number of samples in the bucket.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceHistogramGetBucket(TraceHistogramHandle_t xHistogramHandle, uint32_t uiBucket, uint32_t* puiCount);
+
+/**
+ * @brief Clears all samples of trace histogram.
+ *
+ * @param[in] xHistogramHandle Initialized trace histogram handle.
+ *
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceHistogramReset(TraceHistogramHandle_t xHistogramHandle);
+
+/**
+ * @brief Gets trace histogram at index, used to list all histograms.
+ *
+ * @param[in] uiIndex Index.
+ * @param[out] pxHistogramHandle Trace histogram handle.
+ *
+ * @retval TRC_FAIL No histogram at index
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceHistogramGetAtIndex(uint32_t uiIndex, TraceHistogramHandle_t* pxHistogramHandle);
+
+#else /* ((TRC_CFG_ENABLE_HISTOGRAMS) == 1) */
+
+/**
+ * @internal Dummy Trace Histogram Buffer Structure
+ */
+typedef struct TraceHistogramBuffer
+{
+	uint32_t buffer[1];
+} TraceHistogramBuffer_t;
+
+#define xTraceHistogramInitialize(pxBuffer) ((void)pxBuffer, TRC_SUCCESS)
+
+#define xTraceHistogramCreate(szName, pxHistogramHandle) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_3((void)szName, (void)pxHistogramHandle, TRC_FAIL)
+
+#define xTraceHistogramAdd(xHistogramHandle, uiValue) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_3((void)xHistogramHandle, (void)uiValue, TRC_SUCCESS)
+
+#define xTraceHistogramGetStats(xHistogramHandle, pxStats) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_3((void)xHistogramHandle, (void)pxStats, TRC_FAIL)
+
+#define xTraceHistogramGetBucket(xHistogramHandle, uiBucket, puiCount) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_4((void)xHistogramHandle, (void)uiBucket, (void)puiCount, TRC_FAIL)
+
+#define xTraceHistogramReset(xHistogramHandle) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_2((void)xHistogramHandle, TRC_SUCCESS)
+
+#define xTraceHistogramGetAtIndex(uiIndex, pxHistogramHandle) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_3((void)uiIndex, (void)pxHistogramHandle, TRC_FAIL)
+
+#endif /* ((TRC_CFG_ENABLE_HISTOGRAMS) == 1) */
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
+
+#endif /* (TRC_USE_TRACEALYZER_RECORDER == 1) */
+
+#endif /* TRC_HISTOGRAM_H */
@@ -73,6 +73,29 @@ traceResult xTraceIntervalStop(TraceIntervalHandle_t xIntervalHandle);
  */
 traceResult xTraceIntervalGetState(TraceIntervalHandle_t xIntervalHandle, uint32_t *puxState);
 
+#if ((TRC_CFG_ENABLE_HISTOGRAMS) == 1)
+
+/**
+ * @brief Attaches trace histogram to trace interval.
+ * 
+ * The time from each xTraceIntervalStart() to the following
+ * xTraceIntervalStop() is added to the histogram. Start and stop may be
+ * called from different tasks or ISRs. See xTraceHistogramCreate().
+ * 
+ * @param[in] xIntervalHandle Pointer to initialized trace interval.
+ * @param[in] xHistogramHandle Initialized trace histogram handle, or 0 to detach.
+ * 
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceIntervalSetHistogram(TraceIntervalHandle_t xIntervalHandle, TraceHistogramHandle_t xHistogramHandle);
+
+#else /* ((TRC_CFG_ENABLE_HISTOGRAMS) == 1) */
+
+#define xTraceIntervalSetHistogram(xIntervalHandle, xHistogramHandle) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_3((void)xIntervalHandle, (void)xHistogramHandle, TRC_FAIL)
+
+#endif /* ((TRC_CFG_ENABLE_HISTOGRAMS) == 1) */
+
 /** @} */
 
 #ifdef __cplusplus
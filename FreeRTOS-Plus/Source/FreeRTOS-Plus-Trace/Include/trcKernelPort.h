@@ -263,6 +263,19 @@ void vTraceSetMessageBufferName(void* pvMessageBuffer, const char* szName);
   */
 traceResult xTraceKernelPortGetUnusedStack(void* pvTask, TraceUnsignedBaseType_t *puxUnusedStack);
 
+/**
+ * @internal Retrieves the lowest address of a task stack, where unused stack
+ * space starts, for the incremental stack monitor sweep
+ *
+ * @param[in] pvTask Task pointer
+ * @param[out] ppvStackStart Lowest stack address
+ * @param[out] puiStackUnitSize Size of the unit used for stack sizes (StackType_t)
+ *
+ * @retval TRC_FAIL Failure, e.g. the stack grows upwards
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceKernelPortGetStackStart(void* pvTask, void** ppvStackStart, uint32_t *puiStackUnitSize);
+
 #endif
 
 #else
@@ -302,6 +315,11 @@ traceResult xTraceKernelPortGetUnusedStack(void* pvTask, TraceUnsignedBaseType_t
  */
 #define xTraceKernelPortGetUnusedStack(pvTask, puxUnusedStack) ((void)(pvTask), (void)(puxUnusedStack))
 
+/**
+ * @brief Disabled by TRC_CFG_SCHEDULING_ONLY
+ */
+#define xTraceKernelPortGetStackStart(pvTask, ppvStackStart, puiStackUnitSize) ((void)(pvTask), (void)(ppvStackStart), (void)(puiStackUnitSize), TRC_FAIL)
+
 #endif
 
 #if (((TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_SNAPSHOT) && (TRC_CFG_INCLUDE_ISR_TRACING == 1)) || (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING))
@@ -145,6 +145,8 @@ typedef struct TraceHeaderBuffer
 #include <trcDiagnostics.h>
 #include <trcAssert.h>
 #include <trcCounter.h>
+#include <trcFilter.h>
+#include <trcHistogram.h>
 
 #endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
 
@@ -1535,6 +1537,8 @@ typedef struct TraceRecorderData
 	TraceTaskInfoBuffer_t xTaskInfoBuffer;
 	TraceStackMonitorBuffer_t xStackMonitorBuffer;
 	TraceDiagnosticsBuffer_t xDiagnosticsBuffer;
+	TraceFilterBuffer_t xFilterBuffer;
+	TraceHistogramBuffer_t xHistogramBuffer;
 } TraceRecorderData_t;
 
 extern TraceRecorderData_t* pxTraceRecorderData;
@@ -1648,7 +1652,7 @@ traceResult xTraceTzCtrl(void);
 #define prvTraceStoreEvent_Handle(_eventID, _handle) \
 	{ \
 		TraceEventHandle_t _xEventHandle = 0; \
-		if (xTraceEventBegin(_eventID, sizeof(void*), &_xEventHandle) == TRC_SUCCESS) \
+		if (xTraceEventBeginForObject(_eventID, (void*)(_handle), sizeof(void*), &_xEventHandle) == TRC_SUCCESS) \
 		{ \
 			xTraceEventAddPointer(_xEventHandle, (void*)(_handle)); \
 			xTraceEventEnd(_xEventHandle); \
@@ -1681,7 +1685,7 @@ traceResult xTraceTzCtrl(void);
 #define prvTraceStoreEvent_HandleParam(_eventID, _handle, _param1) \
 	{ \
 		TraceEventHandle_t _xEventHandle = 0; \
-		if (xTraceEventBegin(_eventID, sizeof(void*) + sizeof(uint32_t), &_xEventHandle) == TRC_SUCCESS) \
+		if (xTraceEventBeginForObject(_eventID, (void*)(_handle), sizeof(void*) + sizeof(uint32_t), &_xEventHandle) == TRC_SUCCESS) \
 		{ \
 			xTraceEventAddPointer(_xEventHandle, (void*)(_handle)); \
 			xTraceEventAdd32(_xEventHandle, (uint32_t)(_param1)); \
@@ -1718,7 +1722,7 @@ traceResult xTraceTzCtrl(void);
 #define prvTraceStoreEvent_HandleParamParam(_eventID, _handle, _param1, _param2) \
 	{ \
 		TraceEventHandle_t _xEventHandle = 0; \
-		if (xTraceEventBegin(_eventID, sizeof(void*) + sizeof(uint32_t) + sizeof(uint32_t), &_xEventHandle) == TRC_SUCCESS) \
+		if (xTraceEventBeginForObject(_eventID, (void*)(_handle), sizeof(void*) + sizeof(uint32_t) + sizeof(uint32_t), &_xEventHandle) == TRC_SUCCESS) \
 		{ \
 			xTraceEventAddPointer(_xEventHandle, (void*)(_handle)); \
 			xTraceEventAdd32(_xEventHandle, (uint32_t)(_param1)); \
@@ -34,7 +34,15 @@ extern "C" {
 
 #if (((TRC_CFG_ENABLE_STACK_MONITOR) == 1) && ((TRC_CFG_SCHEDULING_ONLY) == 0))
 
+#ifndef TRC_CFG_STACK_MONITOR_SWEEP_WORDS
+#define TRC_CFG_STACK_MONITOR_SWEEP_WORDS 0
+#endif
+
+#if ((TRC_CFG_STACK_MONITOR_SWEEP_WORDS) > 0)
+#define TRACE_STACK_MONITOR_BUFFER_SIZE ((sizeof(void*) + sizeof(TraceUnsignedBaseType_t) + sizeof(void*) + sizeof(uint32_t) + sizeof(uint32_t)) * (TRC_CFG_STACK_MONITOR_MAX_TASKS) + sizeof(uint32_t))
+#else
 #define TRACE_STACK_MONITOR_BUFFER_SIZE ((sizeof(void*) + sizeof(TraceUnsignedBaseType_t)) * (TRC_CFG_STACK_MONITOR_MAX_TASKS) + sizeof(uint32_t))
+#endif
 
 /**
  * @internal Trace Stack Monitor Buffer Structure
@@ -94,6 +102,11 @@ traceResult xTraceStackMonitorGetAtIndex(uint32_t uiIndex, void** ppvTask, Trace
  * for TRC_CFG_STACK_MONITOR_MAX_REPORTS number of registered
  * tasks/threads.
  * 
+ * If TRC_CFG_STACK_MONITOR_SWEEP_WORDS is non-zero, it instead checks at
+ * most that many stack words, continuing where the previous call stopped,
+ * and only reports a task when its low water mark has moved (and once per
+ * trace session).
+ * 
  * @retval TRC_FAIL Failure
  * @retval TRC_SUCCESS Success
  */
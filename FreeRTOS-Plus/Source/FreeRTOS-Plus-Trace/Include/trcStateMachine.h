@@ -65,6 +65,28 @@ traceResult xTraceStateMachineStateCreate(TraceStateMachineHandle_t xStateMachin
  */
 traceResult xTraceStateMachineSetState(TraceStateMachineHandle_t xStateMachineHandle, TraceStateMachineStateHandle_t xStateHandle);
 
+#if ((TRC_CFG_ENABLE_HISTOGRAMS) == 1)
+
+/**
+ * @brief Attaches trace histogram to trace state machine state.
+ * 
+ * Each time the state machine leaves this state, the time spent in it is
+ * added to the histogram. See xTraceHistogramCreate().
+ * 
+ * @param[in] xStateHandle Pointer to initialized trace state machine state.
+ * @param[in] xHistogramHandle Initialized trace histogram handle, or 0 to detach.
+ * 
+ * @retval TRC_FAIL Failure
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceStateMachineStateSetHistogram(TraceStateMachineStateHandle_t xStateHandle, TraceHistogramHandle_t xHistogramHandle);
+
+#else /* ((TRC_CFG_ENABLE_HISTOGRAMS) == 1) */
+
+#define xTraceStateMachineStateSetHistogram(xStateHandle, xHistogramHandle) TRC_COMMA_EXPR_TO_STATEMENT_EXPR_3((void)xStateHandle, (void)xHistogramHandle, TRC_FAIL)
+
+#endif /* ((TRC_CFG_ENABLE_HISTOGRAMS) == 1) */
+
 /** @} */
 
 #ifdef __cplusplus
@@ -57,6 +57,8 @@ typedef TraceUnsignedBaseType_t TraceStringHandle_t;
 
 typedef TraceUnsignedBaseType_t TraceCounterHandle_t;
 
+typedef TraceUnsignedBaseType_t TraceHistogramHandle_t;
+
 typedef void (*TraceCounterCallback_t)(TraceCounterHandle_t xCounterHandle);
 
 /* DEPRECATED. Backwards compatibility */
@@ -179,6 +179,27 @@ extern "C" {
  */
 #define TRC_CFG_STACK_MONITOR_MAX_REPORTS 1
 
+/**
+ * @def TRC_CFG_STACK_MONITOR_SWEEP_WORDS
+ * @brief Macro which should be defined as an integer value.
+ *
+ * If non-zero, the stack monitor (streaming mode only) sweeps the task stacks
+ * incrementally, checking at most this many 32-bit stack words for each
+ * execution of the Tracealyzer Control task (TzCtrl), and resumes where it
+ * left off the next time. This bounds the time spent in the critical section
+ * regardless of how many and how large the stacks are. Since the low water
+ * mark can only move towards the start of the stack, only the part below the
+ * previous low water mark is checked, and an event is only stored when it
+ * moves. TRC_CFG_STACK_MONITOR_MAX_REPORTS is not used in this mode.
+ *
+ * Requires a kernel port that can tell where a task stack starts. Stacks
+ * that grow upwards are always scanned fully, which also counts against this
+ * budget.
+ *
+ * Default value is 0 (full scan of TRC_CFG_STACK_MONITOR_MAX_REPORTS tasks).
+ */
+#define TRC_CFG_STACK_MONITOR_SWEEP_WORDS 0
+
 /**
  * @def TRC_CFG_CTRL_TASK_PRIORITY
  * @brief The scheduling priority of the Tracealyzer Control (TzCtrl) task. 
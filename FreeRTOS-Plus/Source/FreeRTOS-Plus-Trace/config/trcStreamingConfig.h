@@ -44,6 +44,41 @@ extern "C" {
  */
 #define TRC_CFG_ENTRY_SYMBOL_MAX_LENGTH 32
 
+/**
+ * @def TRC_CFG_ENABLE_FILTER
+ * @brief Enables the event filter rules (see trcFilter.h), which can drop,
+ * sample (1 in N) or rate limit events by event code, object and task before
+ * they reach the stream port. Rules are set with xTraceFilterSetRule() or
+ * from the host with the CMD_SET_FILTER_RULE command.
+ *
+ * When disabled, no filter code is included and events are never checked.
+ */
+#define TRC_CFG_ENABLE_FILTER 0
+
+/**
+ * @def TRC_CFG_FILTER_MAX_RULES
+ * @brief The maximum number of filter rules. Only used if TRC_CFG_ENABLE_FILTER
+ * is 1. Each event is checked against the rules up to the highest rule index
+ * in use, so keep frequently matched rules at low indexes.
+ */
+#define TRC_CFG_FILTER_MAX_RULES 8
+
+/**
+ * @def TRC_CFG_ENABLE_HISTOGRAMS
+ * @brief Enables on-target latency histograms (see trcHistogram.h). Histograms
+ * attached to intervals or state machine states aggregate durations into
+ * power-of-two buckets, with min/max/mean/p99 available through
+ * xTraceHistogramGetStats(), without streaming the events.
+ */
+#define TRC_CFG_ENABLE_HISTOGRAMS 0
+
+/**
+ * @def TRC_CFG_HISTOGRAM_MAX_COUNT
+ * @brief The maximum number of histograms. Each histogram takes 152 bytes.
+ * Only used if TRC_CFG_ENABLE_HISTOGRAMS is 1.
+ */
+#define TRC_CFG_HISTOGRAM_MAX_COUNT 8
+
 #ifdef __cplusplus
 }
 #endif
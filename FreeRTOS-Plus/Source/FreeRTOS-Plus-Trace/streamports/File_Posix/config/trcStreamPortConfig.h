@@ -0,0 +1,77 @@
+/*
+ * Trace Recorder for Tracealyzer v4.6.0
+ * Copyright 2021 Percepio AB
+ * www.percepio.com
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * The configuration for trace streaming ("stream ports").
+ */
+
+#ifndef TRC_STREAM_PORT_CONFIG_H
+#define TRC_STREAM_PORT_CONFIG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*******************************************************************************
+* Configuration Macro: TRC_CFG_STREAM_PORT_TRACE_FILE
+*
+* The trace file name. When file rotation is enabled, a ".<n>" suffix is
+* appended to this name for each file in the rotation.
+******************************************************************************/
+#ifndef TRC_CFG_STREAM_PORT_TRACE_FILE
+#define TRC_CFG_STREAM_PORT_TRACE_FILE "trace.psf"
+#endif
+
+/*******************************************************************************
+* Configuration Macro: TRC_CFG_STREAM_PORT_CHUNK_SIZE
+*
+* The size of each chunk that events are batched into before being handed to
+* the writer thread. Should be a multiple of the file system block size (e.g.
+* 4096) so that every write starts on a block boundary.
+******************************************************************************/
+#define TRC_CFG_STREAM_PORT_CHUNK_SIZE 65536
+
+/*******************************************************************************
+* Configuration Macro: TRC_CFG_STREAM_PORT_CHUNK_COUNT
+*
+* The number of chunks. While the writer thread is busy writing one or more
+* chunks, the recorder keeps filling the remaining ones. If all chunks are
+* full, events are dropped (and counted) instead of blocking the caller.
+******************************************************************************/
+#define TRC_CFG_STREAM_PORT_CHUNK_COUNT 8
+
+/*******************************************************************************
+* Configuration Macro: TRC_CFG_STREAM_PORT_FLUSH_INTERVAL_MS
+*
+* The maximum time, in milliseconds, that a partially filled chunk is held
+* back before it is handed to the writer thread. The check is made from
+* xTraceTzCtrl(), so the effective interval is rounded up to the TzCtrl period.
+******************************************************************************/
+#define TRC_CFG_STREAM_PORT_FLUSH_INTERVAL_MS 250
+
+/*******************************************************************************
+* Configuration Macro: TRC_CFG_STREAM_PORT_ROTATE_SIZE
+*
+* The file size, in bytes, after which the trace continues in a new file.
+* Every file starts a new trace session and holds its own header and entry
+* table, so each file can be opened in Tracealyzer on its own.
+* Set to 0 to disable rotation.
+******************************************************************************/
+#define TRC_CFG_STREAM_PORT_ROTATE_SIZE 0
+
+/*******************************************************************************
+* Configuration Macro: TRC_CFG_STREAM_PORT_ROTATE_COUNT
+*
+* The number of files kept when rotation is enabled. When the last file is
+* full, the first one is overwritten.
+******************************************************************************/
+#define TRC_CFG_STREAM_PORT_ROTATE_COUNT 4
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRC_STREAM_PORT_CONFIG_H */
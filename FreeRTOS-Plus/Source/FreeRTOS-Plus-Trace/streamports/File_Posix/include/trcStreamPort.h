@@ -0,0 +1,141 @@
+/*
+ * Trace Recorder for Tracealyzer v4.6.0
+ * Copyright 2021 Percepio AB
+ * www.percepio.com
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * The interface definitions for trace streaming ("stream ports").
+ * This "stream port" sets up the recorder to stream the trace to file on a
+ * Posix host. Events are batched into chunks that are written to the file by
+ * a dedicated writer thread, so tracing never waits on file I/O.
+ */
+
+#ifndef TRC_STREAM_PORT_H
+#define TRC_STREAM_PORT_H
+
+#if (TRC_USE_TRACEALYZER_RECORDER == 1)
+
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
+
+#include <stdint.h>
+#include <trcTypes.h>
+#include <trcStreamPortConfig.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The chunks already buffer the events, so the internal buffer is not used */
+#define TRC_USE_INTERNAL_BUFFER 0
+
+/* Default file name */
+#ifndef TRC_CFG_STREAM_PORT_TRACE_FILE
+#define TRC_CFG_STREAM_PORT_TRACE_FILE "trace.psf"
+#endif
+
+#define TRC_STREAM_PORT_CHUNK_SIZE ((((TRC_CFG_STREAM_PORT_CHUNK_SIZE) + sizeof(uint32_t) - 1) / sizeof(uint32_t)) * sizeof(uint32_t))
+
+typedef struct TraceStreamPortFileChunk
+{
+	volatile uint32_t uiState;
+	uint32_t uiUsed;
+	uint32_t uiEndOfSession;
+	uint8_t uiData[TRC_STREAM_PORT_CHUNK_SIZE];
+} TraceStreamPortFileChunk_t;
+
+typedef struct TraceStreamPortFile
+{
+	uint32_t uiFillIndex;
+	uint32_t uiWriteIndex;
+	uint32_t uiFileIndex;
+	uint32_t uiFileBytes;
+	volatile uint32_t uiRotateState;
+	volatile uint32_t uiDroppedEvents;
+	uint32_t uiLastFlushMs;
+	TraceStreamPortFileChunk_t xChunks[TRC_CFG_STREAM_PORT_CHUNK_COUNT];
+} TraceStreamPortFile_t;
+
+extern TraceStreamPortFile_t* pxStreamPortFile;
+
+#define TRC_STREAM_PORT_BUFFER_SIZE (sizeof(TraceStreamPortFile_t))
+
+typedef struct TraceStreamPortBuffer
+{
+	uint8_t buffer[TRC_STREAM_PORT_BUFFER_SIZE];
+} TraceStreamPortBuffer_t;
+
+traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer);
+
+#define xTraceStreamPortAllocate(uiSize, ppvData) ((void)(uiSize), xTraceStaticBufferGet(ppvData))
+
+/* Copy to the current chunk. Called from within the recorder's critical section. */
+#define xTraceStreamPortCommit(pvData, uiSize, piBytesCommitted) xTraceStreamPortWriteData(pvData, uiSize, piBytesCommitted)
+
+/**
+ * @brief Copies an event into the current chunk.
+ *
+ * An event is never split between chunks. If the current chunk cannot hold
+ * the event and no free chunk remains, the event is dropped and 0 bytes are
+ * reported as written.
+ *
+ * @param[in] pvData Data to write
+ * @param[in] uiSize Data to write size
+ * @param[out] piBytesWritten Bytes written
+ *
+ * @retval TRC_FAIL Write failed
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceStreamPortWriteData(void* pvData, uint32_t uiSize, int32_t* piBytesWritten);
+
+/**
+ * @brief Polled periodically by xTraceTzCtrl().
+ *
+ * No commands are received from a host. Instead, this hands partially filled
+ * chunks to the writer thread once TRC_CFG_STREAM_PORT_FLUSH_INTERVAL_MS has
+ * passed, and when the current file has reached TRC_CFG_STREAM_PORT_ROTATE_SIZE
+ * it returns a stop command followed by a start command, so that the next file
+ * begins with a complete header and entry table.
+ *
+ * @param[out] pvData Destination data buffer
+ * @param[in] uiSize Destination data buffer size
+ * @param[out] piBytesRead Bytes read
+ *
+ * @retval TRC_FAIL Read failed
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceStreamPortReadData(void* pvData, uint32_t uiSize, int32_t* piBytesRead);
+
+#define xTraceStreamPortOnEnable(uiStartOption) ((void)(uiStartOption), TRC_SUCCESS)
+
+/**
+ * @brief Waits until the writer thread has written all pending chunks.
+ *
+ * @retval TRC_FAIL Failed
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceStreamPortOnDisable(void);
+
+traceResult xTraceStreamPortOnTraceBegin(void);
+
+traceResult xTraceStreamPortOnTraceEnd(void);
+
+/**
+ * @brief Gets the number of events dropped because all chunks were full.
+ *
+ * @param[out] puiDroppedEvents Dropped events
+ *
+ * @retval TRC_FAIL Failed
+ * @retval TRC_SUCCESS Success
+ */
+traceResult xTraceStreamPortGetDroppedEvents(uint32_t* puiDroppedEvents);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*(TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)*/
+
+#endif /*(TRC_USE_TRACEALYZER_RECORDER == 1)*/
+
+#endif /* TRC_STREAM_PORT_H */
@@ -0,0 +1,518 @@
+/*
+ * Trace Recorder for Tracealyzer v4.6.0
+ * Copyright 2021 Percepio AB
+ * www.percepio.com
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Supporting functions for trace streaming, used by the "stream ports"
+ * for reading and writing data to the interface.
+ * Existing ports can easily be modified to fit another setup, e.g., a
+ * different TCP/IP stack, or to define your own stream port.
+ */
+
+#include <trcRecorder.h>
+
+#if (TRC_USE_TRACEALYZER_RECORDER == 1)
+
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#define TRC_STREAM_PORT_CHUNK_FREE 0
+#define TRC_STREAM_PORT_CHUNK_FILLING 1
+#define TRC_STREAM_PORT_CHUNK_SEALED 2
+
+#define TRC_STREAM_PORT_ROTATE_IDLE 0
+#define TRC_STREAM_PORT_ROTATE_REQUESTED 1
+#define TRC_STREAM_PORT_ROTATE_STOPPED 2
+
+/* Must match the layout of TraceCommand_t in trcStreamingRecorder.c */
+#define TRC_STREAM_PORT_COMMAND_SIZE 8
+
+TraceStreamPortFile_t* pxStreamPortFile;
+
+/* The writer thread is a plain Posix thread, not a FreeRTOS task, so it keeps
+writing while the recorder holds its critical section. It alone owns the file. */
+static pthread_t xWriterThread;
+static sem_t xChunkSealed;
+static uint32_t uiWriterStarted = 0;
+static int iTraceFile = -1;
+
+static void* prvWriterThread(void* pvParameters);
+static traceResult prvStartWriterThread(void);
+static TraceStreamPortFileChunk_t* prvClaimChunk(uint32_t uiWait);
+static void prvSealChunk(uint32_t uiEndOfSession);
+static ssize_t prvWriteChunks(struct iovec* pxIov, int iCount);
+static void prvOpenFile(void);
+static void prvCloseFile(void);
+static uint32_t prvGetTimeMs(void);
+static void prvSetCommand(uint8_t* puiCommand, uint8_t uiActive);
+
+traceResult xTraceStreamPortInitialize(TraceStreamPortBuffer_t* pxBuffer)
+{
+	TRC_ASSERT_EQUAL_SIZE(TraceStreamPortBuffer_t, TraceStreamPortFile_t);
+
+	TRC_ASSERT(pxBuffer != 0);
+
+	pxStreamPortFile = (TraceStreamPortFile_t*)pxBuffer;
+	memset(pxStreamPortFile, 0, sizeof(TraceStreamPortFile_t));
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceStreamPortWriteData(void* pvData, uint32_t uiSize, int32_t* piBytesWritten)
+{
+	TraceStreamPortFileChunk_t* pxChunk;
+
+	*piBytesWritten = 0;
+
+	if (pxStreamPortFile == 0)
+	{
+		return TRC_FAIL;
+	}
+
+	pxChunk = prvClaimChunk(0);
+
+	if ((pxChunk != 0) && (pxChunk->uiUsed > 0) && (pxChunk->uiUsed + uiSize > TRC_STREAM_PORT_CHUNK_SIZE))
+	{
+		/* Never split an event between chunks */
+		prvSealChunk(0);
+		pxChunk = prvClaimChunk(0);
+	}
+
+	if (pxChunk == 0)
+	{
+		/* All chunks are waiting for the writer thread */
+		pxStreamPortFile->uiDroppedEvents++;
+
+		return TRC_SUCCESS;
+	}
+
+	if (uiSize > TRC_STREAM_PORT_CHUNK_SIZE)
+	{
+		/* Larger than a chunk, only possible for raw blocking writes, which will retry with the rest */
+		uiSize = TRC_STREAM_PORT_CHUNK_SIZE;
+	}
+
+	memcpy(&pxChunk->uiData[pxChunk->uiUsed], pvData, uiSize);
+	pxChunk->uiUsed += uiSize;
+	*piBytesWritten = (int32_t)uiSize;
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceStreamPortReadData(void* pvData, uint32_t uiSize, int32_t* piBytesRead)
+{
+	TraceStreamPortFileChunk_t* pxChunk;
+	uint32_t uiNow;
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	*piBytesRead = 0;
+
+	if (pxStreamPortFile == 0)
+	{
+		return TRC_SUCCESS;
+	}
+
+	uiNow = prvGetTimeMs();
+
+	if ((uiNow - pxStreamPortFile->uiLastFlushMs) >= (TRC_CFG_STREAM_PORT_FLUSH_INTERVAL_MS))
+	{
+		TRACE_ENTER_CRITICAL_SECTION();
+
+		pxChunk = &pxStreamPortFile->xChunks[pxStreamPortFile->uiFillIndex];
+		if ((pxChunk->uiState == TRC_STREAM_PORT_CHUNK_FILLING) && (pxChunk->uiUsed > 0))
+		{
+			prvSealChunk(0);
+		}
+
+		TRACE_EXIT_CRITICAL_SECTION();
+
+		pxStreamPortFile->uiLastFlushMs = uiNow;
+	}
+
+	if (uiSize < TRC_STREAM_PORT_COMMAND_SIZE)
+	{
+		return TRC_SUCCESS;
+	}
+
+	/* Restart the session to rotate the file, see xTraceStreamPortReadData(...) in trcStreamPort.h */
+	if (pxStreamPortFile->uiRotateState == TRC_STREAM_PORT_ROTATE_REQUESTED)
+	{
+		if (xTraceIsRecorderEnabled())
+		{
+			prvSetCommand((uint8_t*)pvData, 0);
+			*piBytesRead = TRC_STREAM_PORT_COMMAND_SIZE;
+			pxStreamPortFile->uiRotateState = TRC_STREAM_PORT_ROTATE_STOPPED;
+		}
+		else
+		{
+			pxStreamPortFile->uiRotateState = TRC_STREAM_PORT_ROTATE_IDLE;
+		}
+	}
+	else if (pxStreamPortFile->uiRotateState == TRC_STREAM_PORT_ROTATE_STOPPED)
+	{
+		prvSetCommand((uint8_t*)pvData, 1);
+		*piBytesRead = TRC_STREAM_PORT_COMMAND_SIZE;
+		pxStreamPortFile->uiRotateState = TRC_STREAM_PORT_ROTATE_IDLE;
+	}
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceStreamPortOnDisable(void)
+{
+	uint32_t i;
+
+	if ((pxStreamPortFile == 0) || (uiWriterStarted == 0))
+	{
+		return TRC_SUCCESS;
+	}
+
+	/* xTraceStreamPortOnTraceEnd() has sealed the last chunk, wait for the writer thread */
+	for (i = 0; i < (TRC_CFG_STREAM_PORT_CHUNK_COUNT); i++)
+	{
+		while (__atomic_load_n(&pxStreamPortFile->xChunks[i].uiState, __ATOMIC_ACQUIRE) == TRC_STREAM_PORT_CHUNK_SEALED)
+		{
+			usleep(1000);
+		}
+	}
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceStreamPortOnTraceBegin(void)
+{
+	if (pxStreamPortFile == 0)
+	{
+		return TRC_FAIL;
+	}
+
+	if (uiWriterStarted == 0)
+	{
+		if (prvStartWriterThread() == TRC_FAIL)
+		{
+			return TRC_FAIL;
+		}
+	}
+
+	pxStreamPortFile->uiLastFlushMs = prvGetTimeMs();
+
+	/* The writer thread opens the file when the first chunk arrives */
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceStreamPortOnTraceEnd(void)
+{
+	if ((pxStreamPortFile == 0) || (uiWriterStarted == 0))
+	{
+		return TRC_FAIL;
+	}
+
+	/* The writer thread closes the file after writing this chunk */
+	prvSealChunk(1);
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceStreamPortGetDroppedEvents(uint32_t* puiDroppedEvents)
+{
+	TRC_ASSERT(puiDroppedEvents != 0);
+
+	if (pxStreamPortFile == 0)
+	{
+		return TRC_FAIL;
+	}
+
+	*puiDroppedEvents = pxStreamPortFile->uiDroppedEvents;
+
+	return TRC_SUCCESS;
+}
+
+/******************************************************************************/
+/*** INTERNAL FUNCTIONS *******************************************************/
+/******************************************************************************/
+static traceResult prvStartWriterThread(void)
+{
+	sigset_t xAllSignals;
+	sigset_t xPreviousSignals;
+	int iResult;
+
+	if (sem_init(&xChunkSealed, 0, 0) != 0)
+	{
+		printf("Could not create trace writer semaphore, error code %d.\n", errno);
+
+		return TRC_FAIL;
+	}
+
+	/* The thread inherits the signal mask, keep the scheduler's signals away from it */
+	sigfillset(&xAllSignals);
+	pthread_sigmask(SIG_SETMASK, &xAllSignals, &xPreviousSignals);
+	iResult = pthread_create(&xWriterThread, NULL, prvWriterThread, NULL);
+	pthread_sigmask(SIG_SETMASK, &xPreviousSignals, NULL);
+
+	if (iResult != 0)
+	{
+		printf("Could not create trace writer thread, error code %d.\n", iResult);
+		sem_destroy(&xChunkSealed);
+
+		return TRC_FAIL;
+	}
+
+	uiWriterStarted = 1;
+
+	return TRC_SUCCESS;
+}
+
+/* Returns the chunk being filled, or 0 if it is still waiting for the writer thread. */
+static TraceStreamPortFileChunk_t* prvClaimChunk(uint32_t uiWait)
+{
+	TraceStreamPortFileChunk_t* pxChunk = &pxStreamPortFile->xChunks[pxStreamPortFile->uiFillIndex];
+
+	if (pxChunk->uiState == TRC_STREAM_PORT_CHUNK_FILLING)
+	{
+		return pxChunk;
+	}
+
+	while (__atomic_load_n(&pxChunk->uiState, __ATOMIC_ACQUIRE) != TRC_STREAM_PORT_CHUNK_FREE)
+	{
+		if (uiWait == 0)
+		{
+			return 0;
+		}
+
+		sched_yield();
+	}
+
+	pxChunk->uiUsed = 0;
+	pxChunk->uiEndOfSession = 0;
+	pxChunk->uiState = TRC_STREAM_PORT_CHUNK_FILLING;
+
+	return pxChunk;
+}
+
+/* Hands the chunk being filled to the writer thread. */
+static void prvSealChunk(uint32_t uiEndOfSession)
+{
+	TraceStreamPortFileChunk_t* pxChunk;
+
+	/* The end of a session must always reach the writer thread, even if the chunk is empty */
+	pxChunk = prvClaimChunk(uiEndOfSession);
+
+	if (pxChunk == 0)
+	{
+		return;
+	}
+
+	pxChunk->uiEndOfSession = uiEndOfSession;
+	__atomic_store_n(&pxChunk->uiState, TRC_STREAM_PORT_CHUNK_SEALED, __ATOMIC_RELEASE);
+
+	pxStreamPortFile->uiFillIndex = (pxStreamPortFile->uiFillIndex + 1) % (TRC_CFG_STREAM_PORT_CHUNK_COUNT);
+
+	sem_post(&xChunkSealed);
+}
+
+static void* prvWriterThread(void* pvParameters)
+{
+	struct iovec xIov[TRC_CFG_STREAM_PORT_CHUNK_COUNT];
+	TraceStreamPortFileChunk_t* pxChunk;
+	uint32_t uiIndex;
+	uint32_t uiEndOfSession;
+	int iCount;
+	int i;
+	ssize_t xWritten;
+
+	(void)pvParameters;
+
+	for (;;)
+	{
+		while (sem_wait(&xChunkSealed) != 0)
+		{
+			/* Interrupted, wait again */
+		}
+
+		/* Gather all consecutive sealed chunks into one write, up to the end of a session */
+		iCount = 0;
+		uiEndOfSession = 0;
+		uiIndex = pxStreamPortFile->uiWriteIndex;
+
+		while (iCount < (TRC_CFG_STREAM_PORT_CHUNK_COUNT))
+		{
+			pxChunk = &pxStreamPortFile->xChunks[uiIndex];
+
+			if (__atomic_load_n(&pxChunk->uiState, __ATOMIC_ACQUIRE) != TRC_STREAM_PORT_CHUNK_SEALED)
+			{
+				break;
+			}
+
+			xIov[iCount].iov_base = pxChunk->uiData;
+			xIov[iCount].iov_len = pxChunk->uiUsed;
+			iCount++;
+
+			uiIndex = (uiIndex + 1) % (TRC_CFG_STREAM_PORT_CHUNK_COUNT);
+
+			if (pxChunk->uiEndOfSession != 0)
+			{
+				uiEndOfSession = 1;
+				break;
+			}
+		}
+
+		if (iCount == 0)
+		{
+			/* Already written together with an earlier chunk */
+			continue;
+		}
+
+		if (iTraceFile < 0)
+		{
+			prvOpenFile();
+		}
+
+		if (iTraceFile >= 0)
+		{
+			xWritten = prvWriteChunks(xIov, iCount);
+			if (xWritten < 0)
+			{
+				printf("Could not write trace file, error code %d.\n", errno);
+			}
+			else
+			{
+				pxStreamPortFile->uiFileBytes += (uint32_t)xWritten;
+			}
+		}
+
+		for (i = 0; i < iCount; i++)
+		{
+			pxChunk = &pxStreamPortFile->xChunks[pxStreamPortFile->uiWriteIndex];
+			__atomic_store_n(&pxChunk->uiState, TRC_STREAM_PORT_CHUNK_FREE, __ATOMIC_RELEASE);
+			pxStreamPortFile->uiWriteIndex = (pxStreamPortFile->uiWriteIndex + 1) % (TRC_CFG_STREAM_PORT_CHUNK_COUNT);
+		}
+
+		if (uiEndOfSession != 0)
+		{
+			prvCloseFile();
+		}
+#if ((TRC_CFG_STREAM_PORT_ROTATE_SIZE) > 0)
+		else if ((pxStreamPortFile->uiFileBytes >= (TRC_CFG_STREAM_PORT_ROTATE_SIZE)) &&
+			(pxStreamPortFile->uiRotateState == TRC_STREAM_PORT_ROTATE_IDLE))
+		{
+			/* Picked up by xTraceStreamPortReadData() */
+			pxStreamPortFile->uiRotateState = TRC_STREAM_PORT_ROTATE_REQUESTED;
+		}
+#endif
+	}
+
+	return NULL;
+}
+
+/* Writes all chunks, resuming after partial writes. */
+static ssize_t prvWriteChunks(struct iovec* pxIov, int iCount)
+{
+	ssize_t xTotal = 0;
+	ssize_t xWritten;
+
+	while (iCount > 0)
+	{
+		xWritten = writev(iTraceFile, pxIov, iCount);
+		if (xWritten < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			return -1;
+		}
+
+		xTotal += xWritten;
+
+		while ((iCount > 0) && ((size_t)xWritten >= pxIov->iov_len))
+		{
+			xWritten -= (ssize_t)pxIov->iov_len;
+			pxIov++;
+			iCount--;
+		}
+
+		if (iCount > 0)
+		{
+			pxIov->iov_base = (uint8_t*)pxIov->iov_base + xWritten;
+			pxIov->iov_len -= (size_t)xWritten;
+		}
+	}
+
+	return xTotal;
+}
+
+static void prvOpenFile(void)
+{
+#if ((TRC_CFG_STREAM_PORT_ROTATE_SIZE) > 0)
+	char cFileName[256];
+
+	snprintf(cFileName, sizeof(cFileName), "%s.%u", TRC_CFG_STREAM_PORT_TRACE_FILE, (unsigned int)pxStreamPortFile->uiFileIndex);
+#else
+	const char* cFileName = TRC_CFG_STREAM_PORT_TRACE_FILE;
+#endif
+
+	iTraceFile = open(cFileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (iTraceFile < 0)
+	{
+		printf("Could not open trace file, error code %d.\n", errno);
+	}
+	else
+	{
+		printf("Trace file %s created.\n", cFileName);
+	}
+
+	pxStreamPortFile->uiFileBytes = 0;
+}
+
+static void prvCloseFile(void)
+{
+	if (iTraceFile >= 0)
+	{
+		close(iTraceFile);
+		iTraceFile = -1;
+		printf("Trace file closed (%u bytes, %u events dropped).\n", (unsigned int)pxStreamPortFile->uiFileBytes, (unsigned int)pxStreamPortFile->uiDroppedEvents);
+	}
+
+#if ((TRC_CFG_STREAM_PORT_ROTATE_SIZE) > 0)
+	pxStreamPortFile->uiFileIndex = (pxStreamPortFile->uiFileIndex + 1) % (TRC_CFG_STREAM_PORT_ROTATE_COUNT);
+#endif
+}
+
+static uint32_t prvGetTimeMs(void)
+{
+	struct timespec xNow;
+
+	clock_gettime(CLOCK_MONOTONIC, &xNow);
+
+	return (uint32_t)((xNow.tv_sec * 1000) + (xNow.tv_nsec / 1000000));
+}
+
+/* Creates a Start (uiActive = 1) or Stop (uiActive = 0) command as if sent by a host. */
+static void prvSetCommand(uint8_t* puiCommand, uint8_t uiActive)
+{
+	uint16_t checksum = (uint16_t)(0xFFFF - (CMD_SET_ACTIVE + uiActive));
+
+	memset(puiCommand, 0, TRC_STREAM_PORT_COMMAND_SIZE);
+	puiCommand[0] = CMD_SET_ACTIVE;
+	puiCommand[1] = uiActive;
+	puiCommand[6] = (uint8_t)(checksum & 0xFF);
+	puiCommand[7] = (uint8_t)(checksum >> 8);
+}
+
+#endif /*(TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)*/
+
+#endif /*(TRC_USE_TRACEALYZER_RECORDER == 1)*/
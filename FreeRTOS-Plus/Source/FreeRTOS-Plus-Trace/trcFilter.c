@@ -0,0 +1,253 @@
+/*
+* Percepio Trace Recorder for Tracealyzer v4.6.0
+* Copyright 2021 Percepio AB
+* www.percepio.com
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+* The implementation for the event filter rules.
+*/
+
+#include <trcRecorder.h>
+
+#if (TRC_USE_TRACEALYZER_RECORDER == 1)
+
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
+
+#if ((TRC_CFG_ENABLE_FILTER) == 1)
+
+TraceFilterData_t* pxTraceFilterData;
+
+/* Returns 1 if all criteria of the rule match the event */
+static uint32_t prvTraceFilterRuleMatches(const TraceFilterRule_t* pxRule, uint32_t uiEventCode, void* pvObject, void* pvTask);
+
+traceResult xTraceFilterInitialize(TraceFilterBuffer_t* pxBuffer)
+{
+	uint32_t i;
+
+	TRC_ASSERT_EQUAL_SIZE(TraceFilterBuffer_t, TraceFilterData_t);
+
+	/* This should never fail */
+	TRC_ASSERT(pxBuffer != 0);
+
+	pxTraceFilterData = (TraceFilterData_t*)pxBuffer;
+
+	pxTraceFilterData->uiRuleCount = 0;
+	pxTraceFilterData->uiFilteredEvents = 0;
+
+	for (i = 0; i < (TRC_CFG_FILTER_MAX_RULES); i++)
+	{
+		pxTraceFilterData->xRules[i].uiAction = TRC_FILTER_ACTION_NONE;
+	}
+
+	xTraceSetComponentInitialized(TRC_RECORDER_COMPONENT_FILTER);
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceFilterSetRule(uint32_t uiIndex, const TraceFilterRule_t* pxRule)
+{
+	uint32_t i;
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_FILTER));
+
+	/* This should never fail */
+	TRC_ASSERT(pxRule != 0);
+
+	if (uiIndex >= (TRC_CFG_FILTER_MAX_RULES))
+	{
+		return TRC_FAIL;
+	}
+
+	if (((pxRule->uiAction == TRC_FILTER_ACTION_SAMPLE) || (pxRule->uiAction == TRC_FILTER_ACTION_RATE_LIMIT)) && (pxRule->uiParam == 0))
+	{
+		return TRC_FAIL;
+	}
+
+	if (pxRule->uiAction > TRC_FILTER_ACTION_RATE_LIMIT)
+	{
+		return TRC_FAIL;
+	}
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	pxTraceFilterData->xRules[uiIndex] = *pxRule;
+	pxTraceFilterData->xRules[uiIndex].uiCounter = 0;
+
+	/* Only the rules below uiRuleCount are evaluated */
+	pxTraceFilterData->uiRuleCount = 0;
+	for (i = 0; i < (TRC_CFG_FILTER_MAX_RULES); i++)
+	{
+		if (pxTraceFilterData->xRules[i].uiAction != TRC_FILTER_ACTION_NONE)
+		{
+			pxTraceFilterData->uiRuleCount = i + 1;
+		}
+	}
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceFilterClear(void)
+{
+	uint32_t i;
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_FILTER));
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	pxTraceFilterData->uiRuleCount = 0;
+
+	for (i = 0; i < (TRC_CFG_FILTER_MAX_RULES); i++)
+	{
+		pxTraceFilterData->xRules[i].uiAction = TRC_FILTER_ACTION_NONE;
+	}
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceFilterGetFilteredEvents(uint32_t* puiFilteredEvents)
+{
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_FILTER));
+
+	/* This should never fail */
+	TRC_ASSERT(puiFilteredEvents != 0);
+
+	*puiFilteredEvents = pxTraceFilterData->uiFilteredEvents;
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceFilterEvaluate(uint32_t uiEventCode, void* pvObject)
+{
+	TraceFilterRule_t* pxRule;
+	void* pvTask = 0;
+	traceResult xResult = TRC_SUCCESS;
+	uint32_t i;
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	(void)xTraceTaskGetCurrent(&pvTask);
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	for (i = 0; i < pxTraceFilterData->uiRuleCount; i++)
+	{
+		pxRule = &pxTraceFilterData->xRules[i];
+
+		if (pxRule->uiAction == TRC_FILTER_ACTION_NONE || prvTraceFilterRuleMatches(pxRule, uiEventCode, pvObject, pvTask) == 0)
+		{
+			continue;
+		}
+
+		/* The first matching rule decides */
+		switch (pxRule->uiAction)
+		{
+		case TRC_FILTER_ACTION_EXCLUDE:
+			xResult = TRC_FAIL;
+			break;
+		case TRC_FILTER_ACTION_SAMPLE:
+			/* Store the first of every uiParam events */
+			if (pxRule->uiCounter != 0)
+			{
+				xResult = TRC_FAIL;
+			}
+			pxRule->uiCounter++;
+			if (pxRule->uiCounter >= pxRule->uiParam)
+			{
+				pxRule->uiCounter = 0;
+			}
+			break;
+		case TRC_FILTER_ACTION_RATE_LIMIT:
+			/* Reset by xTraceFilterNextPeriod() */
+			if (pxRule->uiCounter >= pxRule->uiParam)
+			{
+				xResult = TRC_FAIL;
+			}
+			else
+			{
+				pxRule->uiCounter++;
+			}
+			break;
+		default:
+			/* TRC_FILTER_ACTION_INCLUDE */
+			break;
+		}
+
+		break;
+	}
+
+	if (xResult == TRC_FAIL)
+	{
+		pxTraceFilterData->uiFilteredEvents++;
+	}
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return xResult;
+}
+
+traceResult xTraceFilterNextPeriod(void)
+{
+	uint32_t i;
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_FILTER));
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	for (i = 0; i < pxTraceFilterData->uiRuleCount; i++)
+	{
+		if (pxTraceFilterData->xRules[i].uiAction == TRC_FILTER_ACTION_RATE_LIMIT)
+		{
+			pxTraceFilterData->xRules[i].uiCounter = 0;
+		}
+	}
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+static uint32_t prvTraceFilterRuleMatches(const TraceFilterRule_t* pxRule, uint32_t uiEventCode, void* pvObject, void* pvTask)
+{
+	if ((pxRule->uiMatch & TRC_FILTER_MATCH_EVENT_CODE) != 0)
+	{
+		if (uiEventCode < pxRule->uiEventCodeFirst || uiEventCode > pxRule->uiEventCodeLast)
+		{
+			return 0;
+		}
+	}
+
+	if ((pxRule->uiMatch & TRC_FILTER_MATCH_OBJECT) != 0)
+	{
+		if (pvObject != pxRule->pvObject)
+		{
+			return 0;
+		}
+	}
+
+	if ((pxRule->uiMatch & TRC_FILTER_MATCH_TASK) != 0)
+	{
+		if (pvTask != pxRule->pvTask)
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+#endif /* ((TRC_CFG_ENABLE_FILTER) == 1) */
+
+#endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
+
+#endif /* (TRC_USE_TRACEALYZER_RECORDER == 1) */
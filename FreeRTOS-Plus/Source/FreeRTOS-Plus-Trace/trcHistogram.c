@@ -0,0 +1,259 @@
+/*
+* Percepio Trace Recorder for Tracealyzer v4.6.0
+* Copyright 2021 Percepio AB
+* www.percepio.com
+*
+* SPDX-License-Identifier: Apache-2.0
+*
+* The implementation of histograms.
+*/
+
+#include <trcRecorder.h>
+
+#if (TRC_USE_TRACEALYZER_RECORDER == 1)
+
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
+
+#if ((TRC_CFG_ENABLE_HISTOGRAMS) == 1)
+
+static TraceHistogramData_t* pxHistogramData;
+
+/* Returns the index of the bucket holding uiValue, i.e. floor(log2(uiValue)) */
+static uint32_t prvTraceHistogramGetBucketIndex(uint32_t uiValue);
+
+/* Clears the samples of a histogram */
+static void prvTraceHistogramClear(TraceHistogram_t* pxHistogram);
+
+traceResult xTraceHistogramInitialize(TraceHistogramBuffer_t* pxBuffer)
+{
+	TRC_ASSERT_EQUAL_SIZE(TraceHistogramBuffer_t, TraceHistogramData_t);
+
+	/* This should never fail */
+	TRC_ASSERT(pxBuffer != 0);
+
+	pxHistogramData = (TraceHistogramData_t*)pxBuffer;
+
+	pxHistogramData->uiHistogramCount = 0;
+
+	xTraceSetComponentInitialized(TRC_RECORDER_COMPONENT_HISTOGRAM);
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceHistogramCreate(const char* szName, TraceHistogramHandle_t* pxHistogramHandle)
+{
+	TraceHistogram_t* pxHistogram;
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_HISTOGRAM));
+
+	/* This should never fail */
+	TRC_ASSERT(pxHistogramHandle != 0);
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	if (pxHistogramData->uiHistogramCount >= (TRC_CFG_HISTOGRAM_MAX_COUNT))
+	{
+		TRACE_EXIT_CRITICAL_SECTION();
+
+		return TRC_FAIL;
+	}
+
+	pxHistogram = &pxHistogramData->xHistograms[pxHistogramData->uiHistogramCount];
+	pxHistogram->szName = szName;
+	prvTraceHistogramClear(pxHistogram);
+
+	pxHistogramData->uiHistogramCount++;
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	*pxHistogramHandle = (TraceHistogramHandle_t)pxHistogram;
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceHistogramAdd(TraceHistogramHandle_t xHistogramHandle, uint32_t uiValue)
+{
+	TraceHistogram_t* pxHistogram = (TraceHistogram_t*)xHistogramHandle;
+	uint32_t uiBucket;
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* This should never fail */
+	TRC_ASSERT(pxHistogram != 0);
+
+	uiBucket = prvTraceHistogramGetBucketIndex(uiValue);
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	if (pxHistogram->uiCount == 0 || uiValue < pxHistogram->uiMin)
+	{
+		pxHistogram->uiMin = uiValue;
+	}
+
+	if (uiValue > pxHistogram->uiMax)
+	{
+		pxHistogram->uiMax = uiValue;
+	}
+
+	pxHistogram->uiSumLow += uiValue;
+	if (pxHistogram->uiSumLow < uiValue)
+	{
+		/* Carry */
+		pxHistogram->uiSumHigh++;
+	}
+
+	pxHistogram->uiCount++;
+	pxHistogram->uiBuckets[uiBucket]++;
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceHistogramGetStats(TraceHistogramHandle_t xHistogramHandle, TraceHistogramStats_t* pxStats)
+{
+	TraceHistogram_t* pxHistogram = (TraceHistogram_t*)xHistogramHandle;
+	TraceHistogram_t xCopy;
+	uint32_t uiTarget, uiCumulative, i;
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* This should never fail */
+	TRC_ASSERT(pxHistogram != 0);
+
+	/* This should never fail */
+	TRC_ASSERT(pxStats != 0);
+
+	/* Work on a consistent copy so samples can keep coming in */
+	TRACE_ENTER_CRITICAL_SECTION();
+	xCopy = *pxHistogram;
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	pxStats->szName = xCopy.szName;
+	pxStats->uiCount = xCopy.uiCount;
+	pxStats->uiMin = xCopy.uiMin;
+	pxStats->uiMax = xCopy.uiMax;
+	pxStats->uiMean = 0;
+	pxStats->uiP99 = 0;
+
+	if (xCopy.uiCount == 0)
+	{
+		return TRC_SUCCESS;
+	}
+
+	pxStats->uiMean = (uint32_t)((((uint64_t)xCopy.uiSumHigh << 32) | xCopy.uiSumLow) / xCopy.uiCount);
+
+	/* At most 1% of the samples are above the bucket reaching uiTarget */
+	uiTarget = xCopy.uiCount - (xCopy.uiCount / 100);
+	uiCumulative = 0;
+	for (i = 0; i < TRC_HISTOGRAM_BUCKETS; i++)
+	{
+		uiCumulative += xCopy.uiBuckets[i];
+		if (uiCumulative >= uiTarget)
+		{
+			break;
+		}
+	}
+
+	/* Upper bound of bucket i is 2^(i+1) - 1 */
+	pxStats->uiP99 = (i >= TRC_HISTOGRAM_BUCKETS - 1) ? 0xFFFFFFFFUL : (((uint32_t)2 << i) - 1);
+
+	if (pxStats->uiP99 > xCopy.uiMax)
+	{
+		pxStats->uiP99 = xCopy.uiMax;
+	}
+
+	if (pxStats->uiP99 < xCopy.uiMin)
+	{
+		pxStats->uiP99 = xCopy.uiMin;
+	}
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceHistogramGetBucket(TraceHistogramHandle_t xHistogramHandle, uint32_t uiBucket, uint32_t* puiCount)
+{
+	TraceHistogram_t* pxHistogram = (TraceHistogram_t*)xHistogramHandle;
+
+	/* This should never fail */
+	TRC_ASSERT(pxHistogram != 0);
+
+	/* This should never fail */
+	TRC_ASSERT(puiCount != 0);
+
+	if (uiBucket >= TRC_HISTOGRAM_BUCKETS)
+	{
+		return TRC_FAIL;
+	}
+
+	*puiCount = pxHistogram->uiBuckets[uiBucket];
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceHistogramReset(TraceHistogramHandle_t xHistogramHandle)
+{
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* This should never fail */
+	TRC_ASSERT(xHistogramHandle != 0);
+
+	TRACE_ENTER_CRITICAL_SECTION();
+	prvTraceHistogramClear((TraceHistogram_t*)xHistogramHandle);
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+traceResult xTraceHistogramGetAtIndex(uint32_t uiIndex, TraceHistogramHandle_t* pxHistogramHandle)
+{
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_HISTOGRAM));
+
+	/* This should never fail */
+	TRC_ASSERT(pxHistogramHandle != 0);
+
+	if (uiIndex >= pxHistogramData->uiHistogramCount)
+	{
+		return TRC_FAIL;
+	}
+
+	*pxHistogramHandle = (TraceHistogramHandle_t)&pxHistogramData->xHistograms[uiIndex];
+
+	return TRC_SUCCESS;
+}
+
+static uint32_t prvTraceHistogramGetBucketIndex(uint32_t uiValue)
+{
+	uint32_t uiIndex = 0;
+
+	if (uiValue >= 0x00010000UL) { uiValue >>= 16; uiIndex += 16; }
+	if (uiValue >= 0x00000100UL) { uiValue >>= 8; uiIndex += 8; }
+	if (uiValue >= 0x00000010UL) { uiValue >>= 4; uiIndex += 4; }
+	if (uiValue >= 0x00000004UL) { uiValue >>= 2; uiIndex += 2; }
+	if (uiValue >= 0x00000002UL) { uiIndex += 1; }
+
+	return uiIndex;
+}
+
+static void prvTraceHistogramClear(TraceHistogram_t* pxHistogram)
+{
+	uint32_t i;
+
+	pxHistogram->uiCount = 0;
+	pxHistogram->uiMin = 0;
+	pxHistogram->uiMax = 0;
+	pxHistogram->uiSumLow = 0;
+	pxHistogram->uiSumHigh = 0;
+
+	for (i = 0; i < TRC_HISTOGRAM_BUCKETS; i++)
+	{
+		pxHistogram->uiBuckets[i] = 0;
+	}
+}
+
+#endif /* ((TRC_CFG_ENABLE_HISTOGRAMS) == 1) */
+
+#endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
+
+#endif /* (TRC_USE_TRACEALYZER_RECORDER == 1) */
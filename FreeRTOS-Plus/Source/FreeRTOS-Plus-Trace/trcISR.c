@@ -135,7 +135,7 @@ traceResult xTraceISRBegin(TraceISRHandle_t xISRHandle)
 
 #if (TRC_CFG_INCLUDE_ISR_TRACING == 1)
 		/* We need to check this */
-		if (xTraceEventBegin(PSF_EVENT_ISR_BEGIN, sizeof(void*), &xEventHandle) == TRC_SUCCESS)
+		if (xTraceEventBeginForObject(PSF_EVENT_ISR_BEGIN, (void*)xISRHandle, sizeof(void*), &xEventHandle) == TRC_SUCCESS)
 		{
 			xTraceEventAddPointer(xEventHandle, (void*)xISRHandle);
 			xTraceEventEnd(xEventHandle);
@@ -15,6 +15,8 @@
 #if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
 
 #define TRC_INTERVAL_STATE_INDEX 0
+#define TRC_INTERVAL_START_TIMESTAMP_INDEX 1
+#define TRC_INTERVAL_HISTOGRAM_INDEX 2
 
 traceResult xTraceIntervalCreate(const char *szName, TraceIntervalHandle_t *pxIntervalHandle)
 {
@@ -40,6 +42,21 @@ traceResult xTraceIntervalCreate(const char *szName, TraceIntervalHandle_t *pxIn
 traceResult xTraceIntervalStart(TraceIntervalHandle_t xIntervalHandle)
 {
 	TraceEventHandle_t xEventHandle = 0;
+#if ((TRC_CFG_ENABLE_HISTOGRAMS) == 1)
+	TraceUnsignedBaseType_t uxHistogram;
+	uint32_t uiTimestamp;
+
+	/* This should never fail */
+	TRC_ASSERT_ALWAYS_EVALUATE(xTraceEntryGetState((TraceEntryHandle_t)xIntervalHandle, TRC_INTERVAL_HISTOGRAM_INDEX, &uxHistogram) == TRC_SUCCESS);
+
+	if (uxHistogram != 0)
+	{
+		xTraceTimestampGet(&uiTimestamp);
+
+		/* This should never fail */
+		TRC_ASSERT_ALWAYS_EVALUATE(xTraceEntrySetState((TraceEntryHandle_t)xIntervalHandle, TRC_INTERVAL_START_TIMESTAMP_INDEX, uiTimestamp) == TRC_SUCCESS);
+	}
+#endif
 	
 	/* This should never fail */
 	TRC_ASSERT_ALWAYS_EVALUATE(xTraceEntrySetState((TraceEntryHandle_t)xIntervalHandle, TRC_INTERVAL_STATE_INDEX, 1) == TRC_SUCCESS);
@@ -58,6 +75,30 @@ traceResult xTraceIntervalStart(TraceIntervalHandle_t xIntervalHandle)
 traceResult xTraceIntervalStop(TraceIntervalHandle_t xIntervalHandle)
 {
 	TraceEventHandle_t xEventHandle = 0;
+#if ((TRC_CFG_ENABLE_HISTOGRAMS) == 1)
+	TraceUnsignedBaseType_t uxHistogram, uxState, uxStartTimestamp;
+	uint32_t uiTimestamp;
+
+	/* This should never fail */
+	TRC_ASSERT_ALWAYS_EVALUATE(xTraceEntryGetState((TraceEntryHandle_t)xIntervalHandle, TRC_INTERVAL_HISTOGRAM_INDEX, &uxHistogram) == TRC_SUCCESS);
+
+	/* This should never fail */
+	TRC_ASSERT_ALWAYS_EVALUATE(xTraceEntryGetState((TraceEntryHandle_t)xIntervalHandle, TRC_INTERVAL_STATE_INDEX, &uxState) == TRC_SUCCESS);
+
+	/* Only complete intervals are added, a histogram attached while the interval was running has no start time */
+	if (uxHistogram != 0 && uxState == 1)
+	{
+		xTraceTimestampGet(&uiTimestamp);
+
+		/* This should never fail */
+		TRC_ASSERT_ALWAYS_EVALUATE(xTraceEntryGetState((TraceEntryHandle_t)xIntervalHandle, TRC_INTERVAL_START_TIMESTAMP_INDEX, &uxStartTimestamp) == TRC_SUCCESS);
+
+		if (uxStartTimestamp != 0)
+		{
+			xTraceHistogramAdd((TraceHistogramHandle_t)uxHistogram, uiTimestamp - (uint32_t)uxStartTimestamp);
+		}
+	}
+#endif
 	
 	/* This should never fail */
 	TRC_ASSERT_ALWAYS_EVALUATE(xTraceEntrySetState((TraceEntryHandle_t)xIntervalHandle, TRC_INTERVAL_STATE_INDEX, 0) == TRC_SUCCESS);
@@ -73,6 +114,17 @@ traceResult xTraceIntervalStop(TraceIntervalHandle_t xIntervalHandle)
 	return TRC_SUCCESS;
 }
 
+#if ((TRC_CFG_ENABLE_HISTOGRAMS) == 1)
+traceResult xTraceIntervalSetHistogram(TraceIntervalHandle_t xIntervalHandle, TraceHistogramHandle_t xHistogramHandle)
+{
+	/* Clear the start time so that a running interval is not measured from a stale start */
+	/* This should never fail */
+	TRC_ASSERT_ALWAYS_EVALUATE(xTraceEntrySetState((TraceEntryHandle_t)xIntervalHandle, TRC_INTERVAL_START_TIMESTAMP_INDEX, 0) == TRC_SUCCESS);
+
+	return xTraceEntrySetState((TraceEntryHandle_t)xIntervalHandle, TRC_INTERVAL_HISTOGRAM_INDEX, (TraceUnsignedBaseType_t)xHistogramHandle);
+}
+#endif
+
 traceResult xTraceIntervalGetState(TraceIntervalHandle_t xIntervalHandle, TraceUnsignedBaseType_t *puxState)
 {
 	return xTraceEntryGetState((TraceEntryHandle_t)xIntervalHandle, TRC_INTERVAL_STATE_INDEX, puxState);
@@ -138,6 +138,28 @@ traceResult xTraceKernelPortGetUnusedStack(void* pvTask, TraceUnsignedBaseType_t
 	return TRC_SUCCESS;
 }
 
+traceResult xTraceKernelPortGetStackStart(void* pvTask, void** ppvStackStart, uint32_t* puiStackUnitSize)
+{
+#if (portSTACK_GROWTH < 0) && (configUSE_TRACE_FACILITY == 1)
+	TaskStatus_t xTaskStatus;
+
+	/* The state is not needed, eRunning skips looking it up */
+	vTaskGetInfo((TaskHandle_t)pvTask, &xTaskStatus, pdFALSE, eRunning);
+
+	*ppvStackStart = (void*)xTaskStatus.pxStackBase;
+	*puiStackUnitSize = sizeof(StackType_t);
+
+	return TRC_SUCCESS;
+#else
+	/* vTaskGetInfo() is not available, or the unused stack space is at the end of the stack, which is not known */
+	(void)pvTask;
+	(void)ppvStackStart;
+	(void)puiStackUnitSize;
+
+	return TRC_FAIL;
+#endif
+}
+
 #endif
 
 traceResult xTraceKernelPortDelay(uint32_t uiTicks)
@@ -20,6 +20,11 @@ typedef struct TraceStackMonitorEntry
 {
 	void *pvTask;
 	TraceUnsignedBaseType_t uxPreviousLowWaterMark;
+#if ((TRC_CFG_STACK_MONITOR_SWEEP_WORDS) > 0)
+	uint32_t *puiStackStart;
+	uint32_t uiScanOffset;
+	uint32_t uiReportedSession;
+#endif
 } TraceStackMonitorEntry_t;
 
 typedef struct TraceStackMonitor
@@ -31,6 +36,22 @@ typedef struct TraceStackMonitor
 
 static TraceStackMonitor_t* pxStackMonitor;
 
+#if ((TRC_CFG_STACK_MONITOR_SWEEP_WORDS) > 0)
+
+/* The value tasks.c fills unused stack with (tskSTACK_FILL_BYTE) */
+#define TRC_STACK_MONITOR_FILL_WORD 0xA5A5A5A5UL
+
+/* Low water mark of an entry that has not been swept yet */
+#define TRC_STACK_MONITOR_UNKNOWN ((TraceUnsignedBaseType_t)-1)
+
+/* The unit xTraceKernelPortGetUnusedStack() reports in */
+static uint32_t uiStackUnitSize = sizeof(uint32_t);
+
+/* Continues the sweep of one entry, returns 1 when the entry is completed */
+static uint32_t prvTraceStackMonitorSweepEntry(TraceStackMonitorEntry_t *pxEntry, uint32_t *puiBudget, uint32_t *puiMoved);
+
+#endif
+
 traceResult xTraceStackMonitorInitialize(TraceStackMonitorBuffer_t *pxBuffer)
 {
 	uint32_t i;
@@ -80,6 +101,27 @@ traceResult xTraceStackMonitorAdd(void *pvTask)
 		return TRC_FAIL;
 	}
 
+#if ((TRC_CFG_STACK_MONITOR_SWEEP_WORDS) > 0)
+	pxStackMonitor->xEntries[pxStackMonitor->uiEntryCount].uiScanOffset = 0;
+	pxStackMonitor->xEntries[pxStackMonitor->uiEntryCount].uiReportedSession = 0;
+
+	if (xTraceKernelPortGetStackStart(pvTask, (void**)&pxStackMonitor->xEntries[pxStackMonitor->uiEntryCount].puiStackStart, &uiStackUnitSize) == TRC_SUCCESS)
+	{
+		/* The stack is not scanned here, the sweep finds the low water mark */
+		pxStackMonitor->xEntries[pxStackMonitor->uiEntryCount].pvTask = pvTask;
+		pxStackMonitor->xEntries[pxStackMonitor->uiEntryCount].uxPreviousLowWaterMark = TRC_STACK_MONITOR_UNKNOWN;
+
+		pxStackMonitor->uiEntryCount++;
+
+		TRACE_EXIT_CRITICAL_SECTION();
+
+		return TRC_SUCCESS;
+	}
+
+	/* Fall back to full scans of this stack */
+	pxStackMonitor->xEntries[pxStackMonitor->uiEntryCount].puiStackStart = 0;
+#endif
+
 	if (xTraceKernelPortGetUnusedStack(pvTask, &uxLowMark) == TRC_SUCCESS)
 	{
 		pxStackMonitor->xEntries[pxStackMonitor->uiEntryCount].pvTask = pvTask;
@@ -117,8 +159,7 @@ traceResult xTraceStackMonitorRemove(void* pvTask)
 			if (pxStackMonitor->uiEntryCount > 1 && i != (pxStackMonitor->uiEntryCount - 1))
 			{
 				/* There are more entries and this is NOT the last entry. Move last entry to this slot. */
-				pxStackMonitor->xEntries[i].pvTask = pxStackMonitor->xEntries[pxStackMonitor->uiEntryCount - 1].pvTask;
-				pxStackMonitor->xEntries[i].uxPreviousLowWaterMark = pxStackMonitor->xEntries[pxStackMonitor->uiEntryCount - 1].uxPreviousLowWaterMark;
+				pxStackMonitor->xEntries[i] = pxStackMonitor->xEntries[pxStackMonitor->uiEntryCount - 1];
 
 				/* Clear old entry that was moved */
 				pxStackMonitor->xEntries[pxStackMonitor->uiEntryCount - 1].pvTask = 0;
@@ -164,6 +205,128 @@ traceResult xTraceStackMonitorGetAtIndex(uint32_t uiIndex, void **ppvTask, Trace
 	return TRC_SUCCESS;
 }
 
+#if ((TRC_CFG_STACK_MONITOR_SWEEP_WORDS) > 0)
+traceResult xTraceStackMonitorReport(void)
+{
+	TraceEventHandle_t xEventHandle = 0;
+	TraceStackMonitorEntry_t *pxStackMonitorEntry;
+	uint32_t uiBudget = (TRC_CFG_STACK_MONITOR_SWEEP_WORDS);
+	uint32_t uiMoved;
+	uint32_t i;
+	static uint32_t uiCurrentIndex = 0;
+
+	TRACE_ALLOC_CRITICAL_SECTION();
+
+	/* This should never fail */
+	TRC_ASSERT(xTraceIsComponentInitialized(TRC_RECORDER_COMPONENT_STACK_MONITOR));
+
+	TRACE_ENTER_CRITICAL_SECTION();
+
+	/* Visit each entry at most once per call, stop when the budget is used up */
+	for (i = 0; i < pxStackMonitor->uiEntryCount; i++)
+	{
+		/* If uiCurrentIndex is too large, reset it */
+		uiCurrentIndex = uiCurrentIndex < pxStackMonitor->uiEntryCount ? uiCurrentIndex : 0;
+
+		pxStackMonitorEntry = &pxStackMonitor->xEntries[uiCurrentIndex];
+
+		if (prvTraceStackMonitorSweepEntry(pxStackMonitorEntry, &uiBudget, &uiMoved) == 0)
+		{
+			/* Out of budget, continue from here next time */
+			break;
+		}
+
+		/* Only report when the low water mark moves, and once per trace session so the value is always known */
+		if ((uiMoved || pxStackMonitorEntry->uiReportedSession != pxTraceRecorderData->uiSessionCounter) && pxStackMonitorEntry->uxPreviousLowWaterMark != TRC_STACK_MONITOR_UNKNOWN)
+		{
+			if (xTraceEventBegin(PSF_EVENT_UNUSED_STACK, sizeof(void*) + sizeof(uint32_t), &xEventHandle) == TRC_SUCCESS)
+			{
+				xTraceEventAddPointer(xEventHandle, pxStackMonitorEntry->pvTask);
+				xTraceEventAdd32(xEventHandle, (uint32_t)pxStackMonitorEntry->uxPreviousLowWaterMark);
+				xTraceEventEnd(xEventHandle);
+
+				pxStackMonitorEntry->uiReportedSession = pxTraceRecorderData->uiSessionCounter;
+			}
+		}
+
+		uiCurrentIndex++;
+
+		if (uiBudget == 0)
+		{
+			break;
+		}
+	}
+
+	TRACE_EXIT_CRITICAL_SECTION();
+
+	return TRC_SUCCESS;
+}
+
+static uint32_t prvTraceStackMonitorSweepEntry(TraceStackMonitorEntry_t *pxEntry, uint32_t *puiBudget, uint32_t *puiMoved)
+{
+	TraceUnsignedBaseType_t uxLowWaterMark;
+	uint32_t uiLimit;
+	uint32_t uiCost;
+
+	*puiMoved = 0;
+
+	if (pxEntry->puiStackStart == 0)
+	{
+		/* No stack start, use a full scan. It reads every unused word, which is
+		 * charged to the budget like the incremental scan. It waits for the next
+		 * call if it does not fit in what is left, unless the budget is untouched
+		 * so that it always gets its turn. */
+		uiCost = (pxEntry->uxPreviousLowWaterMark == TRC_STACK_MONITOR_UNKNOWN) ? (TRC_CFG_STACK_MONITOR_SWEEP_WORDS) : (uint32_t)((pxEntry->uxPreviousLowWaterMark * uiStackUnitSize) / sizeof(uint32_t)) + 1;
+
+		if (uiCost > *puiBudget && *puiBudget < (TRC_CFG_STACK_MONITOR_SWEEP_WORDS))
+		{
+			return 0;
+		}
+
+		xTraceKernelPortGetUnusedStack(pxEntry->pvTask, &uxLowWaterMark);
+
+		uiCost = (uint32_t)((uxLowWaterMark * uiStackUnitSize) / sizeof(uint32_t)) + 1;
+		*puiBudget -= (uiCost < *puiBudget) ? uiCost : *puiBudget;
+
+		if (uxLowWaterMark < pxEntry->uxPreviousLowWaterMark)
+		{
+			pxEntry->uxPreviousLowWaterMark = uxLowWaterMark;
+			*puiMoved = 1;
+		}
+
+		return 1;
+	}
+
+	/* The stack is unused from the start up to the low water mark. Since the
+	 * low water mark can only move towards the start, only that part is checked
+	 * for words that are no longer filled. */
+	uiLimit = (pxEntry->uxPreviousLowWaterMark == TRC_STACK_MONITOR_UNKNOWN) ? 0xFFFFFFFFUL : (uint32_t)((pxEntry->uxPreviousLowWaterMark * uiStackUnitSize) / sizeof(uint32_t));
+
+	while (pxEntry->uiScanOffset < uiLimit)
+	{
+		if (pxEntry->puiStackStart[pxEntry->uiScanOffset] != TRC_STACK_MONITOR_FILL_WORD)
+		{
+			pxEntry->uxPreviousLowWaterMark = (TraceUnsignedBaseType_t)((pxEntry->uiScanOffset * sizeof(uint32_t)) / uiStackUnitSize);
+			*puiMoved = 1;
+
+			break;
+		}
+
+		if (*puiBudget == 0)
+		{
+			return 0;
+		}
+
+		(*puiBudget)--;
+		pxEntry->uiScanOffset++;
+	}
+
+	/* Start over on the next sweep */
+	pxEntry->uiScanOffset = 0;
+
+	return 1;
+}
+#else /* ((TRC_CFG_STACK_MONITOR_SWEEP_WORDS) > 0) */
 traceResult xTraceStackMonitorReport(void)
 {
 	TraceUnsignedBaseType_t uxLowWaterMark;
@@ -211,6 +374,7 @@ traceResult xTraceStackMonitorReport(void)
 
 	return TRC_SUCCESS;
 }
+#endif /* ((TRC_CFG_STACK_MONITOR_SWEEP_WORDS) > 0) */
 #endif /* (((TRC_CFG_ENABLE_STACK_MONITOR) == 1) && ((TRC_CFG_SCHEDULING_ONLY) == 0)) */
 
 #endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
@@ -15,7 +15,14 @@
 #if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)
 
 #define TRC_STATE_MACHINE_STATE_INDEX 0
+#define TRC_STATE_MACHINE_STATE_TIMESTAMP_INDEX 1
 #define TRC_STATE_MACHINE_INDEX 0
+#define TRC_STATE_MACHINE_STATE_HISTOGRAM_INDEX 1
+
+#if ((TRC_CFG_ENABLE_HISTOGRAMS) == 1)
+/* Adds the time spent in the current state to its histogram and restarts the time */
+static void prvTraceStateMachineUpdateHistogram(TraceStateMachineHandle_t xStateMachineHandle);
+#endif
 
 traceResult xTraceStateMachineCreate(const char *szName, TraceStateMachineHandle_t *pxStateMachineHandle)
 {
@@ -80,6 +87,10 @@ traceResult xTraceStateMachineSetState(TraceStateMachineHandle_t xStateMachineHa
 	/* This should never fail */
 	TRC_ASSERT(xStateMachineHandle == (TraceStateMachineHandle_t)uxStateMachine);
 
+#if ((TRC_CFG_ENABLE_HISTOGRAMS) == 1)
+	prvTraceStateMachineUpdateHistogram(xStateMachineHandle);
+#endif
+
 	/* This should never fail */
 	TRC_ASSERT_ALWAYS_EVALUATE(xTraceEntrySetState((TraceEntryHandle_t)xStateMachineHandle, TRC_STATE_MACHINE_STATE_INDEX, (TraceUnsignedBaseType_t)xStateHandle) == TRC_SUCCESS);
 
@@ -94,6 +105,44 @@ traceResult xTraceStateMachineSetState(TraceStateMachineHandle_t xStateMachineHa
 	return TRC_SUCCESS;
 }
 
+#if ((TRC_CFG_ENABLE_HISTOGRAMS) == 1)
+traceResult xTraceStateMachineStateSetHistogram(TraceStateMachineStateHandle_t xStateHandle, TraceHistogramHandle_t xHistogramHandle)
+{
+	/* This should never fail */
+	TRC_ASSERT(xStateHandle != 0);
+
+	return xTraceEntrySetState((TraceEntryHandle_t)xStateHandle, TRC_STATE_MACHINE_STATE_HISTOGRAM_INDEX, (TraceUnsignedBaseType_t)xHistogramHandle);
+}
+
+static void prvTraceStateMachineUpdateHistogram(TraceStateMachineHandle_t xStateMachineHandle)
+{
+	TraceUnsignedBaseType_t uxPreviousState, uxHistogram = 0, uxEnterTimestamp;
+	uint32_t uiTimestamp;
+
+	xTraceTimestampGet(&uiTimestamp);
+
+	/* This should never fail */
+	TRC_ASSERT_ALWAYS_EVALUATE(xTraceEntryGetState((TraceEntryHandle_t)xStateMachineHandle, TRC_STATE_MACHINE_STATE_INDEX, &uxPreviousState) == TRC_SUCCESS);
+
+	if (uxPreviousState != 0)
+	{
+		/* This should never fail */
+		TRC_ASSERT_ALWAYS_EVALUATE(xTraceEntryGetState((TraceEntryHandle_t)uxPreviousState, TRC_STATE_MACHINE_STATE_HISTOGRAM_INDEX, &uxHistogram) == TRC_SUCCESS);
+	}
+
+	if (uxHistogram != 0)
+	{
+		/* This should never fail */
+		TRC_ASSERT_ALWAYS_EVALUATE(xTraceEntryGetState((TraceEntryHandle_t)xStateMachineHandle, TRC_STATE_MACHINE_STATE_TIMESTAMP_INDEX, &uxEnterTimestamp) == TRC_SUCCESS);
+
+		xTraceHistogramAdd((TraceHistogramHandle_t)uxHistogram, uiTimestamp - (uint32_t)uxEnterTimestamp);
+	}
+
+	/* This should never fail */
+	TRC_ASSERT_ALWAYS_EVALUATE(xTraceEntrySetState((TraceEntryHandle_t)xStateMachineHandle, TRC_STATE_MACHINE_STATE_TIMESTAMP_INDEX, uiTimestamp) == TRC_SUCCESS);
+}
+#endif
+
 #endif /* (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING) */
 
 #endif /* (TRC_USE_TRACEALYZER_RECORDER == 1) */
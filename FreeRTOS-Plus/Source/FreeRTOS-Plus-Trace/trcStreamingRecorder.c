@@ -112,6 +112,9 @@ static void prvSetRecorderEnabled(void);
 /* Internal function for stopping the recorder */
 static void prvSetRecorderDisabled(void);
 
+/* Internal function for setting a filter rule from a command */
+static void prvSetFilterRule(TraceCommand_t* cmd);
+
 /******************************************************************************
 * xTraceInitialize
 *
@@ -207,6 +210,16 @@ traceResult xTraceInitialize(void)
 		return TRC_FAIL;
 	}
 
+	if (xTraceFilterInitialize(&pxTraceRecorderData->xFilterBuffer) == TRC_FAIL)
+	{
+		return TRC_FAIL;
+	}
+
+	if (xTraceHistogramInitialize(&pxTraceRecorderData->xHistogramBuffer) == TRC_FAIL)
+	{
+		return TRC_FAIL;
+	}
+
 	if (xTraceKernelPortInitialize(&pxTraceRecorderData->xKernelPortBuffer) == TRC_FAIL)
 	{
 		return TRC_FAIL;
@@ -395,6 +408,7 @@ traceResult xTraceTzCtrl(void)
 	{
 		xTraceDiagnosticsCheckStatus();
 		xTraceStackMonitorReport();
+		xTraceFilterNextPeriod();
 	}
 
 	return TRC_SUCCESS;
@@ -549,6 +563,24 @@ static void prvTraceStoreStartEvent()
 	}
 }
 
+/* Sets or clears (action TRC_FILTER_ACTION_NONE) a filter rule */
+static void prvSetFilterRule(TraceCommand_t* cmd)
+{
+	TraceFilterRule_t xRule;
+	uint16_t uiEventCode = (uint16_t)(cmd->param3 | ((uint16_t)cmd->param4 << 8));
+
+	xRule.uiMatch = (uiEventCode != 0) ? TRC_FILTER_MATCH_EVENT_CODE : 0;
+	xRule.uiEventCodeFirst = uiEventCode;
+	xRule.uiEventCodeLast = uiEventCode;
+	xRule.pvObject = 0;
+	xRule.pvTask = 0;
+	xRule.uiAction = cmd->param2;
+	xRule.uiParam = cmd->param5;
+	xRule.uiCounter = 0;
+
+	(void)xTraceFilterSetRule(cmd->param1, &xRule);
+}
+
 /* Checks if the provided command is a valid command */
 static int prvIsValidCommand(TraceCommand_t* cmd)
 {
@@ -586,6 +618,9 @@ static void prvProcessCommand(TraceCommand_t* cmd)
 				prvSetRecorderDisabled();
 			}
 		  	break;
+		case CMD_SET_FILTER_RULE:
+			prvSetFilterRule(cmd);
+			break;
 		default:
 		  	break;
 	}
@@ -149,7 +149,7 @@ traceResult xTraceTaskReady(void *pvTask)
 	traceResult xResult = TRC_FAIL;
 	TraceEventHandle_t xEventHandle = 0;
 
-	if (xTraceEventBegin(PSF_EVENT_TASK_READY, sizeof(void*), &xEventHandle) == TRC_SUCCESS)
+	if (xTraceEventBeginForObject(PSF_EVENT_TASK_READY, pvTask, sizeof(void*), &xEventHandle) == TRC_SUCCESS)
 	{
 		xTraceEventAddPointer(xEventHandle, pvTask);
 		xTraceEventEnd(xEventHandle);
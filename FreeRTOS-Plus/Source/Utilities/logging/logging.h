@@ -47,6 +47,77 @@ void vLoggingInit( BaseType_t xLogToStdout,
 
 void vPlatformInitLogging(void);
 
+/* The run time log level of one module (translation unit), see
+ * LOGGING_RUNTIME_LEVELS in logging_stack.h and Logging_Levels.c. */
+typedef struct xLOGGING_MODULE
+{
+    const char * pcName;                /* LIBRARY_LOG_NAME of the module. */
+    const char * pcFile;                /* __FILE__ of the module, set when registered. */
+    struct xLOGGING_MODULE * pxNext;    /* The next registered module. */
+    uint16_t usId;                      /* Interned ID, printed in place of file names. */
+    uint8_t ucLevel;                    /* LOG_NONE to LOG_DEBUG, or LOG_LEVEL_UNREGISTERED. */
+    uint8_t ucDefaultLevel;             /* The level the module starts with. */
+} LoggingModule_t;
+
+/* ucLevel of a module that has not logged yet.  It compares above every level,
+ * so the first message of a module always reaches xLoggingRegisterModule(). */
+#define LOG_LEVEL_UNREGISTERED    0xFFU
+
+/*
+ * Register a module when it first logs.  Returns non-zero when messages of
+ * ucLevel are enabled for the module.
+ */
+BaseType_t xLoggingRegisterModule( LoggingModule_t * pxModule,
+                                   const char * pcFile,
+                                   uint8_t ucLevel );
+
+/*
+ * Set the run time level of every module whose library name, or file name
+ * without its directory, equals pcName, or of every module when pcName is
+ * "all".  A module that registers later starts with the level last set for its
+ * library or file name, else with the level of a registered module with the
+ * same library name, else with the level last set for "all", else with its
+ * LIBRARY_LOG_RUNTIME_LEVEL.  Levels set by name are remembered for up to
+ * llPENDING_LEVELS names, see Logging_Levels.c.  Returns the number of
+ * registered modules that were changed.
+ */
+UBaseType_t uxLoggingSetLevel( const char * pcName,
+                               uint8_t ucLevel );
+
+/*
+ * Return the uxIndex'th registered module, or NULL when there are fewer.
+ */
+const LoggingModule_t * pxLoggingGetModule( UBaseType_t uxIndex );
+
+/*
+ * Convert between levels and their names "none", "error", "warn", "info" and
+ * "debug".  xLoggingParseLevel() returns pdFALSE when the name is not known.
+ */
+const char * pcLoggingLevelName( uint8_t ucLevel );
+BaseType_t xLoggingParseLevel( const char * pcName,
+                               size_t xLength,
+                               uint8_t * pucLevel );
+
 void vLoggingPrintf(const char* pcFormat, ...);
 
+/*
+ * Create the low priority task of the deferred logging backend, see
+ * Logging_Deferred.c.  Messages logged before the task runs are formatted by
+ * the caller.
+ */
+void vLoggingDeferredInit( configSTACK_DEPTH_TYPE uxStackSize,
+                           UBaseType_t uxPriority );
+
+/*
+ * Record a message for the deferred logging backend.  The variable arguments
+ * are the arguments of pcPrefixFormat, then the message format, then the
+ * arguments of the message format.  Both formats must remain valid until the
+ * message is printed, so normally they are string literals.  Used by the
+ * logging macros of logging_stack.h when LOGGING_DEFERRED is 1.  The record is
+ * built on the stack of the caller, which needs about
+ * dlDEFERRED_MAX_RECORD_SIZE bytes of stack for it.
+ */
+void vLoggingPrintfDeferred( const char * pcPrefixFormat,
+                             ... );
+
 #endif /* DEMO_LOGGING_H */
@@ -56,7 +56,29 @@
     #error "Please define LIBRARY_LOG_NAME for the library."
 #endif
 
-/* Metadata information to prepend to every log message. */
+/**
+ * @brief Set to 1 to give every module (translation unit) a log level that can
+ * be changed at run time with uxLoggingSetLevel().  Messages above the run time
+ * level cost one comparison.  Messages above LIBRARY_LOG_LEVEL are still
+ * removed at compile time.
+ */
+#ifndef LOGGING_RUNTIME_LEVELS
+    #define LOGGING_RUNTIME_LEVELS    0
+#endif
+
+/* Metadata information to prepend to every log message.  With run time levels
+ * the module is identified by its interned ID, which the log-level command
+ * maps back to its file, rather than by the name of the function. */
+#if ( LOGGING_RUNTIME_LEVELS == 1 )
+    #ifndef LOG_METADATA_FORMAT
+        #define LOG_METADATA_FORMAT    "[#%u:%d] "
+    #endif
+
+    #ifndef LOG_METADATA_ARGS
+        #define LOG_METADATA_ARGS    ( unsigned ) ( pxLoggingModule()->usId ), __LINE__
+    #endif
+#endif
+
 #ifndef LOG_METADATA_FORMAT
     #define LOG_METADATA_FORMAT    "[%s:%d] "                  /**< @brief Format of metadata prefix in log messages. */
 #endif
@@ -78,6 +100,74 @@
     #define SdkLog( message )    vLoggingPrintf message
 #endif
 
+/**
+ * @brief Set to 1 to log each message with a single call to
+ * vLoggingPrintfDeferred(), which stores the raw arguments and leaves the
+ * formatting to a low priority task, instead of formatting it in the caller
+ * with three #SdkLog calls.
+ */
+#ifndef LOGGING_DEFERRED
+    #define LOGGING_DEFERRED    0
+#endif
+
+/**
+ * @brief Removes the parentheses around the arguments of a logging macro.
+ */
+#define LOG_UNWRAP( ... )    __VA_ARGS__
+
+/**
+ * @brief Logs one message with its metadata prefix and line ending.
+ */
+#if ( LOGGING_DEFERRED == 1 )
+    #define SdkLogLine( level, message )    vLoggingPrintfDeferred( "[" level "] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS, LOG_UNWRAP message )
+#else
+    #define SdkLogLine( level, message )    SdkLog( ( "[" level "] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
+#endif
+
+/**
+ * @brief The level a module starts with when run time levels are used.  Levels
+ * above LIBRARY_LOG_LEVEL can be selected at run time, but those messages were
+ * not compiled in.
+ */
+#ifndef LIBRARY_LOG_RUNTIME_LEVEL
+    #define LIBRARY_LOG_RUNTIME_LEVEL    LIBRARY_LOG_LEVEL
+#endif
+
+#if ( LOGGING_RUNTIME_LEVELS == 1 )
+
+/**
+ * @brief The run time level of the module that includes this header.  Each
+ * translation unit has its own instance, registered when it first logs.
+ */
+    static inline LoggingModule_t * pxLoggingModule( void )
+    {
+        static LoggingModule_t xModule = { LIBRARY_LOG_NAME, NULL, NULL, 0U, LOG_LEVEL_UNREGISTERED, ( uint8_t ) ( LIBRARY_LOG_RUNTIME_LEVEL ) };
+
+        return &( xModule );
+    }
+
+/**
+ * @brief Evaluates to non-zero when messages of the given level are enabled for
+ * this module.  An unregistered module compares as enabled and is registered
+ * by the second test.
+ */
+    #define LOG_ENABLED( level )                                   \
+    ( ( pxLoggingModule()->ucLevel >= ( uint8_t ) ( level ) ) &&  \
+      ( ( pxLoggingModule()->ucLevel != LOG_LEVEL_UNREGISTERED ) || ( xLoggingRegisterModule( pxLoggingModule(), __FILE__, ( uint8_t ) ( level ) ) != 0 ) ) )
+
+    #define SdkLogLevel( level, name, message )    do { if( LOG_ENABLED( level ) ) { SdkLogLine( name, message ); } } while( 0 )
+#else
+    #define SdkLogLevel( level, name, message )    SdkLogLine( name, message )
+#endif
+
+/**
+ * @brief Messages above this level are removed at compile time in every
+ * library, whatever its LIBRARY_LOG_LEVEL.
+ */
+#ifndef LOGGING_MAX_LEVEL
+    #define LOGGING_MAX_LEVEL    LOG_DEBUG
+#endif
+
 /**
  * Disable definition of logging interface macros when generating doxygen output,
  * to avoid conflict with documentation of macros at the end of the file.
@@ -91,39 +181,45 @@
     ( LIBRARY_LOG_LEVEL != LOG_DEBUG ) )
     #error "Please define LIBRARY_LOG_LEVEL as either LOG_NONE, LOG_ERROR, LOG_WARN, LOG_INFO, or LOG_DEBUG."
 #else
-    #if LIBRARY_LOG_LEVEL == LOG_DEBUG
+    #if LIBRARY_LOG_LEVEL > LOGGING_MAX_LEVEL
+        #define LOGGING_COMPILED_LEVEL    LOGGING_MAX_LEVEL
+    #else
+        #define LOGGING_COMPILED_LEVEL    LIBRARY_LOG_LEVEL
+    #endif
+
+    #if LOGGING_COMPILED_LEVEL == LOG_DEBUG
         /* All log level messages will logged. */
-        #define LogAlways( message )    SdkLog( ( "[ALWAYS] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogError( message )    SdkLog( ( "[ERROR] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogWarn( message )     SdkLog( ( "[WARN] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogInfo( message )     SdkLog( ( "[INFO] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogDebug( message )    SdkLog( ( "[DEBUG] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
+        #define LogAlways( message )    SdkLogLevel( LOG_NONE, "ALWAYS", message )
+        #define LogError( message )    SdkLogLevel( LOG_ERROR, "ERROR", message )
+        #define LogWarn( message )     SdkLogLevel( LOG_WARN, "WARN", message )
+        #define LogInfo( message )     SdkLogLevel( LOG_INFO, "INFO", message )
+        #define LogDebug( message )    SdkLogLevel( LOG_DEBUG, "DEBUG", message )
 
-    #elif LIBRARY_LOG_LEVEL == LOG_INFO
+    #elif LOGGING_COMPILED_LEVEL == LOG_INFO
         /* Only INFO, WARNING, ERROR, and ALWAYS messages will be logged. */
-        #define LogAlways( message )    SdkLog( ( "[ALWAYS] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogError( message )    SdkLog( ( "[ERROR] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogWarn( message )     SdkLog( ( "[WARN] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogInfo( message )     SdkLog( ( "[INFO] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
+        #define LogAlways( message )    SdkLogLevel( LOG_NONE, "ALWAYS", message )
+        #define LogError( message )    SdkLogLevel( LOG_ERROR, "ERROR", message )
+        #define LogWarn( message )     SdkLogLevel( LOG_WARN, "WARN", message )
+        #define LogInfo( message )     SdkLogLevel( LOG_INFO, "INFO", message )
         #define LogDebug( message )
 
-    #elif LIBRARY_LOG_LEVEL == LOG_WARN
+    #elif LOGGING_COMPILED_LEVEL == LOG_WARN
         /* Only WARNING, ERROR, and ALWAYS messages will be logged. */
-        #define LogAlways( message )    SdkLog( ( "[ALWAYS] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogError( message )    SdkLog( ( "[ERROR] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogWarn( message )     SdkLog( ( "[WARN] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
+        #define LogAlways( message )    SdkLogLevel( LOG_NONE, "ALWAYS", message )
+        #define LogError( message )    SdkLogLevel( LOG_ERROR, "ERROR", message )
+        #define LogWarn( message )     SdkLogLevel( LOG_WARN, "WARN", message )
         #define LogInfo( message )
         #define LogDebug( message )
 
-    #elif LIBRARY_LOG_LEVEL == LOG_ERROR
+    #elif LOGGING_COMPILED_LEVEL == LOG_ERROR
         /* Only ERROR and ALWAYS messages will be logged. */
-        #define LogAlways( message )    SdkLog( ( "[ALWAYS] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogError( message )    SdkLog( ( "[ERROR] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
+        #define LogAlways( message )    SdkLogLevel( LOG_NONE, "ALWAYS", message )
+        #define LogError( message )    SdkLogLevel( LOG_ERROR, "ERROR", message )
         #define LogWarn( message )
         #define LogInfo( message )
         #define LogDebug( message )
 
-    #else /* if LIBRARY_LOG_LEVEL == LOG_NONE */
+    #else /* if LOGGING_COMPILED_LEVEL == LOG_NONE */
 
         #define LogAlways( message )
         #define LogError( message )
@@ -131,7 +227,7 @@
         #define LogInfo( message )
         #define LogDebug( message )
 
-    #endif /* if LIBRARY_LOG_LEVEL == LOG_NONE */
+    #endif /* if LOGGING_COMPILED_LEVEL == LOG_NONE */
 #endif /* if !defined( LIBRARY_LOG_LEVEL ) || ( ( LIBRARY_LOG_LEVEL != LOG_NONE ) && ( LIBRARY_LOG_LEVEL != LOG_ERROR ) && ( LIBRARY_LOG_LEVEL != LOG_WARN ) && ( LIBRARY_LOG_LEVEL != LOG_INFO ) && ( LIBRARY_LOG_LEVEL != LOG_DEBUG ) ) */
 
 #endif /* ifndef LOGGING_STACK_H */
@@ -29,8 +29,12 @@
  * Values:
  * TRC_RECORDER_MODE_SNAPSHOT
  * TRC_RECORDER_MODE_STREAMING
+ *
+ * Can be overridden from the command line, see TRACE_MODE in the Makefile.
  */
-#define TRC_CFG_RECORDER_MODE                    TRC_RECORDER_MODE_SNAPSHOT
+#ifndef TRC_CFG_RECORDER_MODE
+    #define TRC_CFG_RECORDER_MODE                TRC_RECORDER_MODE_SNAPSHOT
+#endif
 
 /**
  * @def TRC_CFG_FREERTOS_VERSION
@@ -0,0 +1,86 @@
+/*
+ * Trace Recorder for Tracealyzer v4.6.0
+ * Copyright 2021 Percepio AB
+ * www.percepio.com
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Configuration parameters for the trace recorder library in streaming mode.
+ * Read more at http://percepio.com/2016/10/05/rtos-tracing/
+ */
+
+#ifndef TRC_STREAMING_CONFIG_H
+#define TRC_STREAMING_CONFIG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @def TRC_CFG_ENTRY_SLOTS
+ * @brief The maximum number of objects and symbols that can be stored. This includes:
+ * - Task names
+ * - Named ISRs (vTraceSetISRProperties)
+ * - Named kernel objects (vTraceStoreKernelObjectName)
+ * - User event channels (xTraceStringRegister)
+ *
+ * If this value is too small, not all symbol names will be stored and the
+ * trace display will be affected. In that case, there will be warnings
+ * (as User Events) from TzCtrl task, that monitors this.
+ */
+#define TRC_CFG_ENTRY_SLOTS 50
+
+/**
+ * @def TRC_CFG_ENTRY_SYMBOL_MAX_LENGTH
+ * @brief The maximum length of symbol names, including:
+ * - Task names
+ * - Named ISRs (vTraceSetISRProperties)
+ * - Named kernel objects (vTraceStoreKernelObjectName)
+ * - User event channel names (xTraceStringRegister)
+ *
+ * If longer symbol names are used, they will be truncated by the recorder,
+ * which will affect the trace display. In that case, there will be warnings
+ * (as User Events) from TzCtrl task, that monitors this.
+ */
+#define TRC_CFG_ENTRY_SYMBOL_MAX_LENGTH 32
+
+/**
+ * @def TRC_CFG_ENABLE_FILTER
+ * @brief Enables the event filter rules (see trcFilter.h), which can drop,
+ * sample (1 in N) or rate limit events by event code, object and task before
+ * they reach the stream port. Rules are set with xTraceFilterSetRule() or
+ * from the host with the CMD_SET_FILTER_RULE command.
+ *
+ * When disabled, no filter code is included and events are never checked.
+ */
+#define TRC_CFG_ENABLE_FILTER 0
+
+/**
+ * @def TRC_CFG_FILTER_MAX_RULES
+ * @brief The maximum number of filter rules. Only used if TRC_CFG_ENABLE_FILTER
+ * is 1. Each event is checked against the rules up to the highest rule index
+ * in use, so keep frequently matched rules at low indexes.
+ */
+#define TRC_CFG_FILTER_MAX_RULES 8
+
+/**
+ * @def TRC_CFG_ENABLE_HISTOGRAMS
+ * @brief Enables on-target latency histograms (see trcHistogram.h). Histograms
+ * attached to intervals or state machine states aggregate durations into
+ * power-of-two buckets, with min/max/mean/p99 available through
+ * xTraceHistogramGetStats(), without streaming the events.
+ */
+#define TRC_CFG_ENABLE_HISTOGRAMS 0
+
+/**
+ * @def TRC_CFG_HISTOGRAM_MAX_COUNT
+ * @brief The maximum number of histograms. Each histogram takes 152 bytes.
+ * Only used if TRC_CFG_ENABLE_HISTOGRAMS is 1.
+ */
+#define TRC_CFG_HISTOGRAM_MAX_COUNT 8
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRC_STREAMING_CONFIG_H */
@@ -36,6 +36,10 @@
  * If mainSELECTED_APPLICATION = FULL_DEMO the more comprehensive test and demo
  * application built. This is implemented and described in main_full.c.
  *
+ * If mainSELECTED_APPLICATION = TRACE_BENCHMARK the trace recorder overhead
+ * benchmark is built. This is implemented and described in
+ * main_trace_benchmark.c.
+ *
  * This file implements the code that is not demo specific, including the
  * hardware setup and FreeRTOS hook functions.
  *
@@ -72,8 +76,9 @@
     #include <trcRecorder.h>
 #endif
 
-#define    BLINKY_DEMO    0
-#define    FULL_DEMO      1
+#define    BLINKY_DEMO        0
+#define    FULL_DEMO          1
+#define    TRACE_BENCHMARK    2
 
 #ifdef BUILD_DIR
     #define BUILD         BUILD_DIR
@@ -93,6 +98,7 @@
 /*-----------------------------------------------------------*/
 extern void main_blinky( void );
 extern void main_full( void );
+extern void main_trace_benchmark( void );
 static void traceOnEnter( void );
 
 /*
@@ -158,17 +164,27 @@ int main( void )
     /* Do not include trace code when performing a code coverage analysis. */
     #if ( projCOVERAGE_TEST != 1 )
         {
-            /* Initialise the trace recorder.  Use of the trace recorder is optional.
-             * See http://www.FreeRTOS.org/trace for more information. */
-            vTraceEnable( TRC_START );
-
-            /* Start the trace recording - the recording is written to a file if
-             * configASSERT() is called. */
-            printf( "\r\nTrace started.\r\nThe trace will be dumped to disk if a call to configASSERT() fails.\r\n" );
-
-            #if ( TRACE_ON_ENTER == 1 )
-                printf( "\r\nThe trace will be dumped to disk if Enter is hit.\r\n" );
-            #endif
+            #if ( mainSELECTED_APPLICATION == TRACE_BENCHMARK )
+                {
+                    /* The benchmark starts the recording itself, after measuring
+                     * the cost of the trace hooks while the recorder is stopped. */
+                    xTraceInitialize();
+                }
+            #else
+                {
+                    /* Initialise the trace recorder.  Use of the trace recorder is optional.
+                     * See http://www.FreeRTOS.org/trace for more information. */
+                    vTraceEnable( TRC_START );
+
+                    /* Start the trace recording - the recording is written to a file if
+                     * configASSERT() is called. */
+                    printf( "\r\nTrace started.\r\nThe trace will be dumped to disk if a call to configASSERT() fails.\r\n" );
+
+                    #if ( TRACE_ON_ENTER == 1 )
+                        printf( "\r\nThe trace will be dumped to disk if Enter is hit.\r\n" );
+                    #endif
+                }
+            #endif /* if ( mainSELECTED_APPLICATION == TRACE_BENCHMARK ) */
         }
     #endif /* if ( projCOVERAGE_TEST != 1 ) */
 
@@ -183,6 +199,11 @@ int main( void )
             console_print( "Starting full demo\n" );
             main_full();
         }
+    #elif ( mainSELECTED_APPLICATION == TRACE_BENCHMARK )
+        {
+            console_print( "Starting trace benchmark\n" );
+            main_trace_benchmark();
+        }
     #else
         {
             #error "The selected demo is not valid"
@@ -358,22 +379,29 @@ static void prvSaveTraceFile( void )
     /* Tracing is not used when code coverage analysis is being performed. */
     #if ( projCOVERAGE_TEST != 1 )
         {
-            FILE * pxOutputFile;
-
-            vTraceStop();
-
-            pxOutputFile = fopen( "Trace.dump", "wb" );
-
-            if( pxOutputFile != NULL )
-            {
-                fwrite( RecorderDataPtr, sizeof( RecorderDataType ), 1, pxOutputFile );
-                fclose( pxOutputFile );
-                printf( "\r\nTrace output saved to Trace.dump\r\n" );
-            }
-            else
-            {
-                printf( "\r\nFailed to create trace dump file\r\n" );
-            }
+            #if ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_SNAPSHOT )
+                FILE * pxOutputFile;
+
+                vTraceStop();
+
+                pxOutputFile = fopen( "Trace.dump", "wb" );
+
+                if( pxOutputFile != NULL )
+                {
+                    fwrite( RecorderDataPtr, sizeof( RecorderDataType ), 1, pxOutputFile );
+                    fclose( pxOutputFile );
+                    printf( "\r\nTrace output saved to Trace.dump\r\n" );
+                }
+                else
+                {
+                    printf( "\r\nFailed to create trace dump file\r\n" );
+                }
+            #else
+                /* The stream port has written the trace while it was recorded,
+                 * stopping the recorder writes out what remains. */
+                vTraceStop();
+                printf( "\r\nTrace stream stopped\r\n" );
+            #endif /* if ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_SNAPSHOT ) */
         }
     #endif /* if ( projCOVERAGE_TEST != 1 ) */
 }
@@ -0,0 +1,293 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/******************************************************************************
+ * NOTE 1: The FreeRTOS demo threads will not be running continuously, so
+ * do not expect to get real time behaviour from the FreeRTOS Linux port, or
+ * this demo application.  The figures reported here are only meaningful when
+ * compared with each other, on the same host.
+ *
+ * NOTE 2:  This file only contains the source code that is specific to the
+ * trace benchmark.  Generic functions, such FreeRTOS hook functions, are
+ * defined in main.c.
+ ******************************************************************************
+ *
+ * main_trace_benchmark() measures the cost of the trace recorder hooks.  It
+ * creates one benchmark task and one yield partner task, then starts the
+ * scheduler.
+ *
+ * The benchmark task runs each of the following operations in a tight loop:
+ * - Task switch:  taskYIELD() to the yield partner task, which yields back.
+ * - Queue:        xQueueSend() followed by xQueueReceive(), both non-blocking.
+ * - ISR:          vTraceStoreISRBegin() followed by vTraceStoreISREnd().
+ * - PrintF:       xTracePrintF() with one integer argument.
+ *
+ * Every operation is first run with the recorder initialised but not started,
+ * then again after xTraceEnable( TRC_START ).  For each operation the elapsed
+ * time per operation is printed for both runs, together with the overhead per
+ * trace event (the difference between the runs divided by the number of
+ * events the operation records) and the resulting events per second.
+ *
+ * The recorder mode and stream port are selected when building:
+ *   make USER_DEMO=TRACE_BENCHMARK                                   (snapshot)
+ *   make USER_DEMO=TRACE_BENCHMARK TRACE_MODE=STREAMING              (File_Posix)
+ *   make USER_DEMO=TRACE_BENCHMARK TRACE_MODE=STREAMING TRACE_STREAM_PORT=RingBuffer
+ * Run "make clean" when changing these options.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Local includes. */
+#include "console.h"
+
+/* The trace recorder is not built when performing a code coverage analysis. */
+#if ( projCOVERAGE_TEST != 1 )
+
+/* Priority at which both tasks are created.  They must be equal so that
+ * taskYIELD() switches between them. */
+#define benchTASK_PRIORITY           ( tskIDLE_PRIORITY + 1 )
+
+/* The number of times each operation is repeated per run. */
+#define benchITERATIONS              ( 200000UL )
+
+/* Task switches are much slower than the other operations on the Linux port. */
+#define benchYIELD_ITERATIONS        ( 20000UL )
+
+/* The number of items the queue can hold at once. */
+#define benchQUEUE_LENGTH            ( 1 )
+
+/*-----------------------------------------------------------*/
+
+/* Describes one of the operations measured. */
+typedef struct BenchmarkOperation
+{
+    const char * pcName;
+    uint32_t ulIterations;
+    uint32_t ulEventsPerOperation;
+    void ( * pvRun )( uint32_t ulIterations );
+} BenchmarkOperation_t;
+
+/*
+ * The tasks as described in the comments at the top of this file.
+ */
+static void prvBenchmarkTask( void * pvParameters );
+static void prvYieldPartnerTask( void * pvParameters );
+
+/*
+ * The operations as described in the comments at the top of this file.
+ */
+static void prvRunTaskSwitch( uint32_t ulIterations );
+static void prvRunQueue( uint32_t ulIterations );
+static void prvRunISR( uint32_t ulIterations );
+static void prvRunPrintF( uint32_t ulIterations );
+
+/*
+ * Returns the time taken by ulIterations repetitions of an operation, in
+ * nanoseconds per operation.
+ */
+static double prvMeasure( const BenchmarkOperation_t * pxOperation );
+
+/*-----------------------------------------------------------*/
+
+static const BenchmarkOperation_t xOperations[] =
+{
+    /* Each yield switches to the partner task and back again. */
+    { "Task switch", benchYIELD_ITERATIONS, 2, prvRunTaskSwitch },
+    { "Queue send/receive", benchITERATIONS, 2, prvRunQueue },
+    { "ISR enter/exit", benchITERATIONS, 2, prvRunISR },
+    { "xTracePrintF", benchITERATIONS, 1, prvRunPrintF }
+};
+
+#define benchNUM_OPERATIONS    ( sizeof( xOperations ) / sizeof( xOperations[ 0 ] ) )
+
+static QueueHandle_t xQueue = NULL;
+static TaskHandle_t xYieldPartnerTask = NULL;
+static volatile BaseType_t xYieldActive = pdFALSE;
+static traceHandle xBenchmarkISR;
+static TraceStringHandle_t xBenchmarkChannel;
+
+/*-----------------------------------------------------------*/
+
+/*** SEE THE COMMENTS AT THE TOP OF THIS FILE ***/
+void main_trace_benchmark( void )
+{
+    xQueue = xQueueCreate( benchQUEUE_LENGTH, sizeof( uint32_t ) );
+    configASSERT( xQueue != NULL );
+
+    xBenchmarkISR = xTraceSetISRProperties( "BenchISR", 1 );
+    xTraceStringRegister( "Benchmark", &xBenchmarkChannel );
+
+    xTaskCreate( prvBenchmarkTask, "Benchmark", configMINIMAL_STACK_SIZE * 4, NULL, benchTASK_PRIORITY, NULL );
+    xTaskCreate( prvYieldPartnerTask, "YieldPartner", configMINIMAL_STACK_SIZE, NULL, benchTASK_PRIORITY, &xYieldPartnerTask );
+
+    vTaskStartScheduler();
+
+    /* If all is well, the scheduler will now be running, and the following
+     * line will never be reached. */
+    for( ; ; )
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkTask( void * pvParameters )
+{
+    double dDisabledNs[ benchNUM_OPERATIONS ];
+    double dEnabledNs[ benchNUM_OPERATIONS ];
+    double dEventNs;
+    size_t x;
+
+    ( void ) pvParameters;
+
+    console_print( "Trace benchmark, recorder %s\n",
+                   ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_SNAPSHOT ) ? "snapshot" : "streaming" );
+
+    for( x = 0; x < benchNUM_OPERATIONS; x++ )
+    {
+        dDisabledNs[ x ] = prvMeasure( &xOperations[ x ] );
+    }
+
+    xTraceEnable( TRC_START );
+
+    for( x = 0; x < benchNUM_OPERATIONS; x++ )
+    {
+        dEnabledNs[ x ] = prvMeasure( &xOperations[ x ] );
+    }
+
+    /* Lets the stream port write out everything recorded. */
+    xTraceDisable();
+
+    console_print( "%-20s %14s %14s %14s %14s\n", "Operation", "Off (ns/op)", "On (ns/op)", "ns/event", "events/s" );
+
+    for( x = 0; x < benchNUM_OPERATIONS; x++ )
+    {
+        dEventNs = ( dEnabledNs[ x ] - dDisabledNs[ x ] ) / ( double ) xOperations[ x ].ulEventsPerOperation;
+
+        console_print( "%-20s %14.1f %14.1f %14.1f %14.0f\n",
+                       xOperations[ x ].pcName,
+                       dDisabledNs[ x ],
+                       dEnabledNs[ x ],
+                       dEventNs,
+                       ( dEventNs > 0.0 ) ? ( 1.0e9 / dEventNs ) : 0.0 );
+    }
+
+    exit( 0 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvYieldPartnerTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        /* Wait until the benchmark task starts the task switch operation. */
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        while( xYieldActive != pdFALSE )
+        {
+            taskYIELD();
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static double prvMeasure( const BenchmarkOperation_t * pxOperation )
+{
+    struct timespec xStart, xEnd;
+    double dElapsedNs;
+
+    clock_gettime( CLOCK_MONOTONIC, &xStart );
+    pxOperation->pvRun( pxOperation->ulIterations );
+    clock_gettime( CLOCK_MONOTONIC, &xEnd );
+
+    dElapsedNs = ( ( double ) ( xEnd.tv_sec - xStart.tv_sec ) * 1.0e9 ) + ( double ) ( xEnd.tv_nsec - xStart.tv_nsec );
+
+    return dElapsedNs / ( double ) pxOperation->ulIterations;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunTaskSwitch( uint32_t ulIterations )
+{
+    uint32_t ul;
+
+    xYieldActive = pdTRUE;
+    xTaskNotifyGive( xYieldPartnerTask );
+
+    for( ul = 0; ul < ulIterations; ul++ )
+    {
+        taskYIELD();
+    }
+
+    /* The partner task blocks again the next time it runs. */
+    xYieldActive = pdFALSE;
+    taskYIELD();
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunQueue( uint32_t ulIterations )
+{
+    uint32_t ul, ulValue;
+
+    for( ul = 0; ul < ulIterations; ul++ )
+    {
+        xQueueSend( xQueue, &ul, 0 );
+        xQueueReceive( xQueue, &ulValue, 0 );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunISR( uint32_t ulIterations )
+{
+    uint32_t ul;
+
+    for( ul = 0; ul < ulIterations; ul++ )
+    {
+        vTraceStoreISRBegin( xBenchmarkISR );
+        vTraceStoreISREnd( 0 );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunPrintF( uint32_t ulIterations )
+{
+    uint32_t ul;
+
+    for( ul = 0; ul < ulIterations; ul++ )
+    {
+        xTracePrintF( xBenchmarkChannel, "Iteration %d", ( int ) ul );
+    }
+}
+/*-----------------------------------------------------------*/
+
+#endif /* if ( projCOVERAGE_TEST != 1 ) */